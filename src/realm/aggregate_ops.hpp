@@ -101,6 +101,13 @@ public:
         return false;
     }
 
+    // Merge in the result of aggregating another range of values. Returns
+    // true if the result of the other range is the new result.
+    bool combine(const MinMaxAggregateOperator& other)
+    {
+        return other.m_result && accumulate(*other.m_result);
+    }
+
     bool is_null() const
     {
         return !m_result;
@@ -178,6 +185,18 @@ public:
         return false;
     }
 
+    // Merge in the result of aggregating another range of values
+    void combine(const Sum& other)
+    {
+        if constexpr (std::is_integral_v<ResultType> && std::is_signed_v<ResultType>) {
+            m_result = std::make_unsigned_t<ResultType>(m_result) + other.m_result;
+        }
+        else {
+            m_result += other.m_result;
+        }
+        m_count += other.m_count;
+    }
+
     bool is_null() const
     {
         return false;
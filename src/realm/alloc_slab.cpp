@@ -25,6 +25,10 @@
 #include <map>
 #include <atomic>
 
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
 #ifdef REALM_DEBUG
 #include <iostream>
 #include <unordered_set>
@@ -104,12 +108,12 @@ void SlabAlloc::init_streaming_header(Header* streaming_header, int file_format_
     };
 }
 
-inline SlabAlloc::Slab::Slab(ref_type r, size_t s)
+inline SlabAlloc::Slab::Slab(ref_type r, size_t s, util::File::HugePages huge_pages)
     : ref_end(r)
     , size(s)
 {
     total_slab_allocated.fetch_add(s, std::memory_order_relaxed);
-    addr = static_cast<char*>(util::mmap_anon(size));
+    addr = static_cast<char*>(util::mmap_anon(size, huge_pages));
 #if REALM_ENABLE_ALLOC_SET_ZERO
     std::fill(addr, addr + size, 0);
 #endif
@@ -241,7 +245,10 @@ SlabAlloc::FreeBlock* SlabAlloc::get_prev_block_if_mergeable(SlabAlloc::FreeBloc
     auto bb = bb_before(entry);
     if (bb->block_before_size <= 0)
         return nullptr; // no prev block, or it is in use
-    return block_before(bb);
+    FreeBlock* prev = block_before(bb);
+    if (!prev->prev)
+        return nullptr; // recycled block
+    return prev;
 }
 
 SlabAlloc::FreeBlock* SlabAlloc::get_next_block_if_mergeable(SlabAlloc::FreeBlock* entry)
@@ -249,7 +256,10 @@ SlabAlloc::FreeBlock* SlabAlloc::get_next_block_if_mergeable(SlabAlloc::FreeBloc
     auto bb = bb_after(entry);
     if (bb->block_after_size <= 0)
         return nullptr; // no next block, or it is in use
-    return block_after(bb);
+    FreeBlock* next = block_after(bb);
+    if (!next->prev && next != m_bump_block)
+        return nullptr; // recycled block
+    return next;
 }
 
 SlabAlloc::FreeList SlabAlloc::find(int size)
@@ -359,6 +369,13 @@ void SlabAlloc::mark_allocated(FreeBlock* entry)
 
 SlabAlloc::FreeBlock* SlabAlloc::allocate_block(int size)
 {
+    if (FreeBlock* block = pop_recycled_block(size))
+        return block;
+    if (m_bump_block && size_from_block(m_bump_block) >= size) {
+        FreeBlock* block = m_bump_block;
+        m_bump_block = break_block(block, size);
+        return block;
+    }
     FreeList list = find(size);
     if (list.found_exact(size)) {
         return pop_freelist_entry(list);
@@ -366,19 +383,67 @@ SlabAlloc::FreeBlock* SlabAlloc::allocate_block(int size)
     // no exact matches.
     list = find_larger(list, size);
     FreeBlock* block;
+    if (!list.found_something() && coalesce_recycled_blocks()) {
+        // The recycled blocks may have merged into a large enough block
+        return allocate_block(size);
+    }
     if (list.found_something()) {
         block = pop_freelist_entry(list);
+        FreeBlock* remaining = break_block(block, size);
+        if (remaining)
+            push_freelist_entry(remaining);
     }
     else {
+        // The remains of the old tail are still usable for smaller blocks
         block = grow_slab(size);
+        if (m_bump_block)
+            push_freelist_entry(m_bump_block);
+        m_bump_block = break_block(block, size);
     }
-    FreeBlock* remaining = break_block(block, size);
-    if (remaining)
-        push_freelist_entry(remaining);
     REALM_ASSERT_EX(size_from_block(block) >= size, size_from_block(block), size, get_file_path_for_assertions());
     return block;
 }
 
+SlabAlloc::FreeBlock* SlabAlloc::pop_recycled_block(int size)
+{
+    if (size > max_recycled_size)
+        return nullptr;
+    FreeBlock*& head = m_recycled_blocks[size / 8];
+    FreeBlock* block = head;
+    if (block) {
+        head = block->next;
+        block->clear_links();
+        --m_num_recycled_blocks;
+    }
+    return block;
+}
+
+void SlabAlloc::push_recycled_block(FreeBlock* entry)
+{
+    FreeBlock*& head = m_recycled_blocks[size_from_block(entry) / 8];
+    entry->prev = nullptr;
+    entry->next = head;
+    head = entry;
+    ++m_num_recycled_blocks;
+}
+
+bool SlabAlloc::coalesce_recycled_blocks()
+{
+    if (m_num_recycled_blocks == 0)
+        return false;
+    // A block merges with the neighbours which have already left their list, so
+    // adjacent free blocks end up as one, whichever order they are visited in.
+    for (FreeBlock*& head : m_recycled_blocks) {
+        while (FreeBlock* block = head) {
+            head = block->next;
+            block->clear_links();
+            merge_free_block(block);
+        }
+    }
+    m_num_recycled_blocks = 0;
+    return true;
+}
+
 SlabAlloc::FreeBlock* SlabAlloc::slab_to_entry(const Slab& slab, ref_type ref_start)
 {
     auto bb = reinterpret_cast<BetweenBlocks*>(slab.addr);
@@ -397,6 +462,9 @@ SlabAlloc::FreeBlock* SlabAlloc::slab_to_entry(const Slab& slab, ref_type ref_st
 void SlabAlloc::clear_freelists()
 {
     m_block_map.clear();
+    m_recycled_blocks.fill(nullptr);
+    m_num_recycled_blocks = 0;
+    m_bump_block = nullptr;
 }
 
 void SlabAlloc::rebuild_freelists_from_slab()
@@ -405,7 +473,12 @@ void SlabAlloc::rebuild_freelists_from_slab()
     ref_type ref_start = align_size_to_section_boundary(m_baseline.load(std::memory_order_relaxed));
     for (const auto& e : m_slabs) {
         FreeBlock* entry = slab_to_entry(e, ref_start);
-        push_freelist_entry(entry);
+        if (&e == &m_slabs.back()) {
+            m_bump_block = entry;
+        }
+        else {
+            push_freelist_entry(entry);
+        }
         ref_start = align_size_to_section_boundary(e.ref_end);
     }
 }
@@ -481,7 +554,7 @@ SlabAlloc::FreeBlock* SlabAlloc::grow_slab(int size)
 
     std::lock_guard<std::mutex> lock(m_mapping_mutex);
     // Create new slab and add to list of slabs
-    m_slabs.emplace_back(ref_end, new_size); // Throws
+    m_slabs.emplace_back(ref_end, new_size, m_cfg.slab_huge_pages); // Throws
     const Slab& slab = m_slabs.back();
     extend_fast_mapping_with_slab(slab.addr);
 
@@ -577,14 +650,30 @@ void SlabAlloc::do_free(ref_type ref, char* addr)
 
 void SlabAlloc::free_block(ref_type ref, SlabAlloc::FreeBlock* block)
 {
-    // merge with surrounding blocks if possible
     block->ref = ref;
+    if (size_from_block(block) <= max_recycled_size) {
+        push_recycled_block(block);
+        return;
+    }
+    merge_free_block(block);
+}
+
+void SlabAlloc::merge_free_block(SlabAlloc::FreeBlock* block)
+{
+    // merge with surrounding blocks if possible
     FreeBlock* prev = get_prev_block_if_mergeable(block);
     if (prev) {
         remove_freelist_entry(prev);
         block = merge_blocks(prev, block);
     }
     FreeBlock* next = get_next_block_if_mergeable(block);
+    if (next && next == m_bump_block) {
+        // the block becomes the start of the tail
+        block = merge_blocks(block, next);
+        block->clear_links();
+        m_bump_block = block;
+        return;
+    }
     if (next) {
         remove_freelist_entry(next);
         block = merge_blocks(block, next);
@@ -721,6 +810,7 @@ ref_type SlabAlloc::attach_file(const std::string& file_path, Config& cfg)
     // Note that get_size() may (will) return a different size before and after
     // the call below to set_encryption_key.
     m_file.set_encryption_key(cfg.encryption_key);
+    m_file.set_encryption_format(cfg.encryption_format);
     File::CloseGuard fcg(m_file);
 
     size_t size = 0;
@@ -1052,7 +1142,14 @@ void SlabAlloc::reset_free_space_tracking()
         --m_translation_table_size;
         m_slabs.pop_back();
     }
-    rebuild_freelists_from_slab();
+    // The slab which is left becomes the tail in one piece. Only the large
+    // blocks on the freelists need to be dropped; the recycled blocks and the
+    // old tail are forgotten along with it.
+    clear_freelists();
+    if (!m_slabs.empty()) {
+        ref_type ref_start = align_size_to_section_boundary(m_baseline.load(std::memory_order_relaxed));
+        m_bump_block = slab_to_entry(m_slabs.back(), ref_start);
+    }
     m_free_space_state = free_space_Clean;
     m_commit_size = 0;
 }
@@ -1200,6 +1297,18 @@ void SlabAlloc::update_reader_view(size_t file_size)
     std::move(new_mappings.begin(), new_mappings.end(), std::back_inserter(m_mappings));
     m_baseline.store(file_size, std::memory_order_relaxed);
 
+    // Advice is given per mapping, so it must be repeated for the extended
+    // last section as well as the new ones. Encrypted files are mapped to
+    // anonymous memory which is filled by decrypting, so there is no
+    // readahead to steer.
+    if (m_cfg.mapping_advice != File::advice_Normal && !m_cfg.encryption_key) {
+        size_t first = old_baseline < old_slab_base ? get_section_index(old_slab_base) - 1 : old_num_mappings;
+        for (size_t k = first; k < m_mappings.size(); ++k) {
+            auto& mapping = m_mappings[k].primary_mapping;
+            util::advise_mapping(mapping.get_addr(), mapping.get_size(), m_cfg.mapping_advice);
+        }
+    }
+
     const size_t ref_start = align_size_to_section_boundary(file_size);
     const size_t ref_displacement = ref_start - old_slab_base;
     if (ref_displacement > 0) {
@@ -1401,6 +1510,57 @@ size_t SlabAlloc::find_section_in_range(size_t start_pos, size_t free_chunk_size
 }
 
 
+void SlabAlloc::advise(ref_type ref, size_t size, util::File::MappingAdvice advice) noexcept
+{
+    REALM_ASSERT_DEBUG(ref + size <= m_baseline.load(std::memory_order_relaxed));
+    if (m_cfg.encryption_key)
+        return;
+    // Arrays crossing a section boundary are read through an extra mapping,
+    // and only their part within the section is covered.
+    size_t section_end = get_upper_section_boundary(ref);
+    if (ref + size > section_end)
+        size = section_end - ref;
+    util::advise_mapping(translate(ref), size, advice);
+}
+
+auto SlabAlloc::get_resident_ranges(size_t max_gap) -> std::vector<std::pair<size_t, size_t>>
+{
+    std::vector<std::pair<size_t, size_t>> ranges;
+#ifndef _WIN32
+    if (m_cfg.encryption_key)
+        return ranges;
+    std::lock_guard<std::mutex> lock(m_mapping_mutex);
+#if REALM_PLATFORM_APPLE
+    std::vector<char> resident;
+#else
+    std::vector<unsigned char> resident;
+#endif
+    const size_t page = page_size();
+    for (size_t k = 0; k < m_mappings.size(); ++k) {
+        auto& mapping = m_mappings[k].primary_mapping;
+        size_t num_pages = (mapping.get_size() + page - 1) / page;
+        resident.resize(num_pages); // Throws
+        if (::mincore(mapping.get_addr(), mapping.get_size(), resident.data()) != 0)
+            continue;
+        size_t section_base = get_section_base(k);
+        for (size_t i = 0; i < num_pages; ++i) {
+            if ((resident[i] & 1) == 0)
+                continue;
+            size_t pos = section_base + i * page;
+            if (!ranges.empty() && ranges.back().first + ranges.back().second + max_gap >= pos) {
+                ranges.back().second = pos + page - ranges.back().first;
+            }
+            else {
+                ranges.emplace_back(pos, page); // Throws
+            }
+        }
+    }
+#else
+    static_cast<void>(max_gap);
+#endif
+    return ranges;
+}
+
 void SlabAlloc::resize_file(size_t new_file_size)
 {
     REALM_ASSERT_EX(new_file_size == round_up_to_page_size(new_file_size), get_file_path_for_assertions());
@@ -1448,20 +1608,17 @@ void SlabAlloc::verify() const
 
 bool SlabAlloc::is_all_free() const
 {
-    // verify that slabs contain only free space.
-    // this is equivalent to each slab holding BetweenBlocks only at the ends.
+    // verify that slabs contain only free space. Recycled blocks are not merged
+    // with their neighbours, so a slab may hold more than one free block.
     for (const auto& e : m_slabs) {
-        auto first = reinterpret_cast<BetweenBlocks*>(e.addr);
-        REALM_ASSERT(first->block_before_size == 0);
-        auto last = reinterpret_cast<BetweenBlocks*>(e.addr + e.size) - 1;
-        REALM_ASSERT(last->block_after_size == 0);
-        if (first->block_after_size != last->block_before_size)
-            return false;
-        auto range = reinterpret_cast<char*>(last) - reinterpret_cast<char*>(first);
-        range -= sizeof(BetweenBlocks);
-        // the size of the free area must match the distance between the two BetweenBlocks:
-        if (range != first->block_after_size)
-            return false;
+        auto bb = reinterpret_cast<BetweenBlocks*>(e.addr);
+        REALM_ASSERT(bb->block_before_size == 0);
+        while (bb->block_after_size != 0) {
+            if (bb->block_after_size < 0)
+                return false;
+            bb = reinterpret_cast<BetweenBlocks*>(reinterpret_cast<char*>(bb + 1) + bb->block_after_size);
+        }
+        REALM_ASSERT(reinterpret_cast<char*>(bb + 1) == e.addr + e.size);
     }
     return true;
 }
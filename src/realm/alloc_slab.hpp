@@ -19,6 +19,7 @@
 #ifndef REALM_ALLOC_SLAB_HPP
 #define REALM_ALLOC_SLAB_HPP
 
+#include <array>
 #include <cstdint> // unint8_t etc
 #include <vector>
 #include <map>
@@ -93,6 +94,18 @@ public:
     /// 32-byte key to use to encrypt and decrypt the backing storage,
     /// or nullptr to disable encryption.
     ///
+    /// \var Config::encryption_format
+    /// The format of the blocks written if the file is encrypted and has no
+    /// data yet. See util::File::set_encryption_format().
+    ///
+    /// \var Config::mapping_advice
+    /// The hint given to the kernel about how the sections of an unencrypted
+    /// file will be read.
+    ///
+    /// \var Config::slab_huge_pages
+    /// How the memory used by write transactions for new and modified arrays
+    /// is backed.
+    ///
     /// \var Config::session_initiator
     /// If set, the caller is the session initiator and
     /// guarantees exclusive access to the file. If attaching in
@@ -114,6 +127,9 @@ public:
         bool clear_file = false;
         bool disable_sync = false;
         const char* encryption_key = nullptr;
+        util::File::EncryptionFormat encryption_format = util::File::encryption_CbcHmac;
+        util::File::MappingAdvice mapping_advice = util::File::advice_Normal;
+        util::File::HugePages slab_huge_pages = util::File::huge_pages_None;
     };
 
     struct Retry {
@@ -317,6 +333,15 @@ public:
         return m_commit_size;
     }
 
+    /// Give the kernel a hint about how the array at \a ref, of \a size bytes,
+    /// in the attached file will be accessed. Does nothing for encrypted files.
+    void advise(ref_type ref, size_t size, util::File::MappingAdvice advice) noexcept;
+
+    /// The ranges of the attached file which are resident in memory, as file
+    /// offset and size in ascending order. Ranges which are less than \a max_gap
+    /// bytes apart are merged. Empty for encrypted files, and on Windows.
+    std::vector<std::pair<size_t, size_t>> get_resident_ranges(size_t max_gap);
+
     /// Returns the total amount of memory currently allocated in slab area
     size_t get_allocated_size() const noexcept;
 
@@ -385,7 +410,7 @@ private:
         char* addr;
         size_t size;
 
-        Slab(ref_type r, size_t s);
+        Slab(ref_type r, size_t s, util::File::HugePages huge_pages);
         ~Slab();
 
         Slab(const Slab&) = delete;
@@ -411,6 +436,16 @@ private:
     //                  describes the size of the space before and after.
     // Each slab (area obtained from the underlying system) has a terminating BetweenBlocks
     // at the beginning and at the end of the Slab.
+    //
+    // During a write transaction the free tail of the newest slab is used as a bump
+    // pointer arena: blocks are carved off its start. Freed blocks of at most
+    // max_recycled_size bytes are not merged with their neighbours, but kept in a list
+    // per size, from which allocations of that exact size are served. Such recycled
+    // blocks have a null 'prev' link, which tells them apart from blocks on the
+    // freelists. When nothing else can serve an allocation, the recycled blocks are
+    // merged with their free neighbours before the slab area is grown. Everything is
+    // discarded when free space tracking is reset, as the slab is then one free
+    // block again.
     struct FreeBlock {
         ref_type ref;    // ref for this entry. Saves a reverse translate / representing links as refs
         FreeBlock* prev; // circular doubly linked list
@@ -429,6 +464,10 @@ private:
     Config m_cfg;
     using FreeListMap = std::map<int, FreeBlock*>; // log(N) addressing for larger blocks
     FreeListMap m_block_map;
+    constexpr static int max_recycled_size = 4096;
+    std::array<FreeBlock*, max_recycled_size / 8 + 1> m_recycled_blocks = {}; // singly linked, indexed by size / 8
+    size_t m_num_recycled_blocks = 0;
+    FreeBlock* m_bump_block = nullptr;                                          // free tail of the newest slab
 
     // abstract notion of a freelist - used to hide whether a freelist
     // is residing in the small blocks or the large blocks structures.
@@ -486,6 +525,12 @@ private:
     // Main entry points for alloc/free:
     FreeBlock* allocate_block(int size);
     void free_block(ref_type ref, FreeBlock* addr);
+    FreeBlock* pop_recycled_block(int size);
+    void push_recycled_block(FreeBlock* entry);
+    // Merge all recycled blocks with their free neighbours. Returns false if there were none.
+    bool coalesce_recycled_blocks();
+    // Merge a free block with its free neighbours and put the result on the freelists
+    void merge_free_block(FreeBlock* block);
 
     // Searching/manipulating freelists
     FreeList find(int size);
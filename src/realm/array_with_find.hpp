@@ -55,6 +55,9 @@ Searching: The main finding function is:
 #include <emmintrin.h>             // SSE2
 #include <realm/realm_nmmintrin.h> // SSE42
 #endif
+#ifdef REALM_COMPILER_AVX
+#include <immintrin.h> // AVX2
+#endif
 
 namespace realm {
 
@@ -120,6 +123,13 @@ public:
 
 #endif
 
+// AVX2 find for Equal/NotEqual on all widths, and for Less/Greater on widths of 8 bits or more
+#ifdef REALM_COMPILER_AVX
+    template <class cond, size_t width, class Callback>
+    REALM_TARGET_AVX2 bool find_avx2(int64_t value, size_t start, size_t end, size_t baseindex,
+                                     QueryStateBase* state, Callback callback) const;
+#endif
+
     template <size_t width>
     inline bool test_zero(uint64_t value) const; // Tests value for 0-elements
 
@@ -368,6 +378,15 @@ bool ArrayWithFind::find_optimized(int64_t value, size_t start, size_t end, size
     // finder cannot handle this bitwidth
     REALM_ASSERT_3(m_array.m_width, !=, 0);
 
+#if defined(REALM_COMPILER_AVX)
+    // Use AVX2 if the payload spans at least two AVX chunks (256 bits each)
+    if constexpr (bitwidth >= 8 ||
+                  (bitwidth > 0 && (std::is_same<cond, Equal>::value || std::is_same<cond, NotEqual>::value))) {
+        if (sseavx<2>() && (end - start2) * bitwidth >= 2 * 256)
+            return find_avx2<cond, bitwidth, Callback>(value, start2, end, baseindex, state, callback);
+    }
+#endif
+
 #if defined(REALM_COMPILER_SSE)
     // Only use SSE if payload is at least one SSE chunk (128 bits) in size. Also note taht SSE doesn't support
     // Less-than comparison for 64-bit values.
@@ -826,6 +845,111 @@ REALM_FORCEINLINE bool ArrayWithFind::find_sse_intern(__m128i* action_data, __m1
 }
 #endif // REALM_COMPILER_SSE
 
+#ifdef REALM_COMPILER_AVX
+// Searches [start, end) 256 bits at a time. Elements before the first byte boundary and after the last whole
+// chunk are searched with compare(). The data needs no particular alignment.
+template <class cond, size_t width, class Callback>
+REALM_TARGET_AVX2 bool ArrayWithFind::find_avx2(int64_t value, size_t start, size_t end, size_t baseindex,
+                                                QueryStateBase* state, Callback callback) const
+{
+    constexpr bool equality = std::is_same<cond, Equal>::value || std::is_same<cond, NotEqual>::value;
+    static_assert(width >= 8 || equality, "Less/Greater is only vectorized for widths of 8 bits or more");
+
+    constexpr size_t elements_per_chunk = 256 / width;
+    size_t first = width < 8 ? round_up(start, 8 / width) : start;
+    size_t num_chunks = (end - first) / elements_per_chunk;
+    size_t last = first + num_chunks * elements_per_chunk;
+
+    if (!compare<cond, width, Callback>(value, start, first, baseindex, state, callback))
+        return false;
+
+    const __m256i* data = reinterpret_cast<const __m256i*>(m_array.m_data + first * width / 8);
+    __m256i search;
+    if constexpr (width == 8)
+        search = _mm256_set1_epi8(static_cast<char>(value));
+    else if constexpr (width == 16)
+        search = _mm256_set1_epi16(static_cast<short int>(value));
+    else if constexpr (width == 32)
+        search = _mm256_set1_epi32(static_cast<int>(value));
+    else if constexpr (width == 64)
+        search = _mm256_set1_epi64x(value);
+    else
+        search = _mm256_set1_epi64x(lower_bits<width>() * value);
+
+    for (size_t i = 0; i < num_chunks; ++i) {
+        __m256i chunk = _mm256_loadu_si256(data + i);
+        size_t s = first + i * elements_per_chunk;
+
+        if constexpr (width >= 8) {
+            __m256i compare_result;
+            if constexpr (equality) {
+                if constexpr (width == 8)
+                    compare_result = _mm256_cmpeq_epi8(chunk, search);
+                else if constexpr (width == 16)
+                    compare_result = _mm256_cmpeq_epi16(chunk, search);
+                else if constexpr (width == 32)
+                    compare_result = _mm256_cmpeq_epi32(chunk, search);
+                else
+                    compare_result = _mm256_cmpeq_epi64(chunk, search);
+            }
+            else {
+                // Less is Greater with the operands swapped
+                constexpr bool gt = std::is_same<cond, Greater>::value;
+                __m256i a = gt ? chunk : search;
+                __m256i b = gt ? search : chunk;
+                if constexpr (width == 8)
+                    compare_result = _mm256_cmpgt_epi8(a, b);
+                else if constexpr (width == 16)
+                    compare_result = _mm256_cmpgt_epi16(a, b);
+                else if constexpr (width == 32)
+                    compare_result = _mm256_cmpgt_epi32(a, b);
+                else
+                    compare_result = _mm256_cmpgt_epi64(a, b);
+            }
+
+            // One bit per byte. Keep the bit of the most significant byte of each element
+            uint32_t resmask = static_cast<uint32_t>(_mm256_movemask_epi8(compare_result));
+            if constexpr (std::is_same<cond, NotEqual>::value)
+                resmask = ~resmask;
+            resmask &= width == 8 ? 0xFFFFFFFF : width == 16 ? 0xAAAAAAAA : width == 32 ? 0x88888888 : 0x80808080;
+
+            while (resmask != 0) {
+                size_t ndx = s + ctz(resmask) / (width / 8);
+                if (!find_action(ndx + baseindex, m_array.get<width>(ndx), state, callback))
+                    return false;
+                resmask &= resmask - 1;
+            }
+        }
+        else {
+            // Fold the bits of each element of (chunk ^ search) into its lowest bit, which is then set for
+            // non-zero elements, that is, for elements different from the search value
+            __m256i diff = _mm256_xor_si256(chunk, search);
+            if constexpr (width >= 2)
+                diff = _mm256_or_si256(diff, _mm256_srli_epi64(diff, 1));
+            if constexpr (width >= 4)
+                diff = _mm256_or_si256(diff, _mm256_srli_epi64(diff, 2));
+            __m256i lower = _mm256_set1_epi64x(lower_bits<width>());
+            __m256i matches = std::is_same<cond, Equal>::value ? _mm256_andnot_si256(diff, lower)
+                                                                : _mm256_and_si256(diff, lower);
+            if (_mm256_testz_si256(matches, matches))
+                continue;
+
+            alignas(32) uint64_t words[4];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(words), matches);
+            for (size_t w = 0; w < 4; ++w) {
+                for (uint64_t bits = words[w]; bits != 0; bits &= bits - 1) {
+                    size_t ndx = s + (w * 64 + ctz(bits)) / width;
+                    if (!find_action(ndx + baseindex, m_array.get<width>(ndx), state, callback))
+                        return false;
+                }
+            }
+        }
+    }
+
+    return compare<cond, width, Callback>(value, last, end, baseindex, state, callback);
+}
+#endif // REALM_COMPILER_AVX
+
 template <class cond, class Callback>
 bool ArrayWithFind::compare_leafs(const Array* foreign, size_t start, size_t end, size_t baseindex,
                                   QueryStateBase* state, Callback callback) const
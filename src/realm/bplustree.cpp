@@ -103,6 +103,7 @@ public:
     void bptree_access(size_t n, AccessFunc) override;
     size_t bptree_erase(size_t n, EraseFunc) override;
     bool bptree_traverse(TraverseFunc) override;
+    size_t bptree_search(SearchFunc) override;
     void verify() const override;
 
     // Other modifiers
@@ -170,6 +171,28 @@ private:
 
 /****************************** BPlusTreeNode ********************************/
 
+namespace {
+
+// The position in 'leaf', which starts at element 'offset' of the tree, of the
+// first element not lying before the partition point
+size_t leaf_search(BPlusTreeNode* leaf, size_t offset, BPlusTreeNode::SearchFunc func)
+{
+    size_t lo = 0;
+    size_t hi = leaf->get_node_size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (func(leaf, mid, offset + mid)) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+} // anonymous namespace
+
 BPlusTreeNode::~BPlusTreeNode()
 {
 }
@@ -221,6 +244,13 @@ bool BPlusTreeLeaf::bptree_traverse(TraverseFunc func)
     return func(this, 0) == IteratorControl::Stop;
 }
 
+size_t BPlusTreeLeaf::bptree_search(SearchFunc func)
+{
+    // Only called on a leaf which is the root. Other leaves are searched by
+    // their parent, which knows their offset.
+    return leaf_search(this, 0, func);
+}
+
 /****************************** BPlusTreeInner *******************************/
 
 BPlusTreeInner::BPlusTreeInner(BPlusTreeBase* tree)
@@ -482,6 +512,53 @@ bool BPlusTreeInner::bptree_traverse(TraverseFunc func)
     return false;
 }
 
+size_t BPlusTreeInner::bptree_search(SearchFunc func)
+{
+    auto get_child_offset = [&](size_t child_ndx) {
+        return m_offsets.is_attached() ? get_bp_node_offset(child_ndx) : child_ndx * get_elems_per_child();
+    };
+
+    // Find the last child whose first element lies before the partition point.
+    // The first element of a child is found in the leftmost leaf below it. If
+    // no child qualifies, the partition point is found in the first child.
+    size_t lo = 1;
+    size_t hi = get_node_size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        ref_type ref = get_bp_node_ref(mid);
+        char* header = m_alloc.translate(ref);
+        while (Array::get_is_inner_bptree_node_from_header(header)) {
+            ref = to_ref(Array::get(header, 1));
+            header = m_alloc.translate(ref);
+        }
+        BPlusTreeLeaf* leaf = m_tree->cache_leaf(MemRef(header, ref, m_alloc));
+        if (func(leaf, 0, get_child_offset(mid) + m_my_offset)) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    // The leaf cache may hold one of the leaves probed above
+    m_tree->invalidate_leaf_cache();
+
+    size_t child_ndx = lo - 1;
+    size_t child_offset = get_child_offset(child_ndx);
+    ref_type child_ref = get_bp_node_ref(child_ndx);
+    char* child_header = m_alloc.translate(child_ref);
+    MemRef mem(child_header, child_ref, m_alloc);
+    bool child_is_leaf = !Array::get_is_inner_bptree_node_from_header(child_header);
+    if (child_is_leaf) {
+        auto leaf = cache_leaf(mem, child_ndx, child_offset + m_my_offset);
+        return child_offset + leaf_search(leaf, child_offset + m_my_offset, func);
+    }
+    BPlusTreeInner node(m_tree);
+    node.set_parent(this, child_ndx + 1);
+    node.init_from_mem(mem);
+    node.set_offset(child_offset + m_my_offset);
+    return child_offset + node.bptree_search(func);
+}
+
 void BPlusTreeInner::move(BPlusTreeNode* new_node, size_t ndx, int64_t adj)
 {
     BPlusTreeInner* dst(static_cast<BPlusTreeInner*>(new_node));
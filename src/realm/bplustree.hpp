@@ -52,6 +52,9 @@ public:
     // Function to be called for all leaves in the tree until the function
     // returns 'IteratorControl::Stop'. 'offset' gives index of the first element in the leaf.
     using TraverseFunc = util::FunctionRef<IteratorControl(BPlusTreeNode*, size_t offset)>;
+    // Function telling if element 'ndx' of a leaf, which is element 'pos' of the
+    // tree, lies before the partition point searched for
+    using SearchFunc = util::FunctionRef<bool(BPlusTreeNode*, size_t ndx, size_t pos)>;
 
     BPlusTreeNode(BPlusTreeBase* tree)
         : m_tree(tree)
@@ -86,6 +89,8 @@ public:
     virtual void bptree_access(size_t n, AccessFunc) = 0;
     virtual size_t bptree_erase(size_t n, EraseFunc) = 0;
     virtual bool bptree_traverse(TraverseFunc) = 0;
+    // Returns the position in this subtree of the partition point
+    virtual size_t bptree_search(SearchFunc) = 0;
 
     // Move elements over in new node, starting with element at position 'ndx'.
     // If this is an inner node, the index offsets should be adjusted with 'adj'
@@ -118,6 +123,7 @@ public:
     void bptree_access(size_t n, AccessFunc) override;
     size_t bptree_erase(size_t n, EraseFunc) override;
     bool bptree_traverse(TraverseFunc) override;
+    size_t bptree_search(SearchFunc) override;
 };
 
 /*****************************************************************************/
@@ -381,6 +387,21 @@ public:
         return value;
     }
 
+    /// The position of the first element for which `pred(position, value)`
+    /// returns false. The predicate must return true for all elements before
+    /// that position and false for all elements from it. The tree is descended
+    /// once, so this is cheaper than a binary search calling get().
+    template <class Pred>
+    size_t partition_point(Pred&& pred) const
+    {
+        auto func = [&pred](BPlusTreeNode* node, size_t ndx, size_t pos) {
+            LeafNode* leaf = static_cast<LeafNode*>(node);
+            return bool(pred(pos, leaf->get(ndx)));
+        };
+
+        return m_root->bptree_search(func);
+    }
+
     std::vector<T> get_all() const
     {
         std::vector<T> all_values;
@@ -262,7 +262,7 @@ inline void Cluster::set_spec(ArrayString& arr, ColKey::Idx col_ndx) const
 }
 
 template <class T>
-inline void Cluster::do_insert_row(size_t ndx, ColKey col, Mixed init_val, bool nullable)
+inline void Cluster::do_insert_rows(size_t ndx, ColKey col, const Mixed* init_vals, size_t num_rows, bool nullable)
 {
     using U = typename util::RemoveOptional<typename T::value_type>::type;
 
@@ -271,11 +271,13 @@ inline void Cluster::do_insert_row(size_t ndx, ColKey col, Mixed init_val, bool
     arr.set_parent(this, col_ndx.val + s_first_col_index);
     set_spec<T>(arr, col_ndx);
     arr.init_from_parent();
-    if (init_val.is_null()) {
-        arr.insert(ndx, T::default_value(nullable));
-    }
-    else {
-        arr.insert(ndx, init_val.get<U>());
+    for (size_t i = 0; i < num_rows; ++i) {
+        if (!init_vals || init_vals[i].is_null()) {
+            arr.insert(ndx + i, T::default_value(nullable));
+        }
+        else {
+            arr.insert(ndx + i, init_vals[i].get<U>());
+        }
     }
 }
 
@@ -355,88 +357,149 @@ void Cluster::insert_row(size_t ndx, ObjKey k, const FieldValues& init_values)
         Array::set(s_key_ref_or_size_index, Array::get(s_key_ref_or_size_index) + 2); // Increments size by 1
     }
 
+    ObjKey origin_key(k.value + get_offset());
     auto val = init_values.begin();
     auto insert_in_column = [&](ColKey col_key) {
-        auto col_ndx = col_key.get_index();
-        auto attr = col_key.get_attrs();
         Mixed init_value;
         // init_values must be sorted in col_ndx order - this is ensured by ClustTree::insert()
-        if (val != init_values.end() && val->col_key.get_index().val == col_ndx.val) {
+        if (val != init_values.end() && val->col_key.get_index().val == col_key.get_index().val) {
             init_value = val->value;
             ++val;
         }
+        insert_rows_in_column(ndx, col_key, &init_value, 1, &origin_key);
+        return IteratorControl::AdvanceToNext;
+    };
+    m_tree_top.for_each_and_every_column(insert_in_column);
+}
 
-        auto type = col_key.get_type();
-        if (attr.test(col_attr_Collection)) {
-            REALM_ASSERT(init_value.is_null());
-            ArrayRef arr(m_alloc);
-            arr.set_parent(this, col_ndx.val + s_first_col_index);
-            arr.init_from_parent();
-            arr.insert(ndx, 0);
-            return IteratorControl::AdvanceToNext;
+size_t Cluster::append(const ClusterRows& rows, size_t begin)
+{
+    size_t sz = node_size();
+    size_t num_rows = std::min(cluster_node_size - sz, rows.keys.size() - begin);
+    if (num_rows == 0)
+        return 0;
+
+    // Ensure the cluster array is big enough to hold 64 bit values.
+    copy_on_write(m_size * 8);
+
+    auto keys = rows.keys.sub_span(begin, num_rows);
+    int64_t offset = int64_t(get_offset());
+    REALM_ASSERT_DEBUG(keys.front().value - offset > get_last_key_value());
+    if (!m_keys.is_attached()) {
+        bool consecutive = true;
+        for (size_t i = 0; i < num_rows && consecutive; ++i)
+            consecutive = (keys[i].value - offset == int64_t(sz + i));
+        if (consecutive) {
+            // Increments size by num_rows
+            Array::set(s_key_ref_or_size_index, Array::get(s_key_ref_or_size_index) + 2 * int64_t(num_rows));
+        }
+        else {
+            ensure_general_form();
         }
+    }
+    if (m_keys.is_attached()) {
+        for (auto k : keys)
+            m_keys.add(k.value - offset);
+    }
 
-        bool nullable = attr.test(col_attr_Nullable);
-        switch (type) {
-            case col_type_Int:
-                if (attr.test(col_attr_Nullable)) {
-                    do_insert_row<ArrayIntNull>(ndx, col_key, init_value, nullable);
-                }
-                else {
-                    do_insert_row<ArrayInteger>(ndx, col_key, init_value, nullable);
-                }
-                break;
-            case col_type_Bool:
-                do_insert_row<ArrayBoolNull>(ndx, col_key, init_value, nullable);
-                break;
-            case col_type_Float:
-                do_insert_row<ArrayFloatNull>(ndx, col_key, init_value, nullable);
-                break;
-            case col_type_Double:
-                do_insert_row<ArrayDoubleNull>(ndx, col_key, init_value, nullable);
-                break;
-            case col_type_String:
-                do_insert_row<ArrayString>(ndx, col_key, init_value, nullable);
-                break;
-            case col_type_Binary:
-                do_insert_row<ArrayBinary>(ndx, col_key, init_value, nullable);
-                break;
-            case col_type_Mixed: {
-                do_insert_mixed(ndx, col_key, init_value, ObjKey(k.value + get_offset()));
-                break;
-            }
-            case col_type_Timestamp:
-                do_insert_row<ArrayTimestamp>(ndx, col_key, init_value, nullable);
-                break;
-            case col_type_Decimal:
-                do_insert_row<ArrayDecimal128>(ndx, col_key, init_value, nullable);
-                break;
-            case col_type_ObjectId:
-                do_insert_row<ArrayObjectIdNull>(ndx, col_key, init_value, nullable);
-                break;
-            case col_type_UUID:
-                do_insert_row<ArrayUUIDNull>(ndx, col_key, init_value, nullable);
-                break;
-            case col_type_Link:
-                do_insert_key(ndx, col_key, init_value, ObjKey(k.value + get_offset()));
-                break;
-            case col_type_TypedLink:
-                do_insert_link(ndx, col_key, init_value, ObjKey(k.value + get_offset()));
-                break;
-            case col_type_BackLink: {
-                ArrayBacklink arr(m_alloc);
-                arr.set_parent(this, col_ndx.val + s_first_col_index);
-                arr.init_from_parent();
-                arr.insert(ndx, 0);
-                break;
-            }
-            default:
-                REALM_ASSERT(false);
-                break;
+    auto col = rows.columns.begin();
+    auto insert_in_column = [&](ColKey col_key) {
+        const Mixed* values = nullptr;
+        if (col != rows.columns.end() && col->first.get_index().val == col_key.get_index().val) {
+            values = col->second.data() + begin;
+            ++col;
         }
+        insert_rows_in_column(sz, col_key, values, num_rows, keys.data());
         return IteratorControl::AdvanceToNext;
     };
     m_tree_top.for_each_and_every_column(insert_in_column);
+    return num_rows;
+}
+
+// Inserts `num_rows` values at `ndx` in the column. `init_values` may be null,
+// in which case all of them get the default value of the column.
+void Cluster::insert_rows_in_column(size_t ndx, ColKey col_key, const Mixed* init_values, size_t num_rows,
+                                    const ObjKey* origin_keys)
+{
+    auto col_ndx = col_key.get_index();
+    auto attr = col_key.get_attrs();
+    auto type = col_key.get_type();
+    auto value = [&](size_t i) {
+        return init_values ? init_values[i] : Mixed();
+    };
+
+    if (attr.test(col_attr_Collection)) {
+        ArrayRef arr(m_alloc);
+        arr.set_parent(this, col_ndx.val + s_first_col_index);
+        arr.init_from_parent();
+        for (size_t i = 0; i < num_rows; ++i) {
+            REALM_ASSERT(value(i).is_null());
+            arr.insert(ndx + i, 0);
+        }
+        return;
+    }
+
+    bool nullable = attr.test(col_attr_Nullable);
+    switch (type) {
+        case col_type_Int:
+            if (attr.test(col_attr_Nullable)) {
+                do_insert_rows<ArrayIntNull>(ndx, col_key, init_values, num_rows, nullable);
+            }
+            else {
+                do_insert_rows<ArrayInteger>(ndx, col_key, init_values, num_rows, nullable);
+            }
+            break;
+        case col_type_Bool:
+            do_insert_rows<ArrayBoolNull>(ndx, col_key, init_values, num_rows, nullable);
+            break;
+        case col_type_Float:
+            do_insert_rows<ArrayFloatNull>(ndx, col_key, init_values, num_rows, nullable);
+            break;
+        case col_type_Double:
+            do_insert_rows<ArrayDoubleNull>(ndx, col_key, init_values, num_rows, nullable);
+            break;
+        case col_type_String:
+            do_insert_rows<ArrayString>(ndx, col_key, init_values, num_rows, nullable);
+            break;
+        case col_type_Binary:
+            do_insert_rows<ArrayBinary>(ndx, col_key, init_values, num_rows, nullable);
+            break;
+        case col_type_Mixed:
+            for (size_t i = 0; i < num_rows; ++i)
+                do_insert_mixed(ndx + i, col_key, value(i), origin_keys[i]);
+            break;
+        case col_type_Timestamp:
+            do_insert_rows<ArrayTimestamp>(ndx, col_key, init_values, num_rows, nullable);
+            break;
+        case col_type_Decimal:
+            do_insert_rows<ArrayDecimal128>(ndx, col_key, init_values, num_rows, nullable);
+            break;
+        case col_type_ObjectId:
+            do_insert_rows<ArrayObjectIdNull>(ndx, col_key, init_values, num_rows, nullable);
+            break;
+        case col_type_UUID:
+            do_insert_rows<ArrayUUIDNull>(ndx, col_key, init_values, num_rows, nullable);
+            break;
+        case col_type_Link:
+            for (size_t i = 0; i < num_rows; ++i)
+                do_insert_key(ndx + i, col_key, value(i), origin_keys[i]);
+            break;
+        case col_type_TypedLink:
+            for (size_t i = 0; i < num_rows; ++i)
+                do_insert_link(ndx + i, col_key, value(i), origin_keys[i]);
+            break;
+        case col_type_BackLink: {
+            ArrayBacklink arr(m_alloc);
+            arr.set_parent(this, col_ndx.val + s_first_col_index);
+            arr.init_from_parent();
+            for (size_t i = 0; i < num_rows; ++i)
+                arr.insert(ndx + i, 0);
+            break;
+        }
+        default:
+            REALM_ASSERT(false);
+            break;
+    }
 }
 
 template <class T>
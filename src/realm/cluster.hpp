@@ -25,6 +25,7 @@
 #include <realm/array_unsigned.hpp>
 #include <realm/data_type.hpp>
 #include <realm/column_type_traits.hpp>
+#include <realm/util/span.hpp>
 
 namespace realm {
 
@@ -67,6 +68,16 @@ private:
     std::vector<FieldValue> m_values;
 };
 
+/// Objects to be appended to a cluster tree by ClusterTree::append(). Object
+/// `i` has the key `keys[i]`, and the value `columns[j].second[i]` in the
+/// column `columns[j].first`. Keys must be increasing, and columns must be
+/// ordered by column index. Columns which are not mentioned get their default
+/// value.
+struct ClusterRows {
+    util::Span<const ObjKey> keys;
+    std::vector<std::pair<ColKey, util::Span<const Mixed>>> columns;
+};
+
 class ClusterNode : public Array {
 public:
     // This structure is used to bring information back to the upper nodes when
@@ -152,6 +163,10 @@ public:
     /// Create a new object identified by 'key' and update 'state' accordingly
     /// Return reference to new node created (if any)
     virtual ref_type insert(ObjKey k, const FieldValues& init_values, State& state) = 0;
+    /// Append the objects `rows[begin]`, ... to the last leaf of this subtree,
+    /// as many as fit without splitting it. Their keys must be greater than all
+    /// keys in the tree. Returns the number of objects appended.
+    virtual size_t append(const ClusterRows& rows, size_t begin) = 0;
     /// Locate object identified by 'key' and update 'state' accordingly
     void get(ObjKey key, State& state) const;
     /// Locate object identified by 'key' and update 'state' accordingly
@@ -283,6 +298,7 @@ public:
         return size() - s_first_col_index;
     }
     ref_type insert(ObjKey k, const FieldValues& init_values, State& state) override;
+    size_t append(const ClusterRows& rows, size_t begin) override;
     bool try_get(ObjKey k, State& state) const noexcept override;
     ObjKey get(size_t, State& state) const override;
     size_t get_ndx(ObjKey key, size_t ndx) const noexcept override;
@@ -313,8 +329,10 @@ private:
     void do_create(ColKey col);
     template <class T>
     void do_insert_column(ColKey col, bool nullable);
+    void insert_rows_in_column(size_t ndx, ColKey col, const Mixed* init_values, size_t num_rows,
+                               const ObjKey* origin_keys);
     template <class T>
-    void do_insert_row(size_t ndx, ColKey col, Mixed init_val, bool nullable);
+    void do_insert_rows(size_t ndx, ColKey col, const Mixed* init_vals, size_t num_rows, bool nullable);
     template <class T>
     void do_move(size_t ndx, ColKey col, Cluster* to);
     template <class T>
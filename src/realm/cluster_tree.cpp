@@ -91,6 +91,7 @@ public:
     void remove_column(ColKey col) override;
     size_t nb_columns() const override;
     ref_type insert(ObjKey k, const FieldValues& init_values, State& state) override;
+    size_t append(const ClusterRows& rows, size_t begin) override;
     bool try_get(ObjKey k, State& state) const noexcept override;
     ObjKey get(size_t ndx, State& state) const override;
     size_t get_ndx(ObjKey key, size_t ndx) const noexcept override;
@@ -336,6 +337,18 @@ ref_type ClusterNodeInner::insert(ObjKey key, const FieldValues& init_values, Cl
     });
 }
 
+size_t ClusterNodeInner::append(const ClusterRows& rows, size_t begin)
+{
+    // The keys are greater than all keys in the tree, so they belong in the
+    // last child
+    ObjKey key(rows.keys[begin].value - int64_t(m_offset));
+    return recurse<size_t>(key, [this, &rows, begin](ClusterNode* node, ChildInfo&) {
+        size_t num_rows = node->append(rows, begin);
+        set_tree_size(get_tree_size() + num_rows);
+        return num_rows;
+    });
+}
+
 bool ClusterNodeInner::try_get(ObjKey key, ClusterNode::State& state) const noexcept
 {
     ChildInfo child_info;
@@ -892,6 +905,30 @@ void ClusterTree::insert_fast(ObjKey k, const FieldValues& init_values, ClusterN
     m_size++;
 }
 
+void ClusterTree::append(const ClusterRows& rows, size_t& num_appended)
+{
+    REALM_ASSERT_DEBUG(std::is_sorted(rows.keys.begin(), rows.keys.end()));
+    REALM_ASSERT(rows.keys.empty() || rows.keys.front().value > get_last_key_value());
+    num_appended = 0;
+    while (num_appended < rows.keys.size()) {
+        size_t n = m_root->append(rows, num_appended);
+        if (n) {
+            m_size += n;
+        }
+        else {
+            // The last leaf is full. Inserting the next object after it
+            // starts a new leaf.
+            FieldValues values;
+            for (auto& [col_key, col_values] : rows.columns)
+                values.insert(col_key, col_values[num_appended]);
+            ClusterNode::State state;
+            insert_fast(rows.keys[num_appended], values, state);
+            n = 1;
+        }
+        num_appended += n;
+    }
+}
+
 ClusterNode::State ClusterTree::insert(ObjKey k, const FieldValues& init_values)
 {
     ClusterNode::State state;
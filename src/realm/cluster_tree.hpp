@@ -130,6 +130,11 @@ public:
 
     // Insert entry for object, but do not create and return the object accessor
     void insert_fast(ObjKey k, const FieldValues& init_values, ClusterNode::State& state);
+    /// Insert the objects in `rows`, whose keys must be greater than all keys
+    /// in the tree, filling up one leaf at a time. Like insert_fast(), this
+    /// does not update search indexes or bump versions. `num_appended` is the
+    /// number of objects inserted, also if an exception is thrown.
+    void append(const ClusterRows& rows, size_t& num_appended);
     // Create and return object
     ClusterNode::State insert(ObjKey k, const FieldValues&);
     // Delete object with given key
@@ -33,6 +33,7 @@
 
 #include <realm/disable_sync_to_disk.hpp>
 #include <realm/group_writer.hpp>
+#include <realm/hot_ranges.hpp>
 #include <realm/impl/simulated_failure.hpp>
 #include <realm/replication.hpp>
 #include <realm/util/errno.hpp>
@@ -42,6 +43,7 @@
 #include <realm/util/scope_exit.hpp>
 #include <realm/util/thread.hpp>
 #include <realm/util/to_string.hpp>
+#include <realm/write_ahead_log.hpp>
 
 #ifndef _WIN32
 #include <sys/wait.h>
@@ -406,6 +408,39 @@ TransactionRef make_transaction_ref(Args&&... args)
     return TransactionRef(new Transaction(std::forward<Args>(args)...), TransactionDeleter);
 }
 
+// Read the arrays near the root of the snapshot at \a top_ref: the top array,
+// the table names and tables, the top array of each table and its children.
+// One level is requested at a time, as the refs of a level are only known once
+// the arrays of the level above have been read, so this blocks until then.
+void prefetch_top_levels(SlabAlloc& alloc, ref_type top_ref)
+{
+    constexpr int num_levels = 4;
+    std::vector<ref_type> refs = {top_ref};
+    for (int level = 0; level < num_levels && !refs.empty(); ++level) {
+        for (ref_type ref : refs)
+            alloc.advise(ref, NodeHeader::header_size, File::advice_WillNeed);
+        std::vector<ref_type> next_refs;
+        for (ref_type ref : refs) {
+            char* header = alloc.translate(ref);
+            alloc.advise(ref, NodeHeader::get_byte_size_from_header(header), File::advice_WillNeed);
+            if (level + 1 == num_levels || !NodeHeader::get_hasrefs_from_header(header))
+                continue;
+            Array array(alloc);
+            array.init_from_mem(MemRef(header, ref, alloc));
+            size_t size = array.size();
+            // Readers need neither the free-lists nor the history
+            if (level == 0)
+                size = std::min(size, size_t(2));
+            for (size_t i = 0; i < size; ++i) {
+                int64_t value = array.get(i);
+                if (value != 0 && (value & 1) == 0)
+                    next_refs.push_back(to_ref(value));
+            }
+        }
+        refs = std::move(next_refs);
+    }
+}
+
 } // anonymous namespace
 
 
@@ -630,6 +665,48 @@ std::string DBOptions::sys_tmp_dir = std::filesystem::temp_directory_path().stri
 std::string DBOptions::sys_tmp_dir = getenv("TMPDIR") ? getenv("TMPDIR") : "";
 #endif
 
+// Read locks on the latest snapshot held on behalf of the read transactions of
+// a DB. The threads of the DB are spread over a number of slots, and each slot
+// holds a read lock on the latest snapshot it has seen, along with the number
+// of transactions using it. A transaction on the same snapshot only increments
+// that number under the mutex of the slot, instead of locking DB::m_mutex and
+// incrementing the count of the ringbuffer entry shared with other processes.
+//
+// A read lock which is no longer used is released when any slot moves on to a
+// newer snapshot, or when the DB commits, so that a slot whose threads have
+// stopped reading does not retain an old snapshot in a DB which never commits. Each read lock is tracked in
+// DB::m_local_locks_held like any other, so closing the DB releases them.
+class DB::ReadLockCache {
+public:
+    struct Pin {
+        ReadLockInfo read_lock;
+        size_t num_users;
+    };
+
+    struct alignas(64) Slot {
+        std::mutex mutex;
+        std::vector<Pin> pins; // The last one is on the newest snapshot
+    };
+
+    static constexpr int num_slots = 16;
+    Slot slots[num_slots];
+
+    static int slot_of_this_thread() noexcept
+    {
+        return int(std::hash<std::thread::id>()(std::this_thread::get_id()) % num_slots);
+    }
+
+    // Forget all read locks, which must have been released by
+    // DB::release_all_read_locks().
+    void clear() noexcept
+    {
+        for (auto& slot : slots) {
+            std::lock_guard<std::mutex> lock(slot.mutex);
+            slot.pins.clear();
+        }
+    }
+};
+
 // NOTES ON CREATION AND DESTRUCTION OF SHARED MUTEXES:
 //
 // According to the 'process-sharing example' in the POSIX man page
@@ -656,15 +733,20 @@ void DB::open(const std::string& path, bool no_create_file, const DBOptions opti
     REALM_ASSERT(!is_attached());
 
     m_db_path = path;
+    m_share_frozen_transactions = options.share_frozen_transactions;
     SlabAlloc& alloc = m_alloc;
     if (options.is_immutable) {
         SlabAlloc::Config cfg;
         cfg.read_only = true;
         cfg.no_create = true;
         cfg.encryption_key = options.encryption_key;
+        cfg.encryption_format = options.encryption_format;
+        cfg.mapping_advice = options.mapping_advice;
         auto top_ref = alloc.attach_file(path, cfg);
         SlabAlloc::DetachGuard dg(alloc);
         Group::read_only_version_check(alloc, top_ref, path);
+        if (options.prefetch_top_levels && top_ref && !options.encryption_key)
+            prefetch_top_levels(alloc, top_ref);
         m_fake_read_lock_if_immutable = ReadLockInfo::make_fake(top_ref, m_alloc.get_baseline());
         dg.release();
         return;
@@ -888,6 +970,11 @@ void DB::open(const std::string& path, bool no_create_file, const DBOptions opti
             // proceed to initialize versioning and other metadata information related to
             // the database. Also create the database if we're beginning a new session
             bool begin_new_session = (info->num_participants == 0);
+            if (begin_new_session && !m_key) {
+                // A previous session which used Durability::WAL may have ended
+                // without bringing the file up to date with its log.
+                recover_write_ahead_log(path, options.durability != Durability::MemOnly); // Throws
+            }
             SlabAlloc::Config cfg;
             cfg.session_initiator = begin_new_session;
             cfg.is_shared = true;
@@ -905,6 +992,9 @@ void DB::open(const std::string& path, bool no_create_file, const DBOptions opti
             cfg.clear_file = (options.durability == Durability::MemOnly && begin_new_session);
 
             cfg.encryption_key = m_key;
+            cfg.encryption_format = m_encryption_format;
+            cfg.mapping_advice = options.mapping_advice;
+            cfg.slab_huge_pages = options.slab_huge_pages;
             ref_type top_ref;
             try {
                 top_ref = alloc.attach_file(path, cfg); // Throws
@@ -954,6 +1044,8 @@ void DB::open(const std::string& path, bool no_create_file, const DBOptions opti
                     Array top{alloc};
                     top.init_from_ref(top_ref);
                     Group::validate_top_array(top, alloc);
+                    if (options.prefetch_top_levels && !m_key)
+                        prefetch_top_levels(alloc, top_ref);
                 }
                 catch (InvalidDatabase& e) {
                     if (e.get_path().empty()) {
@@ -1143,6 +1235,18 @@ void DB::open(const std::string& path, bool no_create_file, const DBOptions opti
             m_pick_next_writer.set_shared_part(info->pick_next_writer, m_lockfile_prefix, "pick_writer",
                                                options.temp_dir);
 
+            if (options.durability == Durability::WAL && !m_key) {
+                m_write_ahead_log = std::make_unique<WriteAheadLog>(get_core_file(path, CoreFileType::WAL)); // Throws
+                m_checkpoint_helper = std::make_unique<CheckpointHelper>(this);
+                m_wal_checkpoint_size = options.wal_checkpoint_size;
+            }
+            if (options.warm_start_interval.count() > 0 && !m_key) {
+                m_warm_start_helper = std::make_unique<WarmStartHelper>(this, options.warm_start_interval);
+            }
+            if (options.cache_read_locks && !m_read_lock_cache) {
+                m_read_lock_cache = std::make_unique<ReadLockCache>();
+            }
+
             // make our presence noted:
             ++info->num_participants;
 
@@ -1278,6 +1382,9 @@ bool DB::compact(bool bump_version_number, util::Optional<const char*> output_en
     if (is_attached() == false) {
         throw std::runtime_error(m_db_path + ": compact must be done on an open/attached DB");
     }
+    // Read locks kept by the cache count as transactions
+    if (m_read_lock_cache)
+        release_idle_cached_read_locks(true);
     SharedInfo* info = m_file_map.get_addr();
     Durability dura = Durability(info->durability);
     const char* write_key = bool(output_encryption_key) ? *output_encryption_key : m_key;
@@ -1297,6 +1404,11 @@ bool DB::compact(bool bump_version_number, util::Optional<const char*> output_en
         if (m_transaction_count != 0)
             return false;
 
+        // The log only applies to the current file, so that must be brought
+        // up to date with it before it is replaced.
+        if (m_write_ahead_log)
+            do_checkpoint_wal(); // Throws
+
         // group::write() will throw if the file already exists.
         // To prevent this, we have to remove the file (should it exist)
         // before calling group::write().
@@ -1305,13 +1417,16 @@ bool DB::compact(bool bump_version_number, util::Optional<const char*> output_en
         // Using start_read here ensures that we have access to the latest entry
         // in the ringbuffer. We need to have access to that later to update top_ref and file_size.
         // This is also needed to attach the group (get the proper top pointer, etc)
-        TransactionRef tr = start_read();
+        // The version is given explicitly, so that the read lock does not come
+        // from the read lock cache, which would keep it after the file is replaced.
+        TransactionRef tr = start_read(get_version_id_of_latest_snapshot());
 
         // Compact by writing a new file holding only live data, then renaming the new file
         // so it becomes the database file, replacing the old one in the process.
         try {
             File file;
             file.open(tmp_path, File::access_ReadWrite, File::create_Must, 0);
+            file.set_encryption_format(m_encryption_format);
             int incr = bump_version_number ? 1 : 0;
             Group::DefaultTableWriter writer;
             tr->write(file, write_key, info->latest_version_number + incr, writer); // Throws
@@ -1349,6 +1464,11 @@ bool DB::compact(bool bump_version_number, util::Optional<const char*> output_en
 #else
         util::File::move(tmp_path, m_db_path);
 #endif
+        if (m_write_ahead_log && write_key) {
+            // Encrypted files are committed as with Durability::Full
+            m_write_ahead_log.reset();
+            File::try_remove(get_core_file(m_db_path, CoreFileType::WAL));
+        }
 
         SlabAlloc::Config cfg;
         cfg.session_initiator = true;
@@ -1358,6 +1478,7 @@ bool DB::compact(bool bump_version_number, util::Optional<const char*> output_en
         cfg.no_create = true;
         cfg.clear_file = false;
         cfg.encryption_key = write_key;
+        cfg.encryption_format = m_encryption_format;
         ref_type top_ref;
         top_ref = m_alloc.attach_file(m_db_path, cfg);
         m_alloc.init_mapping_management(info->latest_version_number);
@@ -1365,6 +1486,8 @@ bool DB::compact(bool bump_version_number, util::Optional<const char*> output_en
         SharedInfo* r_info = m_reader_map.get_addr();
         size_t file_size = m_alloc.get_baseline();
         r_info->init_versioning(top_ref, file_size, info->latest_version_number);
+        // The free-lists of the new file are unrelated to the old ones
+        *m_free_space_index = FreeSpaceIndex();
     }
     return true;
 }
@@ -1397,6 +1520,7 @@ void DB::write_copy(StringData path, const char* output_encryption_key)
     File file;
     file.open(path, File::access_ReadWrite, File::create_Must, 0);
     file.resize(0);
+    file.set_encryption_format(m_encryption_format);
 
     tr->write(file, output_encryption_key, info->latest_version_number, writer);
 }
@@ -1438,8 +1562,19 @@ void DB::release_all_read_locks() noexcept
 // directly.
 void DB::close(bool allow_open_read_transactions)
 {
-    // make helper thread terminate
+    {
+        std::lock_guard<std::mutex> lock(m_frozen_transactions_mutex);
+        m_frozen_transactions.clear();
+    }
+    // make helper threads terminate
     m_commit_helper.reset();
+    m_group_commit_helper.reset();
+    m_checkpoint_helper.reset();
+    if (m_warm_start_helper) {
+        m_warm_start_helper.reset();
+        if (is_attached())
+            record_hot_ranges();
+    }
 
     if (m_fake_read_lock_if_immutable) {
         if (!is_attached())
@@ -1464,6 +1599,8 @@ void DB::close_internal(std::unique_lock<InterprocessMutex> lock, bool allow_ope
     if (!is_attached())
         return;
 
+    if (m_read_lock_cache)
+        release_idle_cached_read_locks(true);
     {
         std::lock_guard<std::recursive_mutex> local_lock(m_mutex);
         if (m_write_transaction_open)
@@ -1476,6 +1613,21 @@ void DB::close_internal(std::unique_lock<InterprocessMutex> lock, bool allow_ope
         if (!lock.owns_lock())
             lock.lock();
 
+        if (m_write_ahead_log) {
+            // The last participant brings the file up to date, so that the next
+            // session does not have to replay the log.
+            if (info->num_participants == 1) {
+                try {
+                    do_checkpoint_wal(); // Throws
+                    m_write_ahead_log.reset();
+                    File::try_remove(get_core_file(m_db_path, CoreFileType::WAL));
+                }
+                catch (...) {
+                } // ignored on purpose.
+            }
+            m_write_ahead_log.reset();
+        }
+
         if (m_alloc.is_attached())
             m_alloc.detach();
 
@@ -1483,6 +1635,8 @@ void DB::close_internal(std::unique_lock<InterprocessMutex> lock, bool allow_ope
             REALM_ASSERT(info->sync_agent_present);
             info->sync_agent_present = 0; // Set to false
         }
+        if (m_read_lock_cache)
+            m_read_lock_cache->clear();
         release_all_read_locks();
         --info->num_participants;
         bool end_of_session = info->num_participants == 0;
@@ -1753,6 +1907,277 @@ void DB::AsyncCommitHelper::main()
 }
 
 
+class DB::GroupCommitHelper {
+public:
+    GroupCommitHelper(DB* db)
+        : m_db(db)
+    {
+    }
+    ~GroupCommitHelper()
+    {
+        {
+            std::unique_lock lg(m_mutex);
+            if (!m_running) {
+                return;
+            }
+            m_running = false;
+            m_cv.notify_one();
+        }
+        // The worker makes the pending commits durable before it terminates
+        m_thread.join();
+    }
+
+    // Must be called by the committing thread while it holds the write mutex
+    // and the read lock on the snapshot which the commit was based on.
+    util::Future<version_type> add_commit(version_type version, const ReadLockInfo& base)
+    {
+        std::unique_lock lg(m_mutex);
+        if (!m_base_lock) {
+            ReadLockInfo lock;
+            m_db->grab_read_lock(lock, VersionID(base.m_version, base.m_reader_idx)); // Throws
+            m_base_lock = lock;
+        }
+        auto pf = util::make_promise_future<version_type>();
+        m_pending.emplace_back(version, std::move(pf.promise));
+        start_thread();
+        m_cv.notify_one();
+        return std::move(pf.future);
+    }
+
+private:
+    DB* m_db;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    // Commits which are not known to be durable yet, in order of version
+    std::deque<std::pair<version_type, util::Promise<version_type>>> m_pending;
+    // A read lock on a snapshot no newer than the one selected by the file
+    // header. It is held while there are commits which are not durable, so that
+    // the space used by the selected snapshot cannot be reused until a newer
+    // snapshot has been selected.
+    util::Optional<ReadLockInfo> m_base_lock;
+    bool m_running = false;
+
+    void main();
+
+    void start_thread()
+    {
+        if (m_running) {
+            return;
+        }
+        m_running = true;
+        m_thread = std::thread([this]() {
+            main();
+        });
+    }
+};
+
+void DB::GroupCommitHelper::main()
+{
+    std::unique_lock lg(m_mutex);
+    for (;;) {
+        m_cv.wait(lg, [this] {
+            return !m_running || !m_pending.empty();
+        });
+        if (m_pending.empty()) {
+            break;
+        }
+
+        // Commits which arrive while we flush are covered by the next flush
+        lg.unlock();
+        GroupCommitFlush flush;
+        ReadLockInfo& snapshot = flush.snapshot;
+        Status status = Status::OK();
+        bool selected = false;
+        try {
+            selected = m_db->flush_group_commit(flush); // Throws
+        }
+        catch (...) {
+            status = exception_to_status();
+        }
+        bool has_snapshot = snapshot.m_version != std::numeric_limits<version_type>::max();
+        if (status.is_ok() && !selected) {
+            // The snapshot is not known to be durable, so nothing is reported
+            // and the flush is retried. The base lock is kept, as the header may still select the
+            // snapshot it protects.
+            m_db->release_read_lock(snapshot);
+            lg.lock();
+            continue;
+        }
+        lg.lock();
+
+        // If the flush failed before the snapshot was chosen, it was meant to
+        // cover all pending commits.
+        while (!m_pending.empty() && m_pending.front().first <= snapshot.m_version) {
+            if (status.is_ok()) {
+                m_pending.front().second.emplace_value(m_pending.front().first);
+            }
+            else {
+                m_pending.front().second.set_error(status);
+            }
+            m_pending.pop_front();
+        }
+
+        if (status.is_ok()) {
+            // The snapshot, or a newer one, is now selected in the file header,
+            // so the lock on it can replace the base lock.
+            REALM_ASSERT(m_base_lock);
+            m_db->release_read_lock(*m_base_lock);
+            m_base_lock = snapshot;
+            if (m_pending.empty()) {
+                m_db->release_read_lock(*m_base_lock);
+                m_base_lock.reset();
+            }
+        }
+        else if (has_snapshot) {
+            // Keep the base lock, as the file header may still select the
+            // snapshot it protects.
+            m_db->release_read_lock(snapshot);
+        }
+    }
+    if (m_base_lock) {
+        m_db->release_read_lock(*m_base_lock);
+        m_base_lock.reset();
+    }
+}
+
+
+class DB::CheckpointHelper {
+public:
+    CheckpointHelper(DB* db)
+        : m_db(db)
+    {
+    }
+    ~CheckpointHelper()
+    {
+        {
+            std::unique_lock lg(m_mutex);
+            if (!m_running) {
+                return;
+            }
+            m_running = false;
+            m_cv.notify_one();
+        }
+        // The worker finishes a requested checkpoint before it terminates
+        m_thread.join();
+    }
+
+    void request_checkpoint()
+    {
+        std::unique_lock lg(m_mutex);
+        m_requested = true;
+        start_thread();
+        m_cv.notify_one();
+    }
+
+private:
+    DB* m_db;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_requested = false;
+    bool m_running = false;
+
+    void main()
+    {
+        std::unique_lock lg(m_mutex);
+        for (;;) {
+            m_cv.wait(lg, [this] {
+                return !m_running || m_requested;
+            });
+            if (!m_requested) {
+                break;
+            }
+            m_requested = false;
+            lg.unlock();
+            try {
+                m_db->checkpoint_wal(); // Throws
+            }
+            catch (...) {
+                // The log is kept, and the checkpoint is retried when it is
+                // requested again by a later commit.
+            }
+            lg.lock();
+        }
+    }
+
+    void start_thread()
+    {
+        if (m_running) {
+            return;
+        }
+        m_running = true;
+        m_thread = std::thread([this]() {
+            main();
+        });
+    }
+};
+
+// Reads the ranges recorded by an earlier process into memory when the DB is
+// opened, and then records the ranges which are resident at every interval.
+class DB::WarmStartHelper {
+public:
+    WarmStartHelper(DB* db, std::chrono::seconds interval)
+        : m_db(db)
+        , m_interval(interval)
+        , m_ranges(HotRanges::read(get_core_file(db->m_db_path, CoreFileType::HotRanges))) // Throws
+    {
+        m_thread = std::thread([this]() {
+            main();
+        });
+    }
+    ~WarmStartHelper()
+    {
+        {
+            std::lock_guard lg(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_one();
+        m_thread.join();
+    }
+
+private:
+    DB* m_db;
+    std::chrono::seconds m_interval;
+    std::vector<HotRanges::Range> m_ranges;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::atomic<bool> m_stop{false};
+
+    void main()
+    {
+        if (!m_ranges.empty()) {
+            try {
+                File file(m_db->m_db_path);                  // Throws
+                HotRanges::prefetch(file, m_ranges, m_stop); // Throws
+            }
+            catch (...) {
+                // Only a hint
+            }
+            m_ranges = {};
+        }
+        std::unique_lock lg(m_mutex);
+        for (;;) {
+            if (m_cv.wait_for(lg, m_interval, [this] {
+                    return m_stop.load();
+                })) {
+                break;
+            }
+            lg.unlock();
+            m_db->record_hot_ranges();
+            lg.lock();
+        }
+    }
+};
+
+
+util::Future<DB::version_type> DB::add_group_commit(version_type version, const ReadLockInfo& base)
+{
+    REALM_ASSERT(m_group_commit_helper);
+    return m_group_commit_helper->add_commit(version, base);
+}
+
 void DB::async_begin_write(util::UniqueFunction<void()> fn)
 {
     REALM_ASSERT(m_commit_helper);
@@ -1886,8 +2311,13 @@ void DB::upgrade_file_format(bool allow_file_format_upgrade, int target_file_for
         wt->set_file_format_version(target_file_format_version);
         m_file_format_version = target_file_format_version;
 
-        if (dirty)
+        if (dirty) {
             wt->commit(); // Throws
+            // Other session participants read the file format version from
+            // the file header.
+            if (m_write_ahead_log)
+                checkpoint_wal(); // Throws
+        }
     }
 }
 
@@ -1897,6 +2327,10 @@ void DB::release_read_lock(ReadLockInfo& read_lock) noexcept
     // ignore if opened with immutable file (then we have no lockfile)
     if (m_fake_read_lock_if_immutable)
         return;
+    if (read_lock.m_cache_slot >= 0) {
+        release_cached_read_lock(read_lock);
+        return;
+    }
     std::lock_guard<std::recursive_mutex> lock(m_mutex);
     bool found_match = false;
     // simple linear search and move-last-over if a match is found.
@@ -1925,6 +2359,7 @@ void DB::grab_read_lock(ReadLockInfo& read_lock, VersionID version_id)
 {
     std::lock_guard<std::recursive_mutex> lock(m_mutex);
     REALM_ASSERT_RELEASE(is_attached());
+    read_lock.m_cache_slot = -1;
     if (version_id.version == std::numeric_limits<version_type>::max()) {
         for (;;) {
             SharedInfo* r_info = m_reader_map.get_addr();
@@ -1989,6 +2424,21 @@ void DB::grab_read_lock(ReadLockInfo& read_lock, VersionID version_id)
 
 void DB::leak_read_lock(ReadLockInfo& read_lock) noexcept
 {
+    if (read_lock.m_cache_slot >= 0) {
+        // The read lock held by the cache is leaked for all transactions using
+        // it. Releasing them later has no effect.
+        ReadLockCache::Slot& slot = m_read_lock_cache->slots[read_lock.m_cache_slot];
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        for (auto i = slot.pins.begin(); i != slot.pins.end(); ++i) {
+            if (i->read_lock.m_version == read_lock.m_version) {
+                ReadLockInfo pinned = i->read_lock;
+                slot.pins.erase(i);
+                leak_read_lock(pinned);
+                return;
+            }
+        }
+        return;
+    }
     std::lock_guard<std::recursive_mutex> lock(m_mutex);
     // simple linear search and move-last-over if a match is found.
     // common case should have only a modest number of transactions in play..
@@ -2002,6 +2452,86 @@ void DB::leak_read_lock(ReadLockInfo& read_lock) noexcept
     }
 }
 
+void DB::grab_cached_read_lock(ReadLockInfo& read_lock, VersionID version_id)
+{
+    if (!m_read_lock_cache || version_id.version != std::numeric_limits<version_type>::max()) {
+        grab_read_lock(read_lock, version_id); // Throws
+        return;
+    }
+    int slot_ndx = ReadLockCache::slot_of_this_thread();
+    ReadLockCache::Slot& slot = m_read_lock_cache->slots[slot_ndx];
+    version_type new_version = 0;
+    {
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        // The position of the latest entry of the ringbuffer is in the part of
+        // the lock file which is never remapped. An entry which the slot holds
+        // a read lock on cannot be recycled, so if it is still the latest, the
+        // snapshot held by the slot is still the latest one.
+        SharedInfo* info = m_file_map.get_addr();
+        if (slot.pins.empty() || slot.pins.back().read_lock.m_reader_idx != info->readers.last()) {
+            ReadLockInfo new_read_lock;
+            grab_read_lock(new_read_lock, version_id); // Throws
+            try {
+                slot.pins.push_back({new_read_lock, 0}); // Throws
+            }
+            catch (...) {
+                release_read_lock(new_read_lock);
+                throw;
+            }
+            new_version = new_read_lock.m_version;
+        }
+        ReadLockCache::Pin& pin = slot.pins.back();
+        ++pin.num_users;
+        read_lock = pin.read_lock;
+        read_lock.m_cache_slot = slot_ndx;
+    }
+    // Release the read locks on older snapshots which are no longer in use,
+    // including those held by slots whose threads have stopped reading
+    if (new_version)
+        release_idle_cached_read_locks(false, new_version);
+}
+
+void DB::release_cached_read_lock(ReadLockInfo& read_lock) noexcept
+{
+    ReadLockCache::Slot& slot = m_read_lock_cache->slots[read_lock.m_cache_slot];
+    std::lock_guard<std::mutex> lock(slot.mutex);
+    for (auto i = slot.pins.begin(); i != slot.pins.end(); ++i) {
+        if (i->read_lock.m_version == read_lock.m_version) {
+            REALM_ASSERT(i->num_users > 0);
+            // The read lock on the newest snapshot is kept for the next
+            // transaction of the slot
+            if (--i->num_users == 0 && i != slot.pins.end() - 1) {
+                release_read_lock(i->read_lock);
+                slot.pins.erase(i);
+            }
+            return;
+        }
+    }
+    // It's OK, the DB was closed, or the read lock was leaked
+}
+
+void DB::release_idle_cached_read_locks(bool wait, version_type older_than) noexcept
+{
+    for (auto& slot : m_read_lock_cache->slots) {
+        std::unique_lock<std::mutex> lock(slot.mutex, std::defer_lock);
+        if (wait) {
+            lock.lock();
+        }
+        else if (!lock.try_lock()) {
+            continue;
+        }
+        for (auto i = slot.pins.begin(); i != slot.pins.end();) {
+            if (i->num_users == 0 && i->read_lock.m_version < older_than) {
+                release_read_lock(i->read_lock);
+                i = slot.pins.erase(i);
+            }
+            else {
+                ++i;
+            }
+        }
+    }
+}
+
 bool DB::do_try_begin_write()
 {
     // In the non-blocking case, we will only succeed if there is no contention for
@@ -2108,6 +2638,11 @@ void DB::do_end_write() noexcept
 
 Replication::version_type DB::do_commit(Transaction& transaction, bool commit_to_disk)
 {
+    // Let the snapshots retained only by the read lock cache be cleaned up by
+    // this commit. The caller may hold m_mutex, so busy slots are skipped.
+    if (m_read_lock_cache)
+        release_idle_cached_read_locks(false);
+
     version_type current_version;
     {
         std::lock_guard<std::recursive_mutex> lock(m_mutex);
@@ -2132,12 +2667,154 @@ Replication::version_type DB::do_commit(Transaction& transaction, bool commit_to
         repl->finalize_commit();
     }
     else {
-        low_level_commit(new_version, transaction); // Throws
+        low_level_commit(new_version, transaction, commit_to_disk); // Throws
     }
     return new_version;
 }
 
 
+bool DB::flush_group_commit(GroupCommitFlush& flush)
+{
+    begin_flush_group_commit(flush);      // Throws
+    return end_flush_group_commit(flush); // Throws
+}
+
+
+void DB::begin_flush_group_commit(GroupCommitFlush& flush)
+{
+    // Write the top ref of the latest snapshot to the slot of the file header
+    // which is not selected.
+    {
+        do_begin_write(); // Throws
+        auto end_write = util::make_scope_exit([&]() noexcept {
+            do_end_write();
+        });
+        grab_read_lock(flush.snapshot, VersionID());                                          // Throws
+        flush.map.map(m_alloc.get_file(), File::access_ReadWrite, sizeof(SlabAlloc::Header)); // Throws
+        flush.old_flags = prepare_top_ref(flush.map, flush.snapshot.m_top_ref, m_file_format_version);
+    }
+
+    // Other writers may commit while the file is synced. They cannot touch the
+    // snapshot, as we hold a read lock on it. When running the test suite,
+    // device synchronization is disabled.
+    if (!get_disable_sync_to_disk())
+        m_alloc.get_file().barrier(); // Throws
+}
+
+
+bool DB::end_flush_group_commit(GroupCommitFlush& flush)
+{
+    // Flip the slot selector bit, unless another writer has changed the header
+    // in the meantime. If it has, the slot may have been overwritten by a
+    // writer which has not synced the file yet, or which never selects it.
+    do_begin_write(); // Throws
+    auto end_write = util::make_scope_exit([&]() noexcept {
+        do_end_write();
+    });
+    bool sync = !get_disable_sync_to_disk();
+    return select_top_ref(flush.map, flush.old_flags, flush.snapshot.m_top_ref, sync); // Throws
+}
+
+
+unsigned DB::prepare_top_ref(util::File::Map<SlabAlloc::Header>& map, ref_type top_ref, int file_format_version)
+{
+    SlabAlloc::Header& file_header = *map.get_addr();
+    unsigned old_flags = file_header.m_flags;
+    int slot_selector = ((old_flags & SlabAlloc::flags_SelectBit) != 0 ? 0 : 1);
+    file_header.m_top_ref[slot_selector] = top_ref;
+    using type_1 = std::remove_reference<decltype(file_header.m_file_format[0])>::type;
+    file_header.m_file_format[slot_selector] = type_1(file_format_version);
+    return old_flags;
+}
+
+
+bool DB::select_top_ref(util::File::Map<SlabAlloc::Header>& map, unsigned old_flags, ref_type top_ref, bool sync)
+{
+    SlabAlloc::Header& file_header = *map.get_addr();
+    int slot_selector = ((old_flags & SlabAlloc::flags_SelectBit) != 0 ? 0 : 1);
+    if (file_header.m_flags != old_flags || file_header.m_top_ref[slot_selector] != top_ref)
+        return false;
+    using type_2 = std::remove_reference<decltype(file_header.m_flags)>::type;
+    file_header.m_flags = type_2(old_flags ^ SlabAlloc::flags_SelectBit);
+    if (sync)
+        map.sync(); // Throws
+    return true;
+}
+
+
+void DB::recover_write_ahead_log(const std::string& path, bool replay)
+{
+    std::string log_path = get_core_file(path, CoreFileType::WAL);
+    if (!File::exists(log_path))
+        return;
+
+    if (replay && File::exists(path)) {
+        File file;
+        file.open(path, File::access_ReadWrite, File::create_Never, 0); // Throws
+        if (file.get_size() >= File::SizeType(sizeof(SlabAlloc::Header))) {
+            WriteAheadLog::Snapshot snapshot = WriteAheadLog::replay(log_path, file); // Throws
+            if (snapshot.top_ref != 0) {
+                // When running the test suite, device synchronization is disabled
+                bool disable_sync = get_disable_sync_to_disk();
+                util::File::Map<SlabAlloc::Header> map(file, File::access_ReadWrite,
+                                                       sizeof(SlabAlloc::Header)); // Throws
+                unsigned old_flags = prepare_top_ref(map, snapshot.top_ref, snapshot.file_format_version);
+                if (!disable_sync)
+                    file.barrier(); // Throws
+                bool selected = select_top_ref(map, old_flags, snapshot.top_ref, !disable_sync); // Throws
+                REALM_ASSERT_RELEASE(selected);
+            }
+        }
+    }
+
+    // The log is recreated by the next session which uses Durability::WAL
+    File::remove(log_path); // Throws
+}
+
+
+void DB::record_hot_ranges() noexcept
+{
+    // Gaps which are small compared to a typical readahead are read too, which
+    // keeps the file small.
+    constexpr size_t max_gap = 64 * 1024;
+    try {
+        auto ranges = m_alloc.get_resident_ranges(max_gap);                          // Throws
+        HotRanges::write(get_core_file(m_db_path, CoreFileType::HotRanges), ranges); // Throws
+    }
+    catch (...) {
+    } // ignored on purpose.
+}
+
+void DB::checkpoint_wal()
+{
+    do_begin_write(); // Throws
+    auto end_write = util::make_scope_exit([&]() noexcept {
+        do_end_write();
+    });
+    do_checkpoint_wal(); // Throws
+}
+
+
+void DB::do_checkpoint_wal()
+{
+    REALM_ASSERT(m_write_ahead_log);
+    // When running the test suite, device synchronization is disabled
+    bool disable_sync = get_disable_sync_to_disk();
+    ReadLockInfo snapshot;
+    grab_read_lock(snapshot, VersionID()); // Throws
+    ReadLockGuard rlg(*this, snapshot);
+    util::File::Map<SlabAlloc::Header> map(m_alloc.get_file(), File::access_ReadWrite,
+                                           sizeof(SlabAlloc::Header)); // Throws
+    unsigned old_flags = prepare_top_ref(map, snapshot.m_top_ref, m_file_format_version);
+    if (!disable_sync)
+        m_alloc.get_file().barrier(); // Throws
+    bool selected = select_top_ref(map, old_flags, snapshot.m_top_ref, !disable_sync); // Throws
+    REALM_ASSERT(selected);
+    // The file now holds everything the log does
+    m_write_ahead_log->clear(); // Throws
+}
+
+
 // Caller must lock m_mutex.
 bool DB::grow_reader_mapping(uint_fast32_t index)
 {
@@ -2239,6 +2916,13 @@ void DB::low_level_commit(uint_fast64_t new_version, Transaction& transaction, b
     // info->readers.dump();
     GroupWriter out(transaction, Durability(info->durability)); // Throws
     out.set_versions(new_version, oldest_version);
+    out.set_free_space_index(m_free_space_index.get());
+    if (m_online_compaction)
+        out.set_online_compaction(m_online_compaction.get());
+    if (m_write_ahead_log) {
+        m_write_ahead_log->begin_record(); // Throws
+        out.set_write_ahead_log(m_write_ahead_log.get());
+    }
     ref_type new_top_ref;
     // Recursively write all changed arrays to end of file
     {
@@ -2255,10 +2939,25 @@ void DB::low_level_commit(uint_fast64_t new_version, Transaction& transaction, b
         // std::cout << "Writing version " << new_version << ", Topptr " << new_top_ref
         //     << " Read lock at version " << oldest_version << std::endl;
         switch (Durability(info->durability)) {
+            case Durability::WAL:
+                if (m_write_ahead_log) {
+                    // Every commit is logged, as replaying the log must restore
+                    // the latest snapshot, but only synced if requested.
+                    m_write_ahead_log->append(new_version, new_top_ref, out.get_file_size(),
+                                              _impl::GroupFriend::get_file_format_version(transaction),
+                                              commit_to_disk); // Throws
+                    if (m_write_ahead_log->size() >= m_wal_checkpoint_size)
+                        m_checkpoint_helper->request_checkpoint(); // Throws
+                    break;
+                }
+                // Encrypted files are committed as with Durability::Full
+                REALM_FALLTHROUGH;
             case Durability::Full:
             case Durability::Unsafe:
                 if (commit_to_disk) {
                     out.commit(new_top_ref); // Throws
+                    if (m_online_compaction)
+                        out.truncate_file(); // Throws
                 }
                 else {
                     out.flush_all_mappings();
@@ -2307,6 +3006,12 @@ void DB::low_level_commit(uint_fast64_t new_version, Transaction& transaction, b
         // At this point, the ringbuffer has been succesfully updated, and the next writer
         // can safely proceed once the writemutex has been lifted.
         info->commit_in_critical_phase = 0;
+        // Only now may the next commit of this DB trust the free-lists left by this one
+        out.publish_free_space_index();
+#ifdef REALM_DEBUG
+        if (out.has_reused_free_space_index())
+            ++m_num_reused_free_space_indexes;
+#endif
     }
     {
         // protect against concurrent updates to the .lock file.
@@ -2355,6 +3060,10 @@ std::string DB::get_core_file(const std::string& base_path, CoreFileType type)
             return base_path + ".note";
         case CoreFileType::Log:
             return base_path + ".log";
+        case CoreFileType::WAL:
+            return base_path + ".wal";
+        case CoreFileType::HotRanges:
+            return base_path + ".hot";
     }
     REALM_UNREACHABLE();
 }
@@ -2367,6 +3076,8 @@ void DB::delete_files(const std::string& base_path, bool* did_delete, bool delet
 
     File::try_remove(get_core_file(base_path, CoreFileType::Note));
     File::try_remove(get_core_file(base_path, CoreFileType::Log));
+    File::try_remove(get_core_file(base_path, CoreFileType::WAL));
+    File::try_remove(get_core_file(base_path, CoreFileType::HotRanges));
     util::try_remove_dir_recursive(get_core_file(base_path, CoreFileType::Management));
 
     if (delete_lockfile) {
@@ -2384,7 +3095,7 @@ TransactionRef DB::start_read(VersionID version_id)
     }
     else {
         ReadLockInfo read_lock;
-        grab_read_lock(read_lock, version_id);
+        grab_cached_read_lock(read_lock, version_id);
         ReadLockGuard g(*this, read_lock);
         read_lock.check();
         tr = make_transaction_ref(shared_from_this(), &m_alloc, read_lock, DB::transact_Reading);
@@ -2395,6 +3106,101 @@ TransactionRef DB::start_read(VersionID version_id)
 }
 
 TransactionRef DB::start_frozen(VersionID version_id)
+{
+    if (!m_share_frozen_transactions)
+        return do_start_frozen(version_id); // Throws
+    if (!is_attached())
+        throw LogicError(LogicError::wrong_transact_state);
+
+    bool latest = version_id.version == std::numeric_limits<version_type>::max();
+    if (latest)
+        version_id = get_version_id_of_latest_snapshot(); // Throws
+    {
+        // Declared before the lock, so that a transaction whose last reference
+        // is dropped here is ended outside of it
+        TransactionRef found;
+        std::lock_guard<std::mutex> lock(m_frozen_transactions_mutex);
+        auto i = m_frozen_transactions.find(version_id.version);
+        if (i != m_frozen_transactions.end()) {
+            // A transaction which all holders have released is not handed out
+            // again
+            found = i->second.lock();
+            if (found && found->m_num_shared_holders > 0)
+                return add_shared_frozen_holder(found); // Throws
+        }
+    }
+
+    // The latest snapshot may have been cleaned up since it was looked up, so
+    // it is asked for again.
+    TransactionRef tr = do_start_frozen(latest ? VersionID() : version_id); // Throws
+    // The transaction which is not used is ended outside of the lock
+    TransactionRef existing;
+    std::lock_guard<std::mutex> lock(m_frozen_transactions_mutex);
+    // Forget the transactions which no longer exist
+    for (auto i = m_frozen_transactions.begin(); i != m_frozen_transactions.end();) {
+        if (i->second.expired()) {
+            i = m_frozen_transactions.erase(i);
+        }
+        else {
+            ++i;
+        }
+    }
+    // Another thread may have started a transaction on the same version in the
+    // meantime
+    auto& entry = m_frozen_transactions[tr->get_version()]; // Throws
+    existing = entry.lock();
+    if (existing && existing->m_num_shared_holders > 0)
+        return add_shared_frozen_holder(existing); // Throws
+    entry = tr;
+    return add_shared_frozen_holder(tr); // Throws
+}
+
+// Each caller of start_frozen() gets a reference of its own to the shared
+// transaction, so that it is released once when the caller drops it, however
+// many times the caller closes the transaction.
+TransactionRef DB::add_shared_frozen_holder(const TransactionRef& tr)
+{
+    struct Holder {
+        Holder(std::weak_ptr<DB> db, TransactionRef tr) noexcept
+            : db(std::move(db))
+            , tr(std::move(tr))
+        {
+        }
+        ~Holder()
+        {
+            if (auto locked_db = db.lock())
+                locked_db->release_shared_frozen_holder(*tr);
+        }
+        std::weak_ptr<DB> db;
+        TransactionRef tr;
+    };
+    auto holder = std::make_shared<Holder>(weak_from_this(), tr); // Throws
+    ++tr->m_num_shared_holders;
+    return TransactionRef(holder, tr.get());
+}
+
+void DB::release_shared_frozen_holder(Transaction& tr) noexcept
+{
+    std::lock_guard<std::mutex> lock(m_frozen_transactions_mutex);
+    // The transaction may have been ended by the last holder
+    if (tr.m_num_shared_holders > 0)
+        --tr.m_num_shared_holders;
+}
+
+bool DB::release_shared_frozen(Transaction& tr)
+{
+    if (!m_share_frozen_transactions)
+        return true;
+    std::lock_guard<std::mutex> lock(m_frozen_transactions_mutex);
+    // Transactions from Transaction::duplicate() are not shared, and closing a
+    // shared transaction has no effect while other callers hold it
+    if (tr.m_num_shared_holders > 1)
+        return false;
+    tr.m_num_shared_holders = 0;
+    return true;
+}
+
+TransactionRef DB::do_start_frozen(VersionID version_id)
 {
     if (!is_attached())
         throw LogicError(LogicError::wrong_transact_state);
@@ -2404,7 +3210,7 @@ TransactionRef DB::start_frozen(VersionID version_id)
     }
     else {
         ReadLockInfo read_lock;
-        grab_read_lock(read_lock, version_id);
+        grab_cached_read_lock(read_lock, version_id);
         ReadLockGuard g(*this, read_lock);
         read_lock.check();
         tr = make_transaction_ref(shared_from_this(), &m_alloc, read_lock, DB::transact_Frozen);
@@ -2490,11 +3296,20 @@ void DB::async_request_write_mutex(TransactionRef& tr, util::UniqueFunction<void
 
 inline DB::DB(const DBOptions& options)
     : m_key(options.encryption_key)
+    , m_encryption_format(options.encryption_format)
     , m_upgrade_callback(std::move(options.upgrade_callback))
+    , m_free_space_index(std::make_unique<FreeSpaceIndex>())
 {
     if (options.enable_async_writes) {
         m_commit_helper = std::make_unique<AsyncCommitHelper>(this);
     }
+    if (options.enable_group_commit && options.durability == Durability::Full && !options.encryption_key) {
+        m_group_commit_helper = std::make_unique<GroupCommitHelper>(this);
+    }
+    if (options.compaction_budget) {
+        m_online_compaction = std::make_unique<OnlineCompaction>();
+        m_online_compaction->budget = options.compaction_budget;
+    }
 }
 
 namespace {
@@ -29,6 +29,7 @@
 #include <realm/util/checked_mutex.hpp>
 #include <realm/util/features.h>
 #include <realm/util/functional.hpp>
+#include <realm/util/future.hpp>
 #include <realm/util/interprocess_condvar.hpp>
 #include <realm/util/interprocess_mutex.hpp>
 #include <realm/version_id.hpp>
@@ -37,10 +38,19 @@
 #include <cstdint>
 #include <limits>
 #include <condition_variable>
+#include <map>
+#include <mutex>
 
 namespace realm {
 
+namespace _impl {
+class DBFriend;
+} // namespace _impl
+
 class Transaction;
+class WriteAheadLog;
+struct FreeSpaceIndex;
+struct OnlineCompaction;
 using TransactionRef = std::shared_ptr<Transaction>;
 
 /// Thrown by DB::create() if the lock file is already open in another
@@ -238,6 +248,10 @@ public:
 
     /// Transactions are obtained from one of the following 3 methods:
     TransactionRef start_read(VersionID = VersionID());
+    // With DBOptions::share_frozen_transactions, callers asking for the same
+    // version get the same frozen transaction for as long as any of them
+    // holds on to it. A caller holds it until it drops the reference it got,
+    // and closing it has no effect while other callers hold it.
     TransactionRef start_frozen(VersionID = VersionID());
     // If nonblocking is true and a write transaction is already active,
     // an invalid TransactionRef is returned.
@@ -295,7 +309,8 @@ public:
     /// If the output_encryption_key is `none` then the file's existing key will
     /// be used (if any). If the output_encryption_key is nullptr, the resulting
     /// file will be unencrypted. Any other value will change the encryption of
-    /// the file to the new 64 byte key.
+    /// the file to the new 64 byte key. An encrypted file is written in the
+    /// format given by DBOptions::encryption_format.
     ///
     /// WARNING: Compact() is not thread-safe with respect to a concurrent close()
     bool compact(bool bump_version_number = false, util::Optional<const char*> output_encryption_key = util::none);
@@ -380,6 +395,8 @@ public:
         Management,
         Note,
         Log,
+        WAL,
+        HotRanges,
     };
 
     /// Get the path for the given type of file for a base Realm file path.
@@ -413,6 +430,10 @@ protected:
 
 private:
     class AsyncCommitHelper;
+    class GroupCommitHelper;
+    class CheckpointHelper;
+    class WarmStartHelper;
+    class ReadLockCache;
     struct SharedInfo;
     struct ReadCount;
     struct ReadLockInfo {
@@ -420,6 +441,7 @@ private:
         uint_fast32_t m_reader_idx = 0;
         ref_type m_top_ref = 0;
         size_t m_file_size = 0;
+        int m_cache_slot = -1; // Slot of the read lock cache holding the lock, or -1
 
         // a little helper
         static std::unique_ptr<ReadLockInfo> make_fake(ref_type top_ref, size_t file_size)
@@ -458,6 +480,7 @@ private:
     std::string m_db_path;
     std::string m_coordination_dir;
     const char* m_key;
+    util::File::EncryptionFormat m_encryption_format;
     int m_file_format_version = 0;
     util::InterprocessMutex m_writemutex;
     std::unique_ptr<ReadLockInfo> m_fake_read_lock_if_immutable;
@@ -467,6 +490,23 @@ private:
     std::function<void(int, int)> m_upgrade_callback;
     std::shared_ptr<metrics::Metrics> m_metrics;
     std::unique_ptr<AsyncCommitHelper> m_commit_helper;
+    std::unique_ptr<GroupCommitHelper> m_group_commit_helper;
+    std::unique_ptr<WriteAheadLog> m_write_ahead_log;
+    std::unique_ptr<CheckpointHelper> m_checkpoint_helper;
+    size_t m_wal_checkpoint_size = 0;
+    std::unique_ptr<WarmStartHelper> m_warm_start_helper;
+    std::unique_ptr<ReadLockCache> m_read_lock_cache;
+    bool m_share_frozen_transactions = false;
+    std::mutex m_frozen_transactions_mutex;
+    std::map<version_type, std::weak_ptr<Transaction>> m_frozen_transactions;
+    std::unique_ptr<FreeSpaceIndex> m_free_space_index;
+#ifdef REALM_DEBUG
+    // Number of commits done on THIS DB which found the free-lists left by its
+    // previous commit in memory, instead of reading them from the file. Only
+    // kept for the unit tests.
+    uint64_t m_num_reused_free_space_indexes = 0;
+#endif
+    std::unique_ptr<OnlineCompaction> m_online_compaction;
     bool m_is_sync_agent = false;
 
     /// Attach this DB instance to the specified database file.
@@ -541,6 +581,29 @@ private:
     // Stop tracking a read lock without actually releasing it.
     void leak_read_lock(ReadLockInfo&) noexcept;
 
+    // Same as grab_read_lock(), except that a read lock on the latest snapshot
+    // is shared with the other transactions of the calling thread through the
+    // read lock cache, if the DB has one.
+    void grab_cached_read_lock(ReadLockInfo&, VersionID);
+    void release_cached_read_lock(ReadLockInfo&) noexcept;
+
+    // Release the read locks held by the read lock cache which are no longer
+    // used by any transaction, and are on snapshots older than `older_than`.
+    // Slots in use by other threads are skipped unless `wait` is true.
+    void release_idle_cached_read_locks(bool wait,
+                                        version_type older_than = std::numeric_limits<version_type>::max()) noexcept;
+
+    // Start a new frozen transaction, which is not shared.
+    TransactionRef do_start_frozen(VersionID);
+    // Called when a frozen transaction is closed. Returns false if it is shared
+    // and other callers of start_frozen() still hold it.
+    bool release_shared_frozen(Transaction&);
+    // Returns a reference to a shared frozen transaction for one more caller of
+    // start_frozen(), which stops holding it when the reference goes away.
+    // Called with m_frozen_transactions_mutex locked.
+    TransactionRef add_shared_frozen_holder(const TransactionRef&);
+    void release_shared_frozen_holder(Transaction&) noexcept;
+
     // Release all read locks held by this DB object. After release, further calls to
     // release_read_lock for locks already released must be avoided.
     void release_all_read_locks() noexcept;
@@ -562,6 +625,60 @@ private:
 
     void do_async_commits();
 
+    /// The state of a flush of the latest snapshot to the file header
+    struct GroupCommitFlush {
+        ReadLockInfo snapshot;
+        util::File::Map<SlabAlloc::Header> map;
+        unsigned old_flags = 0;
+    };
+
+    /// Make the latest snapshot durable and select it in the file header. A
+    /// read lock on the snapshot is grabbed into \a flush. Returns false if
+    /// another writer changed the header before the snapshot was selected, in
+    /// which case the snapshot may not be durable yet and the flush must be
+    /// retried.
+    bool flush_group_commit(GroupCommitFlush& flush);
+    /// The two steps of flush_group_commit(). The write mutex is only held
+    /// while the header is updated, not while the file is synced, which is
+    /// done at the end of the first step.
+    void begin_flush_group_commit(GroupCommitFlush& flush);
+    bool end_flush_group_commit(GroupCommitFlush& flush);
+
+    bool has_group_commit() const noexcept
+    {
+        return bool(m_group_commit_helper);
+    }
+    /// Hand a commit over to the group commit helper. Must be called while the
+    /// write mutex and the read lock \a base, which the commit was based on,
+    /// are held.
+    util::Future<version_type> add_group_commit(version_type version, const ReadLockInfo& base);
+
+    /// Write \a top_ref to the slot of the file header which is not selected,
+    /// and return the flags of the header.
+    static unsigned prepare_top_ref(util::File::Map<SlabAlloc::Header>&, ref_type top_ref,
+                                    int file_format_version);
+    /// Select the slot written by prepare_top_ref(), unless the header has been
+    /// changed since. Returns false if it has.
+    static bool select_top_ref(util::File::Map<SlabAlloc::Header>&, unsigned old_flags, ref_type top_ref,
+                               bool sync);
+
+    /// Bring the Realm file at \a path up to date with the write-ahead log
+    /// left by a previous session, and remove the log. Must only be called by
+    /// the session initiator.
+    static void recover_write_ahead_log(const std::string& path, bool replay);
+
+    /// Select the latest snapshot in the file header and empty the write-ahead
+    /// log. checkpoint_wal() takes the write mutex, while do_checkpoint_wal()
+    /// must be called by someone who holds it, or who otherwise knows that no
+    /// commits can happen.
+    void checkpoint_wal();
+    void do_checkpoint_wal();
+
+    /// Record the ranges of the Realm file which are resident in memory in
+    /// the hot ranges file, for the next process opening it. Errors are
+    /// ignored, as the file is only a hint.
+    void record_hot_ranges() noexcept;
+
     /// Upgrade file format and/or history schema
     void upgrade_file_format(bool allow_file_format_upgrade, int target_file_format_version,
                              int current_hist_schema_version, int target_hist_schema_version);
@@ -583,6 +700,7 @@ private:
     void async_sync_to_disk(util::UniqueFunction<void()> fn);
 
     friend class Transaction;
+    friend class _impl::DBFriend;
 };
 
 inline void DB::get_stats(size_t& free_space, size_t& used_space, size_t* locked_space) const
@@ -646,6 +764,33 @@ inline int DB::get_file_format_version() const noexcept
     return m_file_format_version;
 }
 
+class _impl::DBFriend {
+public:
+    using GroupCommitFlush = DB::GroupCommitFlush;
+
+    static void begin_flush_group_commit(DB& db, GroupCommitFlush& flush)
+    {
+        db.begin_flush_group_commit(flush); // Throws
+    }
+
+    static bool end_flush_group_commit(DB& db, GroupCommitFlush& flush)
+    {
+        return db.end_flush_group_commit(flush); // Throws
+    }
+
+    static void release_read_lock(DB& db, GroupCommitFlush& flush) noexcept
+    {
+        db.release_read_lock(flush.snapshot);
+    }
+
+#ifdef REALM_DEBUG
+    static uint64_t get_num_reused_free_space_indexes(const DB& db) noexcept
+    {
+        return db.m_num_reused_free_space_indexes;
+    }
+#endif
+};
+
 } // namespace realm
 
 #endif // REALM_DB_HPP
@@ -19,9 +19,11 @@
 #ifndef REALM_GROUP_SHARED_OPTIONS_HPP
 #define REALM_GROUP_SHARED_OPTIONS_HPP
 
+#include <chrono>
 #include <functional>
 #include <string>
 #include <realm/backup_restore.hpp>
+#include <realm/util/file.hpp>
 
 namespace realm {
 
@@ -32,7 +34,13 @@ struct DBOptions {
     enum class Durability : uint16_t {
         Full,
         MemOnly,
-        Unsafe // If you use this, you loose ACID property
+        Unsafe, // If you use this, you loose ACID property
+        // Commits are made durable by appending the blocks they write to a
+        // log, which is synced once per commit, instead of syncing the Realm
+        // file twice. The Realm file is updated from the log by checkpoints in
+        // the background, and when it is opened by a new session. Encrypted
+        // files are committed as with Full.
+        WAL
     };
 
     using version_list_t = BackupHandler::version_list_t;
@@ -77,6 +85,13 @@ struct DBOptions {
     /// indicate that encryption should not be used.
     const char* encryption_key;
 
+    /// The format of the blocks written to an encrypted Realm file which has
+    /// no data yet. An existing file keeps its format, but DB::compact() and
+    /// DB::write_copy() write their output in this format, so they can be
+    /// used to convert a file. With encryption_Gcm blocks are authenticated by
+    /// AES-GCM as they are encrypted, instead of by a separate HMAC.
+    util::File::EncryptionFormat encryption_format = util::File::encryption_CbcHmac;
+
     /// If \a allow_file_format_upgrade is set to `true`, this function will
     /// automatically upgrade the file format used in the specified Realm file
     /// if necessary (and if it is possible). In order to prevent this, set \a
@@ -129,6 +144,77 @@ struct DBOptions {
     /// a performance impact.
     bool enable_async_writes = false;
 
+    /// If set, write transactions do not sync the file when they commit.
+    /// Instead, a helper thread makes the commits durable in batches: all
+    /// commits which arrive while a sync is in progress are covered by the next
+    /// one. Transaction::commit() still waits until its commit is durable,
+    /// while Transaction::commit_grouped() returns a future for it. Only has an
+    /// effect with Durability::Full on unencrypted files.
+    bool enable_group_commit = false;
+
+    /// With Durability::WAL, a checkpoint is started in the background when
+    /// the log grows beyond this number of bytes.
+    size_t wal_checkpoint_size = 4 * 1024 * 1024;
+
+    /// If non-zero, commits move arrays from the end of the Realm file into
+    /// free space closer to its start, so that the file shrinks while it is
+    /// open, which DB::compact() cannot do while other DB instances are
+    /// attached. A pass over the file is started when at least a quarter of it
+    /// is free, and each commit then visits and moves roughly this number of
+    /// bytes in addition to what it writes anyway. The file is truncated after
+    /// commits with Durability::Full or Durability::Unsafe. Otherwise, and for
+    /// encrypted files, it is truncated when a new session opens it.
+    size_t compaction_budget = 0;
+
+    /// The hint given to the kernel about how the Realm file will be read,
+    /// where madvise() is available. With File::advice_Random, pages are read
+    /// only when accessed, instead of with the readahead meant for sequential
+    /// reads, which mostly brings in pages a B+tree lookup does not need.
+    /// File::advice_Sequential suits full scans of large tables. Has no effect
+    /// for encrypted files.
+    util::File::MappingAdvice mapping_advice = util::File::advice_Normal;
+
+    /// If set, the top levels of the tree of the latest snapshot, down to the
+    /// children of the top array of each table, are read when the file is
+    /// opened. The arrays of each level are requested together, so that their
+    /// reads overlap, but opening the file waits until they have been read.
+    /// Has no effect for encrypted files.
+    bool prefetch_top_levels = false;
+
+    /// How the memory used by write transactions for new and modified arrays
+    /// is backed. Huge pages reduce the number of TLB misses for large write
+    /// transactions. They are only available on Linux. Pages from the reserved
+    /// pool (File::huge_pages_Explicit) are only used for slabs whose size is a
+    /// multiple of 2 MiB.
+    util::File::HugePages slab_huge_pages = util::File::huge_pages_None;
+
+    /// If non-zero, the ranges of the Realm file which are resident in memory
+    /// are recorded in a file next to it (`<path>.hot`) at this interval, and
+    /// when the DB is closed. When a DB opens the Realm file, the recorded
+    /// ranges are read into memory in the background, so that a restarted
+    /// process does not have to fault in its working set one page at a time.
+    /// Has no effect for encrypted files.
+    std::chrono::seconds warm_start_interval{0};
+
+    /// If set, read transactions on the latest snapshot started by the same
+    /// thread share a read lock, so that only the first of them has to
+    /// register with the lock file. The shared lock is kept after the last of
+    /// them ends, until a thread of this DB starts a transaction on a newer
+    /// snapshot or this DB commits, so a snapshot may be retained for a while
+    /// after it was last used. Suits servers which start a short read transaction for each
+    /// request.
+    bool cache_read_locks = false;
+
+    /// If set, DB::start_frozen() and Transaction::freeze() return the frozen
+    /// transaction which already exists for the requested version, if any, so
+    /// that the accessors of its group and tables are created once for all
+    /// threads reading that version. Each caller holds a shared transaction
+    /// until the reference it got goes away. Closing the transaction has no
+    /// effect while other callers hold it, so it ends when the last of them
+    /// closes it or drops its reference. Transaction::duplicate() still
+    /// returns a transaction of its own.
+    bool share_frozen_transactions = false;
+
     /// sys_tmp_dir will be used if the temp_dir is empty when creating DBOptions.
     /// It must be writable and allowed to create pipe/fifo file on it.
     /// set_sys_tmp_dir is not a thread-safe call and it is only supposed to be called once
@@ -332,7 +332,7 @@ int Group::get_target_file_format_version_for_session(int current_file_format_ve
     // individual file format versions.
 
     if (requested_history_type == Replication::hist_None) {
-        if (current_file_format_version == 22) {
+        if (current_file_format_version == 23) {
             // We are able to open these file formats in RO mode
             return current_file_format_version;
         }
@@ -407,6 +407,7 @@ int Group::read_only_version_check(SlabAlloc& alloc, ref_type top_ref, const std
         case 11:
         case 20:
         case 21:
+        case 22:
         case g_current_file_format_version:
             file_format_ok = true;
             break;
@@ -1577,7 +1578,11 @@ void Group::advance_transact(ref_type new_top_ref, util::NoCopyInputStream& in,
         TransactAdvancer advancer(*this, schema_changed);
         parser.parse(in, advancer); // Throws
     }
+    advance_transact(new_top_ref, writable, schema_changed); // Throws
+}
 
+void Group::advance_transact(ref_type new_top_ref, bool writable, bool schema_changed)
+{
     m_top.detach();                                           // Soft detach
     bool create_group_when_missing = false;                   // See Group::attach_shared().
     attach(new_top_ref, writable, create_group_when_missing); // Throws
@@ -706,6 +706,9 @@ private:
     /// Memory mappings must have been updated to reflect any growth in filesize before
     /// calling advance_transact()
     void advance_transact(ref_type new_top_ref, util::NoCopyInputStream&, bool writable);
+    /// Same as above, for a caller which has already parsed the transaction
+    /// logs, and knows whether they change the schema.
+    void advance_transact(ref_type new_top_ref, bool writable, bool schema_changed);
     void refresh_dirty_accessors();
     void flush_accessors_for_commit();
 
@@ -784,6 +787,11 @@ private:
     ///  22 Object keys are no longer generated from primary key values. Search index
     ///     reintroduced.
     ///
+    ///  23 Ordered indexes, in slot 14 of the top array of a table, and
+    ///     full-text indexes, in slot 15. Tables of older files get the slots
+    ///     when they are first given such an index. Versions which do not
+    ///     maintain these indexes must not open the file.
+    ///
     /// IMPORTANT: When introducing a new file format version, be sure to review
     /// the file validity checks in Group::open() and DB::do_open, the file
     /// format selection logic in
@@ -791,7 +799,7 @@ private:
     /// upgrade logic in Group::upgrade_file_format(), AND the lists of accepted
     /// file formats and the version deletion list residing in "backup_restore.cpp"
 
-    static constexpr int g_current_file_format_version = 22;
+    static constexpr int g_current_file_format_version = 23;
 
     int get_file_format_version() const noexcept;
     void set_file_format_version(int) noexcept;
@@ -32,6 +32,7 @@
 #include <realm/metrics/metric_timer.hpp>
 #include <realm/util/miscellaneous.hpp>
 #include <realm/util/safe_int_ops.hpp>
+#include <realm/write_ahead_log.hpp>
 
 using namespace realm;
 using namespace realm::util;
@@ -117,6 +118,7 @@ bool GroupWriter::MapWindow::extends_to_match(util::File& f, ref_type start_ref,
     if (aligned_ref != m_base_ref)
         return false;
     size_t window_size = get_window_size(f, start_ref, size);
+    m_map.flush(); // Throws
     m_map.unmap();
     m_map.map(f, File::access_ReadWrite, window_size, 0, m_base_ref);
     return true;
@@ -132,7 +134,13 @@ GroupWriter::MapWindow::MapWindow(size_t alignment, util::File& f, ref_type star
 
 GroupWriter::MapWindow::~MapWindow()
 {
-    m_map.flush();
+    // A commit flushes its windows before they are destroyed, so errors are
+    // reported there. A window left by a failed commit is dropped as it is.
+    try {
+        m_map.flush(); // Throws
+    }
+    catch (...) {
+    } // ignored on purpose.
     m_map.unmap();
 }
 
@@ -170,6 +178,7 @@ GroupWriter::GroupWriter(Group& group, Durability dura)
     , m_free_lengths(m_alloc)
     , m_free_versions(m_alloc)
     , m_durability(dura)
+    , m_size_map(m_free_space.free_by_size)
 {
     m_map_windows.reserve(num_map_windows);
 #if REALM_PLATFORM_APPLE && REALM_MOBILE
@@ -316,6 +325,11 @@ ref_type GroupWriter::write_group()
     read_in_freelist();
     // Now, 'm_size_map' holds all free elements candidate for recycling
 
+    if (m_online_compaction) {
+        start_evacuation();
+        evacuate_tail(); // Throws
+    }
+
     Array& top = m_group.m_top;
 #if REALM_ALLOC_DEBUG
     std::cout << "    In-file freelist after merge:  " << m_size_map.size() << std::endl;
@@ -361,7 +375,7 @@ ref_type GroupWriter::write_group()
     // calculate an upper bound on the amount af space required for all of the
     // remaining arrays and allocate the space as one big chunk. This way we can
     // finalize the free-lists before writing them to the file.
-    size_t max_free_list_size = m_size_map.size();
+    size_t max_free_list_size = m_size_map.size() + m_tail_size_map.size();
 
     // We need to add to the free-list any space that was freed during the
     // current transaction, but to avoid clobering the previous version, we
@@ -379,7 +393,7 @@ ref_type GroupWriter::write_group()
     std::cout << "/" << free_read_only_size << std::endl;
 #endif
     max_free_list_size += free_read_only_size;
-    max_free_list_size += m_not_free_in_file.size();
+    max_free_list_size += m_free_space.locked_by_version.size();
     // The final allocation of free space (i.e., the call to
     // reserve_free_space() below) may add extra entries to the free-lists.
     // We reserve room for the worst case scenario, which is as follows:
@@ -413,6 +427,9 @@ ref_type GroupWriter::write_group()
     auto reserve = reserve_free_space(max_free_space_needed + 8); // Throws
     size_t reserve_pos = reserve->second;
     size_t reserve_size = reserve->first;
+    restore_tail_free_space();
+    if (m_online_compaction)
+        shrink_logical_file_size(reserve_pos); // Throws
 
     // At this point we have allocated all the space we need, so we can add to
     // the free-lists any free space created during the current transaction (or
@@ -490,6 +507,8 @@ ref_type GroupWriter::write_group()
     m_free_positions.set(reserve_ndx, value_8); // Throws
     m_free_lengths.set(reserve_ndx, value_9);   // Throws
     m_free_space_size += rest;
+    remove_free_chunk(m_size_map.find({reserve_size, reserve_pos}));
+    add_free_chunk(size_t(end_ref), rest);
 
     // The free-list now have their final form, so we can write them to the file
     // char* start_addr = m_file_map.get_addr() + reserve_ref;
@@ -503,6 +522,12 @@ ref_type GroupWriter::write_group()
     // Write top
     write_array_at(window, top_ref, top.get_header(), top_byte_size); // Throws
     window->encryption_write_barrier(start_addr, used);
+
+    // The index describes the new free-lists, but is only handed back to the DB
+    // by publish_free_space_index() once the commit has succeeded
+    m_free_space.version = m_current_version;
+    m_free_space.free_positions_ref = free_positions_ref;
+
     // Return top_ref so that it can be saved in lock file used for coordination
     return top_ref;
 }
@@ -510,28 +535,46 @@ ref_type GroupWriter::write_group()
 
 void GroupWriter::read_in_freelist()
 {
-    FreeList free_in_file;
-
     size_t limit = m_free_lengths.size();
     REALM_ASSERT_RELEASE_EX(m_free_positions.size() == limit, limit, m_free_positions.size());
     REALM_ASSERT_RELEASE_EX(m_free_versions.size() == limit, limit, m_free_versions.size());
 
-    if (limit) {
-        auto limit_version = m_readlock_version;
+    uint64_t snapshot_version = m_group.m_top.get_as_ref_or_tagged(6).get_as_int();
+    if (m_free_space_index && m_free_space_index->free_positions_ref == m_free_positions.get_ref() &&
+        m_free_space_index->version == snapshot_version && limit) {
+        // The free-lists were written by the previous commit of this DB, which
+        // left the index describing them. Until this commit is published, the
+        // DB is left with an empty index, so a failed commit is never followed
+        // by one which trusts the index.
+        std::swap(m_free_space, *m_free_space_index);
+#ifdef REALM_DEBUG
+        m_reused_free_space_index = true;
+        verify_free_space_index();
+#endif
+    }
+    else {
         for (size_t idx = 0; idx < limit; ++idx) {
             size_t ref = size_t(m_free_positions.get(idx));
             size_t size = size_t(m_free_lengths.get(idx));
-
             uint64_t version = m_free_versions.get(idx);
-            // Entries that are freed in still alive versions are not candidates for merge or allocation
-            if (version >= limit_version) {
-                m_not_free_in_file.emplace_back(ref, size, version);
+            REALM_ASSERT_RELEASE_EX(!(size & 7), size);
+            REALM_ASSERT_RELEASE_EX(!(ref & 7), ref);
+            if (size == 0)
                 continue;
-            }
-
-            free_in_file.emplace_back(ref, size, 0);
+            m_free_space.chunks.emplace(ref, FreeSpaceIndex::Chunk{size, version, true});
+            m_free_space.locked_by_version.emplace(version, ref);
         }
+    }
+
+    // Chunks released in versions which are no longer alive are candidates
+    // for merge and allocation
+    auto& locked = m_free_space.locked_by_version;
+    for (auto it = locked.begin(); it != locked.end() && it->first < m_readlock_version;) {
+        release_chunk(it->second);
+        it = locked.erase(it);
+    }
 
+    if (limit) {
         // This will imply a copy-on-write
         m_free_positions.clear();
         m_free_lengths.clear();
@@ -545,122 +588,407 @@ void GroupWriter::read_in_freelist()
         m_free_lengths.copy_on_write();
         m_free_versions.copy_on_write();
     }
+}
+
+void GroupWriter::publish_free_space_index() noexcept
+{
+    if (m_free_space_index)
+        std::swap(*m_free_space_index, m_free_space);
+}
+
+#ifdef REALM_DEBUG
+// Check that a reused index holds exactly the chunks of the free-lists in the file
+void GroupWriter::verify_free_space_index() const
+{
+    auto it = m_free_space.chunks.begin();
+    size_t num_locked = 0;
+    for (size_t idx = 0; idx < m_free_lengths.size(); ++idx) {
+        size_t size = size_t(m_free_lengths.get(idx));
+        if (size == 0)
+            continue;
+        while (it != m_free_space.chunks.end() && it->second.size == 0)
+            ++it;
+        REALM_ASSERT(it != m_free_space.chunks.end());
+        REALM_ASSERT_EX(it->first == size_t(m_free_positions.get(idx)), it->first, m_free_positions.get(idx));
+        REALM_ASSERT_EX(it->second.size == size, it->second.size, size);
+        REALM_ASSERT(it->second.released_at_version == uint64_t(m_free_versions.get(idx)));
+        if (it->second.locked) {
+            ++num_locked;
+        }
+        else {
+            REALM_ASSERT(m_free_space.free_by_size.count({size, it->first}));
+        }
+        ++it;
+    }
+    while (it != m_free_space.chunks.end() && it->second.size == 0)
+        ++it;
+    REALM_ASSERT(it == m_free_space.chunks.end());
+    REALM_ASSERT(m_free_space.locked_by_version.size() == num_locked);
+}
+#endif
+
+// Make a locked chunk available for allocation, merging it with adjacent free
+// chunks
+void GroupWriter::release_chunk(size_t ref)
+{
+    auto& chunks = m_free_space.chunks;
+    auto it = chunks.find(ref);
+    REALM_ASSERT_RELEASE_EX(it != chunks.end(), ref, m_alloc.get_file_path_for_assertions());
+    it->second.locked = false;
+    it->second.released_at_version = 0;
+
+    auto next = std::next(it);
+    if (next != chunks.end() && !next->second.locked && ref + it->second.size == next->first) {
+        m_size_map.erase({next->second.size, next->first});
+        it->second.size += next->second.size;
+        chunks.erase(next);
+    }
+    if (it != chunks.begin()) {
+        auto prev = std::prev(it);
+        if (!prev->second.locked && prev->first + prev->second.size == ref) {
+            m_size_map.erase({prev->second.size, prev->first});
+            prev->second.size += it->second.size;
+            chunks.erase(it);
+            it = prev;
+        }
+    }
+    m_size_map.emplace(it->second.size, it->first);
+}
 
-    free_in_file.merge_adjacent_entries_in_freelist();
-    // Previous step produces - potentially - some entries with size of zero. These
-    // entries will be skipped in the next step.
-    free_in_file.move_free_in_file_to_size_map(m_size_map);
+GroupWriter::FreeListElement GroupWriter::add_free_chunk(size_t ref, size_t size)
+{
+    m_free_space.chunks.emplace(ref, FreeSpaceIndex::Chunk{size, 0, false});
+    return m_size_map.emplace(size, ref).first;
+}
+
+void GroupWriter::remove_free_chunk(FreeListElement it)
+{
+    m_free_space.chunks.erase(it->second);
+    m_size_map.erase(it);
 }
 
 size_t GroupWriter::recreate_freelist(size_t reserve_pos)
 {
-    std::vector<FreeSpaceEntry> free_in_file;
+    auto& chunks = m_free_space.chunks;
     auto& new_free_space = m_group.m_alloc.get_free_read_only(); // Throws
-    auto nb_elements = m_size_map.size() + m_not_free_in_file.size() + new_free_space.size();
-    free_in_file.reserve(nb_elements);
 
-    size_t reserve_ndx = realm::npos;
+    // The space released during the current transaction may still be used by
+    // readers of the previous version
+    for (const auto& free_space : new_free_space) {
+        size_t ref = free_space.first;
+        size_t size = free_space.second;
+        auto next = chunks.lower_bound(ref);
+        if (REALM_UNLIKELY(next != chunks.end() && ref + size > next->first)) {
+            REALM_ASSERT_RELEASE_EX(ref + size <= next->first, ref, size, next->first, next->second.size,
+                                    next->second.released_at_version, m_current_version,
+                                    m_alloc.get_file_path_for_assertions());
+        }
+        if (next != chunks.begin()) {
+            auto prev = std::prev(next);
+            if (REALM_UNLIKELY(prev->first + prev->second.size > ref)) {
+                REALM_ASSERT_RELEASE_EX(prev->first + prev->second.size <= ref, prev->first, prev->second.size,
+                                        prev->second.released_at_version, ref, size, m_current_version,
+                                        m_alloc.get_file_path_for_assertions());
+            }
+        }
+        chunks.emplace_hint(next, ref, FreeSpaceIndex::Chunk{size, m_current_version, true});
+        m_free_space.locked_by_version.emplace(m_current_version, ref);
+    }
 
-    for (const auto& entry : m_size_map) {
-        free_in_file.emplace_back(entry.second, entry.first, 0);
+    // Copy into arrays in order of position, merging adjacent free chunks
+    // other than the one reserved for the free-lists
+    size_t reserve_ndx = realm::npos;
+    size_t free_space_size = 0;
+    size_t locked_space_size = 0;
+    for (auto it = chunks.begin(); it != chunks.end(); ++it) {
+        size_t ref = it->first;
+        auto& chunk = it->second;
+        if (!chunk.locked && ref != reserve_pos) {
+            size_t size = chunk.size;
+            auto next = std::next(it);
+            while (next != chunks.end() && !next->second.locked && next->first != reserve_pos &&
+                   ref + chunk.size == next->first) {
+                m_size_map.erase({next->second.size, next->first});
+                chunk.size += next->second.size;
+                next = chunks.erase(next);
+            }
+            if (chunk.size != size) {
+                m_size_map.erase({size, ref});
+                m_size_map.emplace(chunk.size, ref);
+            }
+        }
+        if (ref == reserve_pos) {
+            reserve_ndx = m_free_positions.size();
+        }
+        else {
+            // The reserved chunk should not be counted in now. We don't know how much of it
+            // will eventually be used.
+            free_space_size += chunk.size;
+        }
+        if (chunk.locked)
+            locked_space_size += chunk.size;
+        m_free_positions.add(ref);
+        m_free_lengths.add(chunk.size);
+        m_free_versions.add(chunk.released_at_version);
     }
+    REALM_ASSERT_RELEASE(reserve_ndx != realm::npos);
+    m_free_space_size = free_space_size;
+    m_locked_space_size = locked_space_size;
 
-    {
-        size_t locked_space_size = 0;
-        for (const auto& locked : m_not_free_in_file) {
-            free_in_file.emplace_back(locked.ref, locked.size, locked.released_at_version);
-            locked_space_size += locked.size;
+    return reserve_ndx;
+}
+
+void GroupWriter::start_evacuation()
+{
+    OnlineCompaction& state = *m_online_compaction;
+    m_evacuation_budget = state.budget;
+    size_t logical_file_size = to_size_t(m_group.m_top.get(2) / 2);
+    if (state.progress.empty()) {
+        // Start a new pass if enough of the file is free. Half of the free
+        // space is expected to end up beyond the limit. Space which is still
+        // used by a reader is counted, as it will be free by the time the pass
+        // is complete.
+        size_t free_space = 0;
+        for (const auto& chunk : m_free_space.chunks)
+            free_space += chunk.second.size;
+        state.limit = 0;
+        if (free_space >= logical_file_size / 4) {
+            size_t limit = logical_file_size - free_space / 2;
+            state.limit = limit - limit % util::page_size();
         }
+    }
+    if (state.limit >= logical_file_size) {
+        // The file has already been reduced
+        state.limit = 0;
+        state.progress.clear();
+    }
+    if (state.limit == 0)
+        return;
 
-        for (const auto& free_space : new_free_space) {
-            free_in_file.emplace_back(free_space.first, free_space.second, m_current_version);
-            locked_space_size += free_space.second;
+    // Set aside the free space beyond the limit, splitting a chunk which
+    // crosses it
+    ref_type limit = state.limit;
+    auto& chunks = m_free_space.chunks;
+    auto it = chunks.lower_bound(limit);
+    if (it != chunks.begin())
+        --it;
+    for (; it != chunks.end(); ++it) {
+        size_t chunk_pos = it->first;
+        auto& chunk = it->second;
+        if (chunk.locked || chunk_pos + chunk.size <= limit)
+            continue;
+        m_size_map.erase({chunk.size, chunk_pos});
+        if (chunk_pos < limit) {
+            size_t tail_size = chunk_pos + chunk.size - limit;
+            chunk.size = limit - chunk_pos;
+            m_size_map.emplace(chunk.size, chunk_pos);
+            it = chunks.emplace_hint(std::next(it), limit, FreeSpaceIndex::Chunk{tail_size, 0, false});
         }
-        m_locked_space_size = locked_space_size;
+        m_tail_size_map.emplace(it->second.size, it->first);
     }
+}
 
-    REALM_ASSERT(free_in_file.size() == nb_elements);
-    std::sort(begin(free_in_file), end(free_in_file), [](auto& a, auto& b) {
-        return a.ref < b.ref;
-    });
+void GroupWriter::evacuate_tail()
+{
+    OnlineCompaction& state = *m_online_compaction;
+    if (state.limit == 0)
+        return;
 
-    {
-        // Copy into arrays while checking consistency
-        size_t prev_ref = 0;
-        size_t prev_size = 0;
-        size_t free_space_size = 0;
-        auto limit = free_in_file.size();
-        for (size_t i = 0; i < limit; ++i) {
-            const auto& free_space = free_in_file[i];
-            auto ref = free_space.ref;
-            if (REALM_UNLIKELY(prev_ref + prev_size > ref)) {
-                // Check if we are freeing arrays already in 'm_not_free_in_file'
-                for (const auto& elem : new_free_space) {
-                    ref_type free_ref = elem.first;
-                    size_t free_sz = elem.second;
-                    for (const auto& locked : m_not_free_in_file) {
-                        REALM_ASSERT_RELEASE_EX(free_ref < locked.ref || free_ref >= (locked.ref + locked.size),
-                                                locked.ref, locked.size, locked.released_at_version, free_ref,
-                                                m_current_version, m_alloc.get_file_path_for_assertions());
-                        REALM_ASSERT_RELEASE_EX(locked.ref < free_ref || locked.ref >= (free_ref + free_sz),
-                                                locked.ref, locked.released_at_version, free_ref, free_sz,
-                                                m_current_version, m_alloc.get_file_path_for_assertions());
-                    }
-                }
-
-                REALM_ASSERT_RELEASE_EX(prev_ref + prev_size <= ref, prev_ref, prev_size, ref, i, limit,
-                                        m_alloc.get_file_path_for_assertions());
-            }
-            if (reserve_pos == ref) {
-                reserve_ndx = i;
-            }
-            else {
-                // The reserved chunk should not be counted in now. We don't know how much of it
-                // will eventually be used.
-                free_space_size += free_space.size;
-            }
-            m_free_positions.add(free_space.ref);
-            m_free_lengths.add(free_space.size);
-            m_free_versions.add(free_space.released_at_version);
-            prev_ref = free_space.ref;
-            prev_size = free_space.size;
+    // Visit the table names, the tables and the history, in that order
+    const size_t roots[] = {0, 1, 8};
+    const size_t num_roots = sizeof(roots) / sizeof(roots[0]);
+    Array& top = m_group.m_top;
+    std::vector<int64_t> old_table_refs;
+    if (ref_type tables_ref = top.size() > 1 ? top.get_as_ref(1) : 0) {
+        Array tables(m_alloc);
+        tables.init_from_ref(tables_ref);
+        for (size_t i = 0, n = tables.size(); i < n; ++i)
+            old_table_refs.push_back(tables.get(i)); // Throws
+    }
+    auto& progress = state.progress;
+    m_evacuation_resuming = !progress.empty();
+    m_evacuation_stopped = false;
+    size_t i = m_evacuation_resuming ? progress[0] : 0;
+    if (progress.size() <= 1)
+        m_evacuation_resuming = false;
+    for (; i < num_roots; ++i) {
+        if (progress.empty())
+            progress.resize(1);
+        progress[0] = i;
+        if (m_evacuation_budget == 0) {
+            progress.resize(1);
+            m_evacuation_stopped = true;
+            break;
         }
-        REALM_ASSERT_RELEASE(reserve_ndx != realm::npos);
-
-        m_free_space_size = free_space_size;
+        size_t ndx = roots[i];
+        ref_type ref = ndx < top.size() ? top.get_as_ref(ndx) : 0;
+        if (ref) {
+            ref_type new_ref = evacuate(ref, 1); // Throws
+            if (new_ref != ref)
+                top.set(ndx, from_ref(new_ref)); // Throws
+        }
+        m_evacuation_resuming = false;
+        if (m_evacuation_stopped)
+            break;
+    }
+    if (!m_evacuation_stopped) {
+        // The pass is complete. The next commit selects a new limit.
+        progress.clear();
     }
+    bump_evacuated_table_versions(old_table_refs); // Throws
 
-    return reserve_ndx;
+    // Arrays reachable from the group accessors may have been modified
+    // without going through them
+    m_group.m_table_names.init_from_parent();
+    m_group.m_tables.init_from_parent();
 }
 
-void GroupWriter::FreeList::merge_adjacent_entries_in_freelist()
+// The arrays of a table which were moved are freed without going through the
+// table, so bump the version of the table like a change made through it
+// would. Otherwise the accessors of the table would keep what they cache by
+// ref, such as the summaries of the zone map, until the freed space is reused
+// for other arrays.
+void GroupWriter::bump_evacuated_table_versions(const std::vector<int64_t>& old_table_refs)
 {
-    if (size() > 1) {
-        // Combine any adjacent chunks in the freelist
-        auto prev = begin();
-        for (auto it = begin() + 1; it != end(); ++it) {
-            REALM_ASSERT(it->ref > prev->ref);
-            if (prev->ref + prev->size == it->ref) {
-                prev->size += it->size;
-                it->size = 0;
+    Array& top = m_group.m_top;
+    ref_type tables_ref = top.size() > 1 ? top.get_as_ref(1) : 0;
+    if (!tables_ref)
+        return;
+    Array tables(m_alloc);
+    tables.set_parent(&top, 1);
+    tables.init_from_ref(tables_ref);
+    size_t n = std::min(tables.size(), old_table_refs.size());
+    for (size_t i = 0; i < n; ++i) {
+        int64_t value = tables.get(i);
+        // Skip null refs and tagged values, and tables which were not moved
+        if (value == 0 || (value & 1) != 0 || value == old_table_refs[i])
+            continue;
+        Array table_top(m_alloc);
+        table_top.set_parent(&tables, i);
+        table_top.init_from_ref(to_ref(value));
+        if (table_top.size() <= size_t(Table::top_position_for_version))
+            continue;
+        auto version = table_top.get_as_ref_or_tagged(Table::top_position_for_version);
+        REALM_ASSERT(version.is_tagged());
+        table_top.set(Table::top_position_for_version,
+                      RefOrTagged::make_tagged(version.get_as_int() + 1)); // Throws
+    }
+}
+
+// Visit the array at `ref` and its descendants, moving those beyond the limit.
+// Returns the new ref of the array, which differs from `ref` if the array, or
+// any of its descendants, was moved.
+ref_type GroupWriter::evacuate(ref_type ref, size_t depth)
+{
+    // The approximate cost of visiting an array which is not moved
+    constexpr size_t visit_cost = 16;
+
+    auto& progress = m_online_compaction->progress;
+    Array arr(m_alloc);
+    arr.init_from_ref(ref);
+    // Returning to where the previous commit stopped is free, so that every
+    // commit makes progress
+    if (!m_evacuation_resuming)
+        m_evacuation_budget -= std::min(m_evacuation_budget, visit_cost);
+
+    if (arr.has_refs()) {
+        size_t i = 0;
+        if (m_evacuation_resuming) {
+            if (depth < progress.size())
+                i = progress[depth];
+            if (depth + 1 >= progress.size())
+                m_evacuation_resuming = false;
+        }
+        for (size_t n = arr.size(); i < n; ++i) {
+            if (progress.size() <= depth)
+                progress.resize(depth + 1);
+            progress[depth] = i;
+            if (m_evacuation_budget == 0) {
+                progress.resize(depth + 1);
+                m_evacuation_stopped = true;
+                break;
             }
-            else {
-                prev = it;
+            int64_t value = arr.get(i);
+            // Skip null refs and tagged values
+            if (value != 0 && (value & 1) == 0) {
+                ref_type child_ref = to_ref(value);
+                ref_type new_child_ref = evacuate(child_ref, depth + 1); // Throws
+                if (new_child_ref != child_ref)
+                    arr.set(i, from_ref(new_child_ref)); // Throws
             }
+            m_evacuation_resuming = false;
+            if (m_evacuation_stopped)
+                break;
         }
     }
+
+    if (!m_evacuation_stopped && arr.is_read_only() && ref >= m_online_compaction->limit) {
+        // Copy the array byte by byte, as not all arrays hold integers. The
+        // copy is written below the limit by write_group(), and the original
+        // is released like any other modified array.
+        size_t byte_size = arr.get_byte_size();
+        m_evacuation_budget -= std::min(m_evacuation_budget, byte_size);
+        MemRef mem = m_alloc.alloc(byte_size); // Throws
+        realm::safe_copy_n(arr.get_header(), byte_size, mem.get_addr());
+        NodeHeader::set_capacity_in_header(byte_size, mem.get_addr());
+        m_alloc.free_(ref, arr.get_header());
+        return mem.get_ref();
+    }
+    return arr.get_ref();
 }
 
-void GroupWriter::FreeList::move_free_in_file_to_size_map(std::multimap<size_t, size_t>& size_map)
+void GroupWriter::restore_tail_free_space()
 {
-    for (auto& elem : *this) {
-        // Skip elements merged in 'merge_adjacent_entries_in_freelist'
-        if (elem.size) {
-            REALM_ASSERT_RELEASE_EX(!(elem.size & 7), elem.size);
-            REALM_ASSERT_RELEASE_EX(!(elem.ref & 7), elem.ref);
-            size_map.emplace(elem.size, elem.ref);
-        }
+    m_size_map.insert(m_tail_size_map.begin(), m_tail_size_map.end());
+    m_tail_size_map.clear();
+}
+
+// Give back the free space at the end of the file, but not below the limit, as
+// that is where arrays are moved to. Space which is still used by a reader, and
+// the chunk reserved for the free-lists, are kept.
+void GroupWriter::shrink_logical_file_size(size_t reserve_pos)
+{
+    ref_type limit = m_online_compaction->limit;
+    if (limit == 0)
+        return;
+
+    size_t logical_file_size = to_size_t(m_group.m_top.get(2) / 2);
+    auto& chunks = m_free_space.chunks;
+    auto first = chunks.end();
+    size_t end = logical_file_size;
+    while (first != chunks.begin()) {
+        auto prev = std::prev(first);
+        if (prev->second.locked || prev->first == reserve_pos || prev->first + prev->second.size != end)
+            break;
+        first = prev;
+        end = prev->first;
+    }
+    size_t new_file_size = std::max(util::round_up_to_page_size(end), size_t(limit));
+    if (new_file_size >= logical_file_size)
+        return;
+
+    while (first != chunks.end()) {
+        m_size_map.erase({first->second.size, first->first});
+        first = chunks.erase(first);
     }
+    if (new_file_size > end)
+        add_free_chunk(end, new_file_size - end);
+    m_group.m_top.set(2, 1 + 2 * uint64_t(new_file_size)); // Throws
+}
+
+void GroupWriter::truncate_file()
+{
+#ifndef _WIN32
+    // An encrypted file is only truncated when a new session opens it, as the
+    // decrypted blocks may still be cached by the readers. On Windows a file
+    // cannot be truncated while it is mapped.
+    util::File& file = m_alloc.get_file();
+    size_t logical_file_size = to_size_t(m_group.m_top.get(2) / 2);
+    if (file.get_encryption_key() || get_file_size() <= logical_file_size)
+        return;
+    m_map_windows.clear();
+    file.resize(logical_file_size); // Throws
+#endif
 }
 
 size_t GroupWriter::get_free_space(size_t size)
@@ -677,13 +1005,13 @@ size_t GroupWriter::get_free_space(size_t size)
     REALM_ASSERT_RELEASE_EX(!(chunk_size & 7), chunk_size);
 
     size_t rest = chunk_size - size;
-    m_size_map.erase(p);
+    remove_free_chunk(p);
     if (rest > 0) {
         // Allocating part of chunk - this alway happens from the beginning
         // of the chunk. The call to reserve_free_space may split chunks
         // in order to make sure that it returns a chunk from which allocation
         // can be done from the beginning
-        m_size_map.emplace(rest, chunk_pos + size);
+        add_free_chunk(chunk_pos + size, rest);
     }
     return chunk_pos;
 }
@@ -693,14 +1021,14 @@ inline GroupWriter::FreeListElement GroupWriter::split_freelist_chunk(FreeListEl
 {
     size_t start_pos = it->second;
     size_t chunk_size = it->first;
-    m_size_map.erase(it);
+    remove_free_chunk(it);
     REALM_ASSERT_RELEASE_EX(alloc_pos > start_pos, alloc_pos, start_pos);
 
     REALM_ASSERT_RELEASE_EX(!(alloc_pos & 7), alloc_pos);
     size_t size_first = alloc_pos - start_pos;
     size_t size_second = chunk_size - size_first;
-    m_size_map.emplace(size_first, start_pos);
-    return m_size_map.emplace(size_second, alloc_pos);
+    add_free_chunk(start_pos, size_first);
+    return add_free_chunk(alloc_pos, size_second);
 }
 
 GroupWriter::FreeListElement GroupWriter::search_free_space_in_free_list_element(FreeListElement it, size_t size)
@@ -727,7 +1055,7 @@ GroupWriter::FreeListElement GroupWriter::search_free_space_in_free_list_element
 
 GroupWriter::FreeListElement GroupWriter::search_free_space_in_part_of_freelist(size_t size)
 {
-    auto it = m_size_map.lower_bound(size);
+    auto it = m_size_map.lower_bound({size, 0});
     while (it != m_size_map.end()) {
         // Accept either a perfect match or a block that is twice the size. Tests have shown
         // that this is a good strategy.
@@ -740,7 +1068,7 @@ GroupWriter::FreeListElement GroupWriter::search_free_space_in_part_of_freelist(
         }
         else {
             // If block was too small, search for the first that is at least twice as big.
-            it = m_size_map.lower_bound(2 * size);
+            it = m_size_map.lower_bound({2 * size, 0});
         }
     }
     // No match
@@ -751,6 +1079,12 @@ GroupWriter::FreeListElement GroupWriter::search_free_space_in_part_of_freelist(
 GroupWriter::FreeListElement GroupWriter::reserve_free_space(size_t size)
 {
     auto chunk = search_free_space_in_part_of_freelist(size);
+    if (chunk == m_size_map.end() && !m_tail_size_map.empty()) {
+        // The space beyond the limit of the online compaction is used before
+        // extending the file
+        restore_tail_free_space();
+        chunk = search_free_space_in_part_of_freelist(size);
+    }
     while (chunk == m_size_map.end()) {
         // No free space, so we have to extend the file.
         auto new_chunk = extend_free_space(size);
@@ -827,7 +1161,7 @@ GroupWriter::FreeListElement GroupWriter::extend_free_space(size_t requested_siz
     size_t chunk_size = new_file_size - logical_file_size;
     REALM_ASSERT_RELEASE_EX(!(chunk_size & 7), chunk_size);
     REALM_ASSERT_RELEASE(chunk_size != 0);
-    auto it = m_size_map.emplace(chunk_size, logical_file_size);
+    auto it = add_free_chunk(logical_file_size, chunk_size);
 
     // Update the logical file size
     m_group.m_top.set(2, 1 + 2 * uint64_t(new_file_size)); // Throws
@@ -854,6 +1188,8 @@ ref_type GroupWriter::write_array(const char* data, size_t size, uint32_t checks
     memcpy(dest_addr, &checksum, 4);
     memcpy(dest_addr + 4, data + 4, size - 4);
     window->encryption_write_barrier(dest_addr, size);
+    if (m_write_ahead_log)
+        m_write_ahead_log->add_block(pos, dest_addr, size); // Throws
     // return ref of the written array
     ref_type ref = to_ref(pos);
     return ref;
@@ -872,6 +1208,8 @@ void GroupWriter::write_array_at(MapWindow* window, ref_type ref, const char* da
     uint32_t dummy_checksum = 0x41414141UL; // "AAAA" in ASCII
     memcpy(dest_addr, &dummy_checksum, 4);
     memcpy(dest_addr + 4, data + 4, size - 4);
+    if (m_write_ahead_log)
+        m_write_ahead_log->add_block(ref, dest_addr, size); // Throws
 }
 
 
@@ -22,6 +22,8 @@
 #include <cstdint> // unint8_t etc
 #include <utility>
 #include <map>
+#include <set>
+#include <vector>
 
 #include <realm/util/file.hpp>
 #include <realm/alloc.hpp>
@@ -35,6 +37,50 @@ namespace realm {
 // Pre-declarations
 class Group;
 class SlabAlloc;
+class WriteAheadLog;
+
+
+/// The state of an online compaction, which is kept by a DB between its
+/// commits.
+///
+/// A pass of the compaction selects a limit below the logical end of the file,
+/// such that the free space below the limit can hold all the arrays beyond it.
+/// Each commit then visits part of the arrays of the snapshot, and moves the
+/// ones found beyond the limit into free space below it. Parents of a moved
+/// array are rewritten as for any other modification, so the snapshot being
+/// committed never refers to the old copy. Once the end of the file is free,
+/// and no longer used by any reader, the logical file size is reduced.
+struct OnlineCompaction {
+    /// The approximate number of bytes visited and moved per commit.
+    size_t budget;
+    /// Arrays at or beyond this position are moved, or zero when no pass is in
+    /// progress.
+    ref_type limit = 0;
+    /// The child indexes leading to the array where the current pass stopped.
+    std::vector<size_t> progress;
+};
+
+
+/// The free-lists of the file after a commit, which a DB keeps so that its
+/// next commit does not have to read, sort and merge them again, unless
+/// another DB has committed in between.
+struct FreeSpaceIndex {
+    struct Chunk {
+        size_t size;
+        uint64_t released_at_version;
+        bool locked; // May still be used by a reader
+    };
+    /// Every chunk of the free-lists, by position.
+    std::map<size_t, Chunk> chunks;
+    /// The chunks which are not locked, by size and then position.
+    std::set<std::pair<size_t, size_t>> free_by_size;
+    /// The positions of the locked chunks, by the version which released them.
+    std::multimap<uint64_t, size_t> locked_by_version;
+    /// The version of the snapshot, and the ref of its free-list of positions,
+    /// which the index describes. Zero if it describes none.
+    uint64_t version = 0;
+    ref_type free_positions_ref = 0;
+};
 
 
 /// This class is not supposed to be reused for multiple write sessions. In
@@ -88,6 +134,44 @@ public:
     // Flush all cached memory mappings
     void flush_all_mappings();
 
+    /// Add every block written to the file to the current record of \a log.
+    void set_write_ahead_log(WriteAheadLog* log) noexcept
+    {
+        m_write_ahead_log = log;
+    }
+
+    /// Use and update \a index instead of reading the free-lists from the
+    /// file, if it describes the snapshot being written on.
+    void set_free_space_index(FreeSpaceIndex* index) noexcept
+    {
+        m_free_space_index = index;
+    }
+
+    /// Leave the index set by set_free_space_index() describing the
+    /// free-lists written by write_group(). Must only be called once the new
+    /// snapshot has been published to readers.
+    void publish_free_space_index() noexcept;
+
+#ifdef REALM_DEBUG
+    /// Whether write_group() used the index instead of reading the free-lists.
+    bool has_reused_free_space_index() const noexcept
+    {
+        return m_reused_free_space_index;
+    }
+#endif
+
+    /// Move arrays towards the start of the file, as described by \a state,
+    /// while writing the group.
+    void set_online_compaction(OnlineCompaction* state) noexcept
+    {
+        m_online_compaction = state;
+    }
+
+    /// Truncate the file to the logical file size, if it has been reduced by
+    /// the online compaction. Must only be called after commit(), when no
+    /// reader can use the space beyond the logical end of the file.
+    void truncate_file();
+
 private:
     class MapWindow;
     Group& m_group;
@@ -101,33 +185,40 @@ private:
     size_t m_free_space_size = 0;
     size_t m_locked_space_size = 0;
     Durability m_durability;
+    WriteAheadLog* m_write_ahead_log = nullptr;
+    FreeSpaceIndex* m_free_space_index = nullptr;
+    OnlineCompaction* m_online_compaction = nullptr;
+    size_t m_evacuation_budget = 0;
+    bool m_evacuation_resuming = false;
+    bool m_evacuation_stopped = false;
+#ifdef REALM_DEBUG
+    bool m_reused_free_space_index = false;
+#endif
 
-    struct FreeSpaceEntry {
-        FreeSpaceEntry(size_t r, size_t s, uint64_t v)
-            : ref(r)
-            , size(s)
-            , released_at_version(v)
-        {
-        }
-        size_t ref;
-        size_t size;
-        uint64_t released_at_version;
-    };
-    class FreeList : public std::vector<FreeSpaceEntry> {
-    public:
-        FreeList() = default;
-        // Merge adjacent chunks
-        void merge_adjacent_entries_in_freelist();
-        // Copy free space entries to structure where entries are sorted by size
-        void move_free_in_file_to_size_map(std::multimap<size_t, size_t>& size_map);
-    };
-    //  m_free_in_file;
-    std::vector<FreeSpaceEntry> m_not_free_in_file;
-    std::multimap<size_t, size_t> m_size_map;
-    using FreeListElement = std::multimap<size_t, size_t>::iterator;
+    FreeSpaceIndex m_free_space;
+    // The free chunks by size, which are searched for space to allocate
+    std::set<std::pair<size_t, size_t>>& m_size_map;
+    // Free chunks at or beyond the limit of the online compaction, which are
+    // only allocated from when the chunks in m_size_map are exhausted
+    std::set<std::pair<size_t, size_t>> m_tail_size_map;
+    using FreeListElement = std::set<std::pair<size_t, size_t>>::iterator;
 
     void read_in_freelist();
+#ifdef REALM_DEBUG
+    void verify_free_space_index() const;
+#endif
     size_t recreate_freelist(size_t reserve_pos);
+    void release_chunk(size_t ref);
+    FreeListElement add_free_chunk(size_t ref, size_t size);
+    void remove_free_chunk(FreeListElement);
+
+    // Online compaction
+    void start_evacuation();
+    void evacuate_tail();
+    ref_type evacuate(ref_type ref, size_t depth);
+    void bump_evacuated_table_versions(const std::vector<int64_t>& old_table_refs);
+    void restore_tail_free_space();
+    void shrink_logical_file_size(size_t reserve_pos);
     // Currently cached memory mappings. We keep as many as 16 1MB windows
     // open for writing. The allocator will favor sequential allocation
     // from a modest number of windows, depending upon fragmentation, so
@@ -0,0 +1,129 @@
+/*************************************************************************
+ *
+ * Copyright 2022 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/hot_ranges.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#endif
+
+using namespace realm;
+using namespace realm::util;
+
+namespace {
+
+const char s_magic[8] = {'T', '-', 'D', 'B', '-', 'H', 'O', 'T'};
+
+struct Header {
+    char magic[8];
+    uint64_t num_ranges;
+    uint64_t checksum; // Of the ranges
+};
+
+// 64 bit FNV-1a
+uint64_t checksum(const char* data, size_t size) noexcept
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= uint8_t(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Ranges are read ahead in pieces of this size, so that a request to stop is
+// noticed soon.
+constexpr size_t prefetch_chunk_size = 4 * 1024 * 1024;
+
+} // anonymous namespace
+
+void HotRanges::write(const std::string& path, const std::vector<Range>& ranges)
+{
+    std::vector<uint64_t> body;
+    body.reserve(2 * ranges.size()); // Throws
+    for (const auto& range : ranges) {
+        body.push_back(uint64_t(range.first));
+        body.push_back(uint64_t(range.second));
+    }
+    const char* data = reinterpret_cast<const char*>(body.data());
+    size_t size = body.size() * sizeof(uint64_t);
+
+    Header header;
+    std::memcpy(header.magic, s_magic, sizeof(s_magic));
+    header.num_ranges = uint64_t(ranges.size());
+    header.checksum = checksum(data, size);
+
+    File file(path, File::mode_Write);                                  // Throws
+    file.write(reinterpret_cast<const char*>(&header), sizeof(Header)); // Throws
+    file.write(data, size);                                             // Throws
+}
+
+auto HotRanges::read(const std::string& path) -> std::vector<Range>
+{
+    std::vector<Range> ranges;
+    if (!File::exists(path))
+        return ranges;
+    File file;
+    file.open(path, File::access_ReadOnly, File::create_Never, 0); // Throws
+    size_t file_size = size_t(file.get_size());
+    Header header;
+    if (file_size < sizeof(Header) || file.read(reinterpret_cast<char*>(&header), sizeof(Header)) != sizeof(Header) ||
+        std::memcmp(header.magic, s_magic, sizeof(s_magic)) != 0 ||
+        file_size - sizeof(Header) != header.num_ranges * 2 * sizeof(uint64_t))
+        return ranges;
+
+    std::vector<uint64_t> body(2 * size_t(header.num_ranges));
+    size_t size = body.size() * sizeof(uint64_t);
+    char* data = reinterpret_cast<char*>(body.data());
+    if (file.read(data, size) != size || checksum(data, size) != header.checksum)
+        return ranges;
+
+    ranges.reserve(body.size() / 2);
+    for (size_t i = 0; i < body.size(); i += 2)
+        ranges.emplace_back(size_t(body[i]), size_t(body[i + 1]));
+    return ranges;
+}
+
+void HotRanges::prefetch(File& file, const std::vector<Range>& ranges, const std::atomic<bool>& stop)
+{
+    size_t file_size = size_t(file.get_size());
+#if !defined(__linux__)
+    // Without posix_fadvise() the pages are brought in by reading them
+    std::unique_ptr<char[]> buffer(new char[prefetch_chunk_size]);
+#endif
+    for (const auto& range : ranges) {
+        size_t pos = range.first;
+        size_t end = std::min(range.first + range.second, file_size);
+        while (pos < end) {
+            if (stop.load(std::memory_order_relaxed))
+                return;
+            size_t size = std::min(end - pos, prefetch_chunk_size);
+#if defined(__linux__)
+            ::posix_fadvise(file.get_descriptor(), off_t(pos), off_t(size), POSIX_FADV_WILLNEED);
+#else
+            file.seek(File::SizeType(pos)); // Throws
+            file.read(buffer.get(), size);  // Throws
+#endif
+            pos += size;
+        }
+    }
+}
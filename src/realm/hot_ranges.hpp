@@ -0,0 +1,60 @@
+/*************************************************************************
+ *
+ * Copyright 2022 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_HOT_RANGES_HPP
+#define REALM_HOT_RANGES_HPP
+
+#include <realm/util/file.hpp>
+
+#include <atomic>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace realm {
+
+/// The ranges of a Realm file which were resident in memory when they were
+/// last recorded, kept in a small file next to it (`<path>.hot`).
+///
+/// A process opening the Realm file reads the recorded ranges into the page
+/// cache in the background, so that it does not have to fault in the working
+/// set of the previous process one page at a time while serving requests.
+///
+/// The file holds a header with the number of ranges and a checksum, followed
+/// by the file offset and size of each range. A file which was only partially
+/// written, or which was written concurrently by two processes, fails the
+/// checksum and is ignored.
+class HotRanges {
+public:
+    using Range = std::pair<size_t, size_t>; // File offset and size
+
+    /// Replace the contents of the file at \a path by \a ranges.
+    static void write(const std::string& path, const std::vector<Range>& ranges);
+
+    /// The ranges recorded in the file at \a path, or none if the file is
+    /// missing or invalid.
+    static std::vector<Range> read(const std::string& path);
+
+    /// Ask the system to read \a ranges of \a file into the page cache.
+    /// Returns early if \a stop becomes true.
+    static void prefetch(util::File& file, const std::vector<Range>& ranges, const std::atomic<bool>& stop);
+};
+
+} // namespace realm
+
+#endif // REALM_HOT_RANGES_HPP
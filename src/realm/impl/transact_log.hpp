@@ -240,6 +240,128 @@ public:
 // LCOV_EXCL_STOP (NullInstructionObserver)
 
 
+/// Forwards the instructions of a transaction log to an observer, and notes
+/// whether any of them changes the schema. This lets the pass over the log made
+/// for the observer also tell Group::advance_transact() what it would otherwise
+/// have to parse the log once more for.
+template <class Observer>
+class SchemaChangeTracker {
+public:
+    explicit SchemaChangeTracker(Observer& observer) noexcept
+        : m_observer(observer)
+    {
+    }
+
+    bool schema_changed = false;
+
+    bool select_table(TableKey key)
+    {
+        return m_observer.select_table(key);
+    }
+    bool select_collection(ColKey col, ObjKey key)
+    {
+        return m_observer.select_collection(col, key);
+    }
+    bool insert_group_level_table(TableKey key)
+    {
+        schema_changed = true;
+        return m_observer.insert_group_level_table(key);
+    }
+    bool erase_class(TableKey key)
+    {
+        schema_changed = true;
+        return m_observer.erase_class(key);
+    }
+    bool rename_class(TableKey key)
+    {
+        schema_changed = true;
+        return m_observer.rename_class(key);
+    }
+    bool create_object(ObjKey key)
+    {
+        return m_observer.create_object(key);
+    }
+    bool remove_object(ObjKey key)
+    {
+        return m_observer.remove_object(key);
+    }
+    bool modify_object(ColKey col, ObjKey key)
+    {
+        return m_observer.modify_object(col, key);
+    }
+    bool list_set(size_t ndx)
+    {
+        return m_observer.list_set(ndx);
+    }
+    bool list_insert(size_t ndx)
+    {
+        return m_observer.list_insert(ndx);
+    }
+    bool list_move(size_t from, size_t to)
+    {
+        return m_observer.list_move(from, to);
+    }
+    bool list_erase(size_t ndx)
+    {
+        return m_observer.list_erase(ndx);
+    }
+    bool list_clear(size_t size)
+    {
+        return m_observer.list_clear(size);
+    }
+    bool set_insert(size_t ndx)
+    {
+        return m_observer.set_insert(ndx);
+    }
+    bool set_erase(size_t ndx)
+    {
+        return m_observer.set_erase(ndx);
+    }
+    bool set_clear(size_t size)
+    {
+        return m_observer.set_clear(size);
+    }
+    bool dictionary_insert(size_t ndx, Mixed key)
+    {
+        return m_observer.dictionary_insert(ndx, key);
+    }
+    bool dictionary_set(size_t ndx, Mixed key)
+    {
+        return m_observer.dictionary_set(ndx, key);
+    }
+    bool dictionary_erase(size_t ndx, Mixed key)
+    {
+        return m_observer.dictionary_erase(ndx, key);
+    }
+    bool insert_column(ColKey col)
+    {
+        schema_changed = true;
+        return m_observer.insert_column(col);
+    }
+    bool erase_column(ColKey col)
+    {
+        schema_changed = true;
+        return m_observer.erase_column(col);
+    }
+    bool rename_column(ColKey col)
+    {
+        schema_changed = true;
+        return m_observer.rename_column(col);
+    }
+    bool typed_link_change(ColKey col, TableKey dest)
+    {
+        return m_observer.typed_link_change(col, dest);
+    }
+    void parse_complete()
+    {
+        m_observer.parse_complete();
+    }
+
+private:
+    Observer& m_observer;
+};
+
+
 /// See Replication for information about the meaning of the
 /// arguments of each of the functions in this class.
 class TransactLogEncoder {
@@ -0,0 +1,411 @@
+/*************************************************************************
+ *
+ * Copyright 2022 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/index_fulltext.hpp>
+#include <realm/impl/destroy_guard.hpp>
+#include <realm/table.hpp>
+#include <realm/util/thread_pool.hpp>
+
+#include <algorithm>
+
+using namespace realm;
+using namespace realm::util;
+
+namespace {
+
+// A term whose posting list is this many times longer than the current set of
+// candidates is matched by looking up each candidate in the list instead of
+// reading the whole list.
+constexpr size_t s_probe_factor = 16;
+
+inline bool is_word_char(char c)
+{
+    auto uc = static_cast<unsigned char>(c);
+    return uc >= 0x80 || (uc >= '0' && uc <= '9') || (uc >= 'a' && uc <= 'z') || (uc >= 'A' && uc <= 'Z');
+}
+
+std::vector<std::string> get_words(Mixed value)
+{
+    if (value.is_null())
+        return {};
+    return Tokenizer::get_all_words(value.get_string());
+}
+
+struct Entry {
+    std::string word;
+    ObjKey key;
+    // The words are compared as StringData, which is how they are ordered in
+    // the index
+    bool operator<(const Entry& other) const
+    {
+        StringData a(word);
+        StringData b(other.word);
+        return a < b || (a == b && key < other.key);
+    }
+};
+
+} // anonymous namespace
+
+bool Tokenizer::next()
+{
+    m_word.clear();
+    size_t size = m_text.size();
+    while (m_pos < size && !is_word_char(m_text[m_pos]))
+        ++m_pos;
+    if (m_pos == size)
+        return false;
+    while (m_pos < size && is_word_char(m_text[m_pos])) {
+        char c = m_text[m_pos++];
+        if (c >= 'A' && c <= 'Z')
+            c += 'a' - 'A';
+        m_word += c;
+    }
+    return true;
+}
+
+std::vector<std::string> Tokenizer::get_all_words(StringData text)
+{
+    std::vector<std::string> words;
+    Tokenizer tokenizer(text);
+    while (tokenizer.next())
+        words.emplace_back(tokenizer.get());
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+    return words;
+}
+
+std::vector<FullTextIndex::Term> FullTextIndex::get_terms(StringData text)
+{
+    std::vector<Term> terms;
+    Tokenizer tokenizer(text);
+    while (tokenizer.next()) {
+        Term term{tokenizer.get(), tokenizer.get_terminator() == '*'};
+        auto same = [&](const Term& t) {
+            return t.word == term.word && t.is_prefix == term.is_prefix;
+        };
+        if (std::find_if(terms.begin(), terms.end(), same) == terms.end())
+            terms.push_back(std::move(term));
+    }
+    return terms;
+}
+
+bool FullTextIndex::matches(const std::vector<Term>& terms, StringData value)
+{
+    if (terms.empty())
+        return true;
+    auto words = Tokenizer::get_all_words(value);
+    for (auto& term : terms) {
+        auto it = std::lower_bound(words.begin(), words.end(), term.word);
+        if (it == words.end())
+            return false;
+        if (term.is_prefix ? !StringData(*it).begins_with(term.word) : *it != term.word)
+            return false;
+    }
+    return true;
+}
+
+FullTextIndex::FullTextIndex(const ClusterColumn& target_column, Allocator& alloc)
+    : m_top(alloc)
+    , m_words(alloc)
+    , m_keys(alloc)
+    , m_target_column(target_column)
+{
+    REALM_ASSERT(type_supported(target_column.get_data_type()));
+    m_top.create(Array::type_HasRefs); // Throws
+    _impl::DeepArrayDestroyGuard dg(&m_top);
+    m_top.add(0); // Throws
+    m_top.add(0); // Throws
+    m_top.add(RefOrTagged::make_tagged(target_column.get_column_key().value)); // Throws
+    m_words.set_parent(&m_top, s_words_ndx);
+    m_words.create(); // Throws
+    m_keys.set_parent(&m_top, s_keys_ndx);
+    m_keys.create(); // Throws
+    dg.release();
+}
+
+FullTextIndex::FullTextIndex(ref_type ref, ArrayParent* parent, size_t ndx_in_parent,
+                             const ClusterColumn& target_column, Allocator& alloc)
+    : m_top(alloc)
+    , m_words(alloc)
+    , m_keys(alloc)
+    , m_target_column(target_column)
+{
+    m_top.init_from_ref(ref);
+    m_top.set_parent(parent, ndx_in_parent);
+    init_trees();
+}
+
+ColKey FullTextIndex::get_column_key(ref_type ref, Allocator& alloc) noexcept
+{
+    Array top(alloc);
+    top.init_from_ref(ref);
+    return ColKey(top.get_as_ref_or_tagged(s_col_key_ndx).get_as_int());
+}
+
+void FullTextIndex::init_trees()
+{
+    m_words.set_parent(&m_top, s_words_ndx);
+    m_words.init_from_parent();
+    m_keys.set_parent(&m_top, s_keys_ndx);
+    m_keys.init_from_parent();
+}
+
+void FullTextIndex::destroy() noexcept
+{
+    m_top.destroy_deep();
+}
+
+void FullTextIndex::set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept
+{
+    m_top.set_parent(parent, ndx_in_parent);
+}
+
+size_t FullTextIndex::get_ndx_in_parent() const noexcept
+{
+    return m_top.get_ndx_in_parent();
+}
+
+void FullTextIndex::set_ndx_in_parent(size_t ndx_in_parent) noexcept
+{
+    m_top.set_ndx_in_parent(ndx_in_parent);
+}
+
+void FullTextIndex::update_from_parent() noexcept
+{
+    m_top.update_from_parent();
+    init_trees();
+}
+
+void FullTextIndex::refresh_accessor_tree(const ClusterColumn& target_column)
+{
+    m_target_column = target_column;
+    m_top.init_from_parent();
+    init_trees();
+}
+
+ref_type FullTextIndex::get_ref() const noexcept
+{
+    return m_top.get_ref();
+}
+
+size_t FullTextIndex::find_position(StringData word, ObjKey key) const
+{
+    // The entries of a word are ordered by key
+    size_t begin = m_words.partition_point([&](size_t, StringData w) {
+        return w < word;
+    });
+    size_t end = m_words.partition_point([&](size_t pos, StringData w) {
+        return pos < begin || w == word;
+    });
+    if (begin == end)
+        return begin;
+    return m_keys.partition_point([&](size_t pos, int64_t k) {
+        return pos < begin || (pos < end && k < key.value);
+    });
+}
+
+std::pair<size_t, size_t> FullTextIndex::find_range(const Term& term) const
+{
+    StringData word(term.word);
+    size_t begin = m_words.partition_point([&](size_t, StringData w) {
+        return w < word;
+    });
+    size_t end = m_words.partition_point([&](size_t pos, StringData w) {
+        return pos < begin || (term.is_prefix ? w.begins_with(word) : w == word);
+    });
+    return {begin, end};
+}
+
+void FullTextIndex::find_all(std::vector<ObjKey>& result, const std::vector<Term>& terms) const
+{
+    if (terms.empty())
+        return;
+
+    std::vector<std::pair<size_t, size_t>> ranges;
+    for (auto& term : terms) {
+        auto range = find_range(term);
+        if (range.first == range.second)
+            return;
+        ranges.push_back(range);
+    }
+    std::vector<size_t> order(terms.size());
+    for (size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return ranges[a].second - ranges[a].first < ranges[b].second - ranges[b].first;
+    });
+
+    // The keys of the entries of a word are in ascending order, but those of a
+    // prefix are only so per matching word
+    auto read_keys = [&](size_t term_ndx, std::vector<int64_t>& keys) {
+        keys.clear();
+        for (size_t ndx = ranges[term_ndx].first; ndx < ranges[term_ndx].second; ++ndx)
+            keys.push_back(m_keys.get(ndx));
+        if (terms[term_ndx].is_prefix) {
+            std::sort(keys.begin(), keys.end());
+            keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        }
+    };
+    auto in_range = [&](int64_t key, size_t begin, size_t end) {
+        size_t pos = m_keys.partition_point([&](size_t p, int64_t k) {
+            return p < begin || (p < end && k < key);
+        });
+        return pos < end && m_keys.get(pos) == key;
+    };
+
+    std::vector<int64_t> candidates;
+    read_keys(order[0], candidates);
+    std::vector<int64_t> keys;
+    std::vector<int64_t> intersection;
+    for (size_t i = 1; i < order.size() && !candidates.empty(); ++i) {
+        auto [begin, end] = ranges[order[i]];
+        if (!terms[order[i]].is_prefix && end - begin > s_probe_factor * candidates.size()) {
+            auto it = std::remove_if(candidates.begin(), candidates.end(), [&](int64_t key) {
+                return !in_range(key, begin, end);
+            });
+            candidates.erase(it, candidates.end());
+        }
+        else {
+            read_keys(order[i], keys);
+            intersection.clear();
+            std::set_intersection(candidates.begin(), candidates.end(), keys.begin(), keys.end(),
+                                  std::back_inserter(intersection));
+            candidates.swap(intersection);
+        }
+    }
+
+    result.reserve(result.size() + candidates.size());
+    for (auto key : candidates)
+        result.push_back(ObjKey(key));
+}
+
+void FullTextIndex::insert_words(ObjKey key, const std::vector<std::string>& words)
+{
+    for (auto& word : words) {
+        size_t ndx = find_position(word, key);
+        m_words.insert(ndx, word);     // Throws
+        m_keys.insert(ndx, key.value); // Throws
+    }
+}
+
+void FullTextIndex::erase_words(ObjKey key, const std::vector<std::string>& words)
+{
+    for (auto& word : words) {
+        size_t ndx = find_position(word, key);
+        REALM_ASSERT(ndx < size() && m_keys.get(ndx) == key.value);
+        m_words.erase(ndx);
+        m_keys.erase(ndx);
+    }
+}
+
+void FullTextIndex::insert(ObjKey key, Mixed value)
+{
+    insert_words(key, get_words(value)); // Throws
+}
+
+void FullTextIndex::set(ObjKey key, Mixed new_value)
+{
+    auto old_words = get_words(m_target_column.get_value(key));
+    auto new_words = get_words(new_value);
+
+    // Only the words which are added or removed are touched
+    std::vector<std::string> removed;
+    std::vector<std::string> added;
+    std::set_difference(old_words.begin(), old_words.end(), new_words.begin(), new_words.end(),
+                        std::back_inserter(removed));
+    std::set_difference(new_words.begin(), new_words.end(), old_words.begin(), old_words.end(),
+                        std::back_inserter(added));
+    erase_words(key, removed);
+    insert_words(key, added); // Throws
+}
+
+void FullTextIndex::erase(ObjKey key)
+{
+    erase_words(key, get_words(m_target_column.get_value(key)));
+}
+
+void FullTextIndex::clear()
+{
+    m_words.clear();
+    m_keys.clear();
+}
+
+void FullTextIndex::populate()
+{
+    REALM_ASSERT(is_empty());
+    size_t size = m_target_column.size();
+    if (size == 0)
+        return;
+
+    // Large columns are tokenized in chunks on several threads
+    ColKey col_key = m_target_column.get_column_key();
+    constexpr size_t chunk_size = 0x10000;
+    size_t num_chunks = (size + chunk_size - 1) / chunk_size;
+    std::vector<std::vector<Entry>> chunk_entries(num_chunks);
+    auto& pool = ThreadPool::get_default();
+    pool.run(num_chunks, [&](size_t chunk) {
+        size_t begin = chunk * chunk_size;
+        size_t end = std::min(begin + chunk_size, size);
+        auto it = m_target_column.begin();
+        it += begin;
+        auto& entries = chunk_entries[chunk];
+        for (size_t i = begin; i < end; ++i, ++it) {
+            ObjKey key = it->get_key();
+            for (auto& word : get_words(it->get_any(col_key)))
+                entries.push_back({std::move(word), key});
+        }
+    });
+
+    std::vector<Entry> entries;
+    size_t num_entries = 0;
+    for (auto& chunk : chunk_entries)
+        num_entries += chunk.size();
+    entries.reserve(num_entries);
+    for (auto& chunk : chunk_entries) {
+        std::move(chunk.begin(), chunk.end(), std::back_inserter(entries));
+        chunk = {};
+    }
+    parallel_sort(pool, entries.begin(), entries.end(), std::less<>());
+
+    for (auto& entry : entries) {
+        m_words.add(entry.word);     // Throws
+        m_keys.add(entry.key.value); // Throws
+    }
+}
+
+void FullTextIndex::verify() const
+{
+    m_words.verify();
+    m_keys.verify();
+    REALM_ASSERT(m_words.size() == m_keys.size());
+    size_t num_entries = 0;
+    for (auto it = m_target_column.begin(); it != m_target_column.end(); ++it)
+        num_entries += get_words(it->get_any(get_column_key())).size();
+    REALM_ASSERT(num_entries == size());
+    for (size_t i = 0; i < size(); ++i) {
+        ObjKey key(m_keys.get(i));
+        std::string word = m_words.get(i);
+        auto words = get_words(m_target_column.get_value(key));
+        REALM_ASSERT(std::binary_search(words.begin(), words.end(), word));
+        if (i > 0) {
+            Entry prev{m_words.get(i - 1), ObjKey(m_keys.get(i - 1))};
+            Entry entry{word, key};
+            REALM_ASSERT(prev < entry);
+        }
+    }
+}
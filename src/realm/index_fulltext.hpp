@@ -0,0 +1,170 @@
+/*************************************************************************
+ *
+ * Copyright 2022 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_INDEX_FULLTEXT_HPP
+#define REALM_INDEX_FULLTEXT_HPP
+
+#include <realm/array_integer.hpp>
+#include <realm/array_string.hpp>
+#include <realm/bplustree.hpp>
+#include <realm/index_string.hpp>
+
+#include <string>
+#include <vector>
+
+namespace realm {
+
+/// Splits a string into the words which are indexed by a FullTextIndex. A word
+/// is a maximal run of ASCII letters and digits and of non-ASCII characters.
+/// ASCII letters are lower cased, all other characters are kept as they are.
+class Tokenizer {
+public:
+    Tokenizer(StringData text) noexcept
+        : m_text(text)
+    {
+    }
+
+    /// Advance to the next word. Returns false when there are no more words.
+    bool next();
+
+    /// The current word
+    StringData get() const noexcept
+    {
+        return m_word;
+    }
+
+    /// The character following the current word, or 0 at the end of the text.
+    char get_terminator() const noexcept
+    {
+        return m_pos < m_text.size() ? m_text[m_pos] : 0;
+    }
+
+    /// The distinct words of `text`, in ascending order.
+    static std::vector<std::string> get_all_words(StringData text);
+
+private:
+    StringData m_text;
+    size_t m_pos = 0;
+    std::string m_word;
+};
+
+/// An inverted index over the words of a string column. For every word which
+/// occurs in the column, the index holds a posting list of the objects whose
+/// value contains that word.
+///
+/// The postings of all words are stored as (word, object key) entries in two
+/// B+trees of equal size, one holding the words and one holding the keys. They
+/// are ordered by word and then by object key, so the posting list of a word is
+/// a contiguous range of entries in key order, and the words sharing a prefix
+/// are adjacent. The top array of the index holds the refs of the two trees
+/// followed by the key of the indexed column.
+///
+/// Only string columns can have a full-text index.
+class FullTextIndex {
+public:
+    FullTextIndex(const ClusterColumn& target_column, Allocator&);
+    FullTextIndex(ref_type, ArrayParent*, size_t ndx_in_parent, const ClusterColumn& target_column, Allocator&);
+
+    static bool type_supported(DataType type)
+    {
+        return type == type_String;
+    }
+
+    /// The key of the column indexed by the index with the specified top ref.
+    static ColKey get_column_key(ref_type ref, Allocator&) noexcept;
+
+    ColKey get_column_key() const noexcept
+    {
+        return m_target_column.get_column_key();
+    }
+
+    /// A word of a search text. A word followed by `*` in the search text is a
+    /// prefix, which matches every word that starts with it.
+    struct Term {
+        std::string word;
+        bool is_prefix;
+    };
+
+    /// The distinct terms of a search text.
+    static std::vector<Term> get_terms(StringData text);
+
+    /// True if `value` contains a match for every one of `terms`.
+    static bool matches(const std::vector<Term>& terms, StringData value);
+
+    // Accessor concept:
+    void destroy() noexcept;
+    void set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept;
+    size_t get_ndx_in_parent() const noexcept;
+    void set_ndx_in_parent(size_t ndx_in_parent) noexcept;
+    void update_from_parent() noexcept;
+    void refresh_accessor_tree(const ClusterColumn& target_column);
+    ref_type get_ref() const noexcept;
+
+    // FullTextIndex interface:
+
+    /// The number of (word, object) entries in the index.
+    size_t size() const noexcept
+    {
+        return m_keys.size();
+    }
+    bool is_empty() const noexcept
+    {
+        return m_keys.is_empty();
+    }
+
+    void insert(ObjKey key, Mixed value);
+    /// Must be called before the value in the target column is changed.
+    void set(ObjKey key, Mixed new_value);
+    /// Must be called before the object is removed from the target column.
+    void erase(ObjKey key);
+    void clear();
+
+    /// Insert every object of the target column into this index, which must
+    /// be empty. The entries are sorted up front and appended in order.
+    void populate();
+
+    /// Append the keys of the objects matching all of `terms` to `result`, in
+    /// ascending order. The posting list of the rarest term is read first, and
+    /// the remaining terms are then intersected with it one by one.
+    void find_all(std::vector<ObjKey>& result, const std::vector<Term>& terms) const;
+
+    void verify() const;
+
+private:
+    Array m_top;
+    BPlusTree<StringData> m_words;
+    BPlusTree<int64_t> m_keys;
+    ClusterColumn m_target_column;
+
+    static constexpr size_t s_words_ndx = 0;
+    static constexpr size_t s_keys_ndx = 1;
+    static constexpr size_t s_col_key_ndx = 2;
+
+    void init_trees();
+    /// The position of the entry for (`word`, `key`), or of the first entry
+    /// ordered after it if there is no such entry.
+    size_t find_position(StringData word, ObjKey key) const;
+    /// The range of entries matching `term`.
+    std::pair<size_t, size_t> find_range(const Term& term) const;
+    void insert_words(ObjKey key, const std::vector<std::string>& words);
+    void erase_words(ObjKey key, const std::vector<std::string>& words);
+};
+
+} // namespace realm
+
+#endif // REALM_INDEX_FULLTEXT_HPP
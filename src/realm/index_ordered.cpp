@@ -0,0 +1,249 @@
+/*************************************************************************
+ *
+ * Copyright 2022 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/index_ordered.hpp>
+#include <realm/impl/destroy_guard.hpp>
+#include <realm/table.hpp>
+#include <realm/util/thread_pool.hpp>
+
+using namespace realm;
+using namespace realm::util;
+
+namespace {
+
+struct Entry {
+    Mixed value;
+    ObjKey key;
+    bool operator<(const Entry& other) const
+    {
+        int c = value.compare(other.value);
+        return c < 0 || (c == 0 && key < other.key);
+    }
+};
+
+} // anonymous namespace
+
+OrderedIndex::OrderedIndex(const ClusterColumn& target_column, Allocator& alloc)
+    : m_top(alloc)
+    , m_values(alloc)
+    , m_keys(alloc)
+    , m_target_column(target_column)
+{
+    REALM_ASSERT(type_supported(target_column.get_data_type()));
+    m_top.create(Array::type_HasRefs); // Throws
+    _impl::DeepArrayDestroyGuard dg(&m_top);
+    m_top.add(0); // Throws
+    m_top.add(0); // Throws
+    m_top.add(RefOrTagged::make_tagged(target_column.get_column_key().value)); // Throws
+    m_values.set_parent(&m_top, s_values_ndx);
+    m_values.create(); // Throws
+    m_keys.set_parent(&m_top, s_keys_ndx);
+    m_keys.create(); // Throws
+    dg.release();
+}
+
+OrderedIndex::OrderedIndex(ref_type ref, ArrayParent* parent, size_t ndx_in_parent,
+                           const ClusterColumn& target_column, Allocator& alloc)
+    : m_top(alloc)
+    , m_values(alloc)
+    , m_keys(alloc)
+    , m_target_column(target_column)
+{
+    m_top.init_from_ref(ref);
+    m_top.set_parent(parent, ndx_in_parent);
+    init_trees();
+}
+
+ColKey OrderedIndex::get_column_key(ref_type ref, Allocator& alloc) noexcept
+{
+    Array top(alloc);
+    top.init_from_ref(ref);
+    return ColKey(top.get_as_ref_or_tagged(s_col_key_ndx).get_as_int());
+}
+
+void OrderedIndex::init_trees()
+{
+    m_values.set_parent(&m_top, s_values_ndx);
+    m_values.init_from_parent();
+    m_keys.set_parent(&m_top, s_keys_ndx);
+    m_keys.init_from_parent();
+}
+
+void OrderedIndex::destroy() noexcept
+{
+    m_top.destroy_deep();
+}
+
+void OrderedIndex::set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept
+{
+    m_top.set_parent(parent, ndx_in_parent);
+}
+
+size_t OrderedIndex::get_ndx_in_parent() const noexcept
+{
+    return m_top.get_ndx_in_parent();
+}
+
+void OrderedIndex::set_ndx_in_parent(size_t ndx_in_parent) noexcept
+{
+    m_top.set_ndx_in_parent(ndx_in_parent);
+}
+
+void OrderedIndex::update_from_parent() noexcept
+{
+    m_top.update_from_parent();
+    init_trees();
+}
+
+void OrderedIndex::refresh_accessor_tree(const ClusterColumn& target_column)
+{
+    m_target_column = target_column;
+    m_top.init_from_parent();
+    init_trees();
+}
+
+ref_type OrderedIndex::get_ref() const noexcept
+{
+    return m_top.get_ref();
+}
+
+size_t OrderedIndex::find_position(Mixed value, ObjKey key) const
+{
+    // The entries with an equal value are ordered by key
+    size_t begin = lower_bound(value);
+    size_t end = upper_bound(value);
+    if (begin == end)
+        return begin;
+    return m_keys.partition_point([&](size_t pos, int64_t k) {
+        return pos < begin || (pos < end && k < key.value);
+    });
+}
+
+size_t OrderedIndex::lower_bound(Mixed value) const
+{
+    return m_values.partition_point([&](size_t, Mixed v) {
+        return v.compare(value) < 0;
+    });
+}
+
+size_t OrderedIndex::upper_bound(Mixed value) const
+{
+    return m_values.partition_point([&](size_t, Mixed v) {
+        return v.compare(value) <= 0;
+    });
+}
+
+void OrderedIndex::get_keys(size_t begin, size_t end, std::vector<ObjKey>& result) const
+{
+    REALM_ASSERT(begin <= end && end <= size());
+    result.reserve(result.size() + (end - begin));
+    for (size_t i = begin; i < end; ++i) {
+        result.push_back(ObjKey(m_keys.get(i)));
+    }
+}
+
+void OrderedIndex::insert(ObjKey key, Mixed value)
+{
+    size_t ndx = find_position(value, key);
+    m_values.insert(ndx, value); // Throws
+    m_keys.insert(ndx, key.value); // Throws
+}
+
+void OrderedIndex::set(ObjKey key, Mixed new_value)
+{
+    Mixed old_value = m_target_column.get_value(key);
+    if (old_value.compare(new_value) == 0)
+        return;
+
+    size_t ndx = find_position(old_value, key);
+    REALM_ASSERT(ndx < size() && m_keys.get(ndx) == key.value);
+    size_t new_ndx = find_position(new_value, key);
+    if (new_ndx == ndx || new_ndx == ndx + 1) {
+        // The entry stays where it is
+        m_values.set(ndx, new_value); // Throws
+        return;
+    }
+    m_values.erase(ndx);
+    m_keys.erase(ndx);
+    if (new_ndx > ndx)
+        --new_ndx;
+    m_values.insert(new_ndx, new_value); // Throws
+    m_keys.insert(new_ndx, key.value);   // Throws
+}
+
+void OrderedIndex::erase(ObjKey key)
+{
+    size_t ndx = find_position(m_target_column.get_value(key), key);
+    REALM_ASSERT(ndx < size() && m_keys.get(ndx) == key.value);
+    m_values.erase(ndx);
+    m_keys.erase(ndx);
+}
+
+void OrderedIndex::clear()
+{
+    m_values.clear();
+    m_keys.clear();
+}
+
+void OrderedIndex::populate()
+{
+    REALM_ASSERT(is_empty());
+    size_t size = m_target_column.size();
+    if (size == 0)
+        return;
+
+    // Large columns are read in chunks on several threads
+    std::vector<Entry> entries(size);
+    ColKey col_key = m_target_column.get_column_key();
+    constexpr size_t chunk_size = 0x10000;
+    auto& pool = ThreadPool::get_default();
+    pool.run((size + chunk_size - 1) / chunk_size, [&](size_t chunk) {
+        size_t begin = chunk * chunk_size;
+        size_t end = std::min(begin + chunk_size, size);
+        auto it = m_target_column.begin();
+        it += begin;
+        for (size_t i = begin; i < end; ++i, ++it) {
+            entries[i].value = it->get_any(col_key);
+            entries[i].key = it->get_key();
+        }
+    });
+    parallel_sort(pool, entries.begin(), entries.end(), std::less<>());
+
+    for (auto& entry : entries) {
+        m_values.add(entry.value);   // Throws
+        m_keys.add(entry.key.value); // Throws
+    }
+}
+
+void OrderedIndex::verify() const
+{
+    m_values.verify();
+    m_keys.verify();
+    REALM_ASSERT(m_values.size() == m_keys.size());
+    REALM_ASSERT(m_values.size() == m_target_column.size());
+    for (size_t i = 0; i < size(); ++i) {
+        ObjKey key(m_keys.get(i));
+        Mixed value = m_values.get(i);
+        REALM_ASSERT(m_target_column.get_value(key).compare(value) == 0);
+        if (i > 0) {
+            Entry prev{m_values.get(i - 1), ObjKey(m_keys.get(i - 1))};
+            Entry entry{value, key};
+            REALM_ASSERT(prev < entry);
+        }
+    }
+}
@@ -0,0 +1,131 @@
+/*************************************************************************
+ *
+ * Copyright 2022 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_INDEX_ORDERED_HPP
+#define REALM_INDEX_ORDERED_HPP
+
+#include <realm/array_integer.hpp>
+#include <realm/array_mixed.hpp>
+#include <realm/bplustree.hpp>
+#include <realm/index_string.hpp>
+
+#include <vector>
+
+namespace realm {
+
+/// A secondary index which keeps the objects of a table sorted by the value of
+/// one column. Unlike StringIndex, which only answers equality lookups, the
+/// ordered index supports range lookups and iteration in value order.
+///
+/// The entries are stored in two B+trees of equal size, one holding the values
+/// and one holding the object keys. They are ordered by value and then by
+/// object key, with null before all other values. The top array of the index
+/// holds the refs of the two trees followed by the key of the indexed column.
+///
+/// Only integer and timestamp columns can have an ordered index.
+class OrderedIndex {
+public:
+    OrderedIndex(const ClusterColumn& target_column, Allocator&);
+    OrderedIndex(ref_type, ArrayParent*, size_t ndx_in_parent, const ClusterColumn& target_column, Allocator&);
+
+    static bool type_supported(DataType type)
+    {
+        return type == type_Int || type == type_Timestamp;
+    }
+
+    /// The key of the column indexed by the index with the specified top ref.
+    static ColKey get_column_key(ref_type ref, Allocator&) noexcept;
+
+    ColKey get_column_key() const noexcept
+    {
+        return m_target_column.get_column_key();
+    }
+
+    // Accessor concept:
+    void destroy() noexcept;
+    void set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept;
+    size_t get_ndx_in_parent() const noexcept;
+    void set_ndx_in_parent(size_t ndx_in_parent) noexcept;
+    void update_from_parent() noexcept;
+    void refresh_accessor_tree(const ClusterColumn& target_column);
+    ref_type get_ref() const noexcept;
+
+    // OrderedIndex interface:
+
+    size_t size() const noexcept
+    {
+        return m_keys.size();
+    }
+    bool is_empty() const noexcept
+    {
+        return m_keys.is_empty();
+    }
+
+    /// The value and object key of the entry at the specified position.
+    Mixed get_value(size_t ndx) const
+    {
+        return m_values.get(ndx);
+    }
+    ObjKey get_key(size_t ndx) const
+    {
+        return ObjKey(m_keys.get(ndx));
+    }
+
+    void insert(ObjKey key, Mixed value);
+    /// Must be called before the value in the target column is changed.
+    void set(ObjKey key, Mixed new_value);
+    /// Must be called before the object is removed from the target column.
+    void erase(ObjKey key);
+    void clear();
+
+    /// Insert every object of the target column into this index, which must
+    /// be empty. The entries are sorted up front and appended in order.
+    void populate();
+
+    /// The position of the first entry whose value is not less than (for
+    /// lower_bound()) or greater than (for upper_bound()) `value`. Null is less
+    /// than every other value, so upper_bound(Mixed()) is the position of the
+    /// first non-null entry.
+    size_t lower_bound(Mixed value) const;
+    size_t upper_bound(Mixed value) const;
+
+    /// Append the keys of the entries in the position range [begin, end) to
+    /// `result`, in value order.
+    void get_keys(size_t begin, size_t end, std::vector<ObjKey>& result) const;
+
+    void verify() const;
+
+private:
+    Array m_top;
+    BPlusTree<Mixed> m_values;
+    BPlusTree<int64_t> m_keys;
+    ClusterColumn m_target_column;
+
+    static constexpr size_t s_values_ndx = 0;
+    static constexpr size_t s_keys_ndx = 1;
+    static constexpr size_t s_col_key_ndx = 2;
+
+    void init_trees();
+    /// The position of the entry for (`value`, `key`), or of the first entry
+    /// ordered after it if there is no such entry.
+    size_t find_position(Mixed value, ObjKey key) const;
+};
+
+} // namespace realm
+
+#endif // REALM_INDEX_ORDERED_HPP
@@ -29,6 +29,7 @@
 #include <realm/timestamp.hpp>
 #include <realm/column_integer.hpp>
 #include <realm/unicode.hpp>
+#include <realm/util/thread_pool.hpp>
 
 using namespace realm;
 using namespace realm::util;
@@ -1219,6 +1220,141 @@ void StringIndex::erase(ObjKey key)
 
 namespace {
 
+// The order of the values in a list of rows, see SortedListComparator
+bool list_order_less(const Mixed& a, const Mixed& b)
+{
+    if (a.is_null() || b.is_null())
+        return a.is_null() && !b.is_null();
+    if (a == b)
+        return false;
+    return a.compare_signed(b) < 0;
+}
+
+} // anonymous namespace
+
+bool StringIndex::BulkEntry::operator<(const BulkEntry& other) const
+{
+    if (key != other.key)
+        return key < other.key;
+    return obj_key < other.obj_key;
+}
+
+void StringIndex::populate()
+{
+    REALM_ASSERT(is_empty());
+    size_t size = m_target_column.size();
+    if (size == 0)
+        return;
+
+    // Large columns are read in chunks on several threads
+    std::vector<BulkEntry> entries(size);
+    ColKey col_key = m_target_column.get_column_key();
+    constexpr size_t chunk_size = 0x10000;
+    auto& pool = ThreadPool::get_default();
+    pool.run((size + chunk_size - 1) / chunk_size, [&](size_t chunk) {
+        size_t begin = chunk * chunk_size;
+        size_t end = std::min(begin + chunk_size, size);
+        StringConversionBuffer buffer;
+        auto it = m_target_column.begin();
+        it += begin;
+        for (size_t i = begin; i < end; ++i, ++it) {
+            BulkEntry& entry = entries[i];
+            entry.value = it->get_any(col_key);
+            entry.obj_key = it->get_key();
+            entry.key = create_key(entry.value.get_index_data(buffer), 0);
+        }
+    });
+    parallel_sort(pool, entries.begin(), entries.end(), std::less<>());
+
+    ref_type ref = build_subindex(entries.data(), entries.data() + size, 0);
+    m_array->destroy_deep();
+    m_array->init_from_ref(ref);
+    m_array->update_parent();
+}
+
+// Build the (sub)index for the entries in [begin, end), which must be sorted by
+// their key at `offset`.
+ref_type StringIndex::build_subindex(BulkEntry* begin, BulkEntry* end, size_t offset)
+{
+    Allocator& alloc = m_array->get_alloc();
+    std::vector<std::pair<key_type, int64_t>> slots;
+    StringConversionBuffer buffer_1;
+    StringConversionBuffer buffer_2;
+    for (BulkEntry* group = begin; group != end;) {
+        key_type key = group->key;
+        BulkEntry* group_end = std::find_if(group + 1, end, [key](const BulkEntry& entry) {
+            return entry.key != key;
+        });
+        if (group_end - group == 1) {
+            slots.emplace_back(key, int64_t((uint64_t(group->obj_key.value) << 1) + 1)); // shift to indicate literal
+            group = group_end;
+            continue;
+        }
+
+        // As in leaf_insert(), entries which cannot be told apart by extending
+        // the key share a list ordered by value and then object key. Any
+        // other group gets a subindex on the next part of the key.
+        size_t suboffset = offset + s_index_key_length;
+        StringData index_data = group->value.get_index_data(buffer_1);
+        bool use_list = suboffset > s_max_offset || std::all_of(group + 1, group_end, [&](const BulkEntry& entry) {
+                            return entry.value.get_index_data(buffer_2) == index_data;
+                        });
+        if (use_list) {
+            // The group is ordered by object key, which is all that is needed
+            // if the values are duplicates
+            if (std::any_of(group + 1, group_end, [&](const BulkEntry& entry) {
+                    return entry.value != group->value;
+                })) {
+                std::stable_sort(group, group_end, [](const BulkEntry& a, const BulkEntry& b) {
+                    return list_order_less(a.value, b.value);
+                });
+            }
+            IntegerColumn list(alloc);
+            list.create(); // Throws
+            for (BulkEntry* entry = group; entry != group_end; ++entry)
+                list.add(entry->obj_key.value); // Throws
+            slots.emplace_back(key, int64_t(list.get_ref()));
+        }
+        else {
+            for (BulkEntry* entry = group; entry != group_end; ++entry)
+                entry->key = create_key(entry->value.get_index_data(buffer_2), suboffset);
+            std::sort(group, group_end);
+            slots.emplace_back(key, int64_t(build_subindex(group, group_end, suboffset))); // Throws
+        }
+        group = group_end;
+    }
+    return build_nodes(alloc, slots);
+}
+
+// Write the (key, child) pairs in `slots`, which must be sorted by key, into
+// full leaves, and add levels of inner nodes on top until there is one root.
+ref_type StringIndex::build_nodes(Allocator& alloc, std::vector<std::pair<key_type, int64_t>>& slots)
+{
+    REALM_ASSERT(!slots.empty());
+    bool is_leaf = true;
+    for (;;) {
+        std::vector<std::pair<key_type, int64_t>> nodes;
+        for (size_t begin = 0; begin < slots.size(); begin += REALM_MAX_BPNODE_SIZE) {
+            size_t end = std::min(begin + REALM_MAX_BPNODE_SIZE, slots.size());
+            std::unique_ptr<IndexArray> node(create_node(alloc, is_leaf)); // Throws
+            Array keys(alloc);
+            get_child(*node, 0, keys);
+            for (size_t i = begin; i < end; ++i) {
+                keys.add(slots[i].first); // Throws
+                node->add(slots[i].second); // Throws
+            }
+            // Inner nodes are keyed by the last key of each child
+            nodes.emplace_back(slots[end - 1].first, int64_t(node->get_ref()));
+        }
+        if (nodes.size() == 1)
+            return ref_type(nodes[0].second);
+        slots = std::move(nodes);
+        is_leaf = false;
+    }
+}
+
+namespace {
+
 bool has_duplicate_values(const Array& node, const ClusterColumn& target_col) noexcept
 {
     Allocator& alloc = node.get_alloc();
@@ -199,6 +199,12 @@ public:
 
     void erase(ObjKey key);
 
+    /// Insert every object of the target column into this index, which must
+    /// be empty. Instead of descending the tree once per object, all entries
+    /// are sorted by key and the nodes are then written bottom-up, one level at
+    /// a time.
+    void populate();
+
     template <class T>
     ObjKey find_first(T value) const;
     template <class T>
@@ -301,6 +307,16 @@ private:
 
     void node_add_key(ref_type ref);
 
+    // Bulk construction, see populate()
+    struct BulkEntry {
+        Mixed value;
+        ObjKey obj_key;
+        key_type key;
+        bool operator<(const BulkEntry&) const;
+    };
+    ref_type build_subindex(BulkEntry* begin, BulkEntry* end, size_t offset);
+    static ref_type build_nodes(Allocator&, std::vector<std::pair<key_type, int64_t>>& slots);
+
 #ifdef REALM_DEBUG
     static void dump_node_structure(const Array& node, std::ostream&, int level);
 #endif
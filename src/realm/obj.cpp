@@ -1388,6 +1388,10 @@ Obj& Obj::set<int64_t>(ColKey col_key, int64_t value, bool is_default)
     if (index && !m_key.is_unresolved()) {
         index->set<int64_t>(m_key, value);
     }
+    OrderedIndex* ordered_index = m_table->get_ordered_index(col_key);
+    if (ordered_index && !m_key.is_unresolved()) {
+        ordered_index->set(m_key, value);
+    }
 
     Allocator& alloc = get_alloc();
     alloc.bump_content_version();
@@ -1467,6 +1471,9 @@ Obj& Obj::add_int(ColKey col_key, int64_t value)
                 if (StringIndex* index = m_table->get_search_index(col_key)) {
                     index->set<int64_t>(m_key, new_val);
                 }
+                if (OrderedIndex* index = m_table->get_ordered_index(col_key)) {
+                    index->set(m_key, new_val);
+                }
                 values.set(m_row_ndx, new_val);
             }
             else {
@@ -1482,6 +1489,9 @@ Obj& Obj::add_int(ColKey col_key, int64_t value)
             if (StringIndex* index = m_table->get_search_index(col_key)) {
                 index->set<int64_t>(m_key, new_val);
             }
+            if (OrderedIndex* index = m_table->get_ordered_index(col_key)) {
+                index->set(m_key, new_val);
+            }
             values.set(m_row_ndx, new_val);
         }
     }
@@ -1709,6 +1719,14 @@ Obj& Obj::set(ColKey col_key, T value, bool is_default)
     if (index && !m_key.is_unresolved()) {
         index->set<T>(m_key, value);
     }
+    OrderedIndex* ordered_index = m_table->get_ordered_index(col_key);
+    if (ordered_index && !m_key.is_unresolved()) {
+        ordered_index->set(m_key, Mixed(value));
+    }
+    FullTextIndex* fulltext_index = m_table->get_fulltext_index(col_key);
+    if (fulltext_index && !m_key.is_unresolved()) {
+        fulltext_index->set(m_key, Mixed(value));
+    }
 
     Allocator& alloc = get_alloc();
     alloc.bump_content_version();
@@ -2321,6 +2339,14 @@ Obj& Obj::set_null(ColKey col_key, bool is_default)
         if (index && !m_key.is_unresolved()) {
             index->set(m_key, null{});
         }
+        OrderedIndex* ordered_index = m_table->get_ordered_index(col_key);
+        if (ordered_index && !m_key.is_unresolved()) {
+            ordered_index->set(m_key, Mixed());
+        }
+        FullTextIndex* fulltext_index = m_table->get_fulltext_index(col_key);
+        if (fulltext_index && !m_key.is_unresolved()) {
+            fulltext_index->set(m_key, Mixed());
+        }
 
         switch (col_type) {
             case col_type_Int:
@@ -63,6 +63,7 @@ static std::map<int, std::string> opstr = {
     {CompareNode::CONTAINS, "contains"},
     {CompareNode::LIKE, "like"},
     {CompareNode::IN, "in"},
+    {CompareNode::TEXT, "text"},
 };
 
 std::string print_pretty_objlink(const ObjLink& link, const Group* g, ParserDriver* drv)
@@ -634,6 +635,17 @@ Query StringOpsNode::visit(ParserDriver* drv)
 
     verify_only_string_types(right_type, opstr[op]);
 
+    if (op == CompareNode::TEXT) {
+        // Full-text search is only done on plain string columns of the table
+        if (!prop || prop->links_exist() || left_type != type_String || prop->column_key().is_collection() ||
+            right_type != type_String || !right->has_single_value()) {
+            throw InvalidQueryError(
+                "Operator 'TEXT' requires a string property of the queried object on the left and a string constant "
+                "on the right");
+        }
+        return drv->m_base_table->where().fulltext(prop->column_key(), right->get_mixed().get_string());
+    }
+
     if (prop && !prop->links_exist() && right->has_single_value() &&
         (left_type == right_type || left_type == type_Mixed)) {
         auto col_key = prop->column_key();
@@ -1564,6 +1576,16 @@ std::string check_escapes(const char* str)
     return ret + std::string(str);
 }
 
+bool is_text_operator(const char* str)
+{
+    const char* keyword = "text";
+    for (; *keyword; ++str, ++keyword) {
+        if (*str != *keyword && *str != *keyword - 'a' + 'A')
+            return false;
+    }
+    return *str == 0;
+}
+
 } // namespace query_parser
 
 Query Table::query(const std::string& query_string, const std::vector<std::vector<Mixed>>& arguments) const
@@ -110,6 +110,7 @@ public:
     static constexpr int CONTAINS = 8;
     static constexpr int LIKE = 9;
     static constexpr int IN = 10;
+    static constexpr int TEXT = 11;
 };
 
 class ConstantNode : public ParserNode {
@@ -590,6 +591,7 @@ Query ParserDriver::simple_query(int op, ColKey col_key, T val)
 }
 
 std::string check_escapes(const char* str);
+bool is_text_operator(const char* str);
 
 } // namespace query_parser
 } // namespace realm
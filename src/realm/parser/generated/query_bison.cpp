@@ -286,6 +286,7 @@ namespace yy {
       case symbol_kind::SYM_ENDSWITH: // "endswith"
       case symbol_kind::SYM_CONTAINS: // "contains"
       case symbol_kind::SYM_LIKE: // "like"
+      case symbol_kind::SYM_TEXT: // "text"
       case symbol_kind::SYM_BETWEEN: // "between"
       case symbol_kind::SYM_IN: // "in"
       case symbol_kind::SYM_OBJ: // "obj"
@@ -409,6 +410,7 @@ namespace yy {
       case symbol_kind::SYM_ENDSWITH: // "endswith"
       case symbol_kind::SYM_CONTAINS: // "contains"
       case symbol_kind::SYM_LIKE: // "like"
+      case symbol_kind::SYM_TEXT: // "text"
       case symbol_kind::SYM_BETWEEN: // "between"
       case symbol_kind::SYM_IN: // "in"
       case symbol_kind::SYM_OBJ: // "obj"
@@ -532,6 +534,7 @@ namespace yy {
       case symbol_kind::SYM_ENDSWITH: // "endswith"
       case symbol_kind::SYM_CONTAINS: // "contains"
       case symbol_kind::SYM_LIKE: // "like"
+      case symbol_kind::SYM_TEXT: // "text"
       case symbol_kind::SYM_BETWEEN: // "between"
       case symbol_kind::SYM_IN: // "in"
       case symbol_kind::SYM_OBJ: // "obj"
@@ -653,6 +656,7 @@ namespace yy {
       case symbol_kind::SYM_ENDSWITH: // "endswith"
       case symbol_kind::SYM_CONTAINS: // "contains"
       case symbol_kind::SYM_LIKE: // "like"
+      case symbol_kind::SYM_TEXT: // "text"
       case symbol_kind::SYM_BETWEEN: // "between"
       case symbol_kind::SYM_IN: // "in"
       case symbol_kind::SYM_OBJ: // "obj"
@@ -875,6 +879,10 @@ namespace yy {
                  { yyo << yysym.value.template as < std::string > (); }
         break;
 
+      case symbol_kind::SYM_TEXT: // "text"
+                 { yyo << yysym.value.template as < std::string > (); }
+        break;
+
       case symbol_kind::SYM_BETWEEN: // "between"
                  { yyo << yysym.value.template as < std::string > (); }
         break;
@@ -919,51 +927,51 @@ namespace yy {
                  { yyo << yysym.value.template as < std::string > (); }
         break;
 
-      case symbol_kind::SYM_56_: // '+'
+      case symbol_kind::SYM_57_: // '+'
                  { yyo << "<>"; }
         break;
 
-      case symbol_kind::SYM_57_: // '-'
+      case symbol_kind::SYM_58_: // '-'
                  { yyo << "<>"; }
         break;
 
-      case symbol_kind::SYM_58_: // '*'
+      case symbol_kind::SYM_59_: // '*'
                  { yyo << "<>"; }
         break;
 
-      case symbol_kind::SYM_59_: // '/'
+      case symbol_kind::SYM_60_: // '/'
                  { yyo << "<>"; }
         break;
 
-      case symbol_kind::SYM_60_: // '('
+      case symbol_kind::SYM_61_: // '('
                  { yyo << "<>"; }
         break;
 
-      case symbol_kind::SYM_61_: // ')'
+      case symbol_kind::SYM_62_: // ')'
                  { yyo << "<>"; }
         break;
 
-      case symbol_kind::SYM_62_: // '['
+      case symbol_kind::SYM_63_: // '['
                  { yyo << "<>"; }
         break;
 
-      case symbol_kind::SYM_63_: // ']'
+      case symbol_kind::SYM_64_: // ']'
                  { yyo << "<>"; }
         break;
 
-      case symbol_kind::SYM_64_: // '.'
+      case symbol_kind::SYM_65_: // '.'
                  { yyo << "<>"; }
         break;
 
-      case symbol_kind::SYM_65_: // ','
+      case symbol_kind::SYM_66_: // ','
                  { yyo << "<>"; }
         break;
 
-      case symbol_kind::SYM_66_: // '{'
+      case symbol_kind::SYM_67_: // '{'
                  { yyo << "<>"; }
         break;
 
-      case symbol_kind::SYM_67_: // '}'
+      case symbol_kind::SYM_68_: // '}'
                  { yyo << "<>"; }
         break;
 
@@ -1399,6 +1407,7 @@ namespace yy {
       case symbol_kind::SYM_ENDSWITH: // "endswith"
       case symbol_kind::SYM_CONTAINS: // "contains"
       case symbol_kind::SYM_LIKE: // "like"
+      case symbol_kind::SYM_TEXT: // "text"
       case symbol_kind::SYM_BETWEEN: // "between"
       case symbol_kind::SYM_IN: // "in"
       case symbol_kind::SYM_OBJ: // "obj"
@@ -1805,71 +1814,79 @@ namespace yy {
                                 { yylhs.value.as < int > () = CompareNode::LIKE; }
     break;
 
-  case 93: // path: %empty
+  case 93: // stringop: "text"
+                                { yylhs.value.as < int > () = CompareNode::TEXT; }
+    break;
+
+  case 94: // path: %empty
                                 { yylhs.value.as < PathNode* > () = drv.m_parse_nodes.create<PathNode>(); }
     break;
 
-  case 94: // path: path path_elem
+  case 95: // path: path path_elem
                                 { yystack_[1].value.as < PathNode* > ()->add_element(yystack_[0].value.as < std::string > ()); yylhs.value.as < PathNode* > () = yystack_[1].value.as < PathNode* > (); }
     break;
 
-  case 95: // path_elem: id '.'
+  case 96: // path_elem: id '.'
                                 { yylhs.value.as < std::string > () = yystack_[1].value.as < std::string > (); }
     break;
 
-  case 96: // id: "identifier"
+  case 97: // id: "identifier"
                                 { yylhs.value.as < std::string > () = yystack_[0].value.as < std::string > (); }
     break;
 
-  case 97: // id: "@links" '.' "identifier" '.' "identifier"
+  case 98: // id: "@links" '.' "identifier" '.' "identifier"
                                 { yylhs.value.as < std::string > () = std::string("@links.") + yystack_[2].value.as < std::string > () + "." + yystack_[0].value.as < std::string > (); }
     break;
 
-  case 98: // id: "beginswith"
+  case 99: // id: "beginswith"
                                 { yylhs.value.as < std::string > () = yystack_[0].value.as < std::string > (); }
     break;
 
-  case 99: // id: "endswith"
+  case 100: // id: "endswith"
                                 { yylhs.value.as < std::string > () = yystack_[0].value.as < std::string > (); }
     break;
 
-  case 100: // id: "contains"
+  case 101: // id: "contains"
                                 { yylhs.value.as < std::string > () = yystack_[0].value.as < std::string > (); }
     break;
 
-  case 101: // id: "like"
+  case 102: // id: "like"
                                 { yylhs.value.as < std::string > () = yystack_[0].value.as < std::string > (); }
     break;
 
-  case 102: // id: "between"
+  case 103: // id: "text"
                                 { yylhs.value.as < std::string > () = yystack_[0].value.as < std::string > (); }
     break;
 
-  case 103: // id: "key or value"
+  case 104: // id: "between"
                                 { yylhs.value.as < std::string > () = yystack_[0].value.as < std::string > (); }
     break;
 
-  case 104: // id: "sort"
+  case 105: // id: "key or value"
                                 { yylhs.value.as < std::string > () = yystack_[0].value.as < std::string > (); }
     break;
 
-  case 105: // id: "distinct"
+  case 106: // id: "sort"
                                 { yylhs.value.as < std::string > () = yystack_[0].value.as < std::string > (); }
     break;
 
-  case 106: // id: "limit"
+  case 107: // id: "distinct"
                                 { yylhs.value.as < std::string > () = yystack_[0].value.as < std::string > (); }
     break;
 
-  case 107: // id: "ascending"
+  case 108: // id: "limit"
                                 { yylhs.value.as < std::string > () = yystack_[0].value.as < std::string > (); }
     break;
 
-  case 108: // id: "descending"
+  case 109: // id: "ascending"
                                 { yylhs.value.as < std::string > () = yystack_[0].value.as < std::string > (); }
     break;
 
-  case 109: // id: "in"
+  case 110: // id: "descending"
+                                { yylhs.value.as < std::string > () = yystack_[0].value.as < std::string > (); }
+    break;
+
+  case 111: // id: "in"
                                 { yylhs.value.as < std::string > () = yystack_[0].value.as < std::string > (); }
     break;
 
@@ -2221,174 +2238,180 @@ namespace yy {
   }
 
 
-  const signed char parser::yypact_ninf_ = -83;
+  const signed char parser::yypact_ninf_ = -86;
 
   const signed char parser::yytable_ninf_ = -1;
 
   const short
   parser::yypact_[] =
   {
-     136,   -83,   -83,   -24,   -83,   -83,   -83,   -83,   -83,   -83,
-     136,   -83,   -83,   -83,   -83,   -83,   -83,   -83,   -83,   -83,
-     -83,   -83,   -83,   -83,   -13,   136,   358,    24,   -12,   -83,
-     194,    76,   -83,   -83,   -83,   -83,   -83,   -83,   -29,   380,
-     -83,   -83,    11,   -16,    21,    19,   -83,    14,   -83,   136,
-     136,    23,   -83,   -83,   -83,   -83,   -83,   -83,   -83,   227,
-     227,   227,   227,   182,   227,   -83,   -83,   -83,   -83,     2,
-     273,   -83,   358,   400,    -6,   -83,   -83,   -83,   -83,   -83,
-     -83,   -83,   -83,   -83,   -83,   -83,   -83,   -83,   -83,    64,
-       4,   400,    16,   -83,   -83,   358,   -83,   -83,    31,     6,
-      47,    51,   -83,   -83,   -83,   227,   -30,   -83,   -30,   -83,
-     -83,   227,    75,    75,   -83,    49,   316,   -83,    71,    36,
-      58,   -10,   -83,   358,    70,   -83,   400,    61,    77,   -83,
-     -83,   -83,    97,    40,    75,   -83,   -83,   108,    34,   -83,
-      73,   -83,   -83,    82,   -83,   -83,   -83,   -83,    83,    81,
-     -83,    87,   -19,   400,    -8,   400,    88,   123,    91,   400,
-     136,   -83,   -83,   -83,   -37,   -83,   -83,    61,   -83,   -83,
-      34,   -83,   -83,    -2,   400,   -83,   -83,   -83,   400,    92,
-     -37,    61,   104,   -83,   -83
+     138,   -86,   -86,   -22,   -86,   -86,   -86,   -86,   -86,   -86,
+     138,   -86,   -86,   -86,   -86,   -86,   -86,   -86,   -86,   -86,
+     -86,   -86,   -86,   -86,   -17,   138,   389,    48,     5,   -86,
+      22,    57,   -86,   -86,   -86,   -86,   -86,   -86,   -29,   411,
+     -86,   -86,    25,   -16,   354,   -10,   -86,    19,   -86,   138,
+     138,   -37,   -86,   -86,   -86,   -86,   -86,   -86,   -86,   231,
+     231,   231,   231,   185,   231,   -86,   -86,   -86,   -86,   -86,
+       3,   278,   -86,   389,   432,     9,   -86,   -86,   -86,   -86,
+     -86,   -86,   -86,   -86,   -86,   -86,   -86,   -86,   -86,   -86,
+     -86,   -18,     2,   432,    11,   -86,   -86,   389,   -86,   -86,
+      59,    27,    34,    49,   -86,   -86,   -86,   231,     7,   -86,
+       7,   -86,   -86,   231,    76,    76,   -86,    46,   322,   -86,
+      21,    52,    58,   -12,   -86,   389,    71,   -86,   432,    65,
+      79,   -86,   -86,   -86,    99,    62,    76,   -86,   -86,   110,
+      73,   -86,    74,   -86,   -86,    83,   -86,   -86,   -86,   -86,
+      75,    72,   -86,    86,   -39,   432,   -38,   432,    87,   123,
+      92,   432,   138,   -86,   -86,   -86,    20,   -86,   -86,    65,
+     -86,   -86,    73,   -86,   -86,    -7,   432,   -86,   -86,   -86,
+     432,    93,    20,    65,    97,   -86,   -86
   };
 
   const signed char
   parser::yydefact_[] =
   {
-      93,    70,    71,     0,    59,    60,    61,    72,    73,    74,
-      93,    67,    54,    52,    53,    65,    66,    55,    56,    68,
-      69,    57,    58,    62,     0,    93,    49,     0,    33,     3,
-       0,    15,    22,    30,    23,    21,    51,     8,    93,     0,
-      93,     6,     0,     0,     0,     0,    48,     0,     1,    93,
-      93,     2,    82,    83,    85,    87,    88,    86,    84,    93,
-      93,    93,    93,    93,    93,    89,    90,    91,    92,     0,
-      93,    63,    49,     0,    75,    96,    98,    99,   100,   101,
-     102,   109,   104,   105,   106,   107,   108,   103,    94,    75,
-       0,     0,     0,     7,    16,     0,    46,     5,     4,     0,
-       0,     0,    35,    34,    36,    93,    19,    15,    20,    17,
-      18,    93,     9,    11,    14,     0,    93,    12,     0,     0,
-      75,     0,    27,     0,    95,    24,     0,    31,     0,    50,
-      93,    93,     0,     0,    10,    13,    47,     0,    95,    26,
-       0,    76,    77,     0,    78,    79,    80,    81,    29,     0,
-      95,     0,     0,     0,     0,     0,     0,     0,    75,     0,
-      93,    64,    40,    93,     0,    37,    93,    38,    43,    97,
-       0,    25,    28,     0,     0,    44,    45,    41,     0,     0,
-       0,    39,     0,    42,    32
+      94,    70,    71,     0,    59,    60,    61,    72,    73,    74,
+      94,    67,    54,    52,    53,    65,    66,    55,    56,    68,
+      69,    57,    58,    62,     0,    94,    49,     0,    33,     3,
+       0,    15,    22,    30,    23,    21,    51,     8,    94,     0,
+      94,     6,     0,     0,     0,     0,    48,     0,     1,    94,
+      94,     2,    82,    83,    85,    87,    88,    86,    84,    94,
+      94,    94,    94,    94,    94,    89,    90,    91,    92,    93,
+       0,    94,    63,    49,     0,    75,    97,    99,   100,   101,
+     102,   103,   104,   111,   106,   107,   108,   109,   110,   105,
+      95,    75,     0,     0,     0,     7,    16,     0,    46,     5,
+       4,     0,     0,     0,    35,    34,    36,    94,    19,    15,
+      20,    17,    18,    94,     9,    11,    14,     0,    94,    12,
+       0,     0,    75,     0,    27,     0,    96,    24,     0,    31,
+       0,    50,    94,    94,     0,     0,    10,    13,    47,     0,
+      96,    26,     0,    76,    77,     0,    78,    79,    80,    81,
+      29,     0,    96,     0,     0,     0,     0,     0,     0,     0,
+      75,     0,    94,    64,    40,    94,     0,    37,    94,    38,
+      43,    98,     0,    25,    28,     0,     0,    44,    45,    41,
+       0,     0,     0,    39,     0,    42,    32
   };
 
   const signed char
   parser::yypgoto_[] =
   {
-     -83,   -83,    -9,   -83,     1,     0,   -83,   -83,   -83,   -83,
-     -83,   -83,   -83,   -83,   -83,   -22,    90,    89,   -20,    35,
-     -83,   -21,   -82,   -83,   -83,   -83,   -83,   -36,   -83,   -70
+     -86,   -86,    -9,   -86,     1,     0,   -86,   -86,   -86,   -86,
+     -86,   -86,   -86,   -86,   -86,   -30,    89,    88,   -21,    30,
+     -86,   -19,   -85,   -86,   -86,   -86,   -86,   -36,   -86,   -71
   };
 
   const unsigned char
   parser::yydefgoto_[] =
   {
-       0,    27,    28,    29,    30,   107,    32,    90,    33,    51,
-     102,   154,   103,   152,   104,   177,    34,    45,    35,    36,
-      37,    38,   122,   148,    63,    64,    70,    39,    88,    89
+       0,    27,    28,    29,    30,   109,    32,    92,    33,    51,
+     104,   156,   105,   154,   106,   179,    34,    45,    35,    36,
+      37,    38,   124,   150,    63,    64,    71,    39,    90,    91
   };
 
   const unsigned char
   parser::yytable_[] =
   {
-      31,    41,    73,   120,    91,    47,    46,   125,    49,    50,
-      31,    71,    49,    50,   175,   176,    43,   140,     7,     8,
-       9,   127,    49,    50,    48,    31,    44,   150,    61,    62,
-      52,    53,    54,    55,    56,    57,    40,    72,   139,    92,
-      97,    98,   162,   141,   142,    93,   163,    42,   115,    31,
-      31,    47,    46,   165,    71,    49,   149,   166,   121,   179,
-     106,   108,   109,   110,   112,   113,   130,    58,    26,   126,
-     117,    99,   100,   101,    47,   129,   171,    59,    60,    61,
-      62,   128,    94,   164,    95,   167,    96,   141,   142,   172,
-     144,   145,   146,   147,   153,   155,    59,    60,    61,    62,
-     137,    94,    47,   143,   180,    11,   133,   131,   181,    15,
-      16,   132,   134,    19,    20,    72,   135,    65,    66,    67,
-      68,    69,   138,   141,   142,   150,   123,   174,   124,   156,
-     178,    59,    60,    61,    62,   140,    95,   157,   136,     1,
-       2,     3,     4,     5,     6,   158,   160,   159,   161,   168,
-     169,   173,     7,     8,     9,   170,   182,   184,   183,   114,
-      31,   118,    10,   151,    11,    12,    13,    14,    15,    16,
-      17,    18,    19,    20,    21,    22,    23,     0,     0,     0,
-       0,     0,     0,    24,     0,     0,     0,     3,     4,     5,
-       6,     0,     0,     0,     0,     0,    25,   111,     7,     8,
-       9,     0,    26,    52,    53,    54,    55,    56,    57,     0,
+      31,    41,    74,   122,    93,    46,   127,    47,    49,    50,
+      31,    72,   101,   102,   103,   142,    43,    49,    50,     7,
+       8,     9,   129,   164,   167,    31,    44,   165,   168,    49,
+      50,    52,    53,    54,    55,    56,    57,   141,    73,    40,
+      99,   100,   143,   144,    42,   125,    95,   126,    48,    31,
+      31,   117,    46,    94,    47,   181,    97,   151,    98,    72,
+     108,   110,   111,   112,   114,   115,    61,    62,   128,    58,
+      26,   119,   177,   178,   123,   173,   131,   130,    47,    59,
+      60,    61,    62,    49,   166,   152,   169,    97,   132,   138,
+     174,   146,   147,   148,   149,   133,   155,   157,    65,    66,
+      67,    68,    69,    70,   145,   182,    47,    11,   135,   183,
+     134,    15,    16,    73,   136,    19,    20,   139,   137,    59,
+      60,    61,    62,   140,    96,   143,   144,   143,   144,   176,
+     152,   158,   180,    59,    60,    61,    62,   142,   162,   159,
+     161,     1,     2,     3,     4,     5,     6,   160,   163,   170,
+     171,   186,   185,   175,     7,     8,     9,   172,   184,   116,
+     153,   120,    31,     0,    10,     0,    11,    12,    13,    14,
+      15,    16,    17,    18,    19,    20,    21,    22,    23,     0,
+       0,     0,     0,     0,     0,     0,    24,     0,     0,     0,
+       3,     4,     5,     6,     0,     0,     0,     0,     0,    25,
+     113,     7,     8,     9,     0,    26,     0,     0,     0,     0,
+       0,     0,     0,    11,    12,    13,    14,    15,    16,    17,
+      18,    19,    20,    21,    22,    23,     0,     0,     0,     0,
+       0,     0,     0,    24,     0,     0,     3,     4,     5,     6,
+       0,     0,     0,     0,     0,     0,   107,     7,     8,     9,
+       0,     0,    26,     0,     0,     0,     0,     0,     0,    11,
+      12,    13,    14,    15,    16,    17,    18,    19,    20,    21,
+      22,    23,     0,     0,     0,     0,     0,     0,     0,    24,
+       0,     0,     0,     3,     4,     5,     6,     0,     0,     0,
+       0,     0,   107,   118,     7,     8,     9,     0,    26,     0,
+       0,     0,     0,     0,     0,     0,    11,    12,    13,    14,
+      15,    16,    17,    18,    19,    20,    21,    22,    23,     0,
+       0,     0,     0,     0,     0,     0,    24,     3,     4,     5,
+       6,     0,     0,     0,     0,     0,     0,     0,     7,     8,
+       9,     0,     0,     0,     0,    26,     0,     0,     0,     0,
       11,    12,    13,    14,    15,    16,    17,    18,    19,    20,
-      21,    22,    23,     0,     0,     0,     0,     0,     0,    24,
-       0,     0,     3,     4,     5,     6,     0,     0,     0,     0,
-      58,     0,   105,     7,     8,     9,     0,     0,    26,     0,
-      59,    60,    61,    62,     0,    11,    12,    13,    14,    15,
-      16,    17,    18,    19,    20,    21,    22,    23,     0,     0,
-       0,     0,     0,     0,    24,     0,     0,     0,     3,     4,
-       5,     6,     0,     0,     0,     0,     0,   105,   116,     7,
-       8,     9,     0,    26,     0,     0,     0,     0,     0,     0,
-       0,    11,    12,    13,    14,    15,    16,    17,    18,    19,
-      20,    21,    22,    23,     0,     0,     0,     0,     0,     0,
-      24,     3,     4,     5,     6,     0,     0,     0,     0,     0,
-       0,     0,     7,     8,     9,     0,     0,     0,     0,    26,
-       0,     0,     0,     0,    11,    12,    13,    14,    15,    16,
-      17,    18,    19,    20,    21,    22,    23,     0,     0,     0,
-       0,     0,     0,    24,     4,     5,     6,     0,     0,     0,
-       0,     0,     0,     0,     7,     8,     9,     0,     0,     0,
-       0,     0,    26,     0,     0,     0,    11,    12,    13,    14,
-      15,    16,    17,    18,    19,    20,    21,    22,    23,    74,
-       0,     0,     0,     0,     0,    24,     0,    75,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,   119,
-       0,    76,    77,    78,    79,    80,    81,    75,    82,    83,
-      84,    85,    86,     0,     0,    87,     0,     0,     0,     0,
-       0,    76,    77,    78,    79,    80,    81,     0,    82,    83,
-      84,    85,    86,     0,     0,    87
+      21,    22,    23,    52,    53,    54,    55,    56,    57,     0,
+      24,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,    26,
+       0,     0,     0,     0,     0,     4,     5,     6,     0,     0,
+       0,    58,     0,     0,     0,     7,     8,     9,     0,     0,
+       0,    59,    60,    61,    62,     0,    96,    11,    12,    13,
+      14,    15,    16,    17,    18,    19,    20,    21,    22,    23,
+      75,     0,     0,     0,     0,     0,     0,    24,    76,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,   121,    77,    78,    79,    80,    81,    82,    83,    76,
+      84,    85,    86,    87,    88,     0,     0,    89,     0,     0,
+       0,     0,     0,    77,    78,    79,    80,    81,    82,    83,
+       0,    84,    85,    86,    87,    88,     0,     0,    89
   };
 
   const short
   parser::yycheck_[] =
   {
-       0,    10,    38,    73,    40,    26,    26,    89,    24,    25,
-      10,    40,    24,    25,    51,    52,    25,    27,    16,    17,
-      18,    91,    24,    25,     0,    25,    25,    64,    58,    59,
-       9,    10,    11,    12,    13,    14,    60,    66,   120,    28,
-      49,    50,    61,    53,    54,    61,    65,    60,    69,    49,
-      50,    72,    72,    61,    40,    24,   126,    65,    64,    61,
-      59,    60,    61,    62,    63,    64,    60,    46,    66,    65,
-      70,    48,    49,    50,    95,    95,   158,    56,    57,    58,
-      59,    65,    61,   153,    65,   155,    67,    53,    54,   159,
-      20,    21,    22,    23,   130,   131,    56,    57,    58,    59,
-      64,    61,   123,   123,   174,    28,   105,    60,   178,    32,
-      33,    60,   111,    36,    37,    66,   116,    41,    42,    43,
-      44,    45,    64,    53,    54,    64,    62,   163,    64,    32,
-     166,    56,    57,    58,    59,    27,    65,    64,    67,     3,
-       4,     5,     6,     7,     8,    63,    65,    64,    61,    61,
-      27,   160,    16,    17,    18,    64,    64,    53,   180,    69,
-     160,    72,    26,   128,    28,    29,    30,    31,    32,    33,
-      34,    35,    36,    37,    38,    39,    40,    -1,    -1,    -1,
-      -1,    -1,    -1,    47,    -1,    -1,    -1,     5,     6,     7,
-       8,    -1,    -1,    -1,    -1,    -1,    60,    15,    16,    17,
-      18,    -1,    66,     9,    10,    11,    12,    13,    14,    -1,
+       0,    10,    38,    74,    40,    26,    91,    26,    24,    25,
+      10,    40,    49,    50,    51,    27,    25,    24,    25,    16,
+      17,    18,    93,    62,    62,    25,    25,    66,    66,    24,
+      25,     9,    10,    11,    12,    13,    14,   122,    67,    61,
+      49,    50,    54,    55,    61,    63,    62,    65,     0,    49,
+      50,    70,    73,    28,    73,    62,    66,   128,    68,    40,
+      59,    60,    61,    62,    63,    64,    59,    60,    66,    47,
+      67,    71,    52,    53,    65,   160,    97,    66,    97,    57,
+      58,    59,    60,    24,   155,    65,   157,    66,    61,    68,
+     161,    20,    21,    22,    23,    61,   132,   133,    41,    42,
+      43,    44,    45,    46,   125,   176,   125,    28,   107,   180,
+      61,    32,    33,    67,   113,    36,    37,    65,   118,    57,
+      58,    59,    60,    65,    62,    54,    55,    54,    55,   165,
+      65,    32,   168,    57,    58,    59,    60,    27,    66,    65,
+      65,     3,     4,     5,     6,     7,     8,    64,    62,    62,
+      27,    54,   182,   162,    16,    17,    18,    65,    65,    70,
+     130,    73,   162,    -1,    26,    -1,    28,    29,    30,    31,
+      32,    33,    34,    35,    36,    37,    38,    39,    40,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    48,    -1,    -1,    -1,
+       5,     6,     7,     8,    -1,    -1,    -1,    -1,    -1,    61,
+      15,    16,    17,    18,    -1,    67,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    28,    29,    30,    31,    32,    33,    34,
+      35,    36,    37,    38,    39,    40,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    48,    -1,    -1,     5,     6,     7,     8,
+      -1,    -1,    -1,    -1,    -1,    -1,    61,    16,    17,    18,
+      -1,    -1,    67,    -1,    -1,    -1,    -1,    -1,    -1,    28,
+      29,    30,    31,    32,    33,    34,    35,    36,    37,    38,
+      39,    40,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    48,
+      -1,    -1,    -1,     5,     6,     7,     8,    -1,    -1,    -1,
+      -1,    -1,    61,    15,    16,    17,    18,    -1,    67,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    28,    29,    30,    31,
+      32,    33,    34,    35,    36,    37,    38,    39,    40,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    48,     5,     6,     7,
+       8,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    16,    17,
+      18,    -1,    -1,    -1,    -1,    67,    -1,    -1,    -1,    -1,
       28,    29,    30,    31,    32,    33,    34,    35,    36,    37,
-      38,    39,    40,    -1,    -1,    -1,    -1,    -1,    -1,    47,
-      -1,    -1,     5,     6,     7,     8,    -1,    -1,    -1,    -1,
-      46,    -1,    60,    16,    17,    18,    -1,    -1,    66,    -1,
-      56,    57,    58,    59,    -1,    28,    29,    30,    31,    32,
-      33,    34,    35,    36,    37,    38,    39,    40,    -1,    -1,
-      -1,    -1,    -1,    -1,    47,    -1,    -1,    -1,     5,     6,
-       7,     8,    -1,    -1,    -1,    -1,    -1,    60,    15,    16,
-      17,    18,    -1,    66,    -1,    -1,    -1,    -1,    -1,    -1,
-      -1,    28,    29,    30,    31,    32,    33,    34,    35,    36,
-      37,    38,    39,    40,    -1,    -1,    -1,    -1,    -1,    -1,
-      47,     5,     6,     7,     8,    -1,    -1,    -1,    -1,    -1,
-      -1,    -1,    16,    17,    18,    -1,    -1,    -1,    -1,    66,
-      -1,    -1,    -1,    -1,    28,    29,    30,    31,    32,    33,
-      34,    35,    36,    37,    38,    39,    40,    -1,    -1,    -1,
-      -1,    -1,    -1,    47,     6,     7,     8,    -1,    -1,    -1,
-      -1,    -1,    -1,    -1,    16,    17,    18,    -1,    -1,    -1,
-      -1,    -1,    66,    -1,    -1,    -1,    28,    29,    30,    31,
-      32,    33,    34,    35,    36,    37,    38,    39,    40,    19,
-      -1,    -1,    -1,    -1,    -1,    47,    -1,    27,    -1,    -1,
-      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    19,
-      -1,    41,    42,    43,    44,    45,    46,    27,    48,    49,
-      50,    51,    52,    -1,    -1,    55,    -1,    -1,    -1,    -1,
-      -1,    41,    42,    43,    44,    45,    46,    -1,    48,    49,
-      50,    51,    52,    -1,    -1,    55
+      38,    39,    40,     9,    10,    11,    12,    13,    14,    -1,
+      48,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    67,
+      -1,    -1,    -1,    -1,    -1,     6,     7,     8,    -1,    -1,
+      -1,    47,    -1,    -1,    -1,    16,    17,    18,    -1,    -1,
+      -1,    57,    58,    59,    60,    -1,    62,    28,    29,    30,
+      31,    32,    33,    34,    35,    36,    37,    38,    39,    40,
+      19,    -1,    -1,    -1,    -1,    -1,    -1,    48,    27,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    19,    41,    42,    43,    44,    45,    46,    47,    27,
+      49,    50,    51,    52,    53,    -1,    -1,    56,    -1,    -1,
+      -1,    -1,    -1,    41,    42,    43,    44,    45,    46,    47,
+      -1,    49,    50,    51,    52,    53,    -1,    -1,    56
   };
 
   const signed char
@@ -2396,39 +2419,40 @@ namespace yy {
   {
        0,     3,     4,     5,     6,     7,     8,    16,    17,    18,
       26,    28,    29,    30,    31,    32,    33,    34,    35,    36,
-      37,    38,    39,    40,    47,    60,    66,    69,    70,    71,
-      72,    73,    74,    76,    84,    86,    87,    88,    89,    95,
-      60,    70,    60,    70,    72,    85,    86,    89,     0,    24,
-      25,    77,     9,    10,    11,    12,    13,    14,    46,    56,
-      57,    58,    59,    92,    93,    41,    42,    43,    44,    45,
-      94,    40,    66,    95,    19,    27,    41,    42,    43,    44,
-      45,    46,    48,    49,    50,    51,    52,    55,    96,    97,
-      75,    95,    28,    61,    61,    65,    67,    70,    70,    48,
-      49,    50,    78,    80,    82,    60,    72,    73,    72,    72,
-      72,    15,    72,    72,    84,    89,    15,    73,    85,    19,
-      97,    64,    90,    62,    64,    90,    65,    97,    65,    86,
-      60,    60,    60,    72,    72,    73,    67,    64,    64,    90,
-      27,    53,    54,    86,    20,    21,    22,    23,    91,    97,
-      64,    87,    81,    95,    79,    95,    32,    64,    63,    64,
-      65,    61,    61,    65,    97,    61,    65,    97,    61,    27,
-      64,    90,    97,    70,    95,    51,    52,    83,    95,    61,
-      97,    97,    64,    83,    53
+      37,    38,    39,    40,    48,    61,    67,    70,    71,    72,
+      73,    74,    75,    77,    85,    87,    88,    89,    90,    96,
+      61,    71,    61,    71,    73,    86,    87,    90,     0,    24,
+      25,    78,     9,    10,    11,    12,    13,    14,    47,    57,
+      58,    59,    60,    93,    94,    41,    42,    43,    44,    45,
+      46,    95,    40,    67,    96,    19,    27,    41,    42,    43,
+      44,    45,    46,    47,    49,    50,    51,    52,    53,    56,
+      97,    98,    76,    96,    28,    62,    62,    66,    68,    71,
+      71,    49,    50,    51,    79,    81,    83,    61,    73,    74,
+      73,    73,    73,    15,    73,    73,    85,    90,    15,    74,
+      86,    19,    98,    65,    91,    63,    65,    91,    66,    98,
+      66,    87,    61,    61,    61,    73,    73,    74,    68,    65,
+      65,    91,    27,    54,    55,    87,    20,    21,    22,    23,
+      92,    98,    65,    88,    82,    96,    80,    96,    32,    65,
+      64,    65,    66,    62,    62,    66,    98,    62,    66,    98,
+      62,    27,    65,    91,    98,    71,    96,    52,    53,    84,
+      96,    62,    98,    98,    65,    84,    54
   };
 
   const signed char
   parser::yyr1_[] =
   {
-       0,    68,    69,    70,    70,    70,    70,    70,    70,    71,
-      71,    71,    71,    71,    71,    72,    72,    72,    72,    72,
-      72,    73,    73,    73,    74,    74,    74,    74,    74,    74,
-      74,    75,    76,    77,    77,    77,    77,    78,    79,    79,
-      80,    81,    81,    82,    83,    83,    84,    84,    85,    85,
-      85,    86,    86,    86,    86,    86,    86,    86,    86,    86,
-      86,    86,    86,    86,    86,    87,    87,    87,    87,    87,
-      88,    88,    89,    89,    89,    90,    90,    90,    91,    91,
-      91,    91,    92,    92,    92,    93,    93,    93,    93,    94,
-      94,    94,    94,    95,    95,    96,    97,    97,    97,    97,
-      97,    97,    97,    97,    97,    97,    97,    97,    97,    97
+       0,    69,    70,    71,    71,    71,    71,    71,    71,    72,
+      72,    72,    72,    72,    72,    73,    73,    73,    73,    73,
+      73,    74,    74,    74,    75,    75,    75,    75,    75,    75,
+      75,    76,    77,    78,    78,    78,    78,    79,    80,    80,
+      81,    82,    82,    83,    84,    84,    85,    85,    86,    86,
+      86,    87,    87,    87,    87,    87,    87,    87,    87,    87,
+      87,    87,    87,    87,    87,    88,    88,    88,    88,    88,
+      89,    89,    90,    90,    90,    91,    91,    91,    92,    92,
+      92,    92,    93,    93,    93,    94,    94,    94,    94,    95,
+      95,    95,    95,    95,    96,    96,    97,    98,    98,    98,
+      98,    98,    98,    98,    98,    98,    98,    98,    98,    98,
+      98,    98
   };
 
   const signed char
@@ -2443,8 +2467,9 @@ namespace yy {
        1,     1,     1,     2,     6,     1,     1,     1,     1,     1,
        1,     1,     1,     1,     1,     0,     2,     2,     1,     1,
        1,     1,     1,     1,     1,     1,     1,     1,     1,     1,
-       1,     1,     1,     0,     2,     2,     1,     5,     1,     1,
-       1,     1,     1,     1,     1,     1,     1,     1,     1,     1
+       1,     1,     1,     1,     0,     2,     2,     1,     5,     1,
+       1,     1,     1,     1,     1,     1,     1,     1,     1,     1,
+       1,     1
   };
 
 
@@ -2462,7 +2487,7 @@ namespace yy {
   "\"identifier\"", "\"string\"", "\"base64\"", "\"infinity\"", "\"NaN\"",
   "\"natural0\"", "\"number\"", "\"float\"", "\"date\"", "\"UUID\"",
   "\"ObjectId\"", "\"link\"", "\"typed link\"", "\"argument\"",
-  "\"beginswith\"", "\"endswith\"", "\"contains\"", "\"like\"",
+  "\"beginswith\"", "\"endswith\"", "\"contains\"", "\"like\"", "\"text\"",
   "\"between\"", "\"in\"", "\"obj\"", "\"sort\"", "\"distinct\"",
   "\"limit\"", "\"ascending\"", "\"descending\"", "\"@size\"", "\"@type\"",
   "\"key or value\"", "'+'", "'-'", "'*'", "'/'", "'('", "')'", "'['",
@@ -2480,17 +2505,18 @@ namespace yy {
   const short
   parser::yyrline_[] =
   {
-       0,   149,   149,   152,   153,   154,   155,   156,   157,   160,
-     161,   166,   167,   168,   173,   176,   177,   178,   179,   180,
-     181,   184,   185,   186,   189,   190,   191,   192,   193,   194,
-     195,   198,   201,   204,   205,   206,   207,   209,   212,   213,
-     215,   218,   219,   221,   224,   225,   227,   228,   231,   232,
-     233,   236,   237,   238,   239,   240,   241,   242,   243,   244,
-     245,   246,   247,   248,   249,   257,   258,   259,   260,   261,
-     264,   265,   268,   269,   270,   273,   274,   275,   278,   279,
-     280,   281,   284,   285,   286,   289,   290,   291,   292,   295,
-     296,   297,   298,   301,   302,   305,   308,   309,   310,   311,
-     312,   313,   314,   315,   316,   317,   318,   319,   320,   321
+       0,   150,   150,   153,   154,   155,   156,   157,   158,   161,
+     162,   167,   168,   169,   174,   177,   178,   179,   180,   181,
+     182,   185,   186,   187,   190,   191,   192,   193,   194,   195,
+     196,   199,   202,   205,   206,   207,   208,   210,   213,   214,
+     216,   219,   220,   222,   225,   226,   228,   229,   232,   233,
+     234,   237,   238,   239,   240,   241,   242,   243,   244,   245,
+     246,   247,   248,   249,   250,   258,   259,   260,   261,   262,
+     265,   266,   269,   270,   271,   274,   275,   276,   279,   280,
+     281,   282,   285,   286,   287,   290,   291,   292,   293,   296,
+     297,   298,   299,   300,   303,   304,   307,   310,   311,   312,
+     313,   314,   315,   316,   317,   318,   319,   320,   321,   322,
+     323,   324
   };
 
   void
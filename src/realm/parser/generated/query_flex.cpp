@@ -1892,7 +1892,7 @@ return yy::parser::make_STRING (yytext);
 	YY_BREAK
 case 61:
 YY_RULE_SETUP
-return yy::parser::make_ID (check_escapes(yytext));
+return is_text_operator(yytext) ? yy::parser::make_TEXT(yytext) : yy::parser::make_ID (check_escapes(yytext));
 	YY_BREAK
 case 62:
 YY_RULE_SETUP
@@ -101,6 +101,7 @@ using namespace realm::query_parser;
 %token <std::string> ENDSWITH "endswith"
 %token <std::string> CONTAINS "contains"
 %token <std::string> LIKE    "like"
+%token <std::string> TEXT    "text"
 %token <std::string> BETWEEN "between"
 %token <std::string> IN "in"
 %token <std::string> OBJ "obj"
@@ -296,6 +297,7 @@ stringop
     | ENDSWITH                  { $$ = CompareNode::ENDSWITH; }
     | CONTAINS                  { $$ = CompareNode::CONTAINS; }
     | LIKE                      { $$ = CompareNode::LIKE; }
+    | TEXT                      { $$ = CompareNode::TEXT; }
 
 path
     : %empty                    { $$ = drv.m_parse_nodes.create<PathNode>(); }
@@ -311,6 +313,7 @@ id
     | ENDSWITH                  { $$ = $1; }
     | CONTAINS                  { $$ = $1; }
     | LIKE                      { $$ = $1; }
+    | TEXT                      { $$ = $1; }
     | BETWEEN                   { $$ = $1; }
     | KEY_VAL                   { $$ = $1; }
     | SORT                      { $$ = $1; }
@@ -90,7 +90,7 @@ blank   [ \t\r]
 ("B64\""[a-zA-Z0-9/\+=]*\")         return yy::parser::make_BASE64(yytext);
 (\"({char1}|{escape}|{unicode})*\") return yy::parser::make_STRING (yytext);
 ('({char2}|{escape}|{unicode})*')   return yy::parser::make_STRING (yytext);
-({letter}|{utf8})({id_char}|{utf8}|{ws})*           return yy::parser::make_ID (check_escapes(yytext));
+({letter}|{utf8})({id_char}|{utf8}|{ws})*           return is_text_operator(yytext) ? yy::parser::make_TEXT(yytext) : yy::parser::make_ID (check_escapes(yytext));
 
 .          {
              throw yy::parser::syntax_error
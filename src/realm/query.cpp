@@ -28,8 +28,11 @@
 #include <realm/table_view.hpp>
 #include <realm/set.hpp>
 #include <realm/array_integer_tpl.hpp>
+#include <realm/util/thread_pool.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <thread>
 
 using namespace realm;
 using namespace realm::metrics;
@@ -89,6 +92,7 @@ Query::Query(const Query& source)
     , m_groups(source.m_groups)
     , m_table(source.m_table)
     , m_ordering(source.m_ordering)
+    , m_threads(source.m_threads)
 {
     if (source.m_owned_source_table_view) {
         m_owned_source_table_view = source.m_owned_source_table_view->clone();
@@ -135,6 +139,7 @@ Query& Query::operator=(const Query& source)
             m_view = m_source_collection.get();
         }
         m_ordering = source.m_ordering;
+        m_threads = source.m_threads;
     }
     return *this;
 }
@@ -160,6 +165,7 @@ Query::Query(const Query* source, Transaction* tr, PayloadPolicy policy)
         REALM_ASSERT_DEBUG(m_view);
     }
     m_groups = source->m_groups;
+    m_threads = source->m_threads;
     if (source->m_table)
         set_table(tr->import_copy_of(source->m_table));
     // otherwise: empty query.
@@ -933,6 +939,14 @@ Query& Query::like(ColKey column_key, StringData value, bool case_sensitive)
         add_condition<LikeIns>(column_key, value);
     return *this;
 }
+Query& Query::fulltext(ColKey column_key, StringData text)
+{
+    m_table->check_column(column_key);
+    if (column_key.get_type() != col_type_String || column_key.is_collection())
+        throw LogicError(LogicError::type_mismatch);
+    add_node(std::unique_ptr<ParentNode>(new TextSearchNode(text, column_key)));
+    return *this;
+}
 
 
 // Aggregates =================================================================================
@@ -947,8 +961,112 @@ bool Query::eval_object(const Obj& obj) const
 }
 
 
-template <typename T>
-void Query::aggregate(QueryStateBase& st, ColKey column_key) const
+Query& Query::set_threads(size_t num_threads)
+{
+    m_threads = num_threads ? num_threads : std::max(std::thread::hardware_concurrency(), 1u);
+    return *this;
+}
+
+namespace {
+
+// Collects the keys of the matching objects of a chunk of leaves
+class QueryStateCollectKeys : public QueryStateBase {
+public:
+    bool match(size_t index, Mixed) noexcept final
+    {
+        ++m_match_count;
+        m_keys.push_back(ObjKey(m_key_values->get(index) + m_key_offset));
+        return true;
+    }
+
+    std::vector<ObjKey> m_keys;
+};
+
+} // anonymous namespace
+
+/*
+ * Evaluate the query on all leaves of the table using up to m_threads threads.
+ *
+ * The leaves are split into consecutive chunks which the threads claim one at
+ * a time, so that a thread which is done early takes over work which would
+ * otherwise have waited for a slower one. The node tree holds the state of
+ * the leaf being searched, so every thread uses its own clone of it. Each
+ * chunk is aggregated into its own state, and `states` is filled in key order
+ * so that the caller can merge them into the same result as a sequential scan.
+ *
+ * If `LeafType` isn't void, the leaf of `column_key` is passed to the nodes as
+ * the source column, as done for the aggregates.
+ *
+ * Returns false without doing anything if the query should be evaluated
+ * sequentially.
+ */
+template <class LeafType, class State>
+bool Query::evaluate_in_parallel(std::vector<State>& states, ColKey column_key) const
+{
+    if (m_threads < 2 || m_view)
+        return false;
+
+    const Table* table = m_table.unchecked_ptr();
+    Allocator& alloc = table->get_alloc();
+
+    std::vector<std::pair<ref_type, uint64_t>> leaves; // ref and key offset
+    table->traverse_clusters([&](const Cluster* cluster) {
+        leaves.emplace_back(cluster->get_ref(), cluster->get_offset());
+        return IteratorControl::AdvanceToNext;
+    });
+    if (leaves.size() < 2)
+        return false;
+
+    // The pool may have fewer threads than this, in which case some of the
+    // workers will run after each other
+    size_t num_workers = std::min(m_threads, leaves.size());
+    // A few chunks per thread is enough to even out differences in match rates
+    size_t num_chunks = std::min(leaves.size(), num_workers * 4);
+    states.clear();
+    states.resize(num_chunks);
+
+    std::vector<std::unique_ptr<ParentNode>> nodes;
+    nodes.reserve(num_workers);
+    for (size_t i = 0; i < num_workers; ++i) {
+        auto node = root_node()->clone();
+        node->init(true);
+        std::vector<ParentNode*> vec;
+        node->gather_children(vec);
+        nodes.push_back(std::move(node));
+    }
+
+    std::atomic<size_t> next_chunk{0};
+    util::ThreadPool::get_default().run(num_workers, [&](size_t worker) {
+        ParentNode* node = nodes[worker].get();
+        std::unique_ptr<ArrayPayload> leaf;
+        if constexpr (!std::is_void_v<LeafType>) {
+            leaf = std::make_unique<LeafType>(alloc);
+        }
+
+        for (;;) {
+            size_t chunk = next_chunk.fetch_add(1, std::memory_order_relaxed);
+            if (chunk >= num_chunks)
+                break;
+            State& st = states[chunk];
+            size_t begin = leaves.size() * chunk / num_chunks;
+            size_t end = leaves.size() * (chunk + 1) / num_chunks;
+            for (size_t i = begin; i < end; ++i) {
+                Cluster cluster(leaves[i].second, alloc, table->m_clusters);
+                cluster.init(MemRef(leaves[i].first, alloc));
+                node->set_cluster(&cluster);
+                if (leaf)
+                    cluster.init_leaf(column_key, leaf.get());
+                st.m_key_offset = cluster.get_offset();
+                st.m_key_values = cluster.get_key_array();
+                aggregate_internal(node, &st, 0, cluster.node_size(), leaf.get());
+            }
+        }
+    });
+    return true;
+}
+
+template <typename T, typename State>
+void Query::aggregate(State& st, ColKey column_key) const
 {
     using LeafType = typename ColumnTypeTraits<T>::cluster_leaf_type;
 
@@ -981,6 +1099,13 @@ void Query::aggregate(QueryStateBase& st, ColKey column_key) const
             }
             else {
                 // no index, traverse cluster tree
+                std::vector<State> states;
+                if (evaluate_in_parallel<LeafType>(states, column_key)) {
+                    for (auto& chunk_state : states)
+                        st.combine(chunk_state);
+                    return;
+                }
+
                 node = pn;
                 LeafType leaf(m_table.unchecked_ptr()->get_alloc());
 
@@ -1283,6 +1408,17 @@ void Query::do_find_all(TableView& ret, size_t limit) const
                 return;
             }
             // no index on best node (and likely no index at all), descend B+-tree
+            if (limit == size_t(-1)) {
+                std::vector<QueryStateCollectKeys> states;
+                if (evaluate_in_parallel<void>(states)) {
+                    for (auto& chunk_state : states) {
+                        for (auto key : chunk_state.m_keys)
+                            ret.m_key_values.add(key);
+                    }
+                    return;
+                }
+            }
+
             node = pn;
             QueryStateFindAll<KeyColumn> st(ret.m_key_values, limit);
 
@@ -1371,6 +1507,15 @@ size_t Query::do_count(size_t limit) const
             return counter;
         }
         // no index, descend down the B+-tree instead
+        if (limit == size_t(-1)) {
+            std::vector<QueryStateCount> states;
+            if (evaluate_in_parallel<void>(states)) {
+                for (auto& chunk_state : states)
+                    cnt += chunk_state.get_count();
+                return cnt;
+            }
+        }
+
         node = pn;
         QueryStateCount st(limit);
 
@@ -1466,136 +1611,6 @@ size_t Query::remove() const
     return rows;
 }
 
-#if REALM_MULTITHREAD_QUERY
-TableView Query::find_all_multi(size_t start, size_t end)
-{
-    static_cast<void>(start);
-    static_cast<void>(end);
-
-    // Initialization
-    init();
-    ts.next_job = start;
-    ts.end_job = end;
-    ts.done_job = 0;
-    ts.count = 0;
-    ts.table = &table;
-    ts.node = first[0];
-
-    // Signal all threads to start
-    pthread_mutex_unlock(&ts.jobs_mutex);
-    pthread_cond_broadcast(&ts.jobs_cond);
-
-    // Wait until all threads have completed
-    pthread_mutex_lock(&ts.completed_mutex);
-    while (ts.done_job < ts.end_job)
-        pthread_cond_wait(&ts.completed_cond, &ts.completed_mutex);
-    pthread_mutex_lock(&ts.jobs_mutex);
-    pthread_mutex_unlock(&ts.completed_mutex);
-
-    TableView tv(*m_table);
-
-    // Sort search results because user expects ascending order
-    sort(ts.chunks.begin(), ts.chunks.end(), &Query::comp);
-    for (size_t i = 0; i < ts.chunks.size(); ++i) {
-        const size_t from = ts.chunks[i].m_root_node;
-        const size_t upto = (i == ts.chunks.size() - 1) ? size_t(-1) : ts.chunks[i + 1].m_root_node;
-        size_t first = ts.chunks[i].second;
-
-        while (first < ts.results.size() && ts.results[first] < upto && ts.results[first] >= from) {
-            tv.get_ref_column().add(ts.results[first]);
-            ++first;
-        }
-    }
-
-    return move(tv);
-}
-
-int Query::set_threads(unsigned int threadcount)
-{
-#if defined(_WIN32) || defined(__WIN32__) || defined(_WIN64)
-    pthread_win32_process_attach_np();
-#endif
-    pthread_mutex_init(&ts.result_mutex, nullptr);
-    pthread_cond_init(&ts.completed_cond, nullptr);
-    pthread_mutex_init(&ts.jobs_mutex, nullptr);
-    pthread_mutex_init(&ts.completed_mutex, nullptr);
-    pthread_cond_init(&ts.jobs_cond, nullptr);
-
-    pthread_mutex_lock(&ts.jobs_mutex);
-
-    for (size_t i = 0; i < m_threadcount; ++i)
-        pthread_detach(threads[i]);
-
-    for (size_t i = 0; i < threadcount; ++i) {
-        int r = pthread_create(&threads[i], nullptr, query_thread, (void*)&ts);
-        if (r != 0)
-            REALM_ASSERT(false); // todo
-    }
-    m_threadcount = threadcount;
-    return 0;
-}
-
-
-void* Query::query_thread(void* arg)
-{
-    static_cast<void>(arg);
-    thread_state* ts = static_cast<thread_state*>(arg);
-
-    std::vector<size_t> res;
-    std::vector<pair<size_t, size_t>> chunks;
-
-    for (;;) {
-        // Main waiting loop that waits for a query to start
-        pthread_mutex_lock(&ts->jobs_mutex);
-        while (ts->next_job == ts->end_job)
-            pthread_cond_wait(&ts->jobs_cond, &ts->jobs_mutex);
-        pthread_mutex_unlock(&ts->jobs_mutex);
-
-        for (;;) {
-            // Pick a job
-            pthread_mutex_lock(&ts->jobs_mutex);
-            if (ts->next_job == ts->end_job)
-                break;
-            const size_t chunk = min(ts->end_job - ts->next_job, thread_chunk_size);
-            const size_t mine = ts->next_job;
-            ts->next_job += chunk;
-            size_t r = mine - 1;
-            const size_t end = mine + chunk;
-
-            pthread_mutex_unlock(&ts->jobs_mutex);
-
-            // Execute job
-            for (;;) {
-                r = ts->node->find_first(r + 1, end);
-                if (r == end)
-                    break;
-                res.push_back(r);
-            }
-
-            // Append result in common queue shared by all threads.
-            pthread_mutex_lock(&ts->result_mutex);
-            ts->done_job += chunk;
-            if (res.size() > 0) {
-                ts->chunks.push_back(std::pair<size_t, size_t>(mine, ts->results.size()));
-                ts->count += res.size();
-                for (size_t i = 0; i < res.size(); i++) {
-                    ts->results.push_back(res[i]);
-                }
-                res.clear();
-            }
-            pthread_mutex_unlock(&ts->result_mutex);
-
-            // Signal main thread that we might have compleeted
-            pthread_mutex_lock(&ts->completed_mutex);
-            pthread_cond_signal(&ts->completed_cond);
-            pthread_mutex_unlock(&ts->completed_mutex);
-        }
-    }
-    return 0;
-}
-
-#endif // REALM_MULTITHREADQUERY
-
 std::string Query::get_description(util::serializer::SerialisationState& state) const
 {
     std::string description;
@@ -26,14 +26,6 @@
 #include <string>
 #include <vector>
 
-#define REALM_MULTITHREAD_QUERY 0
-
-#if REALM_MULTITHREAD_QUERY
-// FIXME: Use our C++ thread abstraction API since it provides a much
-// higher level of encapsulation and safety.
-#include <pthread.h>
-#endif
-
 #include <realm/aggregate_ops.hpp>
 #include <realm/obj_list.hpp>
 #include <realm/table_ref.hpp>
@@ -211,6 +203,12 @@ public:
     Query& contains(ColKey column_key, StringData value, bool case_sensitive = true);
     Query& like(ColKey column_key, StringData value, bool case_sensitive = true);
 
+    // Matches the strings containing every word of `text`. Words are compared
+    // ignoring the case of ASCII letters, and a word followed by '*' matches
+    // any word starting with it. Uses the full-text index of the column if it
+    // has one.
+    Query& fulltext(ColKey column_key, StringData text);
+
     // These are shortcuts for equal(StringData(c_str)) and
     // not_equal(StringData(c_str)), and are needed to avoid unwanted
     // implicit conversion of char* to bool.
@@ -269,12 +267,25 @@ public:
     // Deletion
     size_t remove() const;
 
-#if REALM_MULTITHREAD_QUERY
     // Multi-threading
-    TableView find_all_multi(size_t start = 0, size_t end = size_t(-1));
-    TableView find_all_multi(size_t start = 0, size_t end = size_t(-1)) const;
-    int set_threads(unsigned int threadcount);
-#endif
+    //
+    // Allow find_all(), count() and the aggregates to scan the table using up
+    // to `num_threads` threads from the default thread pool (see
+    // util::ThreadPool). Each thread evaluates the conditions on a disjoint set
+    // of cluster leaves, and the results are merged in key order, so the
+    // results are the same as for a single threaded scan (except for rounding
+    // differences when summing floating point values). Queries restricted by a
+    // view, queries served by a search index and queries with a limit are
+    // always evaluated on the calling thread. A value of 0 selects one thread
+    // per hardware thread. The default is 1.
+    //
+    // The table must not be modified by other threads while a query is
+    // running, which is already guaranteed for frozen and read transactions.
+    Query& set_threads(size_t num_threads);
+    size_t get_threads() const noexcept
+    {
+        return m_threads;
+    }
 
     const ConstTableRef& get_table() const noexcept
     {
@@ -344,13 +355,16 @@ private:
     template <typename TConditionFunction>
     Query& add_size_condition(ColKey column_key, int64_t value);
 
-    template <typename T>
-    void aggregate(QueryStateBase& st, ColKey column_key) const;
+    template <typename T, typename State>
+    void aggregate(State& st, ColKey column_key) const;
 
     size_t find_best_node(ParentNode* pn) const;
     void aggregate_internal(ParentNode* pn, QueryStateBase* st, size_t start, size_t end,
                             ArrayPayload* source_column) const;
 
+    template <class LeafType, class State>
+    bool evaluate_in_parallel(std::vector<State>& states, ColKey column_key = {}) const;
+
     void do_find_all(TableView& tv, size_t limit) const;
     size_t do_count(size_t limit = size_t(-1)) const;
     void delete_nodes() noexcept;
@@ -396,6 +410,7 @@ private:
     TableView* m_source_table_view = nullptr;      // table views are not refcounted, and not owned by the query.
     std::unique_ptr<TableView> m_owned_source_table_view; // <--- except when indicated here
     util::bind_ptr<DescriptorOrdering> m_ordering;
+    size_t m_threads = 1;
 };
 
 // Implementation:
@@ -51,6 +51,11 @@ public:
     {
         return m_state.items_counted();
     }
+    void combine(const QueryStateSum& other)
+    {
+        m_state.combine(other.m_state);
+        m_match_count += other.m_match_count;
+    }
 
 private:
     aggregate_operations::Sum<typename util::RemoveOptional<T>::type> m_state;
@@ -76,6 +81,14 @@ public:
     {
         return m_state.is_null() ? Mixed() : m_state.result();
     }
+    // Ties are resolved in favour of this state, so states must be combined
+    // in key order
+    void combine(const QueryStateMinMax& other)
+    {
+        if (m_state.combine(other.m_state))
+            m_minmax_key = other.m_minmax_key;
+        m_match_count += other.m_match_count;
+    }
 
 private:
     State<typename util::RemoveOptional<R>::type> m_state;
@@ -209,6 +209,7 @@ public:
     void set_cluster(const Cluster* cluster)
     {
         m_cluster = cluster;
+        m_leaf_checked = false;
         if (m_child)
             m_child->set_cluster(cluster);
         cluster_changed();
@@ -317,7 +318,27 @@ protected:
         return m_table.unchecked_ptr()->get_real_column_type(key);
     }
 
+    // Returns true if the zone map of the table shows that no value in `leaf`
+    // (the leaf of the current cluster) satisfies `Cond` against `value`. The
+    // leaf is looked up at most once per cluster, and not for single rows.
+    template <class Cond, class LeafType, class T>
+    bool leaf_excluded(const LeafType& leaf, const T& value, size_t start, size_t end)
+    {
+        if (!LeafSummary::can_exclude<Cond> || end - start <= 1)
+            return false;
+        if (!m_leaf_checked) {
+            auto table = m_table.unchecked_ptr();
+            auto summary = table->get_zone_map().get(leaf, *table);
+            m_leaf_excluded = summary && !summary->template may_match<Cond>(Mixed(value));
+            m_leaf_checked = true;
+        }
+        return m_leaf_excluded;
+    }
+
 private:
+    bool m_leaf_checked = false;
+    bool m_leaf_excluded = false;
+
     virtual void table_changed()
     {
     }
@@ -332,6 +353,94 @@ private:
 };
 
 
+// The objects matching a range condition on a column with an ordered index
+// form a contiguous range of the index. Only the bounds of the range are looked
+// up when the query is initialized; the keys are read from the index the first
+// time they are needed.
+class OrderedIndexRange {
+public:
+    template <class TConditionFunction>
+    static constexpr bool supports_condition =
+        std::is_same_v<TConditionFunction, Greater> || std::is_same_v<TConditionFunction, GreaterEqual> ||
+        std::is_same_v<TConditionFunction, Less> || std::is_same_v<TConditionFunction, LessEqual>;
+
+    // Look up the entries of `table`s ordered index on `column_key` which
+    // match the condition. Returns false if there is no such index, or if the
+    // condition matches so many objects that scanning the column is cheaper.
+    template <class TConditionFunction>
+    bool init(const Table& table, ColKey column_key, Mixed value)
+    {
+        reset();
+        const OrderedIndex* index = table.get_ordered_index(column_key);
+        if (!index || value.is_null())
+            return false;
+
+        // Null is ordered first, and never matches a range condition
+        if constexpr (std::is_same_v<TConditionFunction, Greater>) {
+            m_begin = index->upper_bound(value);
+            m_end = index->size();
+        }
+        else if constexpr (std::is_same_v<TConditionFunction, GreaterEqual>) {
+            m_begin = index->lower_bound(value);
+            m_end = index->size();
+        }
+        else if constexpr (std::is_same_v<TConditionFunction, Less>) {
+            m_begin = index->upper_bound(Mixed());
+            m_end = index->lower_bound(value);
+        }
+        else {
+            static_assert(std::is_same_v<TConditionFunction, LessEqual>);
+            m_begin = index->upper_bound(Mixed());
+            m_end = index->upper_bound(value);
+        }
+        if (size() > index->size() / s_max_selectivity)
+            return false;
+        m_index = index;
+        return true;
+    }
+
+    void reset()
+    {
+        m_index = nullptr;
+        m_begin = m_end = 0;
+        m_keys.clear();
+        m_keys_fetched = false;
+    }
+
+    bool is_active() const
+    {
+        return m_index != nullptr;
+    }
+
+    size_t size() const
+    {
+        return m_end - m_begin;
+    }
+
+    // The keys of the matching objects, in key order
+    const std::vector<ObjKey>& keys()
+    {
+        if (!m_keys_fetched) {
+            m_index->get_keys(m_begin, m_end, m_keys);
+            std::sort(m_keys.begin(), m_keys.end());
+            m_keys_fetched = true;
+        }
+        return m_keys;
+    }
+
+private:
+    // The index is only used if at most 1/16 of the objects match. Beyond that,
+    // fetching and sorting the keys is slower than scanning the column.
+    static constexpr size_t s_max_selectivity = 16;
+
+    const OrderedIndex* m_index = nullptr;
+    size_t m_begin = 0;
+    size_t m_end = 0;
+    std::vector<ObjKey> m_keys;
+    bool m_keys_fetched = false;
+};
+
+
 class ColumnNodeBase : public ParentNode {
 protected:
     ColumnNodeBase(ColKey column_key)
@@ -447,13 +556,43 @@ public:
     {
     }
 
+    void init(bool will_query_ranges) override
+    {
+        BaseType::init(will_query_ranges);
+
+        if constexpr (OrderedIndexRange::supports_condition<TConditionFunction>) {
+            const Table& table = *this->m_table;
+            if (m_index_range.template init<TConditionFunction>(table, this->m_condition_column_key,
+                                                                Mixed(this->m_value))) {
+                this->m_dT = 0;
+                this->m_dD = double(table.size()) / (m_index_range.size() + 1.1);
+            }
+        }
+    }
+
+    // Objects matching a range condition can be found through an ordered
+    // index. Within a leaf, the leaf is still searched directly.
+    bool has_search_index() const override
+    {
+        return m_index_range.is_active();
+    }
+
+    const std::vector<ObjKey>& index_based_keys() override
+    {
+        return m_index_range.keys();
+    }
+
     size_t find_first_local(size_t start, size_t end) override
     {
+        if (this->template leaf_excluded<TConditionFunction>(*this->m_leaf_ptr, this->m_value, start, end))
+            return not_found;
         return this->m_leaf_ptr->template find_first<TConditionFunction>(this->m_value, start, end);
     }
 
     size_t find_all_local(size_t start, size_t end) override
     {
+        if (this->template leaf_excluded<TConditionFunction>(*this->m_leaf_ptr, this->m_value, start, end))
+            return end;
         return BaseType::template find_all_local<TConditionFunction>(start, end);
     }
 
@@ -466,6 +605,9 @@ public:
     {
         return std::unique_ptr<ParentNode>(new ThisType(*this));
     }
+
+private:
+    OrderedIndexRange m_index_range;
 };
 
 template <size_t linear_search_threshold, class LeafType, class NeedleContainer>
@@ -560,7 +702,7 @@ public:
                     s = start;
                 }
             }
-            else {
+            else if (!this->template leaf_excluded<Equal>(*this->m_leaf_ptr, this->m_value, start, end)) {
                 s = this->m_leaf_ptr->template find_first<Equal>(this->m_value, start, end);
             }
         }
@@ -570,6 +712,8 @@ public:
 
     size_t find_all_local(size_t start, size_t end) override
     {
+        if (!m_nb_needles && this->template leaf_excluded<Equal>(*this->m_leaf_ptr, this->m_value, start, end))
+            return end;
         return BaseType::template find_all_local<Equal>(start, end);
     }
 
@@ -652,6 +796,9 @@ public:
 
     size_t find_first_local(size_t start, size_t end) override
     {
+        if (leaf_excluded<TConditionFunction>(*m_leaf_ptr, m_value, start, end))
+            return not_found;
+
         TConditionFunction cond;
 
         auto find = [&](bool nullability) {
@@ -1006,8 +1153,33 @@ class TimestampNode : public TimestampNodeBase {
 public:
     using TimestampNodeBase::TimestampNodeBase;
 
+    void init(bool will_query_ranges) override
+    {
+        TimestampNodeBase::init(will_query_ranges);
+
+        m_dT = 2.0;
+        if constexpr (OrderedIndexRange::supports_condition<TConditionFunction>) {
+            if (m_index_range.template init<TConditionFunction>(*m_table, m_condition_column_key, Mixed(m_value))) {
+                m_dT = 0;
+                m_dD = double(m_table->size()) / (m_index_range.size() + 1.1);
+            }
+        }
+    }
+
+    bool has_search_index() const override
+    {
+        return m_index_range.is_active();
+    }
+
+    const std::vector<ObjKey>& index_based_keys() override
+    {
+        return m_index_range.keys();
+    }
+
     size_t find_first_local(size_t start, size_t end) override
     {
+        if (leaf_excluded<TConditionFunction>(*m_leaf_ptr, m_value, start, end))
+            return not_found;
         return m_leaf_ptr->find_first<TConditionFunction>(m_value, start, end);
     }
 
@@ -1028,6 +1200,9 @@ protected:
         : TimestampNodeBase(from, tr)
     {
     }
+
+private:
+    OrderedIndexRange m_index_range;
 };
 
 class DecimalNodeBase : public ParentNode {
@@ -1774,6 +1949,91 @@ protected:
     std::string m_lcase;
 };
 
+// Matches the strings which contain all the words of a search text. If the
+// column has a full-text index, the matching keys are looked up in the index
+// up front, otherwise each string is split into words and checked.
+class TextSearchNode : public StringNodeBase {
+public:
+    TextSearchNode(StringData v, ColKey column)
+        : StringNodeBase(v, column)
+        , m_terms(FullTextIndex::get_terms(v))
+    {
+    }
+
+    void init(bool will_query_ranges) override
+    {
+        StringNodeBase::init(will_query_ranges);
+        clear_leaf_state();
+
+        m_dT = 100.0;
+        m_index_matches.clear();
+        m_last_start_key = ObjKey();
+        m_result_get = 0;
+        m_has_search_index = false;
+        if (m_terms.empty())
+            return;
+        if (const FullTextIndex* index = m_table->get_fulltext_index(m_condition_column_key)) {
+            index->find_all(m_index_matches, m_terms);
+            m_has_search_index = true;
+            m_dT = 0.0;
+            m_dD = double(m_table->size()) / (m_index_matches.size() + 1.1);
+        }
+    }
+
+    bool has_search_index() const override
+    {
+        return m_has_search_index;
+    }
+
+    const std::vector<ObjKey>& index_based_keys() override
+    {
+        return m_index_matches;
+    }
+
+    void cluster_changed() override
+    {
+        // If we use the index, we do not need further access to clusters
+        if (!m_has_search_index) {
+            StringNodeBase::cluster_changed();
+        }
+    }
+
+    size_t find_first_local(size_t start, size_t end) override
+    {
+        if (m_has_search_index)
+            return do_search_index(m_last_start_key, m_result_get, m_index_matches, m_cluster, start, end);
+
+        for (size_t s = start; s < end; ++s) {
+            if (FullTextIndex::matches(m_terms, get_string(s)))
+                return s;
+        }
+        return not_found;
+    }
+
+    std::string describe_condition() const override
+    {
+        return "TEXT";
+    }
+
+    std::unique_ptr<ParentNode> clone() const override
+    {
+        return std::unique_ptr<ParentNode>(new TextSearchNode(*this));
+    }
+
+    TextSearchNode(const TextSearchNode& from)
+        : StringNodeBase(from)
+        , m_terms(from.m_terms)
+    {
+    }
+
+private:
+    std::vector<FullTextIndex::Term> m_terms;
+    std::vector<ObjKey> m_index_matches;
+    ObjKey m_last_start_key;
+    size_t m_result_get = 0;
+    bool m_has_search_index = false;
+};
+
 class StringNodeEqualBase : public StringNodeBase {
 public:
     StringNodeEqualBase(StringData v, ColKey column)
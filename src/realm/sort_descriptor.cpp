@@ -21,9 +21,83 @@
 #include <realm/db.hpp>
 #include <realm/util/assert.hpp>
 #include <realm/list.hpp>
+#include <realm/util/thread_pool.hpp>
+
+#include <array>
+#include <numeric>
 
 using namespace realm;
 
+namespace {
+
+// Inputs with at least this many entries are sorted with the values of all
+// columns fetched up front, so that the comparisons can run concurrently. For
+// smaller inputs most comparisons are decided by the first column, and the
+// values of the other columns are only fetched when needed.
+constexpr size_t s_fetch_all_threshold = 1000;
+
+// Number of entries to fetch the values for in each task
+constexpr size_t s_fetch_chunk_size = 4096;
+
+// A view is ordered through an ordered index if it holds at least this fraction
+// of the objects of the table, as the whole index may have to be traversed.
+constexpr size_t s_index_sort_fraction = 4;
+
+// Order preserving mapping of signed integers onto unsigned integers
+inline uint64_t radix_key(int64_t value)
+{
+    return uint64_t(value) ^ (uint64_t(1) << 63);
+}
+
+// Stable sort of the positions in `order` by the lowest `num_bytes` bytes of
+// `keys[position]`, one byte per pass
+void radix_sort_positions(std::vector<size_t>& order, std::vector<size_t>& tmp, const std::vector<uint64_t>& keys,
+                          int num_bytes)
+{
+    size_t size = order.size();
+    std::vector<std::array<size_t, 256>> counts(num_bytes);
+    for (auto& c : counts)
+        c.fill(0);
+    for (uint64_t key : keys) {
+        for (int b = 0; b < num_bytes; ++b)
+            ++counts[b][(key >> (8 * b)) & 0xFF];
+    }
+
+    for (int b = 0; b < num_bytes; ++b) {
+        auto& c = counts[b];
+        // Skip the pass if all keys have the same value for this byte
+        if (c[(keys[0] >> (8 * b)) & 0xFF] == size)
+            continue;
+        size_t offset = 0;
+        for (auto& count : c) {
+            size_t n = count;
+            count = offset;
+            offset += n;
+        }
+        for (size_t pos : order)
+            tmp[c[(keys[pos] >> (8 * b)) & 0xFF]++] = pos;
+        order.swap(tmp);
+    }
+}
+
+// Stable partition of the positions in `order` into null and non-null entries
+void partition_nulls(std::vector<size_t>& order, std::vector<size_t>& tmp, const std::vector<bool>& nulls,
+                     bool nulls_first)
+{
+    auto out = tmp.begin();
+    for (size_t pos : order) {
+        if (nulls[pos] == nulls_first)
+            *out++ = pos;
+    }
+    for (size_t pos : order) {
+        if (nulls[pos] != nulls_first)
+            *out++ = pos;
+    }
+    order.swap(tmp);
+}
+
+} // anonymous namespace
+
 LinkPathPart::LinkPathPart(ColKey col_key, ConstTableRef source)
     : column_key(col_key)
     , from(source->get_key())
@@ -168,6 +242,11 @@ BaseDescriptor::Sorter::Sorter(std::vector<std::vector<ColKey>> const& column_li
 
         if (sz == 1) { // no link chain
             m_columns.emplace_back(&root_table, columns[0], ascending[i]);
+            if (column_lists.size() == 1) {
+                auto index = root_table.get_ordered_index(columns[0]);
+                if (index && indexes.size() * s_index_sort_fraction >= index->size())
+                    m_ordered_index = index;
+            }
             continue;
         }
 
@@ -226,7 +305,7 @@ void DistinctDescriptor::execute(IndexPairs& v, const Sorter& predicate, const B
     }
 
     // Sort by the columns to distinct on
-    std::sort(v.begin(), v.end(), std::ref(predicate));
+    predicate.sort(v);
 
     // Move duplicates to the back - "not less than" is "equal" since they're sorted
     auto duplicates = std::unique(v.begin(), v.end(), [&](const IP& a, const IP& b) {
@@ -252,7 +331,11 @@ BaseDescriptor::Sorter SortDescriptor::sorter(Table const& table, const IndexPai
 
 void SortDescriptor::execute(IndexPairs& v, const Sorter& predicate, const BaseDescriptor* next) const
 {
-    std::sort(v.begin(), v.end(), std::ref(predicate));
+    // If only the first entries are kept, the rest need not be ordered
+    size_t num_needed = npos;
+    if (next && next->get_type() == DescriptorType::Limit)
+        num_needed = static_cast<const LimitDescriptor*>(next)->get_limit();
+    predicate.sort(v, num_needed);
 
     // not doing this on the last step is an optimisation
     if (next) {
@@ -287,7 +370,7 @@ void LimitDescriptor::execute(IndexPairs& v, const Sorter&, const BaseDescriptor
 
 // This function must conform to 'is less' predicate - that is:
 // return true if i is strictly smaller than j
-bool BaseDescriptor::Sorter::operator()(IndexPair i, IndexPair j, bool total_ordering) const
+bool BaseDescriptor::Sorter::operator()(const IndexPair& i, const IndexPair& j, bool total_ordering) const
 {
     // Sorting can be specified by multiple columns, so that if two entries in the first column are
     // identical, then the rows are ordered according to the second column, and so forth. For the
@@ -311,6 +394,10 @@ bool BaseDescriptor::Sorter::operator()(IndexPair i, IndexPair j, bool total_ord
         if (t == 0) {
             c = i.cached_value.compare(j.cached_value);
         }
+        else if (m_all_values_cached) {
+            auto& values = m_columns[t].values;
+            c = values[i.index_in_view].compare(values[j.index_in_view]);
+        }
         else {
             if (m_cache[t - 1].empty()) {
                 m_cache[t - 1].resize(256);
@@ -347,29 +434,214 @@ bool BaseDescriptor::Sorter::operator()(IndexPair i, IndexPair j, bool total_ord
     return total_ordering ? i.index_in_view < j.index_in_view : 0;
 }
 
-void BaseDescriptor::Sorter::cache_first_column(IndexPairs& v)
+void BaseDescriptor::Sorter::cache_values(IndexPairs& v)
 {
-    if (m_columns.empty())
+    // When sorting through an index, the values are read from the index
+    if (m_columns.empty() || m_ordered_index)
         return;
 
-    auto& col = m_columns[0];
-    ColKey ck = col.col_key;
-    for (size_t i = 0; i < v.size(); i++) {
-        IndexPair& index = v[i];
-        ObjKey key = index.key_for_object;
+    m_all_values_cached = v.size() >= s_fetch_all_threshold;
+    size_t num_columns = m_all_values_cached ? m_columns.size() : 1;
+    if (num_columns > 1) {
+        size_t translated_size = std::max_element(v.begin(), v.end())->index_in_view + 1;
+        for (size_t t = 1; t < num_columns; ++t)
+            m_columns[t].values.resize(translated_size);
+    }
 
-        if (!col.translated_keys.empty()) {
-            if (col.is_null[i]) {
-                index.cached_value = Mixed();
-                continue;
+    auto fetch = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            IndexPair& index = v[i];
+            for (size_t t = 0; t < num_columns; ++t) {
+                auto& col = m_columns[t];
+                Mixed& value = (t == 0) ? index.cached_value : col.values[index.index_in_view];
+                ObjKey key = index.key_for_object;
+
+                if (!col.translated_keys.empty()) {
+                    if (col.is_null[index.index_in_view]) {
+                        value = Mixed();
+                        continue;
+                    }
+                    key = col.translated_keys[index.index_in_view];
+                }
+
+                value = col.table->get_object(key).get_any(col.col_key);
             }
-            else {
-                key = col.translated_keys[v[i].index_in_view];
+        }
+    };
+
+    // Each entry is written by one task only, so the values can be fetched concurrently
+    size_t num_chunks = (v.size() + s_fetch_chunk_size - 1) / s_fetch_chunk_size;
+    if (num_chunks > 1) {
+        util::ThreadPool::get_default().run(num_chunks, [&](size_t chunk) {
+            fetch(chunk * s_fetch_chunk_size, std::min((chunk + 1) * s_fetch_chunk_size, v.size()));
+        });
+    }
+    else {
+        fetch(0, v.size());
+    }
+}
+
+void BaseDescriptor::Sorter::sort(IndexPairs& v, size_t num_needed) const
+{
+    if (m_ordered_index) {
+        sort_by_index(v, num_needed);
+    }
+    else if (!m_all_values_cached) {
+        std::sort(v.begin(), v.end(), std::ref(*this));
+    }
+    else if (can_radix_sort()) {
+        radix_sort(v);
+    }
+    else {
+        // The comparisons only read the cached values, so they can run concurrently
+        util::parallel_sort(util::ThreadPool::get_default(), v.begin(), v.end(), std::ref(*this));
+    }
+}
+
+bool BaseDescriptor::Sorter::can_radix_sort() const
+{
+    return std::all_of(m_columns.begin(), m_columns.end(), [](const SortColumn& col) {
+        auto type = col.col_key.get_type();
+        return col.translated_keys.empty() &&
+               (type == col_type_Int || type == col_type_Bool || type == col_type_Timestamp);
+    });
+}
+
+// Least significant digit radix sort over all columns, starting with the last
+// one. Each column is sorted by its value and then by whether the value is
+// null, as null is ordered before all other values. Descending columns are
+// sorted on the inverted keys so that the sort stays stable.
+void BaseDescriptor::Sorter::radix_sort(IndexPairs& v) const
+{
+    // Entries comparing equal must stay ordered by their index in the view
+    if (!std::is_sorted(v.begin(), v.end()))
+        std::sort(v.begin(), v.end());
+
+    size_t size = v.size();
+    std::vector<size_t> order(size);
+    std::vector<size_t> tmp(size);
+    std::iota(order.begin(), order.end(), 0);
+    std::vector<uint64_t> keys(size);
+    std::vector<bool> nulls(size);
+
+    for (size_t t = m_columns.size(); t-- > 0;) {
+        auto& col = m_columns[t];
+        uint64_t invert = col.ascending ? 0 : ~uint64_t(0);
+        auto get_value = [&](size_t pos) -> const Mixed& {
+            return t == 0 ? v[pos].cached_value : col.values[v[pos].index_in_view];
+        };
+
+        bool has_nulls = false;
+        for (size_t pos = 0; pos < size; ++pos) {
+            nulls[pos] = get_value(pos).is_null();
+            has_nulls = has_nulls || nulls[pos];
+        }
+
+        switch (col.col_key.get_type()) {
+            case col_type_Int:
+                for (size_t pos = 0; pos < size; ++pos)
+                    keys[pos] = nulls[pos] ? 0 : radix_key(get_value(pos).get_int()) ^ invert;
+                radix_sort_positions(order, tmp, keys, 8);
+                break;
+            case col_type_Bool:
+                for (size_t pos = 0; pos < size; ++pos)
+                    keys[pos] = nulls[pos] ? 0 : uint64_t(get_value(pos).get_bool()) ^ invert;
+                radix_sort_positions(order, tmp, keys, 1);
+                break;
+            case col_type_Timestamp:
+                // Nanoseconds are the least significant part
+                for (size_t pos = 0; pos < size; ++pos) {
+                    uint32_t ns = nulls[pos] ? 0 : uint32_t(get_value(pos).get_timestamp().get_nanoseconds());
+                    keys[pos] = uint64_t(ns ^ 0x80000000u) ^ invert;
+                }
+                radix_sort_positions(order, tmp, keys, 4);
+                for (size_t pos = 0; pos < size; ++pos)
+                    keys[pos] = nulls[pos] ? 0 : radix_key(get_value(pos).get_timestamp().get_seconds()) ^ invert;
+                radix_sort_positions(order, tmp, keys, 8);
+                break;
+            default:
+                REALM_UNREACHABLE();
+        }
+
+        if (has_nulls)
+            partition_nulls(order, tmp, nulls, col.ascending);
+    }
+
+    std::vector<IndexPair> sorted;
+    sorted.reserve(size);
+    for (size_t pos : order)
+        sorted.push_back(std::move(v[pos]));
+    std::move(sorted.begin(), sorted.end(), v.begin());
+}
+
+// Order the entries by traversing the ordered index of the (single) sort
+// column. Entries with equal values are ordered by their index in the view, so
+// the result is the same as that of the stable sort done otherwise. The
+// traversal stops once `num_needed` entries have been ordered, and the rest
+// are left at the end in an unspecified order.
+void BaseDescriptor::Sorter::sort_by_index(IndexPairs& v, size_t num_needed) const
+{
+    size_t size = v.size();
+
+    // The positions in `v` ordered by key, so that the entries of an object
+    // can be found by binary search. A view may hold an object more than once.
+    std::vector<std::pair<ObjKey, size_t>> positions(size);
+    for (size_t pos = 0; pos < size; ++pos)
+        positions[pos] = {v[pos].key_for_object, pos};
+    if (!std::is_sorted(positions.begin(), positions.end()))
+        std::sort(positions.begin(), positions.end());
+
+    std::vector<IndexPair> sorted;
+    sorted.reserve(size);
+    std::vector<bool> taken(size);
+    auto take_run = [&](size_t begin, size_t end, const Mixed& value) {
+        size_t run_start = sorted.size();
+        for (size_t ndx = begin; ndx < end; ++ndx) {
+            ObjKey key = m_ordered_index->get_key(ndx);
+            auto it = std::lower_bound(positions.begin(), positions.end(), std::make_pair(key, size_t(0)));
+            for (; it != positions.end() && it->first == key; ++it) {
+                sorted.push_back(std::move(v[it->second]));
+                sorted.back().cached_value = value;
+                taken[it->second] = true;
             }
         }
+        // Only needed if the view is not in key order
+        if (!std::is_sorted(sorted.begin() + run_start, sorted.end()))
+            std::sort(sorted.begin() + run_start, sorted.end());
+    };
+
+    // Visit the runs of equal values in the requested order
+    size_t index_size = m_ordered_index->size();
+    bool ascending = m_columns[0].ascending;
+    size_t ndx = ascending ? 0 : index_size;
+    while (sorted.size() < size && sorted.size() < num_needed && (ascending ? ndx < index_size : ndx > 0)) {
+        size_t begin;
+        size_t end;
+        Mixed value;
+        if (ascending) {
+            begin = ndx;
+            value = m_ordered_index->get_value(begin);
+            end = begin + 1;
+            while (end < index_size && m_ordered_index->get_value(end).compare(value) == 0)
+                ++end;
+            ndx = end;
+        }
+        else {
+            end = ndx;
+            value = m_ordered_index->get_value(end - 1);
+            begin = end - 1;
+            while (begin > 0 && m_ordered_index->get_value(begin - 1).compare(value) == 0)
+                --begin;
+            ndx = begin;
+        }
+        take_run(begin, end, value);
+    }
 
-        index.cached_value = col.table->get_object(key).get_any(ck);
+    for (size_t pos = 0; pos < size; ++pos) {
+        if (!taken[pos])
+            sorted.push_back(std::move(v[pos]));
     }
+    std::move(sorted.begin(), sorted.end(), v.begin());
 }
 
 DescriptorOrdering::DescriptorOrdering(const DescriptorOrdering& other)
@@ -29,6 +29,7 @@
 namespace realm {
 
 class SortDescriptor;
+class OrderedIndex;
 class ConstTableRef;
 class Group;
 
@@ -80,7 +81,7 @@ public:
         {
         }
 
-        bool operator()(IndexPair i, IndexPair j, bool total_ordering = true) const;
+        bool operator()(const IndexPair& i, const IndexPair& j, bool total_ordering = true) const;
 
         bool has_links() const
         {
@@ -94,7 +95,20 @@ public:
                 return col.is_null.empty() ? false : col.is_null[i.index_in_view];
             });
         }
-        void cache_first_column(IndexPairs& v);
+        // Fetch the values to sort on. The values of the first column are
+        // stored in IndexPair::cached_value. For large inputs the values of the
+        // remaining columns are fetched up front as well (using the default
+        // thread pool), otherwise they are fetched lazily while comparing.
+        void cache_values(IndexPairs& v);
+
+        // Sort `v` using this predicate. Must be called after cache_values().
+        // Large inputs are sorted using several threads, or with a radix sort
+        // if all columns hold integers, booleans or timestamps. If the view is
+        // sorted on a single column with an ordered index, and covers a large
+        // part of the table, the order is read from the index instead. In that
+        // case only the first `num_needed` entries are guaranteed to be sorted
+        // (and to have their value cached).
+        void sort(IndexPairs& v, size_t num_needed = size_t(-1)) const;
 
     private:
         struct SortColumn {
@@ -106,6 +120,9 @@ public:
             }
             std::vector<bool> is_null;
             std::vector<ObjKey> translated_keys;
+            // Values indexed by IndexPair::index_in_view, if fetched up front.
+            // Not used for the first column.
+            std::vector<Mixed> values;
 
             const Table* table;
             ColKey col_key;
@@ -118,6 +135,12 @@ public:
         };
         using TableCache = std::vector<ObjCache>;
         mutable std::vector<TableCache> m_cache;
+        bool m_all_values_cached = false;
+        const OrderedIndex* m_ordered_index = nullptr;
+
+        bool can_radix_sort() const;
+        void radix_sort(IndexPairs& v) const;
+        void sort_by_index(IndexPairs& v, size_t num_needed) const;
 
         friend class ObjList;
     };
@@ -1,6 +1,10 @@
+#include <realm/sync/noinst/columnar_changeset.hpp>
 #include <realm/sync/noinst/integer_codec.hpp>
 #include <realm/sync/changeset_encoder.hpp>
 
+#include <array>
+#include <unordered_map>
+
 using namespace realm;
 using namespace realm::sync;
 
@@ -430,3 +434,416 @@ void ChangesetEncoder::encode_single(const Changeset& log)
         }
     }
 }
+
+
+namespace {
+
+using namespace realm::_impl::columnar;
+
+class ColumnarChangesetEncoder {
+public:
+    explicit ColumnarChangesetEncoder(const Changeset& log) noexcept
+        : m_log{log}
+    {
+    }
+
+    void encode(ChangesetEncoder::Buffer& out_buffer);
+
+#define REALM_DEFINE_INSTRUCTION_HANDLER(X) void operator()(const Instruction::X&);
+    REALM_FOR_EACH_INSTRUCTION_TYPE(REALM_DEFINE_INSTRUCTION_HANDLER)
+#undef REALM_DEFINE_INSTRUCTION_HANDLER
+
+private:
+    const Changeset& m_log;
+    std::array<util::AppendBuffer<char>, num_streams> m_streams;
+    // Maps each distinct string and binary value to its index in the
+    // dictionary of values that the parser rebuilds as it goes.
+    std::unordered_map<std::string_view, uint64_t> m_string_values;
+    uint64_t m_num_instructions = 0;
+    Instruction::Type m_run_type = Instruction::Type::AddTable;
+    uint64_t m_run_length = 0;
+    int64_t m_prev_table = 0;
+    int64_t m_prev_field = 0;
+    int64_t m_prev_int_key = 0;
+    int64_t m_prev_string_key = 0;
+
+    void append(Stream, uint64_t value);
+    void append_bytes(const void*, size_t);
+    void append_opcode(Instruction::Type);
+    void flush_opcodes();
+    void append_table(InternString);
+    void append_field(InternString);
+    void append_key(const Instruction::PrimaryKey&);
+    void append_path(const Instruction::Path&);
+    void append_path_instr(Instruction::Type, const Instruction::PathInstruction&);
+    void append_payload(const Instruction::Payload&);
+    void append_string(StringBufferRange);
+};
+
+inline void ColumnarChangesetEncoder::append(Stream stream, uint64_t value)
+{
+    char buffer[max_varint_size];
+    std::size_t n = encode_varint(value, buffer);
+    m_streams[std::size_t(stream)].append(buffer, n); // Throws
+}
+
+inline void ColumnarChangesetEncoder::append_bytes(const void* bytes, size_t size)
+{
+    m_streams[std::size_t(Stream::bytes)].append(static_cast<const char*>(bytes), size); // Throws
+}
+
+inline void ColumnarChangesetEncoder::append_opcode(Instruction::Type type)
+{
+    ++m_num_instructions;
+    if (m_run_length != 0 && type == m_run_type) {
+        ++m_run_length;
+        return;
+    }
+    flush_opcodes(); // Throws
+    m_run_type = type;
+    m_run_length = 1;
+}
+
+void ColumnarChangesetEncoder::flush_opcodes()
+{
+    if (m_run_length == 0)
+        return;
+    append(Stream::opcodes, uint64_t(m_run_type)); // Throws
+    append(Stream::opcodes, m_run_length);         // Throws
+    m_run_length = 0;
+}
+
+inline void ColumnarChangesetEncoder::append_table(InternString table)
+{
+    REALM_ASSERT(table != InternString::npos);
+    append(Stream::tables, delta_encode(m_prev_table, table.value)); // Throws
+    m_prev_table = table.value;
+}
+
+inline void ColumnarChangesetEncoder::append_field(InternString field)
+{
+    REALM_ASSERT(field != InternString::npos);
+    append(Stream::fields, delta_encode(m_prev_field, field.value)); // Throws
+    m_prev_field = field.value;
+}
+
+void ColumnarChangesetEncoder::append_key(const Instruction::PrimaryKey& pk)
+{
+    using Type = Instruction::Payload::Type;
+    auto append_type = [&](Type type) {
+        append(Stream::key_types, zigzag_encode(int64_t(type))); // Throws
+    };
+    auto append_key = util::overload{
+        [&](mpark::monostate) {
+            append_type(Type::Null);
+        },
+        [&](int64_t value) {
+            append_type(Type::Int);
+            append(Stream::int_keys, delta_encode(m_prev_int_key, value));
+            m_prev_int_key = value;
+        },
+        [&](InternString str) {
+            REALM_ASSERT(str != InternString::npos);
+            append_type(Type::String);
+            append(Stream::string_keys, delta_encode(m_prev_string_key, str.value));
+            m_prev_string_key = str.value;
+        },
+        [&](GlobalKey key) {
+            append_type(Type::GlobalKey);
+            append(Stream::sizes, key.hi());
+            append(Stream::sizes, key.lo());
+        },
+        [&](ObjectId id) {
+            append_type(Type::ObjectId);
+            append_bytes(&id, sizeof(id));
+        },
+        [&](UUID uuid) {
+            append_type(Type::UUID);
+            const auto bytes = uuid.to_bytes();
+            append_bytes(bytes.data(), bytes.size());
+        },
+    };
+    mpark::visit(std::move(append_key), pk); // Throws
+}
+
+void ColumnarChangesetEncoder::append_path(const Instruction::Path& path)
+{
+    // Integer path elements are encoded as twice their value, and string path
+    // elements as twice their intern string index plus one.
+    append(Stream::paths, path.m_path.size()); // Throws
+    for (auto& element : path.m_path) {
+        if (auto index = mpark::get_if<uint32_t>(&element)) {
+            append(Stream::paths, uint64_t(*index) << 1); // Throws
+        }
+        else if (auto name = mpark::get_if<InternString>(&element)) {
+            REALM_ASSERT(*name != InternString::npos);
+            append(Stream::paths, (uint64_t(name->value) << 1) | 1); // Throws
+        }
+    }
+}
+
+void ColumnarChangesetEncoder::append_path_instr(Instruction::Type type, const Instruction::PathInstruction& instr)
+{
+    append_opcode(type);       // Throws
+    append_table(instr.table); // Throws
+    append_key(instr.object);  // Throws
+    append_field(instr.field); // Throws
+    append_path(instr.path);   // Throws
+}
+
+void ColumnarChangesetEncoder::append_string(StringBufferRange range)
+{
+    StringData str = m_log.get_string(range);
+    std::string_view view{str.data(), str.size()};
+    auto [it, inserted] = m_string_values.emplace(view, m_string_values.size()); // Throws
+    if (!inserted) {
+        append(Stream::strings, it->second + 1); // Throws
+        return;
+    }
+    append(Stream::strings, 0);           // Throws
+    append(Stream::sizes, str.size());    // Throws
+    append_bytes(str.data(), str.size()); // Throws
+}
+
+void ColumnarChangesetEncoder::append_payload(const Instruction::Payload& payload)
+{
+    using Type = Instruction::Payload::Type;
+
+    append(Stream::value_types, zigzag_encode(int64_t(payload.type))); // Throws
+    const auto& data = payload.data;
+
+    switch (payload.type) {
+        case Type::GlobalKey: {
+            append(Stream::sizes, data.key.hi());
+            append(Stream::sizes, data.key.lo());
+            return;
+        }
+        case Type::Int: {
+            append(Stream::ints, zigzag_encode(data.integer));
+            return;
+        }
+        case Type::Bool: {
+            append(Stream::sizes, uint64_t(data.boolean));
+            return;
+        }
+        case Type::String: {
+            append_string(data.str);
+            return;
+        }
+        case Type::Binary: {
+            append_string(data.binary);
+            return;
+        }
+        case Type::Timestamp: {
+            append(Stream::ints, zigzag_encode(data.timestamp.get_seconds()));
+            append(Stream::ints, zigzag_encode(data.timestamp.get_nanoseconds()));
+            return;
+        }
+        case Type::Float: {
+            append_bytes(&data.fnum, sizeof(data.fnum));
+            return;
+        }
+        case Type::Double: {
+            append_bytes(&data.dnum, sizeof(data.dnum));
+            return;
+        }
+        case Type::Decimal: {
+            append_bytes(data.decimal.raw(), sizeof(Decimal128::Bid128));
+            return;
+        }
+        case Type::ObjectId: {
+            append_bytes(&data.object_id, sizeof(data.object_id));
+            return;
+        }
+        case Type::UUID: {
+            const auto bytes = data.uuid.to_bytes();
+            append_bytes(bytes.data(), bytes.size());
+            return;
+        }
+        case Type::Link: {
+            REALM_ASSERT(data.link.target_table != InternString::npos);
+            append(Stream::sizes, data.link.target_table.value);
+            append_key(data.link.target);
+            return;
+        }
+        case Type::Erased:
+            [[fallthrough]];
+        case Type::Dictionary:
+            [[fallthrough]];
+        case Type::ObjectValue:
+            [[fallthrough]];
+        case Type::Null:
+            // The payload type does not carry additional data.
+            return;
+    }
+    REALM_TERMINATE("Invalid payload type.");
+}
+
+void ColumnarChangesetEncoder::operator()(const Instruction::AddTable& instr)
+{
+    append_opcode(Instruction::Type::AddTable);
+    append_table(instr.table);
+    if (auto spec = mpark::get_if<Instruction::AddTable::TopLevelTable>(&instr.type)) {
+        auto table_type = spec->is_asymmetric ? Table::Type::TopLevelAsymmetric : Table::Type::TopLevel;
+        append(Stream::sizes, uint64_t(table_type));
+        append_field(spec->pk_field);
+        append(Stream::value_types, zigzag_encode(int64_t(spec->pk_type)));
+        append(Stream::sizes, uint64_t(spec->pk_nullable));
+    }
+    else {
+        append(Stream::sizes, uint64_t(Table::Type::Embedded));
+    }
+}
+
+void ColumnarChangesetEncoder::operator()(const Instruction::EraseTable& instr)
+{
+    append_opcode(Instruction::Type::EraseTable);
+    append_table(instr.table);
+}
+
+void ColumnarChangesetEncoder::operator()(const Instruction::CreateObject& instr)
+{
+    append_opcode(Instruction::Type::CreateObject);
+    append_table(instr.table);
+    append_key(instr.object);
+}
+
+void ColumnarChangesetEncoder::operator()(const Instruction::EraseObject& instr)
+{
+    append_opcode(Instruction::Type::EraseObject);
+    append_table(instr.table);
+    append_key(instr.object);
+}
+
+void ColumnarChangesetEncoder::operator()(const Instruction::Update& instr)
+{
+    append_path_instr(Instruction::Type::Update, instr);
+    append_payload(instr.value);
+    if (instr.is_array_update()) {
+        append(Stream::sizes, instr.prior_size);
+    }
+    else {
+        append(Stream::sizes, uint64_t(instr.is_default));
+    }
+}
+
+void ColumnarChangesetEncoder::operator()(const Instruction::AddInteger& instr)
+{
+    append_path_instr(Instruction::Type::AddInteger, instr);
+    append(Stream::ints, zigzag_encode(instr.value));
+}
+
+void ColumnarChangesetEncoder::operator()(const Instruction::AddColumn& instr)
+{
+    bool is_dictionary = (instr.collection_type == Instruction::AddColumn::CollectionType::Dictionary);
+    // Mixed columns are always nullable.
+    REALM_ASSERT(instr.type != Instruction::Payload::Type::Null || instr.nullable || is_dictionary);
+    append_opcode(Instruction::Type::AddColumn);
+    append_table(instr.table);
+    append_field(instr.field);
+    append(Stream::value_types, zigzag_encode(int64_t(instr.type)));
+    append(Stream::sizes, uint64_t(instr.nullable));
+    append(Stream::sizes, uint64_t(instr.collection_type));
+    if (instr.type == Instruction::Payload::Type::Link) {
+        REALM_ASSERT(instr.link_target_table != InternString::npos);
+        append(Stream::sizes, instr.link_target_table.value);
+    }
+    if (is_dictionary) {
+        append(Stream::value_types, zigzag_encode(int64_t(instr.key_type)));
+    }
+}
+
+void ColumnarChangesetEncoder::operator()(const Instruction::EraseColumn& instr)
+{
+    append_opcode(Instruction::Type::EraseColumn);
+    append_table(instr.table);
+    append_field(instr.field);
+}
+
+void ColumnarChangesetEncoder::operator()(const Instruction::ArrayInsert& instr)
+{
+    append_path_instr(Instruction::Type::ArrayInsert, instr);
+    append_payload(instr.value);
+    append(Stream::sizes, instr.prior_size);
+}
+
+void ColumnarChangesetEncoder::operator()(const Instruction::ArrayMove& instr)
+{
+    append_path_instr(Instruction::Type::ArrayMove, instr);
+    append(Stream::sizes, instr.ndx_2);
+    append(Stream::sizes, instr.prior_size);
+}
+
+void ColumnarChangesetEncoder::operator()(const Instruction::ArrayErase& instr)
+{
+    append_path_instr(Instruction::Type::ArrayErase, instr);
+    append(Stream::sizes, instr.prior_size);
+}
+
+void ColumnarChangesetEncoder::operator()(const Instruction::Clear& instr)
+{
+    append_path_instr(Instruction::Type::Clear, instr);
+}
+
+void ColumnarChangesetEncoder::operator()(const Instruction::SetInsert& instr)
+{
+    append_path_instr(Instruction::Type::SetInsert, instr);
+    append_payload(instr.value);
+}
+
+void ColumnarChangesetEncoder::operator()(const Instruction::SetErase& instr)
+{
+    append_path_instr(Instruction::Type::SetErase, instr);
+    append_payload(instr.value);
+}
+
+void ColumnarChangesetEncoder::encode(ChangesetEncoder::Buffer& out_buffer)
+{
+    // As for the regular encoding, an empty changeset is encoded as nothing at
+    // all.
+    if (m_log.empty())
+        return;
+
+    const auto& strings = m_log.interned_strings();
+    for (const StringBufferRange& range : strings) {
+        StringData str = m_log.get_string(range);
+        append(Stream::sizes, str.size());    // Throws
+        append_bytes(str.data(), str.size()); // Throws
+    }
+    for (auto instr : m_log) {
+        if (!instr)
+            continue;
+        instr->visit(*this); // Throws
+    }
+    flush_opcodes(); // Throws
+
+    char buffer[max_varint_size];
+    auto append_header = [&](uint64_t value) {
+        out_buffer.append(buffer, encode_varint(value, buffer)); // Throws
+    };
+    char magic = char(ColumnarChangesetMagic);
+    out_buffer.append(&magic, 1); // Throws
+    append_header(format_version);
+    append_header(strings.size());
+    append_header(m_num_instructions);
+    std::size_t streams_size = 0;
+    for (const auto& stream : m_streams) {
+        append_header(stream.size());
+        streams_size += stream.size();
+    }
+    out_buffer.reserve(out_buffer.size() + streams_size); // Throws
+    for (const auto& stream : m_streams)
+        out_buffer.append(stream.data(), stream.size());
+}
+
+} // unnamed namespace
+
+namespace realm::sync {
+
+void encode_changeset_columnar(const Changeset& changeset, ChangesetEncoder::Buffer& out_buffer)
+{
+    ColumnarChangesetEncoder encoder{changeset};
+    encoder.encode(out_buffer); // Throws
+}
+
+} // namespace realm::sync
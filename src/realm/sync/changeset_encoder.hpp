@@ -104,6 +104,14 @@ inline void encode_changeset(const Changeset& changeset, ChangesetEncoder::Buffe
     swap(encoder.buffer(), out_buffer);
 }
 
+/// Encode the changeset in the columnar format, which stores each kind of
+/// instruction field in a separate stream, delta encodes object keys,
+/// run-length encodes the instruction types, and stores repeated string values
+/// only once. This is both smaller and faster to encode and parse than the
+/// format produced by encode_changeset(), and is what changesets are sent as
+/// from sync protocol version 8. parse_changeset() accepts both formats.
+void encode_changeset_columnar(const Changeset&, ChangesetEncoder::Buffer& out_buffer);
+
 } // namespace sync
 } // namespace realm
 
@@ -5,17 +5,82 @@
 #include <realm/mixed.hpp>
 #include <realm/sync/changeset.hpp>
 #include <realm/sync/instructions.hpp>
+#include <realm/sync/noinst/columnar_changeset.hpp>
 #include <realm/sync/noinst/integer_codec.hpp>
 #include <realm/table.hpp>
 #include <realm/util/base64.hpp>
+#include <realm/utilities.hpp>
 
+#include <array>
+#include <cstring>
 #include <unordered_set>
+#include <vector>
+
+#ifdef REALM_COMPILER_SSE
+#include <emmintrin.h> // SSE2
+#endif
 
 using namespace realm;
 using namespace realm::sync;
 
 namespace {
 
+bool is_valid_payload_type(Instruction::Payload::Type type) noexcept
+{
+    using Type = Instruction::Payload::Type;
+    switch (type) {
+        case Type::GlobalKey:
+            [[fallthrough]];
+        case Type::Erased:
+            [[fallthrough]];
+        case Type::Dictionary:
+            [[fallthrough]];
+        case Type::ObjectValue:
+            [[fallthrough]];
+        case Type::Null:
+            [[fallthrough]];
+        case Type::Int:
+            [[fallthrough]];
+        case Type::Bool:
+            [[fallthrough]];
+        case Type::String:
+            [[fallthrough]];
+        case Type::Binary:
+            [[fallthrough]];
+        case Type::Timestamp:
+            [[fallthrough]];
+        case Type::Float:
+            [[fallthrough]];
+        case Type::Double:
+            [[fallthrough]];
+        case Type::Decimal:
+            [[fallthrough]];
+        case Type::Link:
+            [[fallthrough]];
+        case Type::ObjectId:
+            [[fallthrough]];
+        case Type::UUID:
+            return true;
+    }
+    return false;
+}
+
+bool is_valid_collection_type(Instruction::AddColumn::CollectionType type) noexcept
+{
+    using CollectionType = Instruction::AddColumn::CollectionType;
+    switch (type) {
+        case CollectionType::Single:
+            [[fallthrough]];
+        case CollectionType::List:
+            [[fallthrough]];
+        case CollectionType::Dictionary:
+            [[fallthrough]];
+        case CollectionType::Set:
+            return true;
+    }
+    return false;
+}
+
 struct State {
     util::NoCopyInputStream& m_input;
     InstructionHandler& m_handler;
@@ -125,6 +190,11 @@ struct InstructionBuilder : InstructionHandler {
         return m_log.append_string(string);
     }
 
+    bool keeps_string_ranges() const noexcept final
+    {
+        return true;
+    }
+
     void set_intern_string(uint32_t index, StringBufferRange range) final
     {
         InternStrings& strings = m_log.interned_strings();
@@ -135,62 +205,18 @@ struct InstructionBuilder : InstructionHandler {
 
 Instruction::Payload::Type State::read_payload_type()
 {
-    using Type = Instruction::Payload::Type;
     auto type = Instruction::Payload::Type(read_int());
-    // Validate the type.
-    switch (type) {
-        case Type::GlobalKey:
-            [[fallthrough]];
-        case Type::Erased:
-            [[fallthrough]];
-        case Type::Dictionary:
-            [[fallthrough]];
-        case Type::ObjectValue:
-            [[fallthrough]];
-        case Type::Null:
-            [[fallthrough]];
-        case Type::Int:
-            [[fallthrough]];
-        case Type::Bool:
-            [[fallthrough]];
-        case Type::String:
-            [[fallthrough]];
-        case Type::Binary:
-            [[fallthrough]];
-        case Type::Timestamp:
-            [[fallthrough]];
-        case Type::Float:
-            [[fallthrough]];
-        case Type::Double:
-            [[fallthrough]];
-        case Type::Decimal:
-            [[fallthrough]];
-        case Type::Link:
-            [[fallthrough]];
-        case Type::ObjectId:
-            [[fallthrough]];
-        case Type::UUID:
-            return type;
-    }
-    parser_error("Unsupported data type");
+    if (!is_valid_payload_type(type))
+        parser_error("Unsupported data type");
+    return type;
 }
 
 Instruction::AddColumn::CollectionType State::read_collection_type()
 {
-    using CollectionType = Instruction::AddColumn::CollectionType;
     auto type = Instruction::AddColumn::CollectionType(read_int<uint8_t>());
-    // Validate the type.
-    switch (type) {
-        case CollectionType::Single:
-            [[fallthrough]];
-        case CollectionType::List:
-            [[fallthrough]];
-        case CollectionType::Dictionary:
-            [[fallthrough]];
-        case CollectionType::Set:
-            return type;
-    }
-    parser_error("Unsupported collection type");
+    if (!is_valid_collection_type(type))
+        parser_error("Unsupported collection type");
+    return type;
 }
 
 Instruction::Payload State::read_payload()
@@ -668,6 +694,696 @@ void State::parser_error(const char* complaints)
     throw BadChangesetError{complaints};
 }
 
+
+// Decoding of changesets in the columnar format produced by
+// encode_changeset_columnar(). See columnar_changeset.hpp.
+
+using namespace realm::_impl::columnar;
+
+constexpr std::size_t bad_varints = std::size_t(-1);
+
+// Decodes up to `max_values` unsigned LEB128 integers from the range
+// [`begin`, `end`) into `out`, and advances `begin` past them. Returns the
+// number of decoded values, or `bad_varints` if the input is malformed.
+std::size_t decode_varints(const char*& begin, const char* end, uint64_t* out, std::size_t max_values) noexcept
+{
+    using uchar = unsigned char;
+    const char* ptr = begin;
+    std::size_t n = 0;
+#ifdef REALM_COMPILER_SSE
+    // Process 16 bytes at a time, as long as there is room for the up to 16
+    // values that they can hold. The continuation bits of all 16 bytes are
+    // gathered into a mask, which gives the position of the last byte of each
+    // value.
+    const __m128i zero = _mm_setzero_si128();
+    while (max_values - n >= 16 && end - ptr >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+        unsigned continuation_bits = unsigned(_mm_movemask_epi8(chunk));
+        if (continuation_bits == 0) {
+            // Sixteen single-byte values, by far the most common case, as
+            // most values are small or delta encoded. Zero-extend them to 64
+            // bits.
+            __m128i lo = _mm_unpacklo_epi8(chunk, zero);
+            __m128i hi = _mm_unpackhi_epi8(chunk, zero);
+            __m128i quarters[4] = {_mm_unpacklo_epi16(lo, zero), _mm_unpackhi_epi16(lo, zero),
+                                   _mm_unpacklo_epi16(hi, zero), _mm_unpackhi_epi16(hi, zero)};
+            for (int i = 0; i < 4; ++i) {
+                __m128i* out_2 = reinterpret_cast<__m128i*>(out + n + 4 * i);
+                _mm_storeu_si128(out_2, _mm_unpacklo_epi32(quarters[i], zero));
+                _mm_storeu_si128(out_2 + 1, _mm_unpackhi_epi32(quarters[i], zero));
+            }
+            n += 16;
+            ptr += 16;
+            continue;
+        }
+        unsigned end_bits = ~continuation_bits & 0xFFFF;
+        if (end_bits == 0)
+            return bad_varints; // Too many bytes
+        const char* value_begin = ptr;
+        do {
+            const char* value_end = ptr + ctz(end_bits) + 1;
+            std::size_t size = std::size_t(value_end - value_begin);
+            if (size > max_varint_size || (size == max_varint_size && uchar(value_end[-1]) > 1))
+                return bad_varints; // Encoded value too large
+            uint64_t value = 0;
+            for (std::size_t i = 0; i < size; ++i)
+                value |= uint64_t(uchar(value_begin[i]) & 0x7F) << (7 * i);
+            out[n++] = value;
+            value_begin = value_end;
+            end_bits &= end_bits - 1;
+        } while (end_bits != 0);
+        // Any trailing bytes with continuation bits are part of a value that
+        // ends in the next chunk.
+        ptr = value_begin;
+    }
+#endif
+    while (n < max_values && ptr != end) {
+        if (!decode_varint(ptr, end, out[n]))
+            return bad_varints;
+        ++n;
+    }
+    begin = ptr;
+    return n;
+}
+
+// A stream of unsigned LEB128 integers, which are decoded in blocks as they
+// are read, such that memory usage stays constant.
+class VarintStream {
+public:
+    void reset(const char* begin, const char* end) noexcept
+    {
+        m_begin = begin;
+        m_end = end;
+        m_pos = 0;
+        m_size = 0;
+    }
+
+    // Returns false if the stream is exhausted, or if it is malformed.
+    bool read(uint64_t& value) noexcept
+    {
+        if (REALM_UNLIKELY(m_pos == m_size) && !refill())
+            return false;
+        value = m_values[m_pos++];
+        return true;
+    }
+
+    bool at_end() const noexcept
+    {
+        return m_pos == m_size && m_begin == m_end;
+    }
+
+private:
+    static constexpr std::size_t s_block_size = 64;
+
+    const char* m_begin = nullptr;
+    const char* m_end = nullptr;
+    std::size_t m_pos = 0;
+    std::size_t m_size = 0;
+    uint64_t m_values[s_block_size];
+
+    bool refill() noexcept
+    {
+        std::size_t n = decode_varints(m_begin, m_end, m_values, s_block_size);
+        if (n == bad_varints || n == 0)
+            return false;
+        m_pos = 0;
+        m_size = n;
+        return true;
+    }
+};
+
+struct ColumnarHeader {
+    uint64_t num_intern_strings;
+    uint64_t num_instructions;
+    std::array<std::size_t, num_streams> stream_sizes;
+    // The size of everything up to the first stream
+    std::size_t header_size;
+    // The size of the whole changeset
+    std::size_t size;
+};
+
+// Returns false if the header is malformed, or if it is not entirely contained
+// in the specified range.
+bool parse_columnar_header(const char* begin, const char* end, ColumnarHeader& header) noexcept
+{
+    const char* ptr = begin;
+    if (ptr == end || static_cast<unsigned char>(*ptr++) != ColumnarChangesetMagic)
+        return false;
+    uint64_t version;
+    if (!decode_varint(ptr, end, version) || version != format_version)
+        return false;
+    if (!decode_varint(ptr, end, header.num_intern_strings) ||
+        header.num_intern_strings > std::numeric_limits<uint32_t>::max())
+        return false;
+    if (!decode_varint(ptr, end, header.num_instructions))
+        return false;
+    std::size_t streams_size = 0;
+    for (std::size_t& stream_size : header.stream_sizes) {
+        uint64_t size;
+        if (!decode_varint(ptr, end, size) || util::int_cast_with_overflow_detect(size, stream_size))
+            return false;
+        if (util::int_add_with_overflow_detect(streams_size, stream_size))
+            return false;
+    }
+    header.header_size = std::size_t(ptr - begin);
+    header.size = header.header_size;
+    return !util::int_add_with_overflow_detect(header.size, streams_size);
+}
+
+struct ColumnarState {
+    InstructionHandler& m_handler;
+
+    explicit ColumnarState(InstructionHandler& handler)
+        : m_handler(handler)
+    {
+    }
+
+    std::array<VarintStream, num_streams - 1> m_streams;
+    const char* m_bytes_begin = nullptr;
+    const char* m_bytes_end = nullptr;
+
+    uint64_t m_num_intern_strings = 0;
+    // The string and binary values seen so far, which later values may refer
+    // to. They point into the input, which outlives the state. If the handler
+    // keeps its string ranges, a value is added to it once, and the range is
+    // used for all its occurrences.
+    struct StringValue {
+        StringData data;
+        util::Optional<StringBufferRange> range;
+    };
+    std::vector<StringValue> m_string_values;
+
+    int64_t m_prev_table = 0;
+    int64_t m_prev_field = 0;
+    int64_t m_prev_int_key = 0;
+    int64_t m_prev_string_key = 0;
+
+    // `data` must point to a changeset whose header has already been parsed.
+    void parse(const ColumnarHeader& header, const char* data); // Throws
+    void parse_instruction(Instruction::Type);                  // Throws
+
+    uint64_t read(Stream);                                     // Throws
+    uint32_t read_uint32(Stream);                              // Throws
+    int64_t read_signed(Stream);                               // Throws
+    bool read_bool();                                          // Throws
+    const char* read_bytes(std::size_t size);                  // Throws
+    StringData read_new_string();                              // Throws
+    StringBufferRange read_string_value(Instruction::Payload::Type); // Throws
+    InternString read_intern_string(uint64_t index);           // Throws
+    InternString read_table();                                 // Throws
+    InternString read_field();                                 // Throws
+    Instruction::Payload::Type read_payload_type(Stream);      // Throws
+    Instruction::PrimaryKey read_object_key();                 // Throws
+    Instruction::Path read_path();                             // Throws
+    Instruction::Payload read_payload();                       // Throws
+    void read_path_instr(Instruction::PathInstruction& instr); // Throws
+
+    REALM_NORETURN void parser_error(const char* complaint); // Throws
+};
+
+void ColumnarState::parse(const ColumnarHeader& header, const char* data)
+{
+    const char* ptr = data + header.header_size;
+    for (std::size_t i = 0; i < m_streams.size(); ++i) {
+        m_streams[i].reset(ptr, ptr + header.stream_sizes[i]);
+        ptr += header.stream_sizes[i];
+    }
+    m_bytes_begin = ptr;
+    m_bytes_end = ptr + header.stream_sizes[std::size_t(Stream::bytes)];
+
+    m_num_intern_strings = header.num_intern_strings;
+    {
+        std::unordered_set<std::string_view> intern_strings;
+        for (uint64_t i = 0; i < m_num_intern_strings; ++i) {
+            StringData str = read_new_string();
+            if (str.size() > realm::Table::max_string_size)
+                parser_error("string too long");
+            if (!intern_strings.insert(std::string_view{str.data(), str.size()}).second)
+                parser_error("Unexpected intern string");
+            StringBufferRange range = m_handler.add_string_range(str);
+            m_handler.set_intern_string(uint32_t(i), range);
+        }
+    }
+
+    uint64_t num_remaining = header.num_instructions;
+    while (num_remaining != 0) {
+        uint64_t type = read(Stream::opcodes);
+        uint64_t run_length = read(Stream::opcodes);
+        if (run_length == 0 || run_length > num_remaining)
+            parser_error("Bad instruction run length");
+        if (type > std::numeric_limits<uint8_t>::max())
+            parser_error("unknown instruction");
+        num_remaining -= run_length;
+        for (uint64_t i = 0; i < run_length; ++i)
+            parse_instruction(Instruction::Type(type));
+    }
+
+    for (const VarintStream& stream : m_streams) {
+        if (!stream.at_end())
+            parser_error("Unexpected data at end of stream");
+    }
+    if (m_bytes_begin != m_bytes_end)
+        parser_error("Unexpected data at end of stream");
+}
+
+void ColumnarState::parse_instruction(Instruction::Type type)
+{
+    switch (type) {
+        case Instruction::Type::AddTable: {
+            Instruction::AddTable instr;
+            instr.table = read_table();
+            uint64_t table_type = read(Stream::sizes);
+            if (table_type == uint64_t(Table::Type::TopLevel) ||
+                table_type == uint64_t(Table::Type::TopLevelAsymmetric)) {
+                Instruction::AddTable::TopLevelTable spec;
+                spec.pk_field = read_field();
+                spec.pk_type = read_payload_type(Stream::value_types);
+                if (!is_valid_key_type(spec.pk_type)) {
+                    parser_error("Invalid primary key type in AddTable");
+                }
+                spec.pk_nullable = read_bool();
+                spec.is_asymmetric = (table_type == uint64_t(Table::Type::TopLevelAsymmetric));
+                instr.type = spec;
+            }
+            else if (table_type == uint64_t(Table::Type::Embedded)) {
+                instr.type = Instruction::AddTable::EmbeddedTable{};
+            }
+            else {
+                parser_error("AddTable: unknown table type");
+            }
+            m_handler(instr);
+            return;
+        }
+        case Instruction::Type::EraseTable: {
+            Instruction::EraseTable instr;
+            instr.table = read_table();
+            m_handler(instr);
+            return;
+        }
+        case Instruction::Type::CreateObject: {
+            Instruction::CreateObject instr;
+            instr.table = read_table();
+            instr.object = read_object_key();
+            m_handler(instr);
+            return;
+        }
+        case Instruction::Type::EraseObject: {
+            Instruction::EraseObject instr;
+            instr.table = read_table();
+            instr.object = read_object_key();
+            m_handler(instr);
+            return;
+        }
+        case Instruction::Type::Update: {
+            Instruction::Update instr;
+            read_path_instr(instr);
+            instr.value = read_payload();
+            if (!instr.is_array_update()) {
+                instr.is_default = read_bool();
+            }
+            else {
+                instr.prior_size = read_uint32(Stream::sizes);
+            }
+            m_handler(instr);
+            return;
+        }
+        case Instruction::Type::AddInteger: {
+            Instruction::AddInteger instr;
+            read_path_instr(instr);
+            instr.value = read_signed(Stream::ints);
+            m_handler(instr);
+            return;
+        }
+        case Instruction::Type::AddColumn: {
+            Instruction::AddColumn instr;
+            instr.table = read_table();
+            instr.field = read_field();
+            instr.type = read_payload_type(Stream::value_types);
+            instr.nullable = read_bool();
+            uint64_t collection_type = read(Stream::sizes);
+            instr.collection_type = Instruction::AddColumn::CollectionType(uint8_t(collection_type));
+            if (collection_type > std::numeric_limits<uint8_t>::max() ||
+                !is_valid_collection_type(instr.collection_type))
+                parser_error("Unsupported collection type");
+            if (instr.type == Instruction::Payload::Type::Link) {
+                instr.link_target_table = read_intern_string(read(Stream::sizes));
+            }
+            if (instr.collection_type == Instruction::AddColumn::CollectionType::Dictionary) {
+                instr.key_type = read_payload_type(Stream::value_types);
+            }
+            else {
+                instr.key_type = Instruction::Payload::Type::Null;
+            }
+            m_handler(instr);
+            return;
+        }
+        case Instruction::Type::EraseColumn: {
+            Instruction::EraseColumn instr;
+            instr.table = read_table();
+            instr.field = read_field();
+            m_handler(instr);
+            return;
+        }
+        case Instruction::Type::ArrayInsert: {
+            Instruction::ArrayInsert instr;
+            read_path_instr(instr);
+            if (!instr.path.is_array_index()) {
+                parser_error("ArrayInsert without an index");
+            }
+            instr.value = read_payload();
+            instr.prior_size = read_uint32(Stream::sizes);
+            m_handler(instr);
+            return;
+        }
+        case Instruction::Type::ArrayMove: {
+            Instruction::ArrayMove instr;
+            read_path_instr(instr);
+            if (!instr.path.is_array_index()) {
+                parser_error("ArrayMove without an index");
+            }
+            instr.ndx_2 = read_uint32(Stream::sizes);
+            instr.prior_size = read_uint32(Stream::sizes);
+            m_handler(instr);
+            return;
+        }
+        case Instruction::Type::ArrayErase: {
+            Instruction::ArrayErase instr;
+            read_path_instr(instr);
+            if (!instr.path.is_array_index()) {
+                parser_error("ArrayErase without an index");
+            }
+            instr.prior_size = read_uint32(Stream::sizes);
+            m_handler(instr);
+            return;
+        }
+        case Instruction::Type::Clear: {
+            Instruction::Clear instr;
+            read_path_instr(instr);
+            m_handler(instr);
+            return;
+        }
+        case Instruction::Type::SetInsert: {
+            Instruction::SetInsert instr;
+            read_path_instr(instr);
+            instr.value = read_payload();
+            m_handler(instr);
+            return;
+        }
+        case Instruction::Type::SetErase: {
+            Instruction::SetErase instr;
+            read_path_instr(instr);
+            instr.value = read_payload();
+            m_handler(instr);
+            return;
+        }
+    }
+
+    parser_error("unknown instruction");
+}
+
+inline uint64_t ColumnarState::read(Stream stream)
+{
+    uint64_t value;
+    if (REALM_LIKELY(m_streams[std::size_t(stream)].read(value)))
+        return value;
+    parser_error("bad changeset - integer decoding failure");
+}
+
+uint32_t ColumnarState::read_uint32(Stream stream)
+{
+    uint64_t value = read(stream);
+    if (value > std::numeric_limits<uint32_t>::max())
+        parser_error("bad changeset - integer decoding failure");
+    return uint32_t(value);
+}
+
+inline int64_t ColumnarState::read_signed(Stream stream)
+{
+    return zigzag_decode(read(stream));
+}
+
+bool ColumnarState::read_bool()
+{
+    uint64_t value = read(Stream::sizes);
+    if (value > 1)
+        parser_error("bad changeset - integer decoding failure");
+    return value != 0;
+}
+
+const char* ColumnarState::read_bytes(std::size_t size)
+{
+    if (std::size_t(m_bytes_end - m_bytes_begin) < size)
+        parser_error("truncated input");
+    const char* bytes = m_bytes_begin;
+    m_bytes_begin += size;
+    return bytes;
+}
+
+StringData ColumnarState::read_new_string()
+{
+    uint64_t size = read(Stream::sizes);
+    if (size > std::size_t(m_bytes_end - m_bytes_begin))
+        parser_error("truncated input");
+    return StringData{read_bytes(std::size_t(size)), std::size_t(size)};
+}
+
+StringBufferRange ColumnarState::read_string_value(Instruction::Payload::Type type)
+{
+    uint64_t index = read(Stream::strings);
+    StringValue* value = nullptr;
+    if (index == 0) {
+        value = &m_string_values.emplace_back(StringValue{read_new_string(), util::none}); // Throws
+    }
+    else if (index <= m_string_values.size()) {
+        value = &m_string_values[std::size_t(index - 1)];
+    }
+    else {
+        parser_error("Invalid string value reference");
+    }
+    if (type == Instruction::Payload::Type::String && value->data.size() > realm::Table::max_string_size)
+        parser_error("string too long");
+    if (value->range)
+        return *value->range;
+    StringBufferRange range = m_handler.add_string_range(value->data); // Throws
+    if (m_handler.keeps_string_ranges())
+        value->range = range;
+    return range;
+}
+
+InternString ColumnarState::read_intern_string(uint64_t index)
+{
+    if (index >= m_num_intern_strings)
+        parser_error("Invalid interned string");
+    return InternString{uint32_t(index)};
+}
+
+inline InternString ColumnarState::read_table()
+{
+    m_prev_table = delta_decode(m_prev_table, read(Stream::tables));
+    return read_intern_string(uint64_t(m_prev_table));
+}
+
+inline InternString ColumnarState::read_field()
+{
+    m_prev_field = delta_decode(m_prev_field, read(Stream::fields));
+    return read_intern_string(uint64_t(m_prev_field));
+}
+
+Instruction::Payload::Type ColumnarState::read_payload_type(Stream stream)
+{
+    int64_t value = read_signed(stream);
+    auto type = Instruction::Payload::Type(int8_t(value));
+    if (value != int64_t(type) || !is_valid_payload_type(type))
+        parser_error("Unsupported data type");
+    return type;
+}
+
+Instruction::PrimaryKey ColumnarState::read_object_key()
+{
+    using Type = Instruction::Payload::Type;
+    Type type = read_payload_type(Stream::key_types);
+    switch (type) {
+        case Type::Null:
+            return mpark::monostate{};
+        case Type::Int:
+            m_prev_int_key = delta_decode(m_prev_int_key, read(Stream::int_keys));
+            return m_prev_int_key;
+        case Type::String:
+            m_prev_string_key = delta_decode(m_prev_string_key, read(Stream::string_keys));
+            return read_intern_string(uint64_t(m_prev_string_key));
+        case Type::GlobalKey: {
+            uint64_t hi = read(Stream::sizes);
+            uint64_t lo = read(Stream::sizes);
+            return GlobalKey{hi, lo};
+        }
+        case Type::ObjectId: {
+            ObjectId id;
+            std::memcpy(&id, read_bytes(sizeof(id)), sizeof(id));
+            return id;
+        }
+        case Type::UUID: {
+            UUID::UUIDBytes bytes{};
+            std::memcpy(bytes.data(), read_bytes(bytes.size()), bytes.size());
+            return UUID(bytes);
+        }
+        default:
+            break;
+    }
+    parser_error("Unsupported object key type");
+}
+
+Instruction::Path ColumnarState::read_path()
+{
+    Instruction::Path path;
+    uint64_t path_len = read(Stream::paths);
+
+    // Note: Not reserving `path_len`, because a corrupt changeset could cause std::bad_alloc to be thrown.
+    if (path_len != 0)
+        path.m_path.reserve(16);
+
+    for (uint64_t i = 0; i < path_len; ++i) {
+        uint64_t element = read(Stream::paths);
+        if ((element & 1) == 0) {
+            // Integer path element
+            if ((element >> 1) > std::numeric_limits<uint32_t>::max())
+                parser_error("bad changeset - integer decoding failure");
+            path.m_path.emplace_back(uint32_t(element >> 1));
+        }
+        else {
+            // String path element
+            path.m_path.emplace_back(read_intern_string(element >> 1));
+        }
+    }
+
+    return path;
+}
+
+void ColumnarState::read_path_instr(Instruction::PathInstruction& instr)
+{
+    instr.table = read_table();
+    instr.object = read_object_key();
+    instr.field = read_field();
+    instr.path = read_path();
+}
+
+Instruction::Payload ColumnarState::read_payload()
+{
+    using Type = Instruction::Payload::Type;
+
+    Instruction::Payload payload;
+    payload.type = read_payload_type(Stream::value_types);
+    auto& data = payload.data;
+    switch (payload.type) {
+        case Type::GlobalKey: {
+            parser_error("Unsupported payload data type");
+        }
+        case Type::Int: {
+            data.integer = read_signed(Stream::ints);
+            return payload;
+        }
+        case Type::Bool: {
+            data.boolean = read_bool();
+            return payload;
+        }
+        case Type::Float: {
+            std::memcpy(&data.fnum, read_bytes(sizeof(data.fnum)), sizeof(data.fnum));
+            return payload;
+        }
+        case Type::Double: {
+            std::memcpy(&data.dnum, read_bytes(sizeof(data.dnum)), sizeof(data.dnum));
+            return payload;
+        }
+        case Type::String: {
+            data.str = read_string_value(payload.type);
+            return payload;
+        }
+        case Type::Binary: {
+            data.binary = read_string_value(payload.type);
+            return payload;
+        }
+        case Type::Timestamp: {
+            int64_t seconds = read_signed(Stream::ints);
+            int64_t nanoseconds = read_signed(Stream::ints);
+            if (nanoseconds > std::numeric_limits<int32_t>::max() ||
+                nanoseconds < std::numeric_limits<int32_t>::min())
+                parser_error("timestamp out of range");
+            data.timestamp = Timestamp{seconds, int32_t(nanoseconds)};
+            return payload;
+        }
+        case Type::ObjectId: {
+            std::memcpy(&data.object_id, read_bytes(sizeof(data.object_id)), sizeof(data.object_id));
+            return payload;
+        }
+        case Type::Decimal: {
+            Decimal128::Bid128 value;
+            std::memcpy(&value, read_bytes(sizeof(value)), sizeof(value));
+            data.decimal = Decimal128(value);
+            return payload;
+        }
+        case Type::UUID: {
+            UUID::UUIDBytes bytes{};
+            std::memcpy(bytes.data(), read_bytes(bytes.size()), bytes.size());
+            data.uuid = UUID(bytes);
+            return payload;
+        }
+        case Type::Link: {
+            data.link.target_table = read_intern_string(read(Stream::sizes));
+            data.link.target = read_object_key();
+            return payload;
+        }
+
+        case Type::Null:
+            [[fallthrough]];
+        case Type::Dictionary:
+            [[fallthrough]];
+        case Type::Erased:
+            [[fallthrough]];
+        case Type::ObjectValue:
+            return payload;
+    }
+
+    parser_error("Unsupported payload type");
+}
+
+void ColumnarState::parser_error(const char* complaints)
+{
+    throw BadChangesetError{complaints};
+}
+
+// Parses a changeset in the columnar format, whose first block has already
+// been taken from `input`.
+void parse_columnar_changeset(util::Span<const char> first_block, util::NoCopyInputStream& input,
+                              InstructionHandler& handler)
+{
+    ColumnarState state{handler};
+    ColumnarHeader header;
+    const char* begin = first_block.data();
+    const char* end = begin + first_block.size();
+
+    // The streams are parsed in place if the whole changeset is in the first
+    // block, which is generally the case. Otherwise the blocks are gathered,
+    // since the streams are read in parallel.
+    if (parse_columnar_header(begin, end, header) && header.size <= first_block.size()) {
+        if (header.size != first_block.size())
+            throw BadChangesetError("Unexpected data after columnar changeset");
+        state.parse(header, begin); // Throws
+        if (input.next_block().size() != 0)
+            throw BadChangesetError("Unexpected data after columnar changeset");
+        return;
+    }
+
+    std::vector<char> buffer{begin, end}; // Throws
+    for (auto block = input.next_block(); block.size() != 0; block = input.next_block())
+        buffer.insert(buffer.end(), block.begin(), block.end()); // Throws
+    begin = buffer.data();
+    end = begin + buffer.size();
+    if (!parse_columnar_header(begin, end, header))
+        throw BadChangesetError("Bad columnar changeset header");
+    if (header.size != buffer.size())
+        throw BadChangesetError("Unexpected size of columnar changeset");
+    state.parse(header, begin); // Throws
+}
+
 } // anonymous namespace
 
 namespace realm {
@@ -683,8 +1399,20 @@ void parse_changeset(util::InputStream& input, Changeset& out_log)
 void parse_changeset(util::NoCopyInputStream& input, Changeset& out_log)
 {
     InstructionBuilder builder{out_log};
-    State state{input, builder};
+    parse_changeset(input, builder); // Throws
+}
+
+void parse_changeset(util::NoCopyInputStream& input, InstructionHandler& handler)
+{
+    auto first_block = input.next_block();
+    if (is_columnar_changeset(BinaryData{first_block.data(), first_block.size()})) {
+        parse_columnar_changeset(first_block, input, handler); // Throws
+        return;
+    }
 
+    State state{input, handler};
+    state.m_input_begin = first_block.data();
+    state.m_input_end = first_block.data() + first_block.size();
     while (state.has_next())
         state.parse_one();
 }
@@ -12,6 +12,20 @@ namespace sync {
 void parse_changeset(util::NoCopyInputStream&, Changeset& out_log);
 void parse_changeset(util::InputStream&, Changeset& out_log);
 
+/// Pass the interned strings, string values and instructions of the changeset
+/// to the handler as they are parsed, instead of collecting them in a
+/// Changeset. Apart from the input, the parser only holds the interned strings
+/// in memory.
+void parse_changeset(util::NoCopyInputStream&, InstructionHandler&);
+
+/// Returns true if the changeset is in the columnar format produced by
+/// encode_changeset_columnar(), as opposed to the format produced by
+/// encode_changeset().
+inline bool is_columnar_changeset(BinaryData changeset) noexcept
+{
+    return changeset.size() != 0 && uint8_t(changeset[0]) == ColumnarChangesetMagic;
+}
+
 class OwnedMixed : public Mixed {
 public:
     explicit OwnedMixed(std::string&& str)
@@ -45,6 +45,14 @@ struct InstructionApplier {
     void begin_apply(const Changeset&, util::Logger*) noexcept;
     void end_apply() noexcept;
 
+    /// Apply a single instruction between begin_apply() and end_apply(). This
+    /// allows instructions to be applied as they are parsed, in which case the
+    /// changeset passed to begin_apply() need only hold the strings that the
+    /// instructions refer to.
+    ///
+    /// Throws BadChangesetError as apply().
+    void apply_instruction(const Instruction&);
+
 protected:
     util::Optional<Obj> get_top_object(const Instruction::ObjectInstruction&,
                                        const std::string_view& instr = "(unspecified)");
@@ -207,6 +215,12 @@ inline void InstructionApplier::apply(const Changeset& log, util::Logger* logger
     apply(*this, log, logger); // Throws
 }
 
+inline void InstructionApplier::apply_instruction(const Instruction& instr)
+{
+    REALM_ASSERT(m_log);
+    instr.visit(*this); // Throws
+}
+
 } // namespace sync
 } // namespace realm
 
@@ -891,6 +891,12 @@ inline DataType get_data_type(Instruction::Payload::Type type) noexcept
 // encoded integer instruction format.
 static constexpr uint8_t InstrTypeInternString = 0x3f;
 
+// The first byte of a changeset in the columnar encoding (see
+// encode_changeset_columnar()). A changeset in the regular encoding can never
+// start with a byte in the range 0x40-0x7f, as that would be a negative
+// single-byte instruction type.
+static constexpr uint8_t ColumnarChangesetMagic = 0x43;
+
 // This instruction code is only ever used internally by the Changeset class
 // to allow insertion/removal while keeping iterators stable. Should never
 // make it onto the wire.
@@ -908,6 +914,14 @@ struct InstructionHandler {
     /// this function are assumed to refer to ranges in this buffer.
     virtual StringBufferRange add_string_range(StringData) = 0;
 
+    /// Whether the ranges returned by add_string_range() stay valid until the
+    /// whole changeset has been parsed, so that a string value which occurs
+    /// more than once may refer to the range added for its first occurrence.
+    virtual bool keeps_string_ranges() const noexcept
+    {
+        return false;
+    }
+
     /// Handle an instruction.
     virtual void operator()(const Instruction&) = 0;
 };
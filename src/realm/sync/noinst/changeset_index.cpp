@@ -49,6 +49,7 @@ void ChangesetIndex::clear() noexcept
     m_schema_instructions.clear();
     m_conflict_groups_owner.clear();
     m_num_conflict_groups = 0;
+    m_path_instructions.clear();
 }
 
 
@@ -198,6 +199,33 @@ void ChangesetIndex::add_changeset(Changeset& log)
                 REALM_ASSERT(&cg == &object_conflict_group(ids[i]));
             }
             add_instruction_at(cg.ranges, log, it);
+            add_path_instruction(log, it, ids[0]);
+        }
+    }
+}
+
+void ChangesetIndex::add_path_instruction(Changeset& log, Changeset::iterator pos, const GlobalID& object_id)
+{
+    using Instruction = realm::sync::Instruction;
+
+    auto& object_ranges = m_path_instructions[object_id.table_name][object_id.object_id];
+    add_instruction_at(object_ranges.all, log, pos);
+
+    const auto& instr = **pos;
+    if (auto path_instr = instr.get_if<Instruction::PathInstruction>()) {
+        StringData field = log.get_string(path_instr->field);
+        auto it = object_ranges.fields.find(field);
+        if (it == object_ranges.fields.end()) {
+            // Creation and erasure of the object conflicts with every field,
+            // including the ones that are first seen after them.
+            it = object_ranges.fields.emplace(field, object_ranges.create_erase).first;
+        }
+        add_instruction_at(it->second, log, pos);
+    }
+    else {
+        add_instruction_at(object_ranges.create_erase, log, pos);
+        for (auto& pair : object_ranges.fields) {
+            add_instruction_at(pair.second, log, pos);
         }
     }
 }
@@ -270,6 +298,52 @@ auto ChangesetIndex::get_modifications_for_object(GlobalID id) const -> const Ra
     return const_cast<ChangesetIndex*>(this)->get_modifications_for_object(id);
 }
 
+auto ChangesetIndex::find_object_ranges(const GlobalID& object_id) -> ObjectRanges*
+{
+    auto it = m_path_instructions.find(object_id.table_name);
+    if (it == m_path_instructions.end())
+        return nullptr;
+
+    auto& object_ranges = it->second;
+    auto it2 = object_ranges.find(object_id.object_id);
+    if (it2 == object_ranges.end())
+        return nullptr;
+    return &it2->second;
+}
+
+auto ChangesetIndex::get_modifications_for_path(GlobalID id) -> Ranges*
+{
+    if (m_contains_destructive_schema_changes)
+        return &m_everything;
+    auto object_ranges = find_object_ranges(id);
+    if (!object_ranges)
+        return &m_empty;
+    return &object_ranges->all;
+}
+
+auto ChangesetIndex::get_modifications_for_path(GlobalID id, StringData field) -> Ranges*
+{
+    if (m_contains_destructive_schema_changes)
+        return &m_everything;
+    auto object_ranges = find_object_ranges(id);
+    if (!object_ranges)
+        return &m_empty;
+    auto it = object_ranges->fields.find(field);
+    if (it == object_ranges->fields.end())
+        return &object_ranges->create_erase;
+    return &it->second;
+}
+
+auto ChangesetIndex::get_modifications_for_path(GlobalID id) const -> const Ranges*
+{
+    return const_cast<ChangesetIndex*>(this)->get_modifications_for_path(id);
+}
+
+auto ChangesetIndex::get_modifications_for_path(GlobalID id, StringData field) const -> const Ranges*
+{
+    return const_cast<ChangesetIndex*>(this)->get_modifications_for_path(id, field);
+}
+
 auto ChangesetIndex::schema_conflict_group(StringData class_name) -> ConflictGroup&
 {
     auto& conflict_group = m_schema_instructions[class_name];
@@ -485,6 +559,12 @@ void ChangesetIndex::verify() const
                     REALM_ASSERT(&ranges == &ranges_first);
                     REALM_ASSERT(ranges_cover(ranges, log, it));
                 }
+
+                REALM_ASSERT(ranges_cover(*get_modifications_for_path(ids[0]), log, it));
+                if (auto path_instr = instr.get_if<Instruction::PathInstruction>()) {
+                    StringData field = log.get_string(path_instr->field);
+                    REALM_ASSERT(ranges_cover(*get_modifications_for_path(ids[0], field), log, it));
+                }
             }
         }
     }
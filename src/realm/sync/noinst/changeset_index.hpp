@@ -20,6 +20,11 @@ namespace _impl {
 /// if two objects are connected by a link instruction in a changeset, all
 /// instructions pertaining to both objects will be merged with any instruction
 /// that touches either.
+///
+/// Within the conflict groups, the index additionally keeps the instructions
+/// for each object and each field of that object, so that the merge algorithm
+/// only has to visit the instructions whose path overlaps with the path of the
+/// instruction being merged.
 struct ChangesetIndex {
     using Changeset = realm::sync::Changeset;
     using GlobalID = realm::sync::GlobalID;
@@ -75,6 +80,25 @@ struct ChangesetIndex {
     const Ranges* get_modifications_for_object(GlobalID id) const;
     //@}
 
+    //@{
+    /// Returns ranges for every instruction whose path overlaps with the
+    /// path to the object, or to \a field of the object. The first overload
+    /// covers every instruction touching the object. The second overload
+    /// covers every instruction touching \a field, and every instruction
+    /// creating or erasing the object.
+    ///
+    /// The path is indexed down to the field, because array indices further
+    /// down the path are modified by the OT merge algorithm itself.
+    ///
+    /// NOTE: The non-const version does not modify the index, but returns a
+    /// Ranges object that may iterated over in a non-const fashion (such as by
+    /// the OT merge algorithm).
+    Ranges* get_modifications_for_path(GlobalID id);
+    Ranges* get_modifications_for_path(GlobalID id, StringData field);
+    const Ranges* get_modifications_for_path(GlobalID id) const;
+    const Ranges* get_modifications_for_path(GlobalID id, StringData field) const;
+    //@}
+
     //@{
     /// Returns the ranges for all instructions added to the index.
     ///
@@ -123,6 +147,13 @@ private:
     std::list<ConflictGroup> m_conflict_groups_owner;
     size_t m_num_conflict_groups = 0; // must be kept in sync with m_conflict_groups_owner
 
+    struct ObjectRanges {
+        Ranges all;
+        Ranges create_erase;
+        std::map<StringData, Ranges> fields; // Each also covers `create_erase`
+    };
+    std::map<StringData, std::map<PrimaryKey, ObjectRanges>> m_path_instructions;
+
     void clear() noexcept;
 
     Ranges m_empty;
@@ -131,6 +162,9 @@ private:
 
     ConflictGroup& schema_conflict_group(StringData class_name);
     ConflictGroup& object_conflict_group(const GlobalID& object_id);
+    ObjectRanges* find_object_ranges(const GlobalID& object_id);
+
+    void add_path_instruction(Changeset&, Changeset::iterator pos, const GlobalID& object_id);
 
     // Merge \a from into \a into, and delete \a from.
     void merge_conflict_groups(ConflictGroup& into, ConflictGroup& from);
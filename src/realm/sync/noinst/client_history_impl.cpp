@@ -22,6 +22,7 @@
 #include <realm/util/compression.hpp>
 #include <realm/util/features.h>
 #include <realm/util/scope_exit.hpp>
+#include <realm/util/thread_pool.hpp>
 #include <realm/sync/changeset.hpp>
 #include <realm/sync/changeset_parser.hpp>
 #include <realm/sync/instruction_applier.hpp>
@@ -36,6 +37,106 @@
 
 namespace realm::sync {
 
+namespace {
+
+// Applies the instructions of a changeset received from the server as they are
+// parsed, and encodes them for the history at the same time. Apart from the
+// interned strings, only the string value of the current instruction is held
+// in memory.
+class StreamingChangesetIntegrator : public InstructionHandler {
+public:
+    StreamingChangesetIntegrator(InstructionApplier& applier, ChangesetEncoder& encoder) noexcept
+        : m_applier{applier}
+        , m_encoder{encoder}
+    {
+    }
+
+    // Set if a BadChangesetError was thrown by the applier, as opposed to the
+    // parser.
+    bool failed_to_apply = false;
+
+    void set_intern_string(uint32_t index, StringBufferRange range) override
+    {
+        InternStrings& strings = m_strings.interned_strings();
+        REALM_ASSERT(index == strings.size());
+        strings.push_back(range); // Throws
+        m_interned_size = m_strings.string_buffer().size();
+    }
+
+    StringBufferRange add_string_range(StringData string) override
+    {
+        return m_strings.append_string(string); // Throws
+    }
+
+    void operator()(const Instruction& instr) override
+    {
+        // As for encode_changeset(), the interned strings are not written
+        // unless there are instructions.
+        m_encoder.add_string_range(m_strings.string_data());
+        const InternStrings& strings = m_strings.interned_strings();
+        for (; m_num_encoded_strings < strings.size(); ++m_num_encoded_strings)
+            m_encoder.set_intern_string(uint32_t(m_num_encoded_strings), strings[m_num_encoded_strings]); // Throws
+        m_encoder(instr); // Throws
+
+        failed_to_apply = true;
+        m_applier.apply_instruction(instr); // Throws
+        failed_to_apply = false;
+
+        // Discard the string value of the instruction, if any
+        m_strings.string_buffer().resize(m_interned_size);
+    }
+
+    Changeset& strings() noexcept
+    {
+        return m_strings;
+    }
+
+private:
+    InstructionApplier& m_applier;
+    ChangesetEncoder& m_encoder;
+    // The interned strings and the string value of the current instruction,
+    // along with the properties of the changeset, for the applier.
+    Changeset m_strings;
+    std::size_t m_interned_size = 0;
+    std::size_t m_num_encoded_strings = 0;
+};
+
+void integrate_server_changeset_streaming(InstructionApplier& applier, const Transformer::RemoteChangeset& changeset,
+                                          ChangesetEncoder::Buffer& history_buffer, util::Logger& logger)
+{
+    ChangesetEncoder encoder;
+    StreamingChangesetIntegrator integrator{applier, encoder};
+    Changeset& strings = integrator.strings();
+    strings.version = changeset.remote_version;
+    strings.last_integrated_remote_version = changeset.last_integrated_local_version;
+    strings.origin_timestamp = changeset.origin_timestamp;
+    strings.origin_file_ident = changeset.origin_file_ident;
+
+    swap(encoder.buffer(), history_buffer);
+    applier.begin_apply(strings, &logger);
+    ChunkedBinaryInputStream in{changeset.data};
+    try {
+        parse_changeset(in, integrator); // Throws
+    }
+    catch (const BadChangesetError& e) {
+        applier.end_apply();
+        if (integrator.failed_to_apply) {
+            throw IntegrationException(ClientError::bad_changeset,
+                                       util::format("Failed to apply received changeset: %1", e.what()));
+        }
+        throw IntegrationException(ClientError::bad_changeset,
+                                   util::format("Failed to parse received changeset: %1", e.what()));
+    }
+    catch (...) {
+        applier.end_apply();
+        throw;
+    }
+    applier.end_apply();
+    swap(encoder.buffer(), history_buffer);
+}
+
+} // unnamed namespace
+
 void ClientHistory::set_client_file_ident_in_wt(version_type current_version, SaltedFileIdent client_file_ident)
 {
     ensure_updated(current_version); // Throws
@@ -387,21 +488,37 @@ void ClientHistory::integrate_server_changesets(const SyncProgress& progress,
     REALM_ASSERT(incoming_changesets.size() != 0);
 
     std::uint_fast64_t downloaded_bytes_in_message = 0;
-    std::vector<Changeset> changesets;
-    changesets.resize(incoming_changesets.size()); // Throws
+    version_type merge_window_begin = incoming_changesets[0].last_integrated_local_version;
+    for (const RemoteChangeset& changeset : incoming_changesets) {
+        downloaded_bytes_in_message += changeset.original_changeset_size;
+        merge_window_begin = std::min(merge_window_begin, changeset.last_integrated_local_version);
+    }
 
-    try {
-        for (std::size_t i = 0; i < incoming_changesets.size(); ++i) {
-            const RemoteChangeset& changeset = incoming_changesets[i];
-            downloaded_bytes_in_message += changeset.original_changeset_size;
-            parse_remote_changeset(changeset, changesets[i]); // Throws
-            changesets[i].transform_sequence = i;
+    // If no local changes have been made since the changesets were produced,
+    // as is generally the case during a bootstrap, there is nothing to merge
+    // them with, and they are applied as they are parsed. Otherwise they are
+    // parsed before the write transaction is started, so that the write lock
+    // is not held while parsing.
+    std::vector<Changeset> changesets;
+    auto parse_changesets = [&] {
+        changesets.resize(incoming_changesets.size()); // Throws
+
+        // The changesets are independent of each other until they are
+        // transformed, so they are parsed in parallel.
+        try {
+            util::ThreadPool::get_default().run(incoming_changesets.size(), [&](std::size_t i) {
+                parse_remote_changeset(incoming_changesets[i], changesets[i]); // Throws
+                changesets[i].transform_sequence = i;
+            }); // Throws
         }
-    }
-    catch (const TransformError& e) {
-        throw IntegrationException(ClientError::bad_changeset,
-                                   util::format("Failed to parse received changeset: %1", e.what()));
-    }
+        catch (const TransformError& e) {
+            throw IntegrationException(ClientError::bad_changeset,
+                                       util::format("Failed to parse received changeset: %1", e.what()));
+        }
+    };
+    bool may_stream = m_replication.apply_server_changes() && !has_local_changes_after(merge_window_begin); // Throws
+    if (!may_stream)
+        parse_changesets(); // Throws
 
     TransactionRef transact = m_db->start_write(); // Throws
     VersionID old_version = transact->get_version_of_current_transaction();
@@ -412,52 +529,78 @@ void ClientHistory::integrate_server_changesets(const SyncProgress& progress,
     ensure_updated(local_version); // Throws
     prepare_for_write();           // Throws
 
+    // A local change may have been committed since the changesets were
+    // parsed, so the merge window is checked again. As below, it is clamped
+    // to the beginning of the synchronization history.
+    if (merge_window_begin < m_sync_history_base_version)
+        merge_window_begin = m_sync_history_base_version;
+    HistoryEntry local_entry;
+    bool needs_transform = (find_history_entry(merge_window_begin, local_version, local_entry) != 0);
+
     ChangesetEncoder::Buffer transformed_changeset;
-    try {
-        for (std::size_t i = 0; i < incoming_changesets.size(); ++i) {
-            const RemoteChangeset& changeset = incoming_changesets[i];
+    if (may_stream && !needs_transform) {
+        logger.debug("Applying %1 received changesets as they are parsed", incoming_changesets.size()); // Throws
+        TempShortCircuitReplication tscr{m_replication};
+        InstructionApplier applier{*transact};
+        for (const RemoteChangeset& changeset : incoming_changesets) {
             REALM_ASSERT(changeset.last_integrated_local_version <= local_version);
             REALM_ASSERT(changeset.origin_file_ident > 0 && changeset.origin_file_ident != sync_file_id);
-
-            // It is possible that the synchronization history has been trimmed
-            // to a point where a prefix of the merge window is no longer
-            // available, but this can only happen if that prefix consisted
-            // entirely of upload skippable entries. Since such entries (those
-            // that are empty or of remote origin) will be skipped by the
-            // transformer anyway, we can simply clamp the beginning of the
-            // merge window to the beginning of the synchronization history,
-            // when this situation occurs.
-            //
-            // See trim_sync_history() for further details.
-            if (changesets[i].last_integrated_remote_version < m_sync_history_base_version)
-                changesets[i].last_integrated_remote_version = m_sync_history_base_version;
+            integrate_server_changeset_streaming(applier, changeset, transformed_changeset,
+                                                 logger); // Throws
         }
+    }
+    else {
+        // Unless a local change was committed after the changesets were
+        // checked, they have been parsed already
+        if (may_stream)
+            parse_changesets(); // Throws
 
-        if (m_replication.apply_server_changes()) {
-            Transformer& transformer = get_transformer(); // Throws
-            transformer.transform_remote_changesets(*this, sync_file_id, local_version, changesets,
-                                                    &logger); // Throws
-
-            // Changesets are applied to the Realm with replication temporarily
-            // disabled. The main reason for disabling replication and manually adding
-            // the transformed changesets to the history, is that the replication system
-            // (due to technical debt) is unable in some cases to produce a correct
-            // changeset while applying another one (i.e., it cannot carbon copy).
-            TempShortCircuitReplication tscr{m_replication};
-            InstructionApplier applier{*transact};
+        try {
             for (std::size_t i = 0; i < incoming_changesets.size(); ++i) {
-                encode_changeset(changesets[i], transformed_changeset);
-                applier.apply(changesets[i], &logger); // Throws
+                const RemoteChangeset& changeset = incoming_changesets[i];
+                REALM_ASSERT(changeset.last_integrated_local_version <= local_version);
+                REALM_ASSERT(changeset.origin_file_ident > 0 && changeset.origin_file_ident != sync_file_id);
+
+                // It is possible that the synchronization history has been trimmed
+                // to a point where a prefix of the merge window is no longer
+                // available, but this can only happen if that prefix consisted
+                // entirely of upload skippable entries. Since such entries (those
+                // that are empty or of remote origin) will be skipped by the
+                // transformer anyway, we can simply clamp the beginning of the
+                // merge window to the beginning of the synchronization history,
+                // when this situation occurs.
+                //
+                // See trim_sync_history() for further details.
+                if (changesets[i].last_integrated_remote_version < m_sync_history_base_version)
+                    changesets[i].last_integrated_remote_version = m_sync_history_base_version;
+            }
+
+            if (m_replication.apply_server_changes()) {
+                Transformer& transformer = get_transformer(); // Throws
+                transformer.transform_remote_changesets(*this, sync_file_id, local_version, changesets,
+                                                        &logger); // Throws
+
+                // Changesets are applied to the Realm with replication temporarily
+                // disabled. The main reason for disabling replication and manually adding
+                // the transformed changesets to the history, is that the replication system
+                // (due to technical debt) is unable in some cases to produce a correct
+                // changeset while applying another one (i.e., it cannot carbon copy).
+                TempShortCircuitReplication tscr{m_replication};
+                InstructionApplier applier{*transact};
+                for (std::size_t i = 0; i < incoming_changesets.size(); ++i) {
+                    encode_changeset(changesets[i], transformed_changeset);
+                    applier.apply(changesets[i], &logger); // Throws
+                }
             }
         }
-    }
-    catch (const BadChangesetError& e) {
-        throw IntegrationException(ClientError::bad_changeset,
-                                   util::format("Failed to apply received changeset: %1", e.what()));
-    }
-    catch (const TransformError& e) {
-        throw IntegrationException(ClientError::bad_changeset,
-                                   util::format("Failed to transform received changeset: %1", e.what()));
+        catch (const BadChangesetError& e) {
+            throw IntegrationException(ClientError::bad_changeset,
+                                       util::format("Failed to apply received changeset: %1", e.what()));
+        }
+        catch (const TransformError& e) {
+            throw IntegrationException(ClientError::bad_changeset,
+                                       util::format("Failed to transform received changeset: %1", e.what()));
+        }
     }
 
     // downloaded_bytes always contains the total number of downloaded bytes
@@ -485,11 +628,11 @@ void ClientHistory::integrate_server_changesets(const SyncProgress& progress,
     // stored in the client-side history (for now), except that
     // `origin_file_ident` is required to be nonzero, to mark it as having been
     // received from the server.
-    const Changeset& last_changeset = changesets.back();
+    const RemoteChangeset& last_changeset = incoming_changesets.back();
     HistoryEntry entry;
     entry.origin_timestamp = last_changeset.origin_timestamp;
     entry.origin_file_ident = last_changeset.origin_file_ident;
-    entry.remote_version = last_changeset.version;
+    entry.remote_version = last_changeset.remote_version;
     entry.changeset = BinaryData(transformed_changeset.data(), transformed_changeset.size());
     add_sync_history_entry(entry); // Throws
 
@@ -570,6 +713,24 @@ void ClientHistory::set_reciprocal_transform(version_type version, BinaryData da
 }
 
 
+bool ClientHistory::has_local_changes_after(version_type begin_version) const
+{
+    TransactionRef rt = m_db->start_read(); // Throws
+    using gf = _impl::GroupFriend;
+    ref_type ref = gf::get_history_ref(*rt);
+    if (!ref)
+        return false;
+
+    Arrays arrays(m_db->get_alloc(), *rt, ref);
+    version_type end_version = rt->get_version();
+    version_type base_version = end_version - arrays.changesets.size();
+    HistoryEntry entry;
+    version_type last_integrated_server_version;
+    return find_sync_history_entry(arrays, base_version, std::max(begin_version, base_version), end_version, entry,
+                                   last_integrated_server_version) != 0;
+}
+
+
 auto ClientHistory::find_sync_history_entry(Arrays& arrays, version_type base_version, version_type begin_version,
                                             version_type end_version, HistoryEntry& entry,
                                             version_type& last_integrated_server_version) noexcept -> version_type
@@ -410,6 +410,11 @@ private:
                                                 version_type end_version, HistoryEntry& entry,
                                                 version_type& last_integrated_server_version) noexcept;
 
+    // Whether the history of the latest snapshot has changesets of local origin
+    // which succeed `begin_version`. Reads the history outside of a write
+    // transaction.
+    bool has_local_changes_after(version_type begin_version) const;
+
     // sum_of_history_entry_sizes calculates the sum of the changeset sizes of the local history
     // entries that produced a version that succeeds `begin_version` and precedes `end_version`.
     std::uint_fast64_t sum_of_history_entry_sizes(version_type begin_version,
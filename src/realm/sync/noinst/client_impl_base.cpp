@@ -1802,9 +1802,10 @@ void Session::send_upload_message()
                  progress_client_version, progress_server_version, locked_server_version,
                  uploadable_changesets.size()); // Throws
 
+    int protocol_version = m_conn.get_negotiated_protocol_version();
     ClientProtocol& protocol = m_conn.get_client_protocol();
     ClientProtocol::UploadMessageBuilder upload_message_builder =
-        protocol.make_upload_message_builder(logger); // Throws
+        protocol.make_upload_message_builder(protocol_version, logger); // Throws
 
     for (const UploadChangeset& uc : uploadable_changesets) {
         logger.debug("Fetching changeset for upload (client_version=%1, server_version=%2, "
@@ -1869,7 +1870,6 @@ void Session::send_upload_message()
         }
     }
 
-    int protocol_version = m_conn.get_negotiated_protocol_version();
     OutputBuffer& out = m_conn.get_output_buffer();
     session_ident_type session_ident = get_ident();
     upload_message_builder.make_upload_message(protocol_version, out, session_ident, progress_client_version,
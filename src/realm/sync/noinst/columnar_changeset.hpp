@@ -0,0 +1,109 @@
+
+#ifndef REALM_NOINST_COLUMNAR_CHANGESET_HPP
+#define REALM_NOINST_COLUMNAR_CHANGESET_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace realm {
+namespace _impl {
+namespace columnar {
+
+/// Shared definitions of the columnar changeset encoding. See
+/// `doc/changeset.md` for a description of the format, and
+/// encode_changeset_columnar() and parse_changeset() for the encoder and the
+/// parser.
+///
+/// After the leading `sync::ColumnarChangesetMagic` byte, an encoded changeset
+/// consists of a header of unsigned LEB128 integers:
+///
+///     <format version> <number of interned strings> <number of instructions>
+///     <byte size of each stream, in the order of `Stream`>
+///
+/// followed by the contents of the streams, in the order of `Stream`. All
+/// streams except `Stream::bytes` are sequences of unsigned LEB128 integers.
+constexpr std::uint64_t format_version = 1;
+
+enum class Stream {
+    opcodes,     ///< Pairs of (instruction type, run length).
+    tables,      ///< Zigzag delta of the table of each instruction.
+    fields,      ///< Zigzag delta of the field of each instruction.
+    key_types,   ///< Zigzag payload type of each object key.
+    int_keys,    ///< Zigzag delta of each integer object key.
+    string_keys, ///< Zigzag delta of each string object key.
+    paths,       ///< Length of each path, followed by its elements.
+    value_types, ///< Zigzag payload type of each value.
+    ints,        ///< Zigzag integer values.
+    sizes,       ///< Unsigned values: string sizes, prior sizes, flags, etc.
+    strings,     ///< Zero for a new string value, otherwise 1 + its dictionary index.
+    bytes,       ///< Raw bytes: string data, floats, object IDs, etc.
+};
+
+constexpr std::size_t num_streams = std::size_t(Stream::bytes) + 1;
+
+/// The maximum number of bytes used by an unsigned LEB128 encoded 64-bit
+/// integer.
+constexpr std::size_t max_varint_size = 10;
+
+constexpr std::uint64_t zigzag_encode(std::int64_t value) noexcept
+{
+    return (std::uint64_t(value) << 1) ^ (value < 0 ? ~std::uint64_t(0) : 0);
+}
+
+constexpr std::int64_t zigzag_decode(std::uint64_t value) noexcept
+{
+    return std::int64_t((value >> 1) ^ (~(value & 1) + 1));
+}
+
+/// The difference between two values, wrapping around on overflow, such that
+/// `delta_decode(prev, delta_encode(prev, value)) == value`.
+constexpr std::uint64_t delta_encode(std::int64_t prev, std::int64_t value) noexcept
+{
+    return zigzag_encode(std::int64_t(std::uint64_t(value) - std::uint64_t(prev)));
+}
+
+constexpr std::int64_t delta_decode(std::int64_t prev, std::uint64_t delta) noexcept
+{
+    return std::int64_t(std::uint64_t(prev) + std::uint64_t(zigzag_decode(delta)));
+}
+
+/// The size of the specified buffer must be at least `max_varint_size`.
+///
+/// Returns the number of bytes used to hold the encoded value.
+inline std::size_t encode_varint(std::uint64_t value, char* buffer) noexcept
+{
+    char* ptr = buffer;
+    while (value >= 0x80) {
+        *ptr++ = char(0x80 | (value & 0x7F));
+        value >>= 7;
+    }
+    *ptr++ = char(value);
+    return std::size_t(ptr - buffer);
+}
+
+/// If decoding succeeds, the decoded value is assigned to \a value, \a begin
+/// is advanced past the encoded value, and `true` is returned. Otherwise
+/// `false` is returned.
+inline bool decode_varint(const char*& begin, const char* end, std::uint64_t& value) noexcept
+{
+    const char* ptr = begin;
+    std::uint64_t value_2 = 0;
+    for (int shift = 0; shift < 64 && ptr != end; shift += 7) {
+        std::uint64_t part = static_cast<unsigned char>(*ptr++);
+        if (shift == 63 && part > 1)
+            return false; // Failure: Encoded value too large
+        value_2 |= (part & 0x7F) << shift;
+        if ((part & 0x80) == 0) {
+            value = value_2;
+            begin = ptr;
+            return true;
+        }
+    }
+    return false; // Failure: Premature end of input, or too many bytes
+}
+
+} // namespace columnar
+} // namespace _impl
+} // namespace realm
+
+#endif // REALM_NOINST_COLUMNAR_CHANGESET_HPP
@@ -7,6 +7,35 @@ namespace realm::_impl {
 
 using OutputBuffer = util::ResettableExpandableBufferOutputStream;
 
+namespace {
+
+// Changesets are stored in the encoding produced by sync::encode_changeset(),
+// but are sent in the columnar encoding when the protocol version supports it.
+// Returns true if `changeset` was re-encoded into `buffer`, and false if it is
+// already in the right encoding.
+bool transcode_changeset(int protocol_version, const ChunkedBinaryData& changeset,
+                         sync::ChangesetEncoder::Buffer& buffer)
+{
+    bool columnar = sync::uses_columnar_changesets(protocol_version);
+    BinaryData first_chunk = changeset.iterator().get_next();
+    if (first_chunk.size() == 0 || sync::is_columnar_changeset(first_chunk) == columnar)
+        return false;
+
+    ChunkedBinaryInputStream in{changeset};
+    sync::Changeset parsed;
+    sync::parse_changeset(in, parsed); // Throws
+    buffer.clear();
+    if (columnar) {
+        sync::encode_changeset_columnar(parsed, buffer); // Throws
+    }
+    else {
+        sync::encode_changeset(parsed, buffer); // Throws
+    }
+    return true;
+}
+
+} // unnamed namespace
+
 // Client protocol
 
 void ClientProtocol::make_bind_message(int protocol_version, OutputBuffer& out, session_ident_type session_ident,
@@ -60,12 +89,14 @@ void ClientProtocol::make_json_error_message(OutputBuffer& out, session_ident_ty
 }
 
 ClientProtocol::UploadMessageBuilder::UploadMessageBuilder(
-    util::Logger& logger, OutputBuffer& body_buffer, std::vector<char>& compression_buffer,
-    util::compression::CompressMemoryArena& compress_memory_arena)
+    int protocol_version, util::Logger& logger, OutputBuffer& body_buffer, std::vector<char>& compression_buffer,
+    util::compression::CompressMemoryArena& compress_memory_arena, sync::ChangesetEncoder::Buffer& changeset_buffer)
     : logger{logger}
+    , m_protocol_version{protocol_version}
     , m_body_buffer{body_buffer}
     , m_compression_buffer{compression_buffer}
     , m_compress_memory_arena{compress_memory_arena}
+    , m_changeset_buffer{changeset_buffer}
 {
     m_body_buffer.reset();
 }
@@ -75,6 +106,16 @@ void ClientProtocol::UploadMessageBuilder::add_changeset(version_type client_ver
                                                          file_ident_type origin_file_ident,
                                                          ChunkedBinaryData changeset)
 {
+    try {
+        if (transcode_changeset(m_protocol_version, changeset, m_changeset_buffer)) // Throws
+            changeset = BinaryData{m_changeset_buffer.data(), m_changeset_buffer.size()};
+    }
+    catch (const sync::BadChangesetError& e) {
+        // Leave it to the server to reject the changeset.
+        logger.error("Failed to transcode changeset for upload (client_version=%1): %2", client_version,
+                     e.what()); // Throws
+    }
+
     m_body_buffer << client_version << " " << server_version << " " << origin_timestamp << " " << origin_file_ident
                   << " " << changeset.size() << " "; // Throws
     changeset.write_to(m_body_buffer);               // Throws
@@ -118,9 +159,11 @@ void ClientProtocol::UploadMessageBuilder::make_upload_message(int protocol_vers
     REALM_ASSERT(!out.fail());
 }
 
-ClientProtocol::UploadMessageBuilder ClientProtocol::make_upload_message_builder(util::Logger& logger)
+ClientProtocol::UploadMessageBuilder ClientProtocol::make_upload_message_builder(int protocol_version,
+                                                                                util::Logger& logger)
 {
-    return UploadMessageBuilder{logger, m_output_buffer, m_buffer, m_compress_memory_arena};
+    return UploadMessageBuilder{protocol_version, logger, m_output_buffer, m_buffer, m_compress_memory_arena,
+                                m_changeset_buffer};
 }
 
 void ClientProtocol::make_unbind_message(OutputBuffer& out, session_ident_type session_ident)
@@ -172,6 +215,60 @@ void ServerProtocol::make_alloc_message(OutputBuffer& out, session_ident_type se
 }
 
 
+bool ServerProtocol::TranscodedChangesetCache::get(const void* file, int protocol_version,
+                                                   version_type server_version, const ChunkedBinaryData& changeset,
+                                                   sync::ChangesetEncoder::Buffer& buffer, BinaryData& transcoded)
+{
+    Key key{reinterpret_cast<std::uintptr_t>(file), server_version, sync::uses_columnar_changesets(protocol_version)};
+    auto i = m_changesets.find(key);
+    if (i == m_changesets.end()) {
+        if (!transcode_changeset(protocol_version, changeset, buffer)) // Throws
+            return false;
+        if (buffer.size() > m_max_size) {
+            // It could only be cached by dropping everything else, and would
+            // still exceed the budget
+            transcoded = BinaryData{buffer.data(), buffer.size()};
+            return true;
+        }
+        while (!m_lru.empty() && m_size + buffer.size() > m_max_size) {
+            auto j = m_changesets.find(m_lru.front());
+            m_size -= j->second.data.size();
+            m_changesets.erase(j);
+            m_lru.pop_front();
+        }
+        std::vector<char> data(buffer.data(), buffer.data() + buffer.size()); // Throws
+        m_lru.push_back(key);                                                 // Throws
+        try {
+            i = m_changesets.emplace(key, Entry{std::move(data), std::prev(m_lru.end())}).first; // Throws
+        }
+        catch (...) {
+            m_lru.pop_back();
+            throw;
+        }
+        m_size += i->second.data.size();
+    }
+    else {
+        m_lru.splice(m_lru.end(), m_lru, i->second.lru_pos);
+    }
+    transcoded = BinaryData{i->second.data.data(), i->second.data.size()};
+    return true;
+}
+
+
+void ServerProtocol::TranscodedChangesetCache::erase(const void* file) noexcept
+{
+    auto id = reinterpret_cast<std::uintptr_t>(file);
+    auto begin = m_changesets.lower_bound(Key{id, 0, false});
+    auto end = begin;
+    while (end != m_changesets.end() && std::get<0>(end->first) == id) {
+        m_size -= end->second.data.size();
+        m_lru.erase(end->second.lru_pos);
+        ++end;
+    }
+    m_changesets.erase(begin, end);
+}
+
+
 /// insert_single_changeset_download_message() inserts a single changeset and
 /// the associated meta data into the output buffer.
 ///
@@ -181,23 +278,33 @@ void ServerProtocol::make_alloc_message(OutputBuffer& out, session_ident_type se
 /// The message format for the single changeset is <server_version>
 /// <client_version> <timestamp> <client_file_ident> <changeset size>
 /// <changeset>
-void ServerProtocol::insert_single_changeset_download_message(OutputBuffer& out, const ChangesetInfo& changeset_info,
+void ServerProtocol::insert_single_changeset_download_message(int protocol_version, OutputBuffer& out,
+                                                              const ChangesetInfo& changeset_info,
                                                               util::Logger& logger)
 {
     const sync::HistoryEntry& entry = changeset_info.entry;
+    ChunkedBinaryData changeset = entry.changeset;
+    if (changeset_info.cache) {
+        BinaryData transcoded;
+        if (changeset_info.cache->get(changeset_info.file, protocol_version, changeset_info.server_version,
+                                      changeset, m_changeset_buffer, transcoded)) // Throws
+            changeset = transcoded;
+    }
+    else if (transcode_changeset(protocol_version, changeset, m_changeset_buffer)) { // Throws
+        changeset = BinaryData{m_changeset_buffer.data(), m_changeset_buffer.size()};
+    }
 
     out << changeset_info.server_version << " " << changeset_info.client_version << " " << entry.origin_timestamp
-        << " " << entry.origin_file_ident << " " << changeset_info.original_size << " " << entry.changeset.size()
-        << " ";
-    entry.changeset.write_to(out);
+        << " " << entry.origin_file_ident << " " << changeset_info.original_size << " " << changeset.size() << " ";
+    changeset.write_to(out);
 
     if (logger.would_log(util::Logger::Level::trace)) {
         logger.trace("DOWNLOAD: insert single changeset (server_version=%1, "
                      "client_version=%2, timestamp=%3, client_file_ident=%4, "
                      "original_changeset_size=%5, changeset_size=%6, changeset='%7').",
                      changeset_info.server_version, changeset_info.client_version, entry.origin_timestamp,
-                     entry.origin_file_ident, changeset_info.original_size, entry.changeset.size(),
-                     _impl::clamped_hex_dump(entry.changeset.get_first_chunk())); // Throws
+                     entry.origin_file_ident, changeset_info.original_size, changeset.size(),
+                     _impl::clamped_hex_dump(changeset.get_first_chunk())); // Throws
     }
 }
 
@@ -211,11 +318,16 @@ void ServerProtocol::make_download_message(int protocol_version, OutputBuffer& o
                                            std::size_t compressed_body_size, bool body_is_compressed,
                                            util::Logger& logger)
 {
-    static_cast<void>(protocol_version);
+    // The body compression field is 0 for no compression, 1 if the body is
+    // compressed as a whole, and 2 if it is compressed in chunks.
+    int body_compression = 0;
+    if (body_is_compressed)
+        body_compression = (sync::uses_chunked_download_compression(protocol_version) ? 2 : 1);
+
     // The header of the download message.
     out << "download " << session_ident << " " << download_server_version << " " << download_client_version << " "
         << latest_server_version << " " << latest_server_version_salt << " " << upload_client_version << " "
-        << upload_server_version << " " << downloadable_bytes << " " << int(body_is_compressed) << " "
+        << upload_server_version << " " << downloadable_bytes << " " << body_compression << " "
         << uncompressed_body_size << " " << compressed_body_size << "\n"; // Throws
 
     std::size_t body_size = (body_is_compressed ? compressed_body_size : uncompressed_body_size);
@@ -224,10 +336,10 @@ void ServerProtocol::make_download_message(int protocol_version, OutputBuffer& o
     logger.detail("Sending: DOWNLOAD(download_server_version=%1, download_client_version=%2, "
                   "latest_server_version=%3, latest_server_version_salt=%4, "
                   "upload_client_version=%5, upload_server_version=%6, "
-                  "num_changesets=%7, is_body_compressed=%8, body_size=%9, "
+                  "num_changesets=%7, body_compression=%8, body_size=%9, "
                   "compressed_body_size=%10)",
                   download_server_version, download_client_version, latest_server_version, latest_server_version_salt,
-                  upload_client_version, upload_server_version, num_changesets, body_is_compressed,
+                  upload_client_version, upload_server_version, num_changesets, body_compression,
                   uncompressed_body_size, compressed_body_size); // Throws
 }
 
@@ -264,6 +376,81 @@ void ServerProtocol::make_pong(OutputBuffer& out, milliseconds_type timestamp)
 }
 
 
+std::error_code compress_chunked_download_body(util::compression::CompressMemoryArena& compress_memory_arena,
+                                               util::Span<const char> body,
+                                               util::Span<const std::size_t> entry_ends, std::size_t max_chunk_size,
+                                               std::vector<char>& out)
+{
+    out.clear();
+    std::vector<char> compressed_chunk;
+    std::size_t chunk_begin = 0;
+    for (std::size_t i = 0; i < entry_ends.size(); ++i) {
+        std::size_t chunk_end = entry_ends[i];
+        REALM_ASSERT(chunk_end >= chunk_begin && chunk_end <= body.size());
+        bool is_last = (i + 1 == entry_ends.size());
+        if (!is_last && entry_ends[i + 1] - chunk_begin <= max_chunk_size)
+            continue;
+
+        std::size_t chunk_size = chunk_end - chunk_begin;
+        std::error_code ec = util::compression::allocate_and_compress(
+            compress_memory_arena, body.sub_span(chunk_begin, chunk_size), compressed_chunk); // Throws
+        if (ec)
+            return ec;
+
+        std::string chunk_head = util::format("%1 %2\n", chunk_size, compressed_chunk.size()); // Throws
+        out.insert(out.end(), chunk_head.begin(), chunk_head.end());                     // Throws
+        out.insert(out.end(), compressed_chunk.begin(), compressed_chunk.end());         // Throws
+        chunk_begin = chunk_end;
+    }
+    REALM_ASSERT(chunk_begin == body.size());
+    return std::error_code{};
+}
+
+
+std::error_code decompress_chunked_download_body(util::Span<const char> body, util::Span<char> out,
+                                                 util::ThreadPool& thread_pool)
+{
+    using util::compression::error;
+    struct Chunk {
+        util::Span<const char> compressed;
+        util::Span<char> uncompressed;
+    };
+
+    // The chunk heads are parsed up front, so that every chunk knows where its
+    // uncompressed data goes before any of them are decompressed.
+    std::vector<Chunk> chunks;
+    std::size_t offset = 0;
+    try {
+        HeaderLineParser parser(std::string_view(body.data(), body.size()));
+        while (!parser.at_end()) {
+            auto uncompressed_size = parser.read_next<std::size_t>();
+            auto compressed_size = parser.read_next<std::size_t>('\n');
+            if (uncompressed_size > out.size() - offset)
+                return error::incorrect_decompressed_size;
+            auto data = parser.read_sized_data<std::string_view>(compressed_size);
+            chunks.push_back({util::Span<const char>(data.data(), data.size()),
+                              out.sub_span(offset, uncompressed_size)}); // Throws
+            offset += uncompressed_size;
+        }
+    }
+    catch (const ProtocolCodecException&) {
+        return error::corrupt_input;
+    }
+    if (offset != out.size())
+        return error::incorrect_decompressed_size;
+
+    std::vector<std::error_code> errors(chunks.size()); // Throws
+    thread_pool.run(chunks.size(), [&](std::size_t i) {
+        errors[i] = util::compression::decompress(chunks[i].compressed, chunks[i].uncompressed);
+    }); // Throws
+    for (const std::error_code& ec : errors) {
+        if (ec)
+            return ec;
+    }
+    return std::error_code{};
+}
+
+
 std::string make_authorization_header(const std::string& signed_user_token)
 {
     return "Bearer " + signed_user_token;
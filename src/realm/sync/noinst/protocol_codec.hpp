@@ -3,6 +3,8 @@
 
 #include <cstdint>
 #include <algorithm>
+#include <list>
+#include <map>
 #include <memory>
 #include <vector>
 #include <string>
@@ -13,8 +15,10 @@
 #include <realm/util/logger.hpp>
 #include <realm/util/memory_stream.hpp>
 #include <realm/util/optional.hpp>
+#include <realm/util/thread_pool.hpp>
 #include <realm/binary_data.hpp>
 #include <realm/chunked_binary.hpp>
+#include <realm/sync/changeset_encoder.hpp>
 #include <realm/sync/changeset_parser.hpp>
 #include <realm/sync/history.hpp>
 #include <realm/sync/impl/clamped_hex_dump.hpp>
@@ -126,6 +130,23 @@ private:
     std::string_view m_sv;
 };
 
+// compress_chunked_download_body() compresses the body of a DOWNLOAD message as
+// a series of independently compressed chunks, each preceded by a line
+// `<uncompressed chunk size> <compressed chunk size>\n`. `entry_ends` holds the
+// end offset in `body` of each changeset entry. Entries are never split across
+// chunks, and a chunk holds as many entries as fit in `max_chunk_size`, but at
+// least one. The result is stored in `out`.
+std::error_code compress_chunked_download_body(util::compression::CompressMemoryArena&, util::Span<const char> body,
+                                               util::Span<const std::size_t> entry_ends, std::size_t max_chunk_size,
+                                               std::vector<char>& out);
+
+// decompress_chunked_download_body() decompresses a body produced by
+// compress_chunked_download_body() into `out`, whose size must be the size of
+// the uncompressed body. The chunks are decompressed in parallel on
+// `thread_pool`.
+std::error_code decompress_chunked_download_body(util::Span<const char> body, util::Span<char> out,
+                                                 util::ThreadPool& thread_pool);
+
 class ClientProtocol {
 public:
     // clang-format off
@@ -182,8 +203,10 @@ public:
     public:
         util::Logger& logger;
 
-        UploadMessageBuilder(util::Logger& logger, OutputBuffer& body_buffer, std::vector<char>& compression_buffer,
-                             util::compression::CompressMemoryArena& compress_memory_arena);
+        UploadMessageBuilder(int protocol_version, util::Logger& logger, OutputBuffer& body_buffer,
+                             std::vector<char>& compression_buffer,
+                             util::compression::CompressMemoryArena& compress_memory_arena,
+                             sync::ChangesetEncoder::Buffer& changeset_buffer);
 
         void add_changeset(version_type client_version, version_type server_version, timestamp_type origin_timestamp,
                            file_ident_type origin_file_ident, ChunkedBinaryData changeset);
@@ -193,13 +216,15 @@ public:
                                  version_type locked_server_version);
 
     private:
+        const int m_protocol_version;
         std::size_t m_num_changesets = 0;
         OutputBuffer& m_body_buffer;
         std::vector<char>& m_compression_buffer;
         util::compression::CompressMemoryArena& m_compress_memory_arena;
+        sync::ChangesetEncoder::Buffer& m_changeset_buffer;
     };
 
-    UploadMessageBuilder make_upload_message_builder(util::Logger& logger);
+    UploadMessageBuilder make_upload_message_builder(int protocol_version, util::Logger& logger);
 
     void make_unbind_message(OutputBuffer&, session_ident_type session_ident);
 
@@ -377,7 +402,9 @@ private:
         // If this is a PBS connection, then every download message is its own complete batch.
         auto last_in_batch = connection.is_flx_sync_connection() ? msg.read_next<bool>() : true;
         auto downloadable_bytes = msg.read_next<int64_t>();
-        auto is_body_compressed = msg.read_next<bool>();
+        // 0 = not compressed, 1 = compressed as a whole, 2 = compressed in
+        // independently compressed chunks (since protocol version 9).
+        auto body_compression = msg.read_next<int>();
         auto uncompressed_body_size = msg.read_next<size_t>();
         auto compressed_body_size = msg.read_next<size_t>('\n');
 
@@ -385,14 +412,28 @@ private:
             auto header = msg_with_header.substr(0, msg_with_header.size() - msg.remaining().size());
             return report_error(Error::limits_exceeded, "Limits exceeded in input message '%1'", header);
         }
+        if (body_compression < 0 || body_compression > 2) {
+            return report_error(Error::bad_syntax, "Bad body compression %1 in DOWNLOAD message", body_compression);
+        }
 
         std::unique_ptr<char[]> uncompressed_body_buffer;
-        // if is_body_compressed == true, we must decompress the received body.
-        if (is_body_compressed) {
+        // If the body is compressed, we must decompress the received body.
+        if (body_compression != 0) {
+            if (compressed_body_size > msg.bytes_remaining()) {
+                return report_error(Error::bad_syntax, "Bad compressed body size %1 > %2", compressed_body_size,
+                                    msg.bytes_remaining());
+            }
             uncompressed_body_buffer = std::make_unique<char[]>(uncompressed_body_size);
-            std::error_code ec =
-                util::compression::decompress({msg.remaining().data(), compressed_body_size},
-                                              {uncompressed_body_buffer.get(), uncompressed_body_size});
+            util::Span<const char> compressed_body{msg.remaining().data(), compressed_body_size};
+            util::Span<char> uncompressed_body{uncompressed_body_buffer.get(), uncompressed_body_size};
+            std::error_code ec;
+            if (body_compression == 1) {
+                ec = util::compression::decompress(compressed_body, uncompressed_body);
+            }
+            else {
+                ec = decompress_chunked_download_body(compressed_body, uncompressed_body,
+                                                      util::ThreadPool::get_default()); // Throws
+            }
 
             if (ec) {
                 return report_error(Error::bad_decompression, "compression::inflate: %1", ec.message());
@@ -401,9 +442,9 @@ private:
             msg = HeaderLineParser(std::string_view(uncompressed_body_buffer.get(), uncompressed_body_size));
         }
 
-        logger.trace("Download message compression: is_body_compressed = %1, "
+        logger.trace("Download message compression: body_compression = %1, "
                      "compressed_body_size=%2, uncompressed_body_size=%3",
-                     is_body_compressed, compressed_body_size, uncompressed_body_size);
+                     body_compression, compressed_body_size, uncompressed_body_size);
 
         ReceivedChangesets received_changesets;
 
@@ -487,6 +528,7 @@ private:
 
     // Permanent buffers to use for internal purposes such as compression.
     std::vector<char> m_buffer;
+    sync::ChangesetEncoder::Buffer m_changeset_buffer;
 
     util::compression::CompressMemoryArena m_compress_memory_arena;
 };
@@ -531,11 +573,65 @@ public:
     void make_unbound_message(OutputBuffer&, session_ident_type session_ident);
 
 
+    /// The changesets of the server-side histories in the encoding of the
+    /// protocol version of a client, by file, server version and encoding, for
+    /// changesets which are stored in another encoding. A changeset which is
+    /// downloaded by many clients is then re-encoded once. Only changesets as
+    /// they are stored in the history may be looked up, not compacted ones.
+    /// One cache is shared by all the files of a server, so `max_size` bounds
+    /// the memory used for all of them. When the cache is full, the least
+    /// recently used changesets are dropped. A changeset which is larger than
+    /// the whole cache is not cached.
+    class TranscodedChangesetCache {
+    public:
+        explicit TranscodedChangesetCache(std::size_t max_size = 64 * 1024 * 1024) noexcept
+            : m_max_size{max_size}
+        {
+        }
+
+        /// Set `transcoded` to the changeset of `server_version` of `file` in
+        /// the encoding used by `protocol_version`, which is `changeset`
+        /// re-encoded. `file` only identifies the history, and is never
+        /// dereferenced. `transcoded` refers to the cache, or to `buffer` if
+        /// the changeset is too large to be cached, and is valid until the
+        /// next call. Returns false if `changeset` is in that encoding
+        /// already.
+        bool get(const void* file, int protocol_version, version_type server_version,
+                 const ChunkedBinaryData& changeset, sync::ChangesetEncoder::Buffer& buffer, BinaryData& transcoded);
+
+        /// Drop the changesets of `file`. To be called before the identity of
+        /// `file` can be reused.
+        void erase(const void* file) noexcept;
+
+        /// The number of bytes held by the cache.
+        std::size_t size() const noexcept
+        {
+            return m_size;
+        }
+
+    private:
+        // The file identity is held as an integer so that keys of different
+        // files are totally ordered.
+        using Key = std::tuple<std::uintptr_t, version_type, bool>;
+        struct Entry {
+            std::vector<char> data;
+            std::list<Key>::iterator lru_pos;
+        };
+        std::map<Key, Entry> m_changesets;
+        // Least recently used first
+        std::list<Key> m_lru;
+        std::size_t m_size = 0;
+        const std::size_t m_max_size;
+    };
+
     struct ChangesetInfo {
         version_type server_version;
         version_type client_version;
         sync::HistoryEntry entry;
         std::size_t original_size;
+        // Set if the changeset is as stored in the history of `file`
+        TranscodedChangesetCache* cache = nullptr;
+        const void* file = nullptr;
     };
 
     void make_download_message(int protocol_version, OutputBuffer&, session_ident_type session_ident,
@@ -760,7 +856,8 @@ public:
         }
     }
 
-    void insert_single_changeset_download_message(OutputBuffer&, const ChangesetInfo&, util::Logger&);
+    void insert_single_changeset_download_message(int protocol_version, OutputBuffer&, const ChangesetInfo&,
+                                                  util::Logger&);
 
 private:
     // clang-format off
@@ -771,6 +868,10 @@ private:
     static constexpr std::size_t s_max_changeset_size         = std::numeric_limits<std::size_t>::max(); // FIXME: What is a reasonable value here?
     static constexpr std::size_t s_max_body_size              = std::numeric_limits<std::size_t>::max();
     // clang-format on
+
+    // Permanent buffer for changesets that are transcoded to the encoding
+    // used by the protocol version of the client.
+    sync::ChangesetEncoder::Buffer m_changeset_buffer;
 };
 
 // make_authorization_header() makes the value of the Authorization header used in the
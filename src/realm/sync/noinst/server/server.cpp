@@ -187,6 +187,7 @@ bool determine_try_again(ProtocolError error_code) noexcept
 
 class ServerFile;
 class ServerImpl;
+class Worker;
 class HTTPConnection;
 class SyncConnection;
 class Session;
@@ -221,6 +222,7 @@ struct DownloadCache {
     std::size_t compressed_body_size;
     bool body_is_compressed;
     version_type end_version;
+    int protocol_version;
     DownloadCursor download_progress;
     std::uint_fast64_t downloadable_bytes;
     std::size_t num_changesets;
@@ -534,6 +536,7 @@ public:
 
 private:
     ServerImpl& m_server;
+    Worker& m_worker; // The worker thread integrating changes to this file
     ServerFileAccessCache::Slot m_file;
 
     // In general, `m_version_info` refers to the last snapshot of the Realm
@@ -815,6 +818,11 @@ public:
         return m_misc_buffers;
     }
 
+    ServerProtocol::TranscodedChangesetCache& get_transcoded_changeset_cache() noexcept
+    {
+        return m_transcoded_changeset_cache;
+    }
+
     int_fast64_t get_current_server_session_ident() const noexcept
     {
         return m_current_server_session_ident;
@@ -825,9 +833,11 @@ public:
         return m_scratch_memory;
     }
 
-    Worker& get_worker() noexcept
+    // Each file is served by one of the workers, chosen by its path, so that
+    // changes to different files can be integrated in parallel.
+    Worker& get_worker(const std::string& real_path) noexcept
     {
-        return m_worker;
+        return *m_workers[std::hash<std::string>{}(real_path) % m_workers.size()];
     }
 
     void get_workunit_timers(milliseconds_type& parallel_section, milliseconds_type& sequential_section)
@@ -908,11 +918,6 @@ public:
         return file;
     }
 
-    std::unique_ptr<ServerHistory> make_history_for_path()
-    {
-        return std::make_unique<ServerHistory>(*this);
-    }
-
     util::bind_ptr<ServerFile> get_file(const std::string& virt_path) noexcept
     {
         auto i = m_files.find(virt_path);
@@ -998,7 +1003,10 @@ private:
 
     std::unique_ptr<util::network::ssl::Context> m_ssl_context;
     ServerFileAccessCache m_file_access_cache;
-    Worker m_worker;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    // Shared by all files, so it must outlive them. Only accessed by the event
+    // loop thread.
+    ServerProtocol::TranscodedChangesetCache m_transcoded_changeset_cache;
     std::map<std::string, util::bind_ptr<ServerFile>> m_files; // Key is virtual path
     util::network::Acceptor m_acceptor;
     std::int_fast64_t m_next_conn_id = 0;
@@ -1980,28 +1988,48 @@ public:
     std::size_t num_changesets = 0;
     std::size_t accum_original_size = 0;
     std::size_t accum_compacted_size = 0;
-
-    DownloadHistoryEntryHandler(ServerProtocol& protocol, OutputBuffer& buffer, util::Logger& logger) noexcept
-        : m_protocol{protocol}
+    // The end offset in the output buffer of each inserted changeset entry.
+    std::vector<std::size_t> entry_ends;
+
+    /// Changesets of `file` are looked up in `cache`, if not null, rather than
+    /// being re-encoded for the protocol version. This is only allowed when download
+    /// compaction is disabled.
+    DownloadHistoryEntryHandler(int protocol_version, ServerProtocol& protocol, OutputBuffer& buffer,
+                                util::Logger& logger, ServerProtocol::TranscodedChangesetCache* cache,
+                                const ServerFile* file) noexcept
+        : m_protocol_version{protocol_version}
+        , m_protocol{protocol}
         , m_buffer{buffer}
         , m_logger{logger}
+        , m_cache{cache}
+        , m_file{file}
     {
     }
 
+    bool wants_columnar_changesets() const noexcept override
+    {
+        return sync::uses_columnar_changesets(m_protocol_version);
+    }
+
     void handle(version_type server_version, const HistoryEntry& entry, size_t original_size) override
     {
         version_type client_version = entry.remote_version;
-        ServerProtocol::ChangesetInfo info{server_version, client_version, entry, original_size};
-        m_protocol.insert_single_changeset_download_message(m_buffer, info, m_logger); // Throws
+        ServerProtocol::ChangesetInfo info{server_version, client_version, entry, original_size, m_cache, m_file};
+        m_protocol.insert_single_changeset_download_message(m_protocol_version, m_buffer, info,
+                                                            m_logger); // Throws
+        entry_ends.push_back(m_buffer.size()); // Throws
         ++num_changesets;
         accum_original_size += original_size;
         accum_compacted_size += entry.changeset.size();
     }
 
 private:
+    const int m_protocol_version;
     ServerProtocol& m_protocol;
     OutputBuffer& m_buffer;
     util::Logger& m_logger;
+    ServerProtocol::TranscodedChangesetCache* const m_cache;
+    const ServerFile* const m_file;
 };
 
 
@@ -2837,11 +2865,13 @@ private:
             std::size_t accum_original_size;
             std::size_t accum_compacted_size;
             ServerProtocol& protocol = get_server_protocol();
+            int protocol_version = m_connection.get_client_protocol_version();
             bool disable_download_compaction = config.disable_download_compaction;
             bool enable_cache = (config.enable_download_bootstrap_cache && m_download_progress.server_version == 0 &&
                                  m_upload_progress.client_version == 0 && m_upload_threshold.client_version == 0);
             DownloadCache& cache = m_server_file->get_download_cache();
-            bool fetch_from_cache = (enable_cache && cache.body && end_version == cache.end_version);
+            bool fetch_from_cache = (enable_cache && cache.body && end_version == cache.end_version &&
+                                     protocol_version == cache.protocol_version);
             if (fetch_from_cache) {
                 body = cache.body.get();
                 uncompressed_body_size = cache.uncompressed_body_size;
@@ -2865,7 +2895,11 @@ private:
                 out.reset();
                 download_progress = m_download_progress;
                 auto fetch_and_compress = [&](std::size_t max_download_size) {
-                    DownloadHistoryEntryHandler handler{protocol, out, logger};
+                    ServerProtocol::TranscodedChangesetCache* transcoded_cache = nullptr;
+                    if (disable_download_compaction)
+                        transcoded_cache = &server.get_transcoded_changeset_cache();
+                    DownloadHistoryEntryHandler handler{protocol_version, protocol, out,
+                                                        logger, transcoded_cache, m_server_file.get()};
                     std::uint_fast64_t cumulative_byte_size_current;
                     std::uint_fast64_t cumulative_byte_size_total;
                     bool not_expired = history.fetch_download_info(
@@ -2891,8 +2925,19 @@ private:
                     if (uncompressed.size() > max_uncompressed) {
                         compression::CompressMemoryArena& arena = server.get_compress_memory_arena();
                         std::vector<char>& buffer = server.get_misc_buffers().compress;
-                        compression::allocate_and_compress(arena, uncompressed, buffer); // Throws
-                        if (buffer.size() < uncompressed.size()) {
+                        std::error_code ec;
+                        if (sync::uses_chunked_download_compression(protocol_version)) {
+                            // Compress in chunks, so that the client can
+                            // decompress them in parallel.
+                            constexpr std::size_t max_chunk_size = 256 * 1024;
+                            util::Span<const std::size_t> entry_ends{handler.entry_ends};
+                            ec = _impl::compress_chunked_download_body(arena, uncompressed, entry_ends,
+                                                                       max_chunk_size, buffer); // Throws
+                        }
+                        else {
+                            ec = compression::allocate_and_compress(arena, uncompressed, buffer); // Throws
+                        }
+                        if (!ec && buffer.size() < uncompressed.size()) {
                             body = buffer.data();
                             compressed_body_size = buffer.size();
                             body_is_compressed = true;
@@ -2918,6 +2963,7 @@ private:
                     cache.compressed_body_size = compressed_body_size;
                     cache.body_is_compressed = body_is_compressed;
                     cache.end_version = end_version;
+                    cache.protocol_version = protocol_version;
                     cache.download_progress = download_progress;
                     cache.downloadable_bytes = downloadable_bytes;
                     cache.num_changesets = num_changesets;
@@ -3155,11 +3201,12 @@ void SessionQueue::clear() noexcept
 
 ServerFile::ServerFile(ServerImpl& server, ServerFileAccessCache& cache, const std::string& virt_path,
                        std::string real_path, bool disable_sync_to_disk)
-    : logger{"ServerFile[" + virt_path + "]: ", server.logger}               // Throws
-    , wlogger{"ServerFile[" + virt_path + "]: ", server.get_worker().logger} // Throws
+    : logger{"ServerFile[" + virt_path + "]: ", server.logger}                          // Throws
+    , wlogger{"ServerFile[" + virt_path + "]: ", server.get_worker(real_path).logger} // Throws
     , m_server{server}
+    , m_worker{server.get_worker(real_path)}
     , m_file{cache, real_path, virt_path, false, disable_sync_to_disk} // Throws
-    , m_worker_file{server.get_worker().get_file_access_cache(), real_path, virt_path, true, disable_sync_to_disk}
+    , m_worker_file{m_worker.get_file_access_cache(), real_path, virt_path, true, disable_sync_to_disk}
 {
 }
 
@@ -3169,6 +3216,7 @@ ServerFile::~ServerFile() noexcept
     REALM_ASSERT(m_unidentified_sessions.empty());
     REALM_ASSERT(m_identified_sessions.empty());
     REALM_ASSERT(m_file_ident_request == 0);
+    m_server.get_transcoded_changeset_cache().erase(this);
 }
 
 
@@ -3422,8 +3470,7 @@ void ServerFile::group_unblock_work()
         if (REALM_LIKELY(work.has_primary_work)) {
             logger.trace("Work unit unblocked"); // Throws
             m_has_work_in_progress = true;
-            Worker& worker = m_server.get_worker();
-            worker.enqueue(this); // Throws
+            m_worker.enqueue(this); // Throws
         }
     }
 }
@@ -3554,7 +3601,7 @@ ServerHistory& ServerFile::get_client_file_history(WorkerState& state, std::uniq
     if (state.use_file_cache)
         return worker_access().history; // Throws
     const std::string& path = m_worker_file.realm_path;
-    hist_ptr = m_server.make_history_for_path();                   // Throws
+    hist_ptr = std::make_unique<ServerHistory>(m_worker);          // Throws
     DBOptions options = m_worker_file.make_shared_group_options(); // Throws
     sg_ptr = DB::create(*hist_ptr, path, options);                 // Throws
     sg_ptr->claim_sync_agent();                                    // Throws
@@ -3767,7 +3814,7 @@ ServerImpl::ServerImpl(const std::string& root_dir, util::Optional<sync::PKey> p
     , m_access_control{std::move(pkey)}
     , m_protocol_version_range{determine_protocol_version_range(config)}                 // Throws
     , m_file_access_cache{m_config.max_open_files, logger, *this, config.encryption_key} // Throws
-    , m_worker{*this}                                                                    // Throws
+    , m_transcoded_changeset_cache{m_config.max_transcoded_changeset_cache_size}
     , m_acceptor{get_service()}
     , m_server_protocol{}       // Throws
     , m_compress_memory_arena{} // Throws
@@ -3777,6 +3824,10 @@ ServerImpl::ServerImpl(const std::string& root_dir, util::Optional<sync::PKey> p
         m_ssl_context->use_certificate_chain_file(m_config.ssl_certificate_path); // Throws
         m_ssl_context->use_private_key_file(m_config.ssl_certificate_key_path);   // Throws
     }
+    int num_workers = std::max(m_config.num_integration_workers, 1);
+    m_workers.reserve(num_workers); // Throws
+    for (int i = 0; i < num_workers; ++i)
+        m_workers.push_back(std::make_unique<Worker>(*this)); // Throws
 }
 
 
@@ -3814,6 +3865,7 @@ void ServerImpl::start()
     }
     logger.info("Directory holding persistent state: %1", m_root_dir);        // Throws
     logger.info("Maximum number of open files: %1", m_config.max_open_files); // Throws
+    logger.info("Number of integration workers: %1", m_workers.size());      // Throws
     {
         const char* lead_text = "Encryption";
         if (m_config.encryption_key) {
@@ -3865,19 +3917,27 @@ void ServerImpl::run()
     auto ta = util::make_temp_assign(m_running, true);
 
     {
-        auto worker_thread = util::make_thread_exec_guard(m_worker, *this); // Throws
+        std::vector<util::ThreadExecGuardWithParent<Worker, ServerImpl>> worker_threads;
+        worker_threads.reserve(m_workers.size()); // Throws
         std::string name;
-        if (util::Thread::get_name(name)) {
-            name += "-worker";
-            worker_thread.start_with_signals_blocked(name); // Throws
-        }
-        else {
-            worker_thread.start_with_signals_blocked(); // Throws
+        bool has_name = util::Thread::get_name(name);
+        for (std::size_t i = 0; i < m_workers.size(); ++i) {
+            auto& worker_thread = worker_threads.emplace_back(*m_workers[i], *this); // Throws
+            if (has_name) {
+                std::string worker_name = name + "-worker";
+                if (m_workers.size() > 1)
+                    worker_name += util::to_string(i);
+                worker_thread.start_with_signals_blocked(worker_name); // Throws
+            }
+            else {
+                worker_thread.start_with_signals_blocked(); // Throws
+            }
         }
 
         m_service.run(); // Throws
 
-        worker_thread.stop_and_rethrow(); // Throws
+        for (auto& worker_thread : worker_threads)
+            worker_thread.stop_and_rethrow(); // Throws
     }
 
     logger.info("Realm sync server stopped");
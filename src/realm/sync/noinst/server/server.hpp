@@ -76,6 +76,14 @@ public:
         /// for each major thread).
         long max_open_files = 256;
 
+        /// The number of worker threads integrating the changes uploaded by
+        /// clients. Each Realm file is assigned to one of them by a hash of
+        /// its path, so that uploads to different files are integrated in
+        /// parallel, while the changes to one file are still integrated in
+        /// order. Each worker keeps its own cache of open Realm files (see
+        /// \ref max_open_files).
+        int num_integration_workers = 1;
+
         /// An optional custom clock to be used for token expiration checks. If
         /// no clock is specified, the server will use the system clock.
         Clock* token_expiration_clock = nullptr;
@@ -179,6 +187,12 @@ public:
         /// for the need to resend the same changes after network disconnects.
         std::size_t max_download_size = 0x1000000; // 16 MiB
 
+        /// The maximum accumulated size of the changesets that the server keeps
+        /// re-encoded for the protocol version of clients, for all files
+        /// together. This cache is only used when download compaction is
+        /// disabled (\ref disable_download_compaction).
+        std::size_t max_transcoded_changeset_cache_size = 0x4000000; // 64 MiB
+
         /// The maximum number of connections that can be queued up waiting to
         /// be accepted by the server. This corresponds to the `backlog`
         /// argument of the `listen()` function as described by POSIX.
@@ -866,10 +866,18 @@ bool ServerHistory::fetch_download_info(file_ident_type client_file_ident, Downl
     if (!disable_download_compaction) {
         compact_changesets(changesets.data(), changesets.size());
 
+        // Encoded as the handler wants them, so that they need not be
+        // transcoded for the wire
+        bool columnar = handler.wants_columnar_changesets();
         ChangesetEncoder::Buffer encode_buffer;
         for (std::size_t i = 0; i < changesets.size(); ++i) {
             auto& changeset = changesets[i];
-            encode_changeset(changeset, encode_buffer); // Throws
+            if (columnar) {
+                encode_changeset_columnar(changeset, encode_buffer); // Throws
+            }
+            else {
+                encode_changeset(changeset, encode_buffer); // Throws
+            }
             HistoryEntry entry;
             entry.remote_version = changeset.last_integrated_remote_version;
             entry.origin_file_ident = changeset.origin_file_ident;
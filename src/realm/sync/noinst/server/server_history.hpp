@@ -136,6 +136,12 @@ public:
 
     struct HistoryEntryHandler {
         virtual void handle(version_type server_version, const HistoryEntry&, std::size_t original_size) = 0;
+        /// Whether changesets which are encoded anew, such as compacted ones,
+        /// are to be in the columnar encoding.
+        virtual bool wants_columnar_changesets() const noexcept
+        {
+            return false;
+        }
         virtual ~HistoryEntryHandler() {}
     };
 
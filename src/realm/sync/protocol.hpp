@@ -33,12 +33,33 @@ namespace sync {
 //   7 Client takes the 'action' specified in the 'json_error' messages received
 //     from server. Client sends 'json_error' messages to the server.
 //
+//   8 Changesets in UPLOAD and DOWNLOAD messages use the columnar encoding
+//     (see encode_changeset_columnar()).
+//
+//   9 The body of a DOWNLOAD message may be compressed as a series of
+//     independently compressed chunks, which the client decompresses in
+//     parallel.
+//
 //  XX Changes:
 //     - TBD
 //
 constexpr int get_current_protocol_version() noexcept
 {
-    return 7;
+    return 9;
+}
+
+/// Whether changesets in UPLOAD and DOWNLOAD messages use the columnar encoding
+/// in the specified protocol version.
+constexpr bool uses_columnar_changesets(int protocol_version) noexcept
+{
+    return protocol_version >= 8;
+}
+
+/// Whether the body of a DOWNLOAD message is compressed in chunks, when it is
+/// compressed, in the specified protocol version.
+constexpr bool uses_chunked_download_compression(int protocol_version) noexcept
+{
+    return protocol_version >= 9;
 }
 
 constexpr std::string_view get_pbs_websocket_protocol_prefix() noexcept
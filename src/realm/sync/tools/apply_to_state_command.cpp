@@ -99,7 +99,7 @@ DownloadMessage DownloadMessage::parse(HeaderLineParser& msg, Logger& logger, bo
     auto last_in_batch = is_flx_sync ? msg.read_next<bool>() : true;
     ret.batch_state = last_in_batch ? sync::DownloadBatchState::LastInBatch : sync::DownloadBatchState::MoreToCome;
     ret.downloadable_bytes = msg.read_next<int64_t>();
-    auto is_body_compressed = msg.read_next<bool>();
+    auto body_compression = msg.read_next<int>();
     auto uncompressed_body_size = msg.read_next<size_t>();
     auto compressed_body_size = msg.read_next<size_t>('\n');
 
@@ -110,10 +110,17 @@ DownloadMessage DownloadMessage::parse(HeaderLineParser& msg, Logger& logger, bo
                  ret.latest_server_version.version);
 
     std::string_view body_str;
-    if (is_body_compressed) {
+    if (body_compression != 0) {
         ret.uncompressed_body_buffer.set_size(uncompressed_body_size);
         auto compressed_body = msg.read_sized_data<BinaryData>(compressed_body_size);
-        std::error_code ec = util::compression::decompress(compressed_body, ret.uncompressed_body_buffer);
+        std::error_code ec;
+        if (body_compression == 2) {
+            ec = decompress_chunked_download_body(compressed_body, ret.uncompressed_body_buffer,
+                                                  ThreadPool::get_default());
+        }
+        else {
+            ec = util::compression::decompress(compressed_body, ret.uncompressed_body_buffer);
+        }
 
         if (ec) {
             throw ProtocolCodecException("error decompressing download message");
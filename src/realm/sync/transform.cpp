@@ -659,8 +659,8 @@ struct TransformerImpl::Transformer {
         }
         else {
             ///
-            /// CONFLICT GROUP: Everything touching the involved objects,
-            /// including schema changes.
+            /// CONFLICT GROUP: Everything touching the path of the instruction,
+            /// i.e. the same field of the object, or the object itself.
             ///
             _impl::ChangesetIndex::GlobalID major_ids[2];
             size_t num_major_ids = m_major_side.get_object_ids_in_current_instruction(major_ids, 2);
@@ -677,16 +677,28 @@ struct TransformerImpl::Transformer {
                     if (i + 1 != num_major_ids)
                         std::cerr << ", ";
                 }
+                if (auto path_instr = instr.get_if<Instruction::PathInstruction>()) {
+                    std::cerr << " (field '" << m_major_side.get_string(path_instr->field) << "')";
+                }
                 std::cerr << "\n" << TERM_RESET;
             }
 #endif // REALM_DEBUG LCOV_EXCL_STOP
-            auto ranges = index.get_modifications_for_object(major_ids[0]);
             if (num_major_ids == 2) {
                 // Check that the index has correctly joined the ranges for the
                 // two object IDs.
-                REALM_ASSERT(ranges == index.get_modifications_for_object(major_ids[1]));
+                REALM_ASSERT(index.get_modifications_for_object(major_ids[0]) ==
+                             index.get_modifications_for_object(major_ids[1]));
             }
-            return ranges;
+
+            // Merge rules between object instructions only ever act on
+            // instructions that touch the same object, and among those,
+            // instructions on different fields never interact. So there is
+            // no need to visit the rest of the conflict group.
+            if (auto path_instr = instr.get_if<Instruction::PathInstruction>()) {
+                StringData field = m_major_side.get_string(path_instr->field);
+                return index.get_modifications_for_path(major_ids[0], field);
+            }
+            return index.get_modifications_for_path(major_ids[0]);
         }
     }
 
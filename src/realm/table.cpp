@@ -38,6 +38,7 @@
 #include <realm/util/miscellaneous.hpp>
 #include <realm/util/serializer.hpp>
 
+#include <numeric>
 #include <stdexcept>
 
 #ifdef REALM_DEBUG
@@ -653,6 +654,7 @@ void Table::init(ref_type top_ref, ArrayParent* parent, size_t ndx_in_parent, bo
     }
     else
         m_in_file_version_at_transaction_boundary = rot_version.get_as_int();
+    m_zone_map.clear();
 
     auto rot_pk_key = m_top.get_as_ref_or_tagged(top_position_for_pk_col);
     m_primary_key_col = rot_pk_key.is_tagged() ? ColKey(rot_pk_key.get_as_int()) : ColKey();
@@ -676,6 +678,7 @@ void Table::init(ref_type top_ref, ArrayParent* parent, size_t ndx_in_parent, bo
     else {
         m_tombstones = nullptr;
     }
+    refresh_secondary_index_accessors();
     m_cookie = cookie_initialized;
 }
 
@@ -706,75 +709,98 @@ void Table::populate_search_index(ColKey col_key)
 {
     auto col_ndx = col_key.get_index().val;
     StringIndex* index = m_index_accessors[col_ndx].get();
+    index->populate(); // Throws
+}
 
-    // Insert ref to index
-    for (auto o : *this) {
-        ObjKey key = o.get_key();
-        DataType type = get_column_type(col_key);
+void Table::erase_from_search_indexes(ObjKey key)
+{
+    // Tombstones do not use index - will crash if we try to erase values
+    if (!key.is_unresolved()) {
+        for (auto&& index : m_index_accessors) {
+            if (index) {
+                index->erase(key);
+            }
+        }
+        for (auto&& index : m_ordered_index_accessors) {
+            index->erase(key);
+        }
+        for (auto&& index : m_fulltext_index_accessors) {
+            index->erase(key);
+        }
+    }
+}
 
-        if (type == type_Int) {
-            if (is_nullable(col_key)) {
-                Optional<int64_t> value = o.get<Optional<int64_t>>(col_key);
-                index->insert(key, value); // Throws
+// The value a new object gets in an ordered index when the column is not
+// given an initial value
+static Mixed ordered_index_value(ColKey col_key, Mixed value)
+{
+    if (value.is_null() && !col_key.is_nullable()) {
+        if (col_key.get_type() == col_type_Int)
+            return Mixed(int64_t(0));
+        return Mixed(Timestamp(0, 0));
+    }
+    return value;
+}
+
+static void insert_into_index(StringIndex& index, ColKey col_key, ObjKey key, Mixed value)
+{
+    auto type = col_key.get_type();
+    auto attr = col_key.get_attrs();
+    bool nullable = attr.test(col_attr_Nullable);
+    switch (type) {
+        case col_type_Int:
+            if (value.is_null()) {
+                index.insert(key, ArrayIntNull::default_value(nullable));
             }
             else {
-                int64_t value = o.get<int64_t>(col_key);
-                index->insert(key, value); // Throws
+                index.insert(key, value.get<int64_t>());
             }
-        }
-        else if (type == type_Bool) {
-            if (is_nullable(col_key)) {
-                Optional<bool> value = o.get<Optional<bool>>(col_key);
-                index->insert(key, value); // Throws
+            break;
+        case col_type_Bool:
+            if (value.is_null()) {
+                index.insert(key, ArrayBoolNull::default_value(nullable));
             }
             else {
-                bool value = o.get<bool>(col_key);
-                index->insert(key, value); // Throws
+                index.insert(key, value.get<bool>());
             }
-        }
-        else if (type == type_String) {
-            StringData value = o.get<StringData>(col_key);
-            index->insert(key, value); // Throws
-        }
-        else if (type == type_Timestamp) {
-            Timestamp value = o.get<Timestamp>(col_key);
-            index->insert(key, value); // Throws
-        }
-        else if (type == type_ObjectId) {
-            if (is_nullable(col_key)) {
-                Optional<ObjectId> value = o.get<Optional<ObjectId>>(col_key);
-                index->insert(key, value); // Throws
+            break;
+        case col_type_String:
+            if (value.is_null()) {
+                index.insert(key, ArrayString::default_value(nullable));
             }
             else {
-                ObjectId value = o.get<ObjectId>(col_key);
-                index->insert(key, value); // Throws
+                index.insert(key, value.get<String>());
             }
-        }
-        else if (type == type_UUID) {
-            if (is_nullable(col_key)) {
-                Optional<UUID> value = o.get<Optional<UUID>>(col_key);
-                index->insert(key, value); // Throws
+            break;
+        case col_type_Timestamp:
+            if (value.is_null()) {
+                index.insert(key, ArrayTimestamp::default_value(nullable));
             }
             else {
-                UUID value = o.get<UUID>(col_key);
-                index->insert(key, value); // Throws
+                index.insert(key, value.get<Timestamp>());
             }
-        }
-        else {
-            REALM_ASSERT_RELEASE(false && "Data type does not support search index");
-        }
-    }
-}
-
-void Table::erase_from_search_indexes(ObjKey key)
-{
-    // Tombstones do not use index - will crash if we try to erase values
-    if (!key.is_unresolved()) {
-        for (auto&& index : m_index_accessors) {
-            if (index) {
-                index->erase(key);
+            break;
+        case col_type_ObjectId:
+            if (value.is_null()) {
+                index.insert(key, ArrayObjectIdNull::default_value(nullable));
             }
-        }
+            else {
+                index.insert(key, value.get<ObjectId>());
+            }
+            break;
+        case col_type_Mixed:
+            index.insert(key, value);
+            break;
+        case col_type_UUID:
+            if (value.is_null()) {
+                index.insert(key, ArrayUUIDNull::default_value(nullable));
+            }
+            else {
+                index.insert(key, value.get<UUID>());
+            }
+            break;
+        default:
+            REALM_UNREACHABLE();
     }
 }
 
@@ -799,67 +825,26 @@ void Table::update_indexes(ObjKey key, const FieldValues& values)
 
         if (auto&& index = m_index_accessors[column_ndx]) {
             // There is an index for this column
-            auto col_key = m_leaf_ndx2colkey[column_ndx];
-            auto type = col_key.get_type();
-            auto attr = col_key.get_attrs();
-            bool nullable = attr.test(col_attr_Nullable);
-            switch (type) {
-                case col_type_Int:
-                    if (init_value.is_null()) {
-                        index->insert(key, ArrayIntNull::default_value(nullable));
-                    }
-                    else {
-                        index->insert(key, init_value.get<int64_t>());
-                    }
-                    break;
-                case col_type_Bool:
-                    if (init_value.is_null()) {
-                        index->insert(key, ArrayBoolNull::default_value(nullable));
-                    }
-                    else {
-                        index->insert(key, init_value.get<bool>());
-                    }
-                    break;
-                case col_type_String:
-                    if (init_value.is_null()) {
-                        index->insert(key, ArrayString::default_value(nullable));
-                    }
-                    else {
-                        index->insert(key, init_value.get<String>());
-                    }
-                    break;
-                case col_type_Timestamp:
-                    if (init_value.is_null()) {
-                        index->insert(key, ArrayTimestamp::default_value(nullable));
-                    }
-                    else {
-                        index->insert(key, init_value.get<Timestamp>());
-                    }
-                    break;
-                case col_type_ObjectId:
-                    if (init_value.is_null()) {
-                        index->insert(key, ArrayObjectIdNull::default_value(nullable));
-                    }
-                    else {
-                        index->insert(key, init_value.get<ObjectId>());
-                    }
-                    break;
-                case col_type_Mixed:
-                    index->insert(key, init_value);
-                    break;
-                case col_type_UUID:
-                    if (init_value.is_null()) {
-                        index->insert(key, ArrayUUIDNull::default_value(nullable));
-                    }
-                    else {
-                        index->insert(key, init_value.get<UUID>());
-                    }
-                    break;
-                default:
-                    REALM_UNREACHABLE();
-            }
+            insert_into_index(*index, m_leaf_ndx2colkey[column_ndx], key, init_value);
         }
     }
+
+    for (auto&& index : m_ordered_index_accessors) {
+        ColKey col_key = index->get_column_key();
+        auto it = std::find_if(values.begin(), values.end(), [&](const FieldValue& v) {
+            return v.col_key == col_key;
+        });
+        index->insert(key, ordered_index_value(col_key, it == values.end() ? Mixed() : it->value));
+    }
+
+    for (auto&& index : m_fulltext_index_accessors) {
+        ColKey col_key = index->get_column_key();
+        auto it = std::find_if(values.begin(), values.end(), [&](const FieldValue& v) {
+            return v.col_key == col_key;
+        });
+        if (it != values.end())
+            index->insert(key, it->value);
+    }
 }
 
 void Table::clear_indexes()
@@ -869,6 +854,12 @@ void Table::clear_indexes()
             index->clear();
         }
     }
+    for (auto&& index : m_ordered_index_accessors) {
+        index->clear();
+    }
+    for (auto&& index : m_fulltext_index_accessors) {
+        index->clear();
+    }
 }
 
 void Table::do_add_search_index(ColKey col_key)
@@ -945,6 +936,122 @@ void Table::remove_search_index(ColKey col_key)
     m_spec.set_column_attr(spec_ndx, attr); // Throws
 }
 
+bool Table::has_ordered_index(ColKey col_key) const noexcept
+{
+    return get_ordered_index(col_key) != nullptr;
+}
+
+void Table::add_ordered_index(ColKey col_key)
+{
+    check_column(col_key);
+
+    // Early-out if already indexed
+    if (has_ordered_index(col_key))
+        return;
+
+    if (!OrderedIndex::type_supported(DataType(col_key.get_type())) || col_key.is_collection()) {
+        throw LogicError(LogicError::illegal_combination);
+    }
+
+    if (!m_ordered_index_refs.is_attached()) {
+        // The slot is added on demand, as files created by older versions
+        // do not have it
+        while (m_top.size() <= top_position_for_ordered_indexes)
+            m_top.add(0); // Throws
+        bool context_flag = false;
+        MemRef mem = Array::create_empty_array(Array::type_HasRefs, context_flag, m_alloc); // Throws
+        m_ordered_index_refs.init_from_mem(mem);
+        m_ordered_index_refs.update_parent(); // Throws
+    }
+
+    // Create the index
+    auto index = std::make_unique<OrderedIndex>(ClusterColumn(&m_clusters, col_key), get_alloc()); // Throws
+    size_t ndx = m_ordered_index_refs.size();
+    index->set_parent(&m_ordered_index_refs, ndx);
+    m_ordered_index_refs.add(from_ref(index->get_ref())); // Throws
+    m_ordered_index_accessors.push_back(std::move(index));
+
+    m_ordered_index_accessors.back()->populate(); // Throws
+}
+
+void Table::remove_ordered_index(ColKey col_key)
+{
+    check_column(col_key);
+    auto it = std::find_if(m_ordered_index_accessors.begin(), m_ordered_index_accessors.end(), [&](auto&& index) {
+        return index->get_column_key() == col_key;
+    });
+
+    // Early-out if non-indexed
+    if (it == m_ordered_index_accessors.end())
+        return;
+
+    // Destroy and remove the index, and close the gap in the accessor list
+    size_t ndx = it - m_ordered_index_accessors.begin();
+    (*it)->destroy();
+    m_ordered_index_accessors.erase(it);
+    m_ordered_index_refs.erase(ndx);
+    for (size_t i = ndx; i < m_ordered_index_accessors.size(); ++i)
+        m_ordered_index_accessors[i]->set_ndx_in_parent(i);
+}
+
+bool Table::has_fulltext_index(ColKey col_key) const noexcept
+{
+    return get_fulltext_index(col_key) != nullptr;
+}
+
+void Table::add_fulltext_index(ColKey col_key)
+{
+    check_column(col_key);
+
+    // Early-out if already indexed
+    if (has_fulltext_index(col_key))
+        return;
+
+    if (!FullTextIndex::type_supported(DataType(col_key.get_type())) || col_key.is_collection()) {
+        throw LogicError(LogicError::illegal_combination);
+    }
+
+    if (!m_fulltext_index_refs.is_attached()) {
+        // The slot is added on demand, as files created by older versions
+        // do not have it
+        while (m_top.size() <= top_position_for_fulltext_indexes)
+            m_top.add(0); // Throws
+        bool context_flag = false;
+        MemRef mem = Array::create_empty_array(Array::type_HasRefs, context_flag, m_alloc); // Throws
+        m_fulltext_index_refs.init_from_mem(mem);
+        m_fulltext_index_refs.update_parent(); // Throws
+    }
+
+    // Create the index
+    auto index = std::make_unique<FullTextIndex>(ClusterColumn(&m_clusters, col_key), get_alloc()); // Throws
+    size_t ndx = m_fulltext_index_refs.size();
+    index->set_parent(&m_fulltext_index_refs, ndx);
+    m_fulltext_index_refs.add(from_ref(index->get_ref())); // Throws
+    m_fulltext_index_accessors.push_back(std::move(index));
+
+    m_fulltext_index_accessors.back()->populate(); // Throws
+}
+
+void Table::remove_fulltext_index(ColKey col_key)
+{
+    check_column(col_key);
+    auto it = std::find_if(m_fulltext_index_accessors.begin(), m_fulltext_index_accessors.end(), [&](auto&& index) {
+        return index->get_column_key() == col_key;
+    });
+
+    // Early-out if non-indexed
+    if (it == m_fulltext_index_accessors.end())
+        return;
+
+    // Destroy and remove the index, and close the gap in the accessor list
+    size_t ndx = it - m_fulltext_index_accessors.begin();
+    (*it)->destroy();
+    m_fulltext_index_accessors.erase(it);
+    m_fulltext_index_refs.erase(ndx);
+    for (size_t i = ndx; i < m_fulltext_index_accessors.size(); ++i)
+        m_fulltext_index_accessors[i]->set_ndx_in_parent(i);
+}
+
 void Table::enumerate_string_column(ColKey col_key)
 {
     check_column(col_key);
@@ -1038,6 +1145,8 @@ ColKey Table::do_insert_root_column(ColKey col_key, ColumnType type, StringData
 void Table::do_erase_root_column(ColKey col_key)
 {
     size_t col_ndx = col_key.get_index().val;
+    remove_ordered_index(col_key);
+    remove_fulltext_index(col_key);
     // If the column had a source index we have to remove and destroy that as well
     ref_type index_ref = m_index_refs.get_as_ref(col_ndx);
     if (index_ref) {
@@ -1175,9 +1284,13 @@ void Table::fully_detach() noexcept
     m_spec.detach();
     m_top.detach();
     m_index_refs.detach();
+    m_ordered_index_refs.detach();
+    m_fulltext_index_refs.detach();
     m_opposite_table.detach();
     m_opposite_column.detach();
     m_index_accessors.clear();
+    m_ordered_index_accessors.clear();
+    m_fulltext_index_accessors.clear();
 }
 
 
@@ -1991,6 +2104,8 @@ ref_type Table::create_empty_table(Allocator& alloc, TableKey key)
     top.add(0); // pk col key
     top.add(0); // flags
     top.add(0); // tombstones
+    top.add(0); // ordered indexes
+    top.add(0); // full-text indexes
 
     REALM_ASSERT(top.size() == top_array_size);
 
@@ -2482,6 +2597,18 @@ void Table::update_from_parent() noexcept
                 index->update_from_parent();
             }
         }
+        if (m_ordered_index_refs.is_attached()) {
+            m_ordered_index_refs.update_from_parent();
+            for (auto&& index : m_ordered_index_accessors) {
+                index->update_from_parent();
+            }
+        }
+        if (m_fulltext_index_refs.is_attached()) {
+            m_fulltext_index_refs.update_from_parent();
+            for (auto&& index : m_fulltext_index_accessors) {
+                index->update_from_parent();
+            }
+        }
 
         m_opposite_table.update_from_parent();
         m_opposite_column.update_from_parent();
@@ -2632,6 +2759,7 @@ void Table::flush_for_commit()
             ++m_in_file_version_at_transaction_boundary;
             auto rot_version = RefOrTagged::make_tagged(m_in_file_version_at_transaction_boundary);
             m_top.set(top_position_for_version, rot_version);
+            m_zone_map.table_changed();
         }
     }
 }
@@ -2647,11 +2775,13 @@ void Table::refresh_content_version()
         if (m_in_file_version_at_transaction_boundary != rot_version.get_as_int()) {
             m_in_file_version_at_transaction_boundary = rot_version.get_as_int();
             bump_content_version();
+            m_zone_map.table_changed();
         }
     }
     else {
         // assume the worst:
         bump_content_version();
+        m_zone_map.clear();
     }
 }
 
@@ -2692,6 +2822,7 @@ void Table::refresh_accessor_tree()
     bump_storage_version();
     build_column_mapping();
     refresh_index_accessors();
+    refresh_secondary_index_accessors();
 }
 
 void Table::refresh_index_accessors()
@@ -2727,6 +2858,41 @@ void Table::refresh_index_accessors()
     }
 }
 
+template <class IndexType>
+void Table::refresh_secondary_index_accessors(size_t top_position, Array& index_refs,
+                                              std::vector<std::unique_ptr<IndexType>>& accessors)
+{
+    if (m_top.size() <= top_position || !m_top.get_as_ref(top_position)) {
+        index_refs.detach();
+        accessors.clear();
+        return;
+    }
+
+    // The indexes are identified by their position, so an accessor may now
+    // refer to the index of another column
+    index_refs.init_from_parent();
+    size_t sz = index_refs.size();
+    accessors.resize(sz);
+    for (size_t ndx = 0; ndx < sz; ++ndx) {
+        ref_type ref = index_refs.get_as_ref(ndx);
+        ClusterColumn virtual_col(&m_clusters, IndexType::get_column_key(ref, get_alloc()));
+        if (auto& index = accessors[ndx]) {
+            index->refresh_accessor_tree(virtual_col);
+        }
+        else {
+            index = std::make_unique<IndexType>(ref, &index_refs, ndx, virtual_col, get_alloc());
+        }
+    }
+}
+
+void Table::refresh_secondary_index_accessors()
+{
+    refresh_secondary_index_accessors(top_position_for_ordered_indexes, m_ordered_index_refs,
+                                      m_ordered_index_accessors);
+    refresh_secondary_index_accessors(top_position_for_fulltext_indexes, m_fulltext_index_refs,
+                                      m_fulltext_index_accessors);
+}
+
 bool Table::is_cross_table_link_target() const noexcept
 {
     auto is_cross_link = [this](ColKey col_key) {
@@ -3227,6 +3393,244 @@ void Table::create_objects(const std::vector<ObjKey>& keys)
     }
 }
 
+std::vector<ObjKey> Table::create_objects(size_t num_objects, const std::vector<ColumnValues>& columns)
+{
+    if (is_embedded())
+        throw LogicError(LogicError::wrong_kind_of_table);
+    auto primary_key_col = get_primary_key_column();
+
+    // Order the columns by leaf index, so that the values of a row can be
+    // appended to FieldValues in order
+    std::vector<const ColumnValues*> cols;
+    cols.reserve(columns.size());
+    for (auto& c : columns) {
+        check_column(c.col_key);
+        if (c.col_key.is_collection() || c.values.size() != num_objects)
+            throw LogicError(LogicError::illegal_combination);
+        DataType type = DataType(c.col_key.get_type());
+        if (type != type_Mixed) {
+            bool nullable = c.col_key.is_nullable();
+            for (auto& value : c.values) {
+                if (value.is_null()) {
+                    if (!nullable)
+                        throw LogicError(LogicError::column_not_nullable);
+                }
+                else if (value.get_type() != type) {
+                    throw LogicError(LogicError::type_mismatch);
+                }
+            }
+        }
+        cols.push_back(&c);
+    }
+    std::sort(cols.begin(), cols.end(), [](const ColumnValues* a, const ColumnValues* b) {
+        return a->col_key.get_index().val < b->col_key.get_index().val;
+    });
+    auto duplicate_col = std::adjacent_find(cols.begin(), cols.end(), [](auto a, auto b) {
+        return a->col_key == b->col_key;
+    });
+    if (duplicate_col != cols.end())
+        throw LogicError(LogicError::illegal_combination);
+
+    // Validate all primary keys before creating anything. Sorting them finds
+    // the duplicates within the batch and gives the order in which they are
+    // added to the primary key index later on.
+    const ColumnValues* pk_values = nullptr;
+    std::vector<size_t> pk_order;
+    if (primary_key_col) {
+        for (auto c : cols) {
+            if (c->col_key == primary_key_col)
+                pk_values = c;
+        }
+        if (!pk_values)
+            throw LogicError(LogicError::illegal_combination);
+        auto& pks = pk_values->values;
+        pk_order.resize(num_objects);
+        std::iota(pk_order.begin(), pk_order.end(), size_t(0));
+        std::sort(pk_order.begin(), pk_order.end(), [&](size_t a, size_t b) {
+            return pks[a] < pks[b];
+        });
+        auto throw_duplicate = [&](const Mixed& pk) {
+            throw std::logic_error(util::format(
+                "Attempting to create an object in '%1' with an existing primary key value '%2'.", get_name(), pk));
+        };
+        for (size_t i = 1; i < num_objects; ++i) {
+            if (pks[pk_order[i - 1]] == pks[pk_order[i]])
+                throw_duplicate(pks[pk_order[i]]);
+        }
+        if (!m_clusters.is_empty()) {
+            auto&& pk_index = m_index_accessors[primary_key_col.get_index().val];
+            for (auto& pk : pks) {
+                if (pk_index->find_first(pk))
+                    throw_duplicate(pk);
+            }
+        }
+    }
+
+    std::vector<ObjKey> keys(num_objects);
+    auto get_field_values = [&](size_t row, bool with_primary_key) {
+        FieldValues values;
+        for (auto c : cols) {
+            if (with_primary_key || c->col_key != primary_key_col)
+                values.insert(c->col_key, c->values[row]);
+        }
+        return values;
+    };
+
+    if (primary_key_col && (is_asymmetric() || nb_unresolved())) {
+        // Resurrecting tombstones and scheduling asymmetric objects for
+        // deletion is taken care of by the single object path
+        for (size_t row = 0; row < num_objects; ++row) {
+            keys[row] = create_object_with_primary_key(pk_values->values[row], get_field_values(row, false),
+                                                       UpdateMode::never)
+                            .get_key();
+        }
+        return keys;
+    }
+
+    Replication* repl = get_repl();
+    // Setting a column of a new object to null does not change anything, so
+    // such instructions are left out unless the changes are going to be merged
+    // by sync, where every assignment takes part in conflict resolution.
+    bool replicate_nulls = repl && (repl->get_history_type() == Replication::hist_SyncClient ||
+                                    repl->get_history_type() == Replication::hist_SyncServer);
+    // New keys only need to be checked against the existing objects if they
+    // are within the range of keys already in use.
+    int64_t last_key_value = m_clusters.is_empty() ? -1 : m_clusters.get_last_key_value();
+
+    // The search indexes are updated for all the new objects at the end. This
+    // is also done if creation fails part way, as the objects created up to
+    // that point remain.
+    size_t num_created = 0;
+    auto index_new_objects = [&] {
+        for (auto&& index : m_index_accessors) {
+            if (!index)
+                continue;
+            ColKey col_key = index->get_column_key();
+            auto col = std::find_if(cols.begin(), cols.end(), [&](auto c) {
+                return c->col_key == col_key;
+            });
+            if (col == cols.end()) {
+                for (size_t row = 0; row < num_created; ++row)
+                    insert_into_index(*index, col_key, keys[row], Mixed());
+                continue;
+            }
+            auto& values = (*col)->values;
+            std::vector<size_t> order;
+            if (col_key == primary_key_col) {
+                order = std::move(pk_order);
+            }
+            else {
+                order.resize(num_objects);
+                std::iota(order.begin(), order.end(), size_t(0));
+                std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+                    if (int cmp = values[a].compare(values[b]))
+                        return cmp < 0;
+                    return a < b;
+                });
+            }
+            for (auto row : order) {
+                if (row < num_created)
+                    insert_into_index(*index, col_key, keys[row], values[row]);
+            }
+        }
+        for (auto&& index : m_ordered_index_accessors) {
+            ColKey col_key = index->get_column_key();
+            auto col = std::find_if(cols.begin(), cols.end(), [&](auto c) {
+                return c->col_key == col_key;
+            });
+            for (size_t row = 0; row < num_created; ++row) {
+                Mixed value = (col == cols.end()) ? Mixed() : (*col)->values[row];
+                index->insert(keys[row], ordered_index_value(col_key, value));
+            }
+        }
+        for (auto&& index : m_fulltext_index_accessors) {
+            ColKey col_key = index->get_column_key();
+            auto col = std::find_if(cols.begin(), cols.end(), [&](auto c) {
+                return c->col_key == col_key;
+            });
+            if (col == cols.end())
+                continue;
+            for (size_t row = 0; row < num_created; ++row)
+                index->insert(keys[row], (*col)->values[row]);
+        }
+        m_clusters.bump_content_version();
+        m_clusters.bump_storage_version();
+    };
+
+    // Allocate all the keys first. If they all come after the existing
+    // objects, which is the case unless keys have been reused, the objects
+    // are appended to the cluster tree one leaf at a time.
+    std::vector<GlobalKey> object_ids;
+    if (!primary_key_col && repl)
+        object_ids.resize(num_objects);
+    bool can_append = true;
+    for (size_t row = 0; row < num_objects; ++row) {
+        ObjKey key;
+        if (primary_key_col) {
+            do {
+                key = ObjKey(allocate_sequence_number());
+            } while (key.value <= last_key_value && m_clusters.is_valid(key));
+        }
+        else {
+            GlobalKey object_id;
+            do {
+                object_id = allocate_object_id_squeezed();
+                key = object_id.get_local_key(get_sync_file_id());
+            } while (key.value <= last_key_value && m_clusters.is_valid(key));
+            if (repl)
+                object_ids[row] = object_id;
+        }
+        REALM_ASSERT(key.value >= 0);
+        if (key.value <= (row ? keys[row - 1].value : last_key_value))
+            can_append = false;
+        keys[row] = key;
+    }
+
+    // The objects are replicated in creation order once they exist, also if
+    // creation fails part way.
+    auto replicate_new_objects = [&] {
+        if (!repl)
+            return;
+        for (size_t row = 0; row < num_created; ++row) {
+            ObjKey key = keys[row];
+            if (primary_key_col)
+                repl->create_object_with_primary_key(this, key, pk_values->values[row]);
+            else
+                repl->create_object(this, object_ids[row]);
+            for (auto c : cols) {
+                const Mixed& value = c->values[row];
+                if (c->col_key != primary_key_col && (replicate_nulls || !value.is_null()))
+                    repl->set(this, c->col_key, key, value, _impl::instr_Set);
+            }
+        }
+    };
+
+    try {
+        if (can_append) {
+            ClusterRows rows;
+            rows.keys = util::Span<const ObjKey>(keys.data(), keys.size());
+            for (auto c : cols)
+                rows.columns.emplace_back(c->col_key, c->values);
+            m_clusters.append(rows, num_created);
+        }
+        else {
+            for (; num_created < num_objects; ++num_created) {
+                ClusterNode::State state;
+                m_clusters.insert_fast(keys[num_created], get_field_values(num_created, true), state);
+            }
+        }
+    }
+    catch (...) {
+        replicate_new_objects();
+        index_new_objects();
+        throw;
+    }
+    replicate_new_objects();
+    index_new_objects();
+
+    return keys;
+}
+
 void Table::dump_objects()
 {
     m_clusters.dump_objects();
@@ -3742,6 +4146,8 @@ ColKey Table::set_nullability(ColKey col_key, bool nullable, bool throw_on_null)
     check_column(col_key);
 
     bool si = has_search_index(col_key);
+    bool oi = has_ordered_index(col_key);
+    bool fi = has_fulltext_index(col_key);
     std::string column_name(get_column_name(col_key));
     auto type = col_key.get_type();
     auto attr = col_key.get_attrs();
@@ -3777,6 +4183,10 @@ ColKey Table::set_nullability(ColKey col_key, bool nullable, bool throw_on_null)
 
     if (si)
         do_add_search_index(new_col);
+    if (oi)
+        add_ordered_index(new_col);
+    if (fi)
+        add_fulltext_index(new_col);
 
     return new_col;
 }
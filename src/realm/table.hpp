@@ -28,6 +28,7 @@
 
 #include <realm/util/features.h>
 #include <realm/util/function_ref.hpp>
+#include <realm/util/span.hpp>
 #include <realm/util/thread.hpp>
 #include <realm/table_ref.hpp>
 #include <realm/spec.hpp>
@@ -35,7 +36,10 @@
 #include <realm/table_cluster_tree.hpp>
 #include <realm/keys.hpp>
 #include <realm/global_key.hpp>
+#include <realm/index_fulltext.hpp>
+#include <realm/index_ordered.hpp>
 #include <realm/index_string.hpp>
+#include <realm/zone_map.hpp>
 
 // Only set this to one when testing the code paths that exercise object ID
 // hash collisions. It artificially limits the "optimistic" local ID to use
@@ -50,6 +54,7 @@ template <class>
 class BacklinkCount;
 class TableView;
 class Group;
+class GroupWriter;
 class SortDescriptor;
 class TableView;
 template <class>
@@ -202,6 +207,43 @@ public:
     void add_search_index(ColKey col_key);
     void remove_search_index(ColKey col_key);
 
+    /// has_ordered_index() returns true if, and only if an ordered index has
+    /// been added to the specified column.
+    ///
+    /// add_ordered_index() adds an ordered index to the specified column of the
+    /// table. An ordered index keeps the objects sorted by the value of the
+    /// column, and is used by queries with range conditions (greater, less,
+    /// between) and by sorting on the column. Only integer and timestamp
+    /// columns can be indexed this way. A column can have both a search index
+    /// and an ordered index. It has no effect if the column already has an
+    /// ordered index.
+    ///
+    /// remove_ordered_index() removes the ordered index from the specified
+    /// column. It has no effect if the column has no ordered index.
+    ///
+    /// Ordered indexes are local to the file, and are not replicated.
+    bool has_ordered_index(ColKey col_key) const noexcept;
+    void add_ordered_index(ColKey col_key);
+    void remove_ordered_index(ColKey col_key);
+
+    /// has_fulltext_index() returns true if, and only if a full-text index has
+    /// been added to the specified column.
+    ///
+    /// add_fulltext_index() adds a full-text index to the specified string
+    /// column of the table. The index maps each word occurring in the column to
+    /// the objects containing it, and is used by Query::fulltext() and the
+    /// TEXT operator of the query language. A column can have both a search
+    /// index and a full-text index. It has no effect if the column already has
+    /// a full-text index.
+    ///
+    /// remove_fulltext_index() removes the full-text index from the specified
+    /// column. It has no effect if the column has no full-text index.
+    ///
+    /// Full-text indexes are local to the file, and are not replicated.
+    bool has_fulltext_index(ColKey col_key) const noexcept;
+    void add_fulltext_index(ColKey col_key);
+    void remove_fulltext_index(ColKey col_key);
+
     void enumerate_string_column(ColKey col_key);
     bool is_enumerated(ColKey col_key) const noexcept;
     bool contains_unique_values(ColKey col_key) const;
@@ -277,6 +319,23 @@ public:
     void create_objects(size_t number, std::vector<ObjKey>& keys);
     /// Create a number of objects with keys supplied
     void create_objects(const std::vector<ObjKey>& keys);
+    /// Values for one column in a call to create_objects(). Entry `i` of
+    /// `values` becomes the value of `col_key` in the i'th created object.
+    struct ColumnValues {
+        ColKey col_key;
+        util::Span<const Mixed> values;
+    };
+    /// Create `num_objects` objects from columnar input and return their keys
+    /// in input order. Columns which are not mentioned get their default value.
+    /// If the table has a primary key, the primary key column must be among
+    /// `columns`, and a LogicError is thrown before anything is created if any
+    /// of its values is duplicated or already in use, and a null for a column
+    /// which is not nullable is also rejected up front. The result is the same
+    /// as calling create_object() or create_object_with_primary_key() for each
+    /// row, but the objects are appended one cluster leaf and one column at a
+    /// time, search indexes are updated in one pass sorted by value, and no
+    /// per-object lookups are made in an initially empty table.
+    std::vector<ObjKey> create_objects(size_t num_objects, const std::vector<ColumnValues>& columns);
     /// Does the key refer to an object within the table?
     bool is_valid(ObjKey key) const noexcept
     {
@@ -397,6 +456,29 @@ public:
             return nullptr;
         return m_index_accessors[col.get_index().val].get();
     }
+    // Will return pointer to ordered index accessor. Will return nullptr if no index
+    OrderedIndex* get_ordered_index(ColKey col) const noexcept
+    {
+        for (auto&& index : m_ordered_index_accessors) {
+            if (index->get_column_key() == col)
+                return index.get();
+        }
+        return nullptr;
+    }
+    // Will return pointer to full-text index accessor. Will return nullptr if no index
+    FullTextIndex* get_fulltext_index(ColKey col) const noexcept
+    {
+        for (auto&& index : m_fulltext_index_accessors) {
+            if (index->get_column_key() == col)
+                return index.get();
+        }
+        return nullptr;
+    }
+    // Value ranges of the column leaves, used by queries to skip leaves
+    ZoneMap& get_zone_map() const noexcept
+    {
+        return m_zone_map;
+    }
     template <class T>
     ObjKey find_first(ColKey col_key, T value) const;
 
@@ -687,9 +769,13 @@ private:
     std::unique_ptr<TableClusterTree> m_tombstones; // 13th slot in m_top
     TableKey m_key;                                 // 4th slot in m_top
     Array m_index_refs;                             // 5th slot in m_top
+    Array m_ordered_index_refs;                     // 15th slot in m_top
+    Array m_fulltext_index_refs;                    // 16th slot in m_top
     Array m_opposite_table;                         // 7th slot in m_top
     Array m_opposite_column;                        // 8th slot in m_top
     std::vector<std::unique_ptr<StringIndex>> m_index_accessors;
+    std::vector<std::unique_ptr<OrderedIndex>> m_ordered_index_accessors;
+    std::vector<std::unique_ptr<FullTextIndex>> m_fulltext_index_accessors;
     ColKey m_primary_key_col;
     Replication* const* m_repl;
     static Replication* g_dummy_replication;
@@ -808,6 +894,13 @@ private:
     /// table.
     void refresh_accessor_tree();
     void refresh_index_accessors();
+    /// Refresh the accessors of the ordered and full-text indexes
+    void refresh_secondary_index_accessors();
+    /// Refresh the accessors of the indexes whose refs are held in slot
+    /// `top_position` of the top array
+    template <class IndexType>
+    void refresh_secondary_index_accessors(size_t top_position, Array& index_refs,
+                                           std::vector<std::unique_ptr<IndexType>>& accessors);
     void refresh_content_version();
     void flush_for_commit();
 
@@ -821,6 +914,8 @@ private:
     std::vector<size_t> m_leaf_ndx2spec_ndx;
     Type m_table_type = Type::TopLevel;
     uint64_t m_in_file_version_at_transaction_boundary = 0;
+    // Must be told whenever m_in_file_version_at_transaction_boundary changes
+    mutable ZoneMap m_zone_map;
     AtomicLifeCycleCookie m_cookie;
 
     static constexpr int top_position_for_spec = 0;
@@ -838,7 +933,9 @@ private:
     static constexpr int top_position_for_flags = 12;
     // flags contents: bit 0-1 - table type
     static constexpr int top_position_for_tombstones = 13;
-    static constexpr int top_array_size = 14;
+    static constexpr int top_position_for_ordered_indexes = 14;
+    static constexpr int top_position_for_fulltext_indexes = 15;
+    static constexpr int top_array_size = 16;
 
     enum { s_collision_map_lo = 0, s_collision_map_hi = 1, s_collision_map_local_id = 2, s_collision_map_num_slots };
 
@@ -856,6 +953,7 @@ private:
     friend class LinkMap;
     friend class LinkView;
     friend class Group;
+    friend class GroupWriter;
     friend class Transaction;
     friend class Cluster;
     friend class ClusterTree;
@@ -1188,6 +1286,8 @@ inline Table::Table(Allocator& alloc)
     , m_spec(m_alloc)
     , m_clusters(this, m_alloc, top_position_for_cluster_tree)
     , m_index_refs(m_alloc)
+    , m_ordered_index_refs(m_alloc)
+    , m_fulltext_index_refs(m_alloc)
     , m_opposite_table(m_alloc)
     , m_opposite_column(m_alloc)
     , m_repl(&g_dummy_replication)
@@ -1195,6 +1295,8 @@ inline Table::Table(Allocator& alloc)
 {
     m_spec.set_parent(&m_top, top_position_for_spec);
     m_index_refs.set_parent(&m_top, top_position_for_search_indexes);
+    m_ordered_index_refs.set_parent(&m_top, top_position_for_ordered_indexes);
+    m_fulltext_index_refs.set_parent(&m_top, top_position_for_fulltext_indexes);
     m_opposite_table.set_parent(&m_top, top_position_for_opposite_table);
     m_opposite_column.set_parent(&m_top, top_position_for_opposite_column);
 
@@ -1210,6 +1312,8 @@ inline Table::Table(Replication* const* repl, Allocator& alloc)
     , m_spec(m_alloc)
     , m_clusters(this, m_alloc, top_position_for_cluster_tree)
     , m_index_refs(m_alloc)
+    , m_ordered_index_refs(m_alloc)
+    , m_fulltext_index_refs(m_alloc)
     , m_opposite_table(m_alloc)
     , m_opposite_column(m_alloc)
     , m_repl(repl)
@@ -1217,6 +1321,8 @@ inline Table::Table(Replication* const* repl, Allocator& alloc)
 {
     m_spec.set_parent(&m_top, top_position_for_spec);
     m_index_refs.set_parent(&m_top, top_position_for_search_indexes);
+    m_ordered_index_refs.set_parent(&m_top, top_position_for_ordered_indexes);
+    m_fulltext_index_refs.set_parent(&m_top, top_position_for_fulltext_indexes);
     m_opposite_table.set_parent(&m_top, top_position_for_opposite_table);
     m_opposite_column.set_parent(&m_top, top_position_for_opposite_column);
     m_cookie = cookie_created;
@@ -526,8 +526,8 @@ void TableView::do_sort(const DescriptorOrdering& ordering)
 
         // Sorting can be specified by multiple columns, so that if two entries in the first column are
         // identical, then the rows are ordered according to the second column, and so forth. For the
-        // first column, we cache all the payload of fields of the view in a std::vector<Mixed>
-        predicate.cache_first_column(index_pairs);
+        // first column (and for all columns of large views), we cache the values of the view up front
+        predicate.cache_values(index_pairs);
 
         base_descr->execute(index_pairs, predicate, next);
     }
@@ -125,6 +125,9 @@ void Transaction::close()
     if (m_transact_stage == DB::transact_Writing) {
         rollback();
     }
+    if (m_transact_stage == DB::transact_Frozen && !db->release_shared_frozen(*this)) {
+        return;
+    }
     if (m_transact_stage == DB::transact_Reading || m_transact_stage == DB::transact_Frozen) {
         do_end_read();
     }
@@ -148,11 +151,38 @@ DB::version_type Transaction::commit()
 
     REALM_ASSERT(is_attached());
 
+    // With group commit, we leave the sync to the group commit helper
+    if (db->has_group_commit())
+        return commit_grouped().get(); // Throws
+
     // before committing, allow any accessors at group level or below to sync
     flush_accessors_for_commit();
 
     DB::version_type new_version = db->do_commit(*this); // Throws
+    end_write_after_commit();
+    return new_version;
+}
+
+util::Future<DB::version_type> Transaction::commit_grouped()
+{
+    if (!is_attached())
+        throw LogicError(LogicError::wrong_transact_state);
+    if (m_transact_stage != DB::transact_Writing)
+        throw LogicError(LogicError::wrong_transact_state);
+
+    if (!db->has_group_commit())
+        return util::Future<DB::version_type>::make_ready(commit()); // Throws
+
+    flush_accessors_for_commit();
+
+    DB::version_type new_version = db->do_commit(*this, false);    // Throws
+    auto durable = db->add_group_commit(new_version, m_read_lock); // Throws
+    end_write_after_commit();
+    return durable;
+}
 
+void Transaction::end_write_after_commit()
+{
     // We need to set m_read_lock in order for wait_for_change to work.
     // To set it, we grab a readlock on the latest available snapshot
     // and release it again.
@@ -165,8 +195,6 @@ DB::version_type Transaction::commit()
 
     do_end_read();
     m_read_lock = lock_after_commit;
-
-    return new_version;
 }
 
 void Transaction::rollback()
@@ -321,7 +349,7 @@ TransactionRef Transaction::duplicate()
     if (m_transact_stage == DB::transact_Reading)
         return db->start_read(version);
     if (m_transact_stage == DB::transact_Frozen)
-        return db->start_frozen(version);
+        return db->do_start_frozen(version);
 
     throw LogicError(LogicError::wrong_transact_state);
 }
@@ -465,7 +493,7 @@ void Transaction::upgrade_file_format(int target_file_format_version)
     // Be sure to revisit the following upgrade logic when a new file format
     // version is introduced. The following assert attempt to help you not
     // forget it.
-    REALM_ASSERT_EX(target_file_format_version == 22, target_file_format_version);
+    REALM_ASSERT_EX(target_file_format_version == 23, target_file_format_version);
 
     // DB::do_open() must ensure that only supported version are allowed.
     // It does that by asking backup if the current file format version is
@@ -604,6 +632,9 @@ void Transaction::upgrade_file_format(int target_file_format_version)
         }
     }
 
+    // Upgrade from version 22 requires no changes. Version 23 only makes older
+    // versions, which would not keep ordered indexes up to date, refuse the file.
+
     // NOTE: Additional future upgrade steps go here.
 }
 
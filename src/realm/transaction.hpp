@@ -55,6 +55,12 @@ public:
     size_t get_commit_size() const;
 
     DB::version_type commit() REQUIRES(!m_async_mutex);
+    /// Commit the write transaction without waiting for the commit to become
+    /// durable. The commit is visible to other transactions when this returns,
+    /// and the future becomes ready with its version once a group flush has
+    /// written it to stable storage. If DBOptions::enable_group_commit is not
+    /// in effect, this is the same as commit() and the future is already ready.
+    util::Future<DB::version_type> commit_grouped() REQUIRES(!m_async_mutex);
     void rollback() REQUIRES(!m_async_mutex);
     void end_read() REQUIRES(!m_async_mutex);
 
@@ -183,6 +189,7 @@ private:
     bool internal_advance_read(O* observer, VersionID target_version, _impl::History&, bool);
     void set_transact_stage(DB::TransactStage stage) noexcept;
     void do_end_read() noexcept REQUIRES(!m_async_mutex);
+    void end_write_after_commit() REQUIRES(!m_async_mutex);
     void initialize_replication();
 
     void replicate(Transaction* dest, Replication& repl) const;
@@ -206,6 +213,10 @@ private:
     bool m_waiting_for_sync GUARDED_BY(m_async_mutex) = false;
 
     DB::TransactStage m_transact_stage = DB::transact_Ready;
+    // Number of callers of DB::start_frozen() which share this transaction and
+    // still hold the reference they got, or 0 once it has been closed.
+    // Protected by DB::m_frozen_transactions_mutex.
+    size_t m_num_shared_holders = 0;
 
     friend class DB;
     friend class DisableReplication;
@@ -407,18 +418,22 @@ inline void Transaction::rollback_and_continue_as_read(O* observer)
 
     BinaryData uncommitted_changes = repl->get_uncommitted_changes();
 
-    // Possible optimization: We are currently creating two transaction log parsers, one here,
-    // and one in advance_transact(). That is wasteful as the parser creation is
-    // expensive.
+    // The parser is reused for the observer, which also finds any schema
+    // changes, so that advance_transact() does not parse the log again.
     util::SimpleInputStream in(uncommitted_changes);
     _impl::TransactLogParser parser; // Throws
     _impl::TransactReverser reverser;
     parser.parse(in, reverser); // Throws
 
+    bool schema_changed = false;
+    bool parsed = false;
     if (observer && uncommitted_changes.size()) {
         _impl::ReversedNoCopyInputStream reversed_in(reverser);
-        parser.parse(reversed_in, *observer); // Throws
-        observer->parse_complete();           // Throws
+        _impl::SchemaChangeTracker<O> tracker(*observer);
+        parser.parse(reversed_in, tracker); // Throws
+        observer->parse_complete();         // Throws
+        schema_changed = tracker.schema_changed;
+        parsed = true;
     }
 
     // Mark all managed space (beyond the attached file) as free.
@@ -428,10 +443,15 @@ inline void Transaction::rollback_and_continue_as_read(O* observer)
     ref_type top_ref = m_read_lock.m_top_ref;
     size_t file_size = m_read_lock.m_file_size;
 
-    _impl::ReversedNoCopyInputStream reversed_in(reverser);
     m_alloc.update_reader_view(file_size); // Throws
     update_allocator_wrappers(false);
-    advance_transact(top_ref, reversed_in, false); // Throws
+    if (parsed) {
+        advance_transact(top_ref, false, schema_changed); // Throws
+    }
+    else {
+        _impl::ReversedNoCopyInputStream reversed_in(reverser);
+        advance_transact(top_ref, reversed_in, false); // Throws
+    }
 
     if (!holds_write_mutex())
         db->end_write_on_correct_thread();
@@ -468,13 +488,18 @@ inline bool Transaction::internal_advance_read(O* observer, VersionID version_id
     ref_type hist_ref = gf::get_history_ref(alloc, new_top_ref);
     hist.update_from_ref_and_version(hist_ref, new_version);
 
+    // The changesets are read straight from the history, and parsed only once
+    // when there is an observer, which also finds any schema changes.
+    bool schema_changed = false;
     if (observer) {
         // This has to happen in the context of the originally bound snapshot
         // and while the read transaction is still in a fully functional state.
         _impl::TransactLogParser parser;
         _impl::ChangesetInputStream in(hist, old_version, new_version);
-        parser.parse(in, *observer); // Throws
-        observer->parse_complete();  // Throws
+        _impl::SchemaChangeTracker<O> tracker(*observer);
+        parser.parse(in, tracker); // Throws
+        observer->parse_complete(); // Throws
+        schema_changed = tracker.schema_changed;
     }
 
     // The old read lock must be retained for as long as the change history is
@@ -486,8 +511,13 @@ inline bool Transaction::internal_advance_read(O* observer, VersionID version_id
     // that the history was always implemented as a versioned entity, that was
     // part of the Realm state, then it would not have been necessary to retain
     // the old read lock beyond this point.
-    _impl::ChangesetInputStream in(hist, old_version, new_version);
-    advance_transact(new_top_ref, in, writable); // Throws
+    if (observer) {
+        advance_transact(new_top_ref, writable, schema_changed); // Throws
+    }
+    else {
+        _impl::ChangesetInputStream in(hist, old_version, new_version);
+        advance_transact(new_top_ref, in, writable); // Throws
+    }
     g.release();
     db->release_read_lock(m_read_lock);
     m_read_lock = new_read_lock;
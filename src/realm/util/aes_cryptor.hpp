@@ -22,6 +22,7 @@
 #include <cstdint>
 #include <vector>
 #include <realm/util/file.hpp>
+#include <realm/util/function_ref.hpp>
 
 #if REALM_ENABLE_ENCRYPTION
 
@@ -35,6 +36,7 @@
 #else
 #include <openssl/sha.h>
 #include <openssl/evp.h>
+#include <openssl/rand.h>
 #endif
 
 namespace realm {
@@ -45,14 +47,23 @@ class EncryptedFileMapping;
 
 class AESCryptor {
 public:
-    AESCryptor(const uint8_t* key);
+    // \a format is the format of the blocks written, unless the file already
+    // has a first block, in which case the format of that block is used.
+    AESCryptor(const uint8_t* key, File::EncryptionFormat format = File::encryption_CbcHmac);
     ~AESCryptor() noexcept;
 
     void set_file_size(off_t new_size);
 
+    // Read and decrypt the blocks in the given range. Blocks which have never
+    // been written are left untouched, and false is returned if there were
+    // any. Large ranges are decrypted on several threads.
     bool read(FileDesc fd, off_t pos, char* dst, size_t size);
     void try_read_block(FileDesc fd, off_t pos, char* dst) noexcept;
-    void write(FileDesc fd, off_t pos, const char* src, size_t size) noexcept;
+    // Encrypt and write the blocks in the given range. Large ranges are
+    // encrypted on several threads. The buffers and ciphers which this needs
+    // are set up by set_file_size(), so that only handing the work to the
+    // threads may throw.
+    void write(FileDesc fd, off_t pos, const char* src, size_t size);
 
 private:
     enum EncryptionMode {
@@ -68,26 +79,39 @@ private:
 #endif
     };
 
-#if REALM_PLATFORM_APPLE
-    CCCryptorRef m_encr;
-    CCCryptorRef m_decr;
-#elif defined(_WIN32)
-    BCRYPT_KEY_HANDLE m_aes_key_handle;
-#else
-    uint8_t m_aesKey[32];
-    EVP_CIPHER_CTX* m_ctx;
-#endif
+    // Ciphers for both directions, set up with the key. Each thread
+    // encrypting or decrypting blocks uses its own.
+    struct Ciphers;
 
+    uint8_t m_aesKey[32];
     uint8_t m_hmacKey[32];
+    std::unique_ptr<Ciphers> m_ciphers;
+    std::vector<std::unique_ptr<Ciphers>> m_task_ciphers; // For the tasks of a batch but the first
     std::vector<iv_table> m_iv_buffer;
     std::unique_ptr<char[]> m_rw_buffer;
     std::unique_ptr<char[]> m_dst_buffer;
+    size_t m_buffer_blocks = 0;
+    std::vector<iv_table*> m_batch_iv;
+    std::vector<char> m_batch_written;
+    File::EncryptionFormat m_format;
+    bool m_format_selected = false;
 
     void calc_hmac(const void* src, size_t len, uint8_t* dst, const uint8_t* key) const;
     bool check_hmac(const void* data, size_t len, const uint8_t* hmac) const;
-    void crypt(EncryptionMode mode, off_t pos, char* dst, const char* src, const char* stored_iv) noexcept;
+    void crypt(Ciphers&, EncryptionMode mode, off_t pos, char* dst, const char* src, const char* stored_iv) noexcept;
+    void gcm_encrypt(Ciphers&, off_t pos, char* dst, const char* src, uint32_t iv, uint8_t* tag) noexcept;
+    bool gcm_decrypt(Ciphers&, off_t pos, char* dst, const char* src, uint32_t iv, const uint8_t* tag) noexcept;
+    bool try_decrypt(Ciphers&, off_t pos, char* dst, const char* src, size_t bytes_read, uint32_t iv,
+                     const uint8_t* hmac);
+    void select_format(FileDesc fd) noexcept;
+    void encrypt_block(Ciphers&, off_t pos, char* dst, const char* src, iv_table& iv) noexcept;
+    void restore_previous_iv(iv_table& iv) noexcept;
+    bool decrypt_block(Ciphers&, off_t pos, char* dst, const char* src, size_t bytes_read, iv_table& iv);
+    void run_batch(size_t num_blocks, FunctionRef<void(Ciphers&, size_t begin, size_t end)> fn);
+    void reserve_buffers(size_t num_blocks);
+    static size_t get_num_batch_tasks(size_t num_blocks);
     iv_table& get_iv_table(FileDesc fd, off_t data_pos) noexcept;
-    void handle_error();
+    static void handle_error();
 };
 
 struct ReaderInfo {
@@ -106,7 +130,7 @@ struct SharedFileInfo {
     size_t progress_index = 0;
     std::vector<ReaderInfo> readers;
 
-    SharedFileInfo(const uint8_t* key, FileDesc file_descriptor);
+    SharedFileInfo(const uint8_t* key, FileDesc file_descriptor, File::EncryptionFormat format);
 };
 }
 }
@@ -23,6 +23,7 @@
 #if REALM_ENABLE_ENCRYPTION
 #include <cstdlib>
 #include <algorithm>
+#include <limits>
 #include <stdexcept>
 #include <system_error>
 
@@ -47,13 +48,14 @@
 
 #include <realm/util/encrypted_file_mapping.hpp>
 #include <realm/util/terminate.hpp>
+#include <realm/util/thread_pool.hpp>
 
 namespace realm {
 namespace util {
 
-SharedFileInfo::SharedFileInfo(const uint8_t* key, FileDesc file_descriptor)
+SharedFileInfo::SharedFileInfo(const uint8_t* key, FileDesc file_descriptor, File::EncryptionFormat format)
     : fd(file_descriptor)
-    , cryptor(key)
+    , cryptor(key, format)
 {
 }
 
@@ -78,6 +80,21 @@ SharedFileInfo::SharedFileInfo(const uint8_t* key, FileDesc file_descriptor)
 // ciphertext. This ensures that if an error occurs between writing the IV and
 // the ciphertext, we can still determine that we should use the old IV, since
 // the ciphertext's hash will match the old ciphertext.
+//
+// Files may instead be written with AES-GCM, which produces an authentication
+// tag in the same pass as the ciphertext, so that no separate hash of the
+// ciphertext has to be computed. The tag takes the place of the hash, and each
+// IV table entry records which of the two formats it was written with, so
+// recovering from an interrupted write works the same way for both. GCM must
+// never encrypt two different plaintexts with the same nonce, and the IV table
+// on disk may be older than the data which was encrypted with the IVs after
+// it: a backup of the file may be restored, and after a crash the data may
+// have reached the disk without its IV table. Files written with the same key
+// (e.g. the copies made by compaction) also start with empty IV tables. Each
+// write with AES-GCM therefore uses a new random 64 bit IV rather than the
+// next one. The first write of a block with AES-GCM stores a placeholder as
+// the previous entry, so that versions which only know AES-CBC fail to decrypt
+// the block instead of taking it for one whose first write was interrupted.
 
 struct iv_table {
     uint32_t iv1;
@@ -93,6 +110,148 @@ const size_t block_size = 4096;
 const size_t metadata_size = sizeof(iv_table);
 const size_t blocks_per_metadata_block = block_size / metadata_size;
 
+// Batches of blocks are only split across threads in parts of at least this
+// many blocks.
+const size_t min_blocks_per_task = 8;
+
+// An entry written with AES-GCM holds the 16 byte tag at the start of the
+// hmac field, followed by the upper 32 bits of a 64 bit IV, and a marker which
+// tells it apart from an HMAC. The last byte of the marker is the state of the
+// entry. The 96 bit nonce is the 64 bit IV followed by the 32 bit index of the
+// block, which limits such files to 16 TiB.
+const int gcm_tag_size = 16;
+const size_t gcm_iv_high_offset = 16;
+const size_t gcm_marker_offset = 20;
+const uint8_t gcm_marker[7] = {'A', 'E', 'S', '-', 'G', 'C', 'M'};
+const size_t gcm_state_offset = gcm_marker_offset + sizeof(gcm_marker);
+const uint64_t gcm_max_file_size = uint64_t(block_size) << 32;
+
+enum GcmState : uint8_t {
+    // The entry describes the data of the block
+    gcm_Valid = 1,
+    // Placeholder for the previous entry of a block written once
+    gcm_Empty = 3,
+};
+
+bool is_gcm(const uint8_t* hmac) noexcept
+{
+    return memcmp(hmac + gcm_marker_offset, gcm_marker, sizeof(gcm_marker)) == 0;
+}
+
+bool is_gcm(const uint8_t* hmac, GcmState state) noexcept
+{
+    return is_gcm(hmac) && hmac[gcm_state_offset] == state;
+}
+
+void set_gcm_marker(uint8_t* hmac, GcmState state) noexcept
+{
+    memcpy(hmac + gcm_marker_offset, gcm_marker, sizeof(gcm_marker));
+    hmac[gcm_state_offset] = state;
+}
+
+// The size of the file is checked by AESCryptor::set_file_size(), so the
+// index of the block always fits in 32 bits
+void gcm_nonce(uint8_t* nonce, off_t pos, uint32_t iv, const uint8_t* hmac) noexcept
+{
+    uint64_t block_index = uint64_t(pos) / block_size;
+    memcpy(nonce, &iv, 4);
+    memcpy(nonce + 4, hmac + gcm_iv_high_offset, 4);
+    for (size_t i = 0; i < 4; ++i)
+        nonce[8 + i] = uint8_t(block_index >> (8 * i));
+}
+
+// Picks the IV of an AES-GCM write. The low 32 bits are never 0, which is
+// reserved for blocks which have never been written.
+void gcm_random_iv(uint32_t& iv, uint32_t& iv_high) noexcept
+{
+    uint8_t bytes[8];
+    do {
+#if REALM_PLATFORM_APPLE
+        arc4random_buf(bytes, sizeof(bytes));
+#elif defined(_WIN32)
+        NTSTATUS ret = BCryptGenRandom(nullptr, bytes, sizeof(bytes), BCRYPT_USE_SYSTEM_PREFERRED_RNG);
+        REALM_ASSERT_RELEASE_EX(ret == 0 && "BCryptGenRandom()", ret);
+#else
+        int ret = RAND_bytes(bytes, sizeof(bytes));
+        REALM_ASSERT_RELEASE_EX(ret == 1 && "RAND_bytes()", ret);
+#endif
+        memcpy(&iv, bytes, 4);
+    } while (iv == 0);
+    memcpy(&iv_high, bytes + 4, 4);
+}
+
+#if REALM_PLATFORM_APPLE || defined(_WIN32)
+// CommonCrypto has no public AES-GCM API, so on Apple platforms, and on
+// Windows to share the code, AES-GCM is built from AES-ECB: the counter blocks
+// are encrypted to get the keystream, and the tag is computed by GHASH below.
+// For a block, the input to AES-ECB is the zero block (which gives the GHASH
+// key), the initial counter block (which gives the mask of the tag), and the
+// counter blocks of the data.
+const size_t gcm_keystream_size = 2 * aes_block_size + block_size;
+
+void gcm_counter_blocks(const uint8_t* nonce, uint8_t* blocks) noexcept
+{
+    memset(blocks, 0, aes_block_size);
+    for (size_t i = 0; i <= block_size / aes_block_size; ++i) {
+        uint8_t* counter = blocks + aes_block_size * (i + 1);
+        memcpy(counter, nonce, 12);
+        uint32_t value = uint32_t(i + 1);
+        for (size_t j = 0; j < 4; ++j)
+            counter[12 + j] = uint8_t(value >> (24 - 8 * j));
+    }
+}
+
+uint64_t load_big_endian(const uint8_t* bytes) noexcept
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < 8; ++i)
+        value = (value << 8) | bytes[i];
+    return value;
+}
+
+void store_big_endian(uint8_t* bytes, uint64_t value) noexcept
+{
+    for (size_t i = 0; i < 8; ++i)
+        bytes[i] = uint8_t(value >> (56 - 8 * i));
+}
+
+// Multiplies `x` by `h` in the field of GHASH. Both are held as their big
+// endian halves.
+void ghash_multiply(uint64_t* x, const uint64_t* h) noexcept
+{
+    uint64_t z[2] = {0, 0};
+    uint64_t v[2] = {h[0], h[1]};
+    for (int i = 0; i < 128; ++i) {
+        uint64_t bit = (x[i / 64] >> (63 - i % 64)) & 1;
+        z[0] ^= v[0] & (0 - bit);
+        z[1] ^= v[1] & (0 - bit);
+        uint64_t carry = v[1] & 1;
+        v[1] = (v[1] >> 1) | (v[0] << 63);
+        v[0] = (v[0] >> 1) ^ (0xe100000000000000ULL & (0 - carry));
+    }
+    x[0] = z[0];
+    x[1] = z[1];
+}
+
+// Computes the tag of the ciphertext of a block from the output of AES-ECB
+// for gcm_counter_blocks()
+void gcm_tag(const uint8_t* keystream, const uint8_t* ciphertext, uint8_t* tag) noexcept
+{
+    uint64_t h[2] = {load_big_endian(keystream), load_big_endian(keystream + 8)};
+    uint64_t y[2] = {0, 0};
+    for (size_t i = 0; i < block_size; i += aes_block_size) {
+        y[0] ^= load_big_endian(ciphertext + i);
+        y[1] ^= load_big_endian(ciphertext + i + 8);
+        ghash_multiply(y, h);
+    }
+    // The lengths in bits of the (empty) additional data and of the ciphertext
+    y[1] ^= uint64_t(block_size) * 8;
+    ghash_multiply(y, h);
+    store_big_endian(tag, y[0] ^ load_big_endian(keystream + aes_block_size));
+    store_big_endian(tag + 8, y[1] ^ load_big_endian(keystream + aes_block_size + 8));
+}
+#endif
+
 // map an offset in the data to the actual location in the file
 template <typename Int>
 Int real_offset(Int pos)
@@ -142,9 +301,37 @@ size_t check_read(FileDesc fd, off_t pos, void* dst, size_t len)
 
 } // anonymous namespace
 
-AESCryptor::AESCryptor(const uint8_t* key)
-    : m_rw_buffer(new char[block_size])
-    , m_dst_buffer(new char[block_size])
+struct AESCryptor::Ciphers {
+    explicit Ciphers(const uint8_t* key);
+    ~Ciphers() noexcept;
+
+#if REALM_PLATFORM_APPLE
+    CCCryptorRef encr;
+    CCCryptorRef decr;
+    CCCryptorRef ecb;
+#elif defined(_WIN32)
+    BCRYPT_ALG_HANDLE aes_alg_handle = nullptr;
+    BCRYPT_KEY_HANDLE aes_key_handle = nullptr;
+    BCRYPT_ALG_HANDLE ecb_alg_handle = nullptr;
+    BCRYPT_KEY_HANDLE ecb_key_handle = nullptr;
+#else
+    EVP_CIPHER_CTX* encr = nullptr;
+    EVP_CIPHER_CTX* decr = nullptr;
+    // AES-GCM contexts are only set up when first used
+    EVP_CIPHER_CTX* gcm_encr = nullptr;
+    EVP_CIPHER_CTX* gcm_decr = nullptr;
+    const uint8_t* gcm_key;
+
+    EVP_CIPHER_CTX* get_gcm(EncryptionMode mode);
+#endif
+
+#if REALM_PLATFORM_APPLE || defined(_WIN32)
+    // Encrypts the counter blocks of AES-GCM for the nonce
+    void gcm_keystream(const uint8_t* nonce, uint8_t* keystream) noexcept;
+#endif
+};
+
+AESCryptor::Ciphers::Ciphers(const uint8_t* key)
 {
 #if REALM_PLATFORM_APPLE
     // A random iv is passed to CCCryptorReset. This iv is *not used* by Realm; we set it manually prior to
@@ -153,43 +340,118 @@ AESCryptor::AESCryptor(const uint8_t* key)
     unsigned char u_iv[kCCKeySizeAES256];
     arc4random_buf(u_iv, kCCKeySizeAES256);
     void* iv = u_iv;
-    CCCryptorCreate(kCCEncrypt, kCCAlgorithmAES, 0 /* options */, key, kCCKeySizeAES256, iv, &m_encr);
-    CCCryptorCreate(kCCDecrypt, kCCAlgorithmAES, 0 /* options */, key, kCCKeySizeAES256, iv, &m_decr);
+    CCCryptorCreate(kCCEncrypt, kCCAlgorithmAES, 0 /* options */, key, kCCKeySizeAES256, iv, &encr);
+    CCCryptorCreate(kCCDecrypt, kCCAlgorithmAES, 0 /* options */, key, kCCKeySizeAES256, iv, &decr);
+    CCCryptorCreate(kCCEncrypt, kCCAlgorithmAES, kCCOptionECBMode, key, kCCKeySizeAES256, nullptr, &ecb);
 #elif defined(_WIN32)
-    BCRYPT_ALG_HANDLE hAesAlg = NULL;
     int ret;
-    ret = BCryptOpenAlgorithmProvider(&hAesAlg, BCRYPT_AES_ALGORITHM, NULL, 0);
+    ret = BCryptOpenAlgorithmProvider(&aes_alg_handle, BCRYPT_AES_ALGORITHM, NULL, 0);
     REALM_ASSERT_RELEASE_EX(ret == 0 && "BCryptOpenAlgorithmProvider()", ret);
 
-    ret = BCryptSetProperty(hAesAlg, BCRYPT_CHAINING_MODE, (PBYTE)BCRYPT_CHAIN_MODE_CBC,
+    ret = BCryptSetProperty(aes_alg_handle, BCRYPT_CHAINING_MODE, (PBYTE)BCRYPT_CHAIN_MODE_CBC,
                             sizeof(BCRYPT_CHAIN_MODE_CBC), 0);
     REALM_ASSERT_RELEASE_EX(ret == 0 && "BCryptSetProperty()", ret);
 
-    ret = BCryptGenerateSymmetricKey(hAesAlg, &m_aes_key_handle, nullptr, 0, (PBYTE)key, 32, 0);
+    ret = BCryptGenerateSymmetricKey(aes_alg_handle, &aes_key_handle, nullptr, 0, (PBYTE)key, 32, 0);
     REALM_ASSERT_RELEASE_EX(ret == 0 && "BCryptGenerateSymmetricKey()", ret);
-#else
-    m_ctx = EVP_CIPHER_CTX_new();
 
-    if (!m_ctx)
-        handle_error();
+    ret = BCryptOpenAlgorithmProvider(&ecb_alg_handle, BCRYPT_AES_ALGORITHM, NULL, 0);
+    REALM_ASSERT_RELEASE_EX(ret == 0 && "BCryptOpenAlgorithmProvider()", ret);
 
-    memcpy(m_aesKey, key, 32);
+    ret = BCryptSetProperty(ecb_alg_handle, BCRYPT_CHAINING_MODE, (PBYTE)BCRYPT_CHAIN_MODE_ECB,
+                            sizeof(BCRYPT_CHAIN_MODE_ECB), 0);
+    REALM_ASSERT_RELEASE_EX(ret == 0 && "BCryptSetProperty()", ret);
+
+    ret = BCryptGenerateSymmetricKey(ecb_alg_handle, &ecb_key_handle, nullptr, 0, (PBYTE)key, 32, 0);
+    REALM_ASSERT_RELEASE_EX(ret == 0 && "BCryptGenerateSymmetricKey()", ret);
+#else
+    // The key schedules are computed once here, and only the IV is set for
+    // each block.
+    gcm_key = key;
+    encr = EVP_CIPHER_CTX_new();
+    decr = EVP_CIPHER_CTX_new();
+    if (!encr || !decr) {
+        EVP_CIPHER_CTX_free(encr);
+        EVP_CIPHER_CTX_free(decr);
+        handle_error();
+    }
+    // Use zero padding - we always write a whole page
+    if (!EVP_CipherInit_ex(encr, EVP_aes_256_cbc(), NULL, key, NULL, mode_Encrypt) ||
+        !EVP_CIPHER_CTX_set_padding(encr, 0) ||
+        !EVP_CipherInit_ex(decr, EVP_aes_256_cbc(), NULL, key, NULL, mode_Decrypt) ||
+        !EVP_CIPHER_CTX_set_padding(decr, 0)) {
+        EVP_CIPHER_CTX_free(encr);
+        EVP_CIPHER_CTX_free(decr);
+        handle_error();
+    }
 #endif
-    memcpy(m_hmacKey, key + 32, 32);
 }
 
-AESCryptor::~AESCryptor() noexcept
+AESCryptor::Ciphers::~Ciphers() noexcept
 {
 #if REALM_PLATFORM_APPLE
-    CCCryptorRelease(m_encr);
-    CCCryptorRelease(m_decr);
+    CCCryptorRelease(encr);
+    CCCryptorRelease(decr);
+    CCCryptorRelease(ecb);
 #elif defined(_WIN32)
+    BCryptDestroyKey(aes_key_handle);
+    BCryptCloseAlgorithmProvider(aes_alg_handle, 0);
+    BCryptDestroyKey(ecb_key_handle);
+    BCryptCloseAlgorithmProvider(ecb_alg_handle, 0);
 #else
-    EVP_CIPHER_CTX_cleanup(m_ctx);
-    EVP_CIPHER_CTX_free(m_ctx);
+    EVP_CIPHER_CTX_free(encr);
+    EVP_CIPHER_CTX_free(decr);
+    EVP_CIPHER_CTX_free(gcm_encr);
+    EVP_CIPHER_CTX_free(gcm_decr);
 #endif
 }
 
+#if !REALM_PLATFORM_APPLE && !defined(_WIN32)
+EVP_CIPHER_CTX* AESCryptor::Ciphers::get_gcm(EncryptionMode mode)
+{
+    EVP_CIPHER_CTX*& ctx = mode == mode_Encrypt ? gcm_encr : gcm_decr;
+    if (!ctx) {
+        EVP_CIPHER_CTX* new_ctx = EVP_CIPHER_CTX_new();
+        if (!new_ctx || !EVP_CipherInit_ex(new_ctx, EVP_aes_256_gcm(), NULL, gcm_key, NULL, mode)) {
+            EVP_CIPHER_CTX_free(new_ctx);
+            handle_error();
+        }
+        ctx = new_ctx;
+    }
+    return ctx;
+}
+#else
+void AESCryptor::Ciphers::gcm_keystream(const uint8_t* nonce, uint8_t* keystream) noexcept
+{
+    uint8_t counter_blocks[gcm_keystream_size];
+    gcm_counter_blocks(nonce, counter_blocks);
+#if REALM_PLATFORM_APPLE
+    size_t bytes_encrypted = 0;
+    CCCryptorStatus err = CCCryptorUpdate(ecb, counter_blocks, gcm_keystream_size, keystream, gcm_keystream_size,
+                                          &bytes_encrypted);
+    REALM_ASSERT(err == kCCSuccess);
+    REALM_ASSERT(bytes_encrypted == gcm_keystream_size);
+#else
+    ULONG cbData;
+    int i = BCryptEncrypt(ecb_key_handle, counter_blocks, gcm_keystream_size, nullptr, nullptr, 0, keystream,
+                          gcm_keystream_size, &cbData, 0);
+    REALM_ASSERT_RELEASE_EX(i == 0 && "BCryptEncrypt()", i);
+    REALM_ASSERT_RELEASE_EX(cbData == gcm_keystream_size && "BCryptEncrypt()", cbData);
+#endif
+}
+#endif
+
+AESCryptor::AESCryptor(const uint8_t* key, File::EncryptionFormat format)
+    : m_format(format)
+{
+    memcpy(m_aesKey, key, 32);
+    memcpy(m_hmacKey, key + 32, 32);
+    m_ciphers = std::make_unique<Ciphers>(m_aesKey);
+    reserve_buffers(1);
+}
+
+AESCryptor::~AESCryptor() noexcept = default;
+
 void AESCryptor::handle_error()
 {
     throw std::runtime_error("Error occurred in encryption layer");
@@ -198,9 +460,14 @@ void AESCryptor::handle_error()
 void AESCryptor::set_file_size(off_t new_size)
 {
     REALM_ASSERT(new_size >= 0 && !int_cast_has_overflow<size_t>(new_size));
+    if (REALM_UNLIKELY(uint64_t(new_size) > gcm_max_file_size))
+        throw std::runtime_error("Encrypted file too large: " + std::to_string(int64_t(new_size)));
     size_t new_size_casted = size_t(new_size);
     size_t block_count = (new_size_casted + block_size - 1) / block_size;
     m_iv_buffer.reserve((block_count + blocks_per_metadata_block - 1) & ~(blocks_per_metadata_block - 1));
+    // No batch is larger than a metadata block, so writing does not have to
+    // allocate anything once the file has been sized
+    reserve_buffers(std::min(block_count, blocks_per_metadata_block)); // Throws
 }
 
 iv_table& AESCryptor::get_iv_table(FileDesc fd, off_t data_pos) noexcept
@@ -237,48 +504,112 @@ bool AESCryptor::check_hmac(const void* src, size_t len, const uint8_t* hmac) co
     return result == 0;
 }
 
-bool AESCryptor::read(FileDesc fd, off_t pos, char* dst, size_t size)
+size_t AESCryptor::get_num_batch_tasks(size_t num_blocks)
 {
-    REALM_ASSERT(size % block_size == 0);
-    while (size > 0) {
-        ssize_t bytes_read = check_read(fd, real_offset(pos), m_rw_buffer.get(), block_size);
+    size_t num_threads = ThreadPool::get_default().get_num_threads();
+    return std::max<size_t>(std::min(num_blocks / min_blocks_per_task, num_threads + 1), 1);
+}
 
-        if (bytes_read == 0)
-            return false;
+void AESCryptor::reserve_buffers(size_t num_blocks)
+{
+    if (num_blocks <= m_buffer_blocks)
+        return;
+    m_rw_buffer.reset(new char[num_blocks * block_size]);  // Throws
+    m_dst_buffer.reset(new char[num_blocks * block_size]); // Throws
+    m_batch_iv.reserve(num_blocks);                        // Throws
+    m_batch_written.reserve(num_blocks);                   // Throws
+    // The first task of a batch uses the ciphers of the cryptor, and each of
+    // the others keeps its own from one batch to the next
+    size_t num_tasks = get_num_batch_tasks(num_blocks);
+    while (m_task_ciphers.size() + 1 < num_tasks)
+        m_task_ciphers.push_back(std::make_unique<Ciphers>(m_aesKey)); // Throws
+    m_buffer_blocks = num_blocks;
+}
 
-        iv_table& iv = get_iv_table(fd, pos);
-        if (iv.iv1 == 0) {
-            // This block has never been written to, so we've just read pre-allocated
-            // space. No memset() since the code using this doesn't rely on
-            // pre-allocated space being zeroed.
-            return false;
-        }
+void AESCryptor::run_batch(size_t num_blocks, FunctionRef<void(Ciphers&, size_t begin, size_t end)> fn)
+{
+    REALM_ASSERT_DEBUG(num_blocks <= m_buffer_blocks);
+    size_t num_tasks = std::min(get_num_batch_tasks(num_blocks), m_task_ciphers.size() + 1);
+    if (num_tasks <= 1) {
+        fn(*m_ciphers, 0, num_blocks);
+        return;
+    }
+    ThreadPool::get_default().run(num_tasks, [&](size_t i) {
+        size_t begin = num_blocks * i / num_tasks;
+        size_t end = num_blocks * (i + 1) / num_tasks;
+        fn(i == 0 ? *m_ciphers : *m_task_ciphers[i - 1], begin, end);
+    }); // Throws
+}
 
-        if (!check_hmac(m_rw_buffer.get(), bytes_read, iv.hmac1)) {
-            // Either the DB is corrupted or we were interrupted between writing the
-            // new IV and writing the data
-            if (iv.iv2 == 0) {
-                // Very first write was interrupted
-                return false;
-            }
+bool AESCryptor::try_decrypt(Ciphers& ciphers, off_t pos, char* dst, const char* src, size_t bytes_read,
+                             uint32_t iv, const uint8_t* hmac)
+{
+    if (is_gcm(hmac))
+        return is_gcm(hmac, gcm_Valid) && bytes_read == block_size && gcm_decrypt(ciphers, pos, dst, src, iv, hmac);
 
-            if (check_hmac(m_rw_buffer.get(), bytes_read, iv.hmac2)) {
-                // Un-bump the IV since the write with the bumped IV never actually
-                // happened
-                memcpy(&iv.iv1, &iv.iv2, 32);
-            }
-            else {
-                // If the file has been shrunk and then re-expanded, we may have
-                // old hmacs that don't go with this data. ftruncate() is
-                // required to fill any added space with zeroes, so assume that's
-                // what happened if the buffer is all zeroes
-                for (ssize_t i = 0; i < bytes_read; ++i) {
-                    if (m_rw_buffer[i] != 0)
-                        throw DecryptionFailed();
-                }
-                return false;
-            }
-        }
+    if (!check_hmac(src, bytes_read, hmac))
+        return false;
+    crypt(ciphers, mode_Decrypt, pos, dst, src, reinterpret_cast<const char*>(&iv));
+    return true;
+}
+
+bool AESCryptor::decrypt_block(Ciphers& ciphers, off_t pos, char* dst, const char* src, size_t bytes_read,
+                               iv_table& iv)
+{
+    if (bytes_read == 0)
+        return false;
+
+    if (iv.iv1 == 0) {
+        // This block has never been written to, so we've just read pre-allocated
+        // space. No memset() since the code using this doesn't rely on
+        // pre-allocated space being zeroed.
+        return false;
+    }
+
+    if (try_decrypt(ciphers, pos, dst, src, bytes_read, iv.iv1, iv.hmac1))
+        return true;
+
+    // Either the DB is corrupted or we were interrupted between writing the
+    // new IV and writing the data
+    if (iv.iv2 == 0 || is_gcm(iv.hmac2, gcm_Empty)) {
+        // Very first write was interrupted
+        return false;
+    }
+
+    if (try_decrypt(ciphers, pos, dst, src, bytes_read, iv.iv2, iv.hmac2)) {
+        // The write with the bumped IV never actually happened
+        restore_previous_iv(iv);
+        return true;
+    }
+
+    // If the file has been shrunk and then re-expanded, we may have
+    // old hmacs that don't go with this data. ftruncate() is
+    // required to fill any added space with zeroes, so assume that's
+    // what happened if the buffer is all zeroes
+    for (size_t i = 0; i < bytes_read; ++i) {
+        if (src[i] != 0)
+            throw DecryptionFailed();
+    }
+    return false;
+}
+
+bool AESCryptor::read(FileDesc fd, off_t pos, char* dst, size_t size)
+{
+    REALM_ASSERT(size % block_size == 0);
+    bool all_written = true;
+    while (size > 0) {
+        // The blocks of a metadata block are stored contiguously in the file,
+        // so they are read with a single call.
+        size_t first_block = size_t(pos) / block_size;
+        size_t num_blocks = std::min(size / block_size,
+                                     blocks_per_metadata_block - first_block % blocks_per_metadata_block);
+        reserve_buffers(num_blocks); // Throws
+        size_t bytes_read = check_read(fd, real_offset(pos), m_rw_buffer.get(), num_blocks * block_size);
+
+        m_batch_iv.clear();
+        for (size_t i = 0; i < num_blocks; ++i)
+            m_batch_iv.push_back(&get_iv_table(fd, pos + off_t(i * block_size))); // Throws
+        m_batch_written.resize(num_blocks);                                       // Throws
 
         // We may expect some adress ranges of the destination buffer of
         // AESCryptor::read() to stay unmodified, i.e. being overwritten with
@@ -293,14 +624,26 @@ bool AESCryptor::read(FileDesc fd, off_t pos, char* dst, size_t size)
         //
         // We therefore decrypt to a temporary buffer first and then copy the
         // completely decrypted data after.
-        crypt(mode_Decrypt, pos, m_dst_buffer.get(), m_rw_buffer.get(), reinterpret_cast<const char*>(&iv.iv1));
-        memcpy(dst, m_dst_buffer.get(), block_size);
+        run_batch(num_blocks, [&](Ciphers& ciphers, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                size_t offset = i * block_size;
+                size_t bytes = bytes_read > offset ? std::min(bytes_read - offset, block_size) : 0;
+                m_batch_written[i] = decrypt_block(ciphers, pos + off_t(offset), m_dst_buffer.get() + offset,
+                                                   m_rw_buffer.get() + offset, bytes, *m_batch_iv[i]); // Throws
+            }
+        }); // Throws
+        for (size_t i = 0; i < num_blocks; ++i) {
+            if (m_batch_written[i])
+                memcpy(dst + i * block_size, m_dst_buffer.get() + i * block_size, block_size);
+            else
+                all_written = false;
+        }
 
-        pos += block_size;
-        dst += block_size;
-        size -= block_size;
+        pos += off_t(num_blocks * block_size);
+        dst += num_blocks * block_size;
+        size -= num_blocks * block_size;
     }
-    return true;
+    return all_written;
 }
 
 void AESCryptor::try_read_block(FileDesc fd, off_t pos, char* dst) noexcept
@@ -320,59 +663,122 @@ void AESCryptor::try_read_block(FileDesc fd, off_t pos, char* dst) noexcept
         return;
     }
 
-    if (!check_hmac(m_rw_buffer.get(), bytes_read, iv.hmac1)) {
-        if (iv.iv2 == 0) {
-            std::cerr << "First write interrupted: 0x" << std::hex << pos << std::endl;
-        }
+    if (try_decrypt(*m_ciphers, pos, dst, m_rw_buffer.get(), bytes_read, iv.iv1, iv.hmac1))
+        return;
 
-        if (check_hmac(m_rw_buffer.get(), bytes_read, iv.hmac2)) {
-            std::cerr << "Restore old IV: 0x" << std::hex << pos << std::endl;
-            memcpy(&iv.iv1, &iv.iv2, 32);
-        }
-        else {
-            std::cerr << "Checksum failed: 0x" << std::hex << pos << std::endl;
-        }
+    if (iv.iv2 == 0 || is_gcm(iv.hmac2, gcm_Empty)) {
+        std::cerr << "First write interrupted: 0x" << std::hex << pos << std::endl;
     }
-    crypt(mode_Decrypt, pos, dst, m_rw_buffer.get(), reinterpret_cast<const char*>(&iv.iv1));
+
+    if (try_decrypt(*m_ciphers, pos, dst, m_rw_buffer.get(), bytes_read, iv.iv2, iv.hmac2)) {
+        std::cerr << "Restore old IV: 0x" << std::hex << pos << std::endl;
+        restore_previous_iv(iv);
+        return;
+    }
+
+    std::cerr << "Checksum failed: 0x" << std::hex << pos << std::endl;
+    if (!is_gcm(iv.hmac1))
+        crypt(*m_ciphers, mode_Decrypt, pos, dst, m_rw_buffer.get(), reinterpret_cast<const char*>(&iv.iv1));
+    else
+        gcm_decrypt(*m_ciphers, pos, dst, m_rw_buffer.get(), iv.iv1, iv.hmac1);
 }
 
-void AESCryptor::write(FileDesc fd, off_t pos, const char* src, size_t size) noexcept
+void AESCryptor::select_format(FileDesc fd) noexcept
 {
-    REALM_ASSERT(size % block_size == 0);
-    while (size > 0) {
-        iv_table& iv = get_iv_table(fd, pos);
+    if (m_format_selected)
+        return;
+    // A file which has a first block keeps its format, so only writing a new
+    // file (e.g. by compaction) changes the format.
+    iv_table& iv = get_iv_table(fd, 0);
+    if (iv.iv1 != 0)
+        m_format = is_gcm(iv.hmac1) ? File::encryption_Gcm : File::encryption_CbcHmac;
+    m_format_selected = true;
+}
+
+void AESCryptor::restore_previous_iv(iv_table& iv) noexcept
+{
+    // Un-bump the IV. The nonce of an interrupted AES-GCM write is not used
+    // again, as every such write picks a new random one.
+    memcpy(&iv.iv1, &iv.iv2, 32);
+}
 
+void AESCryptor::encrypt_block(Ciphers& ciphers, off_t pos, char* dst, const char* src, iv_table& iv) noexcept
+{
+    bool gcm = m_format == File::encryption_Gcm;
+    if (gcm && iv.iv1 == 0) {
+        iv.iv2 = 1;
+        memset(iv.hmac2, 0, sizeof(iv.hmac2));
+        set_gcm_marker(iv.hmac2, gcm_Empty);
+    }
+    else {
         memcpy(&iv.iv2, &iv.iv1, 32);
-        do {
+    }
+    do {
+        if (gcm) {
+            // The IVs after the one on disk may already have been used (see
+            // the top of this file)
+            uint32_t iv_high;
+            gcm_random_iv(iv.iv1, iv_high);
+            memcpy(iv.hmac1 + gcm_iv_high_offset, &iv_high, 4);
+            set_gcm_marker(iv.hmac1, gcm_Valid);
+            gcm_encrypt(ciphers, pos, dst, src, iv.iv1, iv.hmac1);
+        }
+        else {
             ++iv.iv1;
             // 0 is reserved for never-been-used, so bump if we just wrapped around
             if (iv.iv1 == 0)
                 ++iv.iv1;
+            crypt(ciphers, mode_Encrypt, pos, dst, src, reinterpret_cast<const char*>(&iv.iv1));
+            calc_hmac(dst, block_size, iv.hmac1, m_hmacKey);
+        }
+        // In the extremely unlikely case that both the old and new versions have
+        // the same hash we won't know which IV to use, so bump the IV until
+        // they're different.
+    } while (REALM_UNLIKELY(memcmp(iv.hmac1, iv.hmac2, 4) == 0));
+}
 
-            crypt(mode_Encrypt, pos, m_rw_buffer.get(), src, reinterpret_cast<const char*>(&iv.iv1));
-            calc_hmac(m_rw_buffer.get(), block_size, iv.hmac1, m_hmacKey);
-            // In the extremely unlikely case that both the old and new versions have
-            // the same hash we won't know which IV to use, so bump the IV until
-            // they're different.
-        } while (REALM_UNLIKELY(memcmp(iv.hmac1, iv.hmac2, 4) == 0));
+void AESCryptor::write(FileDesc fd, off_t pos, const char* src, size_t size)
+{
+    REALM_ASSERT(size % block_size == 0);
+    select_format(fd);
+    while (size > 0) {
+        // The blocks of a metadata block, and their IV tables, are stored
+        // contiguously in the file, so each is written with a single call.
+        size_t first_block = size_t(pos) / block_size;
+        size_t num_blocks = std::min(size / block_size,
+                                     blocks_per_metadata_block - first_block % blocks_per_metadata_block);
+        reserve_buffers(num_blocks); // Throws
+
+        m_batch_iv.clear();
+        for (size_t i = 0; i < num_blocks; ++i)
+            m_batch_iv.push_back(&get_iv_table(fd, pos + off_t(i * block_size)));
+
+        run_batch(num_blocks, [&](Ciphers& ciphers, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                size_t offset = i * block_size;
+                encrypt_block(ciphers, pos + off_t(offset), m_rw_buffer.get() + offset, src + offset,
+                              *m_batch_iv[i]);
+            }
+        }); // Throws
 
-        check_write(fd, iv_table_pos(pos), &iv, sizeof(iv));
-        check_write(fd, real_offset(pos), m_rw_buffer.get(), block_size);
+        check_write(fd, iv_table_pos(pos), m_batch_iv[0], num_blocks * sizeof(iv_table));
+        check_write(fd, real_offset(pos), m_rw_buffer.get(), num_blocks * block_size);
 
-        pos += block_size;
-        src += block_size;
-        size -= block_size;
+        pos += off_t(num_blocks * block_size);
+        src += num_blocks * block_size;
+        size -= num_blocks * block_size;
     }
 }
 
-void AESCryptor::crypt(EncryptionMode mode, off_t pos, char* dst, const char* src, const char* stored_iv) noexcept
+void AESCryptor::crypt(Ciphers& ciphers, EncryptionMode mode, off_t pos, char* dst, const char* src,
+                       const char* stored_iv) noexcept
 {
     uint8_t iv[aes_block_size] = {0};
     memcpy(iv, stored_iv, 4);
     memcpy(iv + 4, &pos, sizeof(pos));
 
 #if REALM_PLATFORM_APPLE
-    CCCryptorRef cryptor = mode == mode_Encrypt ? m_encr : m_decr;
+    CCCryptorRef cryptor = mode == mode_Encrypt ? ciphers.encr : ciphers.decr;
     CCCryptorReset(cryptor, iv);
 
     size_t bytesEncrypted = 0;
@@ -384,14 +790,14 @@ void AESCryptor::crypt(EncryptionMode mode, off_t pos, char* dst, const char* sr
     int i;
 
     if (mode == mode_Encrypt) {
-        i = BCryptEncrypt(m_aes_key_handle, (PUCHAR)src, block_size, nullptr, (PUCHAR)iv, sizeof(iv), (PUCHAR)dst,
-                          block_size, &cbData, 0);
+        i = BCryptEncrypt(ciphers.aes_key_handle, (PUCHAR)src, block_size, nullptr, (PUCHAR)iv, sizeof(iv),
+                          (PUCHAR)dst, block_size, &cbData, 0);
         REALM_ASSERT_RELEASE_EX(i == 0 && "BCryptEncrypt()", i);
         REALM_ASSERT_RELEASE_EX(cbData == block_size && "BCryptEncrypt()", cbData);
     }
     else if (mode == mode_Decrypt) {
-        i = BCryptDecrypt(m_aes_key_handle, (PUCHAR)src, block_size, nullptr, (PUCHAR)iv, sizeof(iv), (PUCHAR)dst,
-                          block_size, &cbData, 0);
+        i = BCryptDecrypt(ciphers.aes_key_handle, (PUCHAR)src, block_size, nullptr, (PUCHAR)iv, sizeof(iv),
+                          (PUCHAR)dst, block_size, &cbData, 0);
         REALM_ASSERT_RELEASE_EX(i == 0 && "BCryptDecrypt()", i);
         REALM_ASSERT_RELEASE_EX(cbData == block_size && "BCryptDecrypt()", cbData);
     }
@@ -400,20 +806,76 @@ void AESCryptor::crypt(EncryptionMode mode, off_t pos, char* dst, const char* sr
     }
 
 #else
-    if (!EVP_CipherInit_ex(m_ctx, EVP_aes_256_cbc(), NULL, m_aesKey, iv, mode))
+    EVP_CIPHER_CTX* ctx = mode == mode_Encrypt ? ciphers.encr : ciphers.decr;
+    // Keep the cipher and key schedule, and only set the IV
+    if (!EVP_CipherInit_ex(ctx, NULL, NULL, NULL, iv, -1))
         handle_error();
 
     int len;
-    // Use zero padding - we always write a whole page
-    EVP_CIPHER_CTX_set_padding(m_ctx, 0);
-
-    if (!EVP_CipherUpdate(m_ctx, reinterpret_cast<uint8_t*>(dst), &len, reinterpret_cast<const uint8_t*>(src),
+    if (!EVP_CipherUpdate(ctx, reinterpret_cast<uint8_t*>(dst), &len, reinterpret_cast<const uint8_t*>(src),
                           block_size))
         handle_error();
 
     // Finalize the encryption. Should not output further data.
-    if (!EVP_CipherFinal_ex(m_ctx, reinterpret_cast<uint8_t*>(dst) + len, &len))
+    if (!EVP_CipherFinal_ex(ctx, reinterpret_cast<uint8_t*>(dst) + len, &len))
+        handle_error();
+#endif
+}
+
+void AESCryptor::gcm_encrypt(Ciphers& ciphers, off_t pos, char* dst, const char* src, uint32_t iv,
+                             uint8_t* tag) noexcept
+{
+    uint8_t nonce[12];
+    gcm_nonce(nonce, pos, iv, tag);
+#if REALM_PLATFORM_APPLE || defined(_WIN32)
+    uint8_t keystream[gcm_keystream_size];
+    ciphers.gcm_keystream(nonce, keystream);
+    for (size_t i = 0; i < block_size; ++i)
+        dst[i] = char(uint8_t(src[i]) ^ keystream[2 * aes_block_size + i]);
+    gcm_tag(keystream, reinterpret_cast<const uint8_t*>(dst), tag);
+#else
+    EVP_CIPHER_CTX* ctx = ciphers.get_gcm(mode_Encrypt);
+    int len;
+    if (!EVP_CipherInit_ex(ctx, NULL, NULL, NULL, nonce, -1) ||
+        !EVP_CipherUpdate(ctx, reinterpret_cast<uint8_t*>(dst), &len, reinterpret_cast<const uint8_t*>(src),
+                          block_size) ||
+        !EVP_CipherFinal_ex(ctx, reinterpret_cast<uint8_t*>(dst) + len, &len) ||
+        !EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, gcm_tag_size, tag))
+        handle_error();
+#endif
+}
+
+bool AESCryptor::gcm_decrypt(Ciphers& ciphers, off_t pos, char* dst, const char* src, uint32_t iv,
+                             const uint8_t* tag) noexcept
+{
+    uint8_t nonce[12];
+    gcm_nonce(nonce, pos, iv, tag);
+#if REALM_PLATFORM_APPLE || defined(_WIN32)
+    uint8_t keystream[gcm_keystream_size];
+    ciphers.gcm_keystream(nonce, keystream);
+    uint8_t expected_tag[gcm_tag_size];
+    gcm_tag(keystream, reinterpret_cast<const uint8_t*>(src), expected_tag);
+    // Fails if the data does not match the tag
+    uint8_t diff = 0;
+    for (int i = 0; i < gcm_tag_size; ++i)
+        diff |= expected_tag[i] ^ tag[i];
+    if (diff != 0)
+        return false;
+    for (size_t i = 0; i < block_size; ++i)
+        dst[i] = char(uint8_t(src[i]) ^ keystream[2 * aes_block_size + i]);
+    return true;
+#else
+    uint8_t expected_tag[gcm_tag_size];
+    memcpy(expected_tag, tag, gcm_tag_size);
+    EVP_CIPHER_CTX* ctx = ciphers.get_gcm(mode_Decrypt);
+    int len;
+    if (!EVP_CipherInit_ex(ctx, NULL, NULL, NULL, nonce, -1) ||
+        !EVP_CipherUpdate(ctx, reinterpret_cast<uint8_t*>(dst), &len, reinterpret_cast<const uint8_t*>(src),
+                          block_size) ||
+        !EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, gcm_tag_size, expected_tag))
         handle_error();
+    // Fails if the data does not match the tag
+    return EVP_CipherFinal_ex(ctx, reinterpret_cast<uint8_t*>(dst) + len, &len) > 0;
 #endif
 }
 
@@ -479,8 +941,15 @@ EncryptedFileMapping::EncryptedFileMapping(SharedFileInfo& file, size_t file_off
 EncryptedFileMapping::~EncryptedFileMapping()
 {
     if (m_access == File::access_ReadWrite) {
-        flush();
-        sync();
+        // The owner of a mapping flushes it before removing it, so that errors
+        // are reported. Any error here leaves the dirty pages unwritten, as if
+        // the process had terminated.
+        try {
+            flush(); // Throws
+            sync();
+        }
+        catch (...) {
+        } // ignored on purpose.
     }
     m_file.mappings.erase(remove(m_file.mappings.begin(), m_file.mappings.end(), this));
 }
@@ -509,20 +978,52 @@ bool EncryptedFileMapping::copy_up_to_date_page(size_t local_page_ndx) noexcept
     // Precondition: this method must never be called for a page which
     // is already up to date.
     REALM_ASSERT(is_not(m_page_state[local_page_ndx], UpToDate));
+    if (EncryptedFileMapping* m = find_up_to_date_page(local_page_ndx)) {
+        size_t shadow_mapping_local_ndx = local_page_ndx + m_first_page - m->m_first_page;
+        memcpy(page_addr(local_page_ndx), m->page_addr(shadow_mapping_local_ndx),
+               static_cast<size_t>(1ULL << m_page_shift));
+        return true;
+    }
+    return false;
+}
+
+EncryptedFileMapping* EncryptedFileMapping::find_up_to_date_page(size_t local_page_ndx) noexcept
+{
+    size_t page_ndx_in_file = local_page_ndx + m_first_page;
     for (size_t i = 0; i < m_file.mappings.size(); ++i) {
         EncryptedFileMapping* m = m_file.mappings[i];
-        size_t page_ndx_in_file = local_page_ndx + m_first_page;
         if (m == this || !m->contains_page(page_ndx_in_file))
             continue;
 
         size_t shadow_mapping_local_ndx = page_ndx_in_file - m->m_first_page;
-        if (is(m->m_page_state[shadow_mapping_local_ndx], UpToDate)) {
-            memcpy(page_addr(local_page_ndx), m->page_addr(shadow_mapping_local_ndx),
-                   static_cast<size_t>(1ULL << m_page_shift));
-            return true;
-        }
+        if (is(m->m_page_state[shadow_mapping_local_ndx], UpToDate))
+            return m;
     }
-    return false;
+    return nullptr;
+}
+
+size_t EncryptedFileMapping::get_read_ahead(size_t local_page_ndx) noexcept
+{
+    // Pages which are decrypted in order are most likely read by a scan, so
+    // the following pages are decrypted along with them, in batches which
+    // double in size for every further page in order.
+    if (local_page_ndx == m_next_sequential_page) {
+        size_t max_read_ahead = std::max<size_t>(max_read_ahead_size >> m_page_shift, 1);
+        m_read_ahead = std::min(std::max<size_t>(m_read_ahead * 2, 1), max_read_ahead);
+    }
+    else {
+        m_read_ahead = 0;
+    }
+
+    // Pages which are up to date in any mapping must not be read from the
+    // file, as they may have been changed since they were last written.
+    size_t num_pages = 1;
+    while (num_pages <= m_read_ahead && local_page_ndx + num_pages < m_page_state.size() &&
+           is_not(m_page_state[local_page_ndx + num_pages], UpToDate) &&
+           !find_up_to_date_page(local_page_ndx + num_pages))
+        ++num_pages;
+    m_next_sequential_page = local_page_ndx + num_pages;
+    return num_pages;
 }
 
 void EncryptedFileMapping::refresh_page(size_t local_page_ndx)
@@ -531,15 +1032,18 @@ void EncryptedFileMapping::refresh_page(size_t local_page_ndx)
 
     char* addr = page_addr(local_page_ndx);
 
+    size_t num_pages = 1;
     if (!copy_up_to_date_page(local_page_ndx)) {
+        num_pages = get_read_ahead(local_page_ndx);
         size_t page_ndx_in_file = local_page_ndx + m_first_page;
-        m_file.cryptor.read(m_file.fd, off_t(page_ndx_in_file << m_page_shift), addr,
-                            static_cast<size_t>(1ULL << m_page_shift));
+        m_file.cryptor.read(m_file.fd, off_t(page_ndx_in_file << m_page_shift), addr, num_pages << m_page_shift);
+    }
+    for (size_t i = local_page_ndx; i < local_page_ndx + num_pages; ++i) {
+        if (is_not(m_page_state[i], UpToDate | RefetchRequired))
+            m_num_decrypted++;
+        clear(m_page_state[i], RefetchRequired);
+        set(m_page_state[i], UpToDate);
     }
-    if (is_not(m_page_state[local_page_ndx], UpToDate | RefetchRequired))
-        m_num_decrypted++;
-    clear(m_page_state[local_page_ndx], RefetchRequired);
-    set(m_page_state[local_page_ndx], UpToDate);
 }
 
 void EncryptedFileMapping::mark_for_refresh(size_t ref_start, size_t ref_end)
@@ -736,19 +1240,27 @@ void EncryptedFileMapping::reclaim_untouched(size_t& progress_index, size_t& wor
     return;
 }
 
-void EncryptedFileMapping::flush() noexcept
+void EncryptedFileMapping::flush()
 {
     const size_t num_dirty_pages = m_page_state.size();
-    for (size_t local_page_ndx = 0; local_page_ndx < num_dirty_pages; ++local_page_ndx) {
+    size_t local_page_ndx = 0;
+    while (local_page_ndx < num_dirty_pages) {
         if (is_not(m_page_state[local_page_ndx], Dirty)) {
             validate_page(local_page_ndx);
+            ++local_page_ndx;
             continue;
         }
 
+        // Adjacent dirty pages are written together, so that they can be
+        // encrypted on several threads.
+        size_t end = local_page_ndx + 1;
+        while (end < num_dirty_pages && is(m_page_state[end], Dirty))
+            ++end;
         size_t page_ndx_in_file = local_page_ndx + m_first_page;
         m_file.cryptor.write(m_file.fd, off_t(page_ndx_in_file << m_page_shift), page_addr(local_page_ndx),
-                             static_cast<size_t>(1ULL << m_page_shift));
-        clear(m_page_state[local_page_ndx], Dirty);
+                             (end - local_page_ndx) << m_page_shift); // Throws
+        for (; local_page_ndx < end; ++local_page_ndx)
+            clear(m_page_state[local_page_ndx], Dirty);
     }
 
     validate();
@@ -879,13 +1391,15 @@ void EncryptedFileMapping::set(void* new_addr, size_t new_size, size_t new_file_
     // this design should be revisited.
     m_file.cryptor.set_file_size(off_t(new_size + new_file_offset));
 
-    flush();
+    flush(); // Throws
     m_addr = new_addr;
 
     m_first_page = new_file_offset >> m_page_shift;
     size_t num_pages = new_size >> m_page_shift;
 
     m_num_decrypted = 0;
+    m_next_sequential_page = size_t(-1);
+    m_read_ahead = 0;
     m_page_state.clear();
     m_chunk_dont_scan.clear();
 
@@ -47,7 +47,7 @@ public:
 
     // Write all dirty pages to disk and mark them read-only
     // Does not call fsync
-    void flush() noexcept;
+    void flush(); // Throws
 
     // Sync this file to disk
     void sync() noexcept;
@@ -139,6 +139,12 @@ private:
 
     File::AccessMode m_access;
 
+    // The page following the last batch of pages read from the file, and the
+    // number of pages read along with the requested one in that batch.
+    size_t m_next_sequential_page = size_t(-1);
+    size_t m_read_ahead = 0;
+    static constexpr size_t max_read_ahead_size = 256 * 1024;
+
 #ifdef REALM_DEBUG
     std::unique_ptr<char[]> m_validate_buffer;
 #endif
@@ -147,6 +153,8 @@ private:
 
     void mark_outdated(size_t local_page_ndx) noexcept;
     bool copy_up_to_date_page(size_t local_page_ndx) noexcept;
+    EncryptedFileMapping* find_up_to_date_page(size_t local_page_ndx) noexcept;
+    size_t get_read_ahead(size_t local_page_ndx) noexcept;
     void refresh_page(size_t local_page_ndx);
     void write_and_update_all(size_t local_page_ndx, size_t begin_offset, size_t end_offset) noexcept;
     void reclaim_page(size_t page_ndx);
@@ -1277,7 +1277,7 @@ void File::unlock() noexcept
 
 void* File::map(AccessMode a, size_t size, int /*map_flags*/, size_t offset) const
 {
-    return realm::util::mmap(m_fd, size, a, offset, m_encryption_key.get());
+    return realm::util::mmap(m_fd, size, a, offset, m_encryption_key.get(), m_encryption_format);
 }
 
 void* File::map_fixed(AccessMode a, void* address, size_t size, int /* map_flags */, size_t offset) const
@@ -1306,7 +1306,7 @@ void* File::map_reserve(AccessMode a, size_t size, size_t offset) const
 #if REALM_ENABLE_ENCRYPTION
 void* File::map(AccessMode a, size_t size, EncryptedFileMapping*& mapping, int /*map_flags*/, size_t offset) const
 {
-    return realm::util::mmap(m_fd, size, a, offset, m_encryption_key.get(), mapping);
+    return realm::util::mmap(m_fd, size, a, offset, m_encryption_key.get(), mapping, m_encryption_format);
 }
 
 void* File::map_fixed(AccessMode a, void* address, size_t size, EncryptedFileMapping* mapping, int /* map_flags */,
@@ -1330,7 +1330,7 @@ void* File::map_reserve(AccessMode a, size_t size, size_t offset, EncryptedFileM
 {
     if (m_encryption_key.get()) {
         // encrypted file - just mmap it, the encryption layer handles if the mapping extends beyond eof
-        return realm::util::mmap(m_fd, size, a, offset, m_encryption_key.get(), mapping);
+        return realm::util::mmap(m_fd, size, a, offset, m_encryption_key.get(), mapping, m_encryption_format);
     }
 #ifndef _WIN32
     // not encrypted, do a proper reservation on Unixes'
@@ -1739,7 +1739,8 @@ bool File::MapBase::try_reserve(const File& file, AccessMode a, size_t size, siz
     m_offset = offset;
 #if REALM_ENABLE_ENCRYPTION
     if (file.m_encryption_key) {
-        m_encrypted_mapping = util::reserve_mapping(addr, m_fd, offset, a, file.m_encryption_key.get());
+        m_encrypted_mapping = util::reserve_mapping(addr, m_fd, offset, a, file.m_encryption_key.get(),
+                                                    file.m_encryption_format);
     }
 #endif
 #endif
@@ -200,6 +200,31 @@ public:
         create_Must   ///< Fail if the file already exists.
     };
 
+    /// The format of the blocks written to an encrypted file. Blocks of
+    /// either format can always be read, but a file which already has data
+    /// keeps the format of its first block, whichever format is requested.
+    enum EncryptionFormat {
+        encryption_CbcHmac, ///< AES-256-CBC, authenticated by HMAC-SHA224.
+        encryption_Gcm      ///< AES-256-GCM.
+    };
+
+    /// Hints about how a memory mapping will be accessed. See
+    /// util::advise_mapping(). They have no effect where madvise() is not
+    /// available.
+    enum MappingAdvice {
+        advice_Normal,     ///< The default readahead of the system.
+        advice_Random,     ///< No readahead, as for lookups in a B+tree.
+        advice_Sequential, ///< Aggressive readahead, as for full scans.
+        advice_WillNeed    ///< Start reading the range in the background.
+    };
+
+    /// How anonymous memory is backed. See util::mmap_anon().
+    enum HugePages {
+        huge_pages_None,        ///< Regular pages.
+        huge_pages_Transparent, ///< Ask for transparent huge pages (Linux).
+        huge_pages_Explicit     ///< Use the reserved huge page pool (Linux), or else transparent ones.
+    };
+
     enum {
         flag_Trunc = 1, ///< Truncate the file if it already exists.
         flag_Append = 2 ///< Move to end of file before each write.
@@ -379,6 +404,19 @@ public:
     /// null_ptr if no key set.
     const char* get_encryption_key() const;
 
+    /// Set the format used for blocks written to this file if it is
+    /// encrypted, and has no data yet. Must be called before any mappings
+    /// are created. The default is encryption_CbcHmac.
+    void set_encryption_format(EncryptionFormat format) noexcept
+    {
+        m_encryption_format = format;
+    }
+
+    EncryptionFormat get_encryption_format() const noexcept
+    {
+        return m_encryption_format;
+    }
+
     /// Set the path used for emulating file locks. If not set explicitly,
     /// the emulation will use the path of the file itself suffixed by ".fifo"
     void set_fifo_path(const std::string& fifo_dir_path, const std::string& fifo_file_name);
@@ -631,6 +669,7 @@ private:
 #endif
 #endif
     std::unique_ptr<const char[]> m_encryption_key = nullptr;
+    EncryptionFormat m_encryption_format = encryption_CbcHmac;
     std::string m_path;
 
     bool lock(bool exclusive, bool non_blocking);
@@ -1068,6 +1107,7 @@ inline File::File(File&& f) noexcept
     f.m_fd = -1;
 #endif
     m_encryption_key = std::move(f.m_encryption_key);
+    m_encryption_format = f.m_encryption_format;
 }
 
 inline File& File::operator=(File&& f) noexcept
@@ -1088,6 +1128,7 @@ inline File& File::operator=(File&& f) noexcept
 #endif
 #endif
     m_encryption_key = std::move(f.m_encryption_key);
+    m_encryption_format = f.m_encryption_format;
     return *this;
 }
 
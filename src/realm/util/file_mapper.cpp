@@ -25,7 +25,13 @@
 #else
 #include <cerrno>
 #include <sys/mman.h>
+#include <sys/resource.h>
 #include <unistd.h>
+#if defined(__linux__) && !REALM_ANDROID
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
 #endif
 
 #include <realm/exceptions.hpp>
@@ -500,7 +506,7 @@ SharedFileInfo* get_file_info_for_file(File& file)
 
 namespace {
 EncryptedFileMapping* add_mapping(void* addr, size_t size, FileDesc fd, size_t file_offset, File::AccessMode access,
-                                  const char* encryption_key)
+                                  const char* encryption_key, File::EncryptionFormat format)
 {
 #ifndef _WIN32
     struct stat st;
@@ -557,7 +563,7 @@ EncryptedFileMapping* add_mapping(void* addr, size_t size, FileDesc fd, size_t f
 #endif
 
         try {
-            f.info = std::make_shared<SharedFileInfo>(reinterpret_cast<const uint8_t*>(encryption_key), fd);
+            f.info = std::make_shared<SharedFileInfo>(reinterpret_cast<const uint8_t*>(encryption_key), fd, format);
         }
         catch (...) {
 #ifdef _WIN32
@@ -625,13 +631,13 @@ void remove_mapping(void* addr, size_t size)
 } // anonymous namespace
 
 void* mmap(FileDesc fd, size_t size, File::AccessMode access, size_t offset, const char* encryption_key,
-           EncryptedFileMapping*& mapping)
+           EncryptedFileMapping*& mapping, File::EncryptionFormat format)
 {
     _impl::SimulatedFailure::trigger_mmap(size);
     if (encryption_key) {
         size = round_up_to_page_size(size);
         void* addr = mmap_anon(size);
-        mapping = add_mapping(addr, size, fd, offset, access, encryption_key);
+        mapping = add_mapping(addr, size, fd, offset, access, encryption_key, format);
         return addr;
     }
     else {
@@ -642,9 +648,9 @@ void* mmap(FileDesc fd, size_t size, File::AccessMode access, size_t offset, con
 
 
 EncryptedFileMapping* reserve_mapping(void* addr, FileDesc fd, size_t offset, File::AccessMode access,
-                                      const char* encryption_key)
+                                      const char* encryption_key, File::EncryptionFormat format)
 {
-    return add_mapping(addr, 0, fd, offset, access, encryption_key);
+    return add_mapping(addr, 0, fd, offset, access, encryption_key, format);
 }
 
 void extend_encrypted_mapping(EncryptedFileMapping* mapping, void* addr, size_t offset, size_t old_size,
@@ -663,14 +669,14 @@ void remove_encrypted_mapping(void* addr, size_t size)
 }
 
 void* mmap_reserve(FileDesc fd, size_t reservation_size, File::AccessMode access, size_t offset_in_file,
-                   const char* enc_key, EncryptedFileMapping*& mapping)
+                   const char* enc_key, EncryptedFileMapping*& mapping, File::EncryptionFormat format)
 {
     auto addr = mmap_reserve(fd, reservation_size, offset_in_file);
     if (enc_key) {
         REALM_ASSERT(reservation_size == round_up_to_page_size(reservation_size));
         // we create a mapping for the entire reserved area. This causes full initialization of some fairly
         // large std::vectors, which it would be nice to avoid. This is left as a future optimization.
-        mapping = add_mapping(addr, reservation_size, fd, offset_in_file, access, enc_key);
+        mapping = add_mapping(addr, reservation_size, fd, offset_in_file, access, enc_key, format);
     }
     else {
         mapping = nullptr;
@@ -701,9 +707,10 @@ void* mmap_fixed(FileDesc fd, void* address_request, size_t size, File::AccessMo
 
 #endif
 
-void* mmap_anon(size_t size)
+void* mmap_anon(size_t size, File::HugePages huge_pages)
 {
 #ifdef _WIN32
+    static_cast<void>(huge_pages);
     HANDLE hMapFile;
     LPCTSTR pBuf;
 
@@ -723,6 +730,16 @@ void* mmap_anon(size_t size)
     CloseHandle(hMapFile);
     return (void*)pBuf;
 #else
+#ifdef MAP_HUGETLB
+    // Pages from the reserved pool must be mapped in whole huge pages. If the
+    // pool is empty, transparent huge pages are the next best thing.
+    constexpr size_t huge_page_size = 2 * 1024 * 1024;
+    if (huge_pages == File::huge_pages_Explicit && size % huge_page_size == 0) {
+        void* addr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_ANON | MAP_PRIVATE | MAP_HUGETLB, -1, 0);
+        if (addr != MAP_FAILED)
+            return addr;
+    }
+#endif
     void* addr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_ANON | MAP_PRIVATE, -1, 0);
     if (addr == MAP_FAILED) {
         int err = errno; // Eliminate any risk of clobbering
@@ -732,10 +749,103 @@ void* mmap_anon(size_t size)
         throw std::system_error(err, std::system_category(),
                                 std::string("mmap() failed (size: ") + util::to_string(size) + ", offset is 0)");
     }
+#ifdef MADV_HUGEPAGE
+    if (huge_pages != File::huge_pages_None)
+        ::madvise(addr, size, MADV_HUGEPAGE);
+#else
+    static_cast<void>(huge_pages);
+#endif
     return addr;
 #endif
 }
 
+void advise_mapping(void* addr, size_t size, File::MappingAdvice advice) noexcept
+{
+#ifdef _WIN32
+    static_cast<void>(addr);
+    static_cast<void>(size);
+    static_cast<void>(advice);
+#else
+    int native_advice = MADV_NORMAL;
+    switch (advice) {
+        case File::advice_Normal:
+            break;
+        case File::advice_Random:
+            native_advice = MADV_RANDOM;
+            break;
+        case File::advice_Sequential:
+            native_advice = MADV_SEQUENTIAL;
+            break;
+        case File::advice_WillNeed:
+            native_advice = MADV_WILLNEED;
+            break;
+    }
+    uintptr_t begin = reinterpret_cast<uintptr_t>(addr) & ~uintptr_t(page_size() - 1);
+    uintptr_t end = reinterpret_cast<uintptr_t>(addr) + size;
+    ::madvise(reinterpret_cast<void*>(begin), size_t(end - begin), native_advice);
+#endif
+}
+
+namespace {
+
+MappingStats get_fault_counts()
+{
+    MappingStats stats;
+#ifndef _WIN32
+    struct rusage usage;
+#if defined(__linux__)
+    int who = RUSAGE_THREAD;
+#else
+    int who = RUSAGE_SELF;
+#endif
+    if (getrusage(who, &usage) == 0) {
+        stats.major_faults = uint64_t(usage.ru_majflt);
+        stats.minor_faults = uint64_t(usage.ru_minflt);
+    }
+#endif
+    return stats;
+}
+
+} // anonymous namespace
+
+MappingCounters::MappingCounters()
+    : m_start(get_fault_counts())
+{
+#if defined(__linux__) && !REALM_ANDROID
+    struct perf_event_attr attr;
+    std::memset(&attr, 0, sizeof attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.size = sizeof attr;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // Count for the calling thread on any CPU
+    m_tlb_fd = int(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+}
+
+MappingCounters::~MappingCounters() noexcept
+{
+#ifndef _WIN32
+    if (m_tlb_fd != -1)
+        ::close(m_tlb_fd);
+#endif
+}
+
+MappingStats MappingCounters::get() const
+{
+    MappingStats stats = get_fault_counts();
+    stats.major_faults -= m_start.major_faults;
+    stats.minor_faults -= m_start.minor_faults;
+#ifndef _WIN32
+    uint64_t count;
+    if (m_tlb_fd != -1 && ::read(m_tlb_fd, &count, sizeof count) == ssize_t(sizeof count))
+        stats.tlb_misses = int64_t(count);
+#endif
+    return stats;
+}
+
 void* mmap_fixed(FileDesc fd, void* address_request, size_t size, File::AccessMode access, size_t offset,
                  const char* enc_key)
 {
@@ -777,19 +887,21 @@ void* mmap_reserve(FileDesc fd, size_t reservation_size, size_t offset_in_file)
 }
 
 
-void* mmap(FileDesc fd, size_t size, File::AccessMode access, size_t offset, const char* encryption_key)
+void* mmap(FileDesc fd, size_t size, File::AccessMode access, size_t offset, const char* encryption_key,
+           File::EncryptionFormat format)
 {
     _impl::SimulatedFailure::trigger_mmap(size);
 #if REALM_ENABLE_ENCRYPTION
     if (encryption_key) {
         size = round_up_to_page_size(size);
         void* addr = mmap_anon(size);
-        add_mapping(addr, size, fd, offset, access, encryption_key);
+        add_mapping(addr, size, fd, offset, access, encryption_key, format);
         return addr;
     }
     else
 #else
     REALM_ASSERT(!encryption_key);
+    static_cast<void>(format);
 #endif
     {
 
@@ -952,7 +1064,7 @@ void msync(FileDesc fd, void* addr, size_t size)
         // first check the encrypted mappings
         LockGuard lock(mapping_mutex);
         if (mapping_and_addr* m = find_mapping_for_addr(addr, round_up_to_page_size(size))) {
-            m->mapping->flush();
+            m->mapping->flush(); // Throws
             m->mapping->sync();
             return;
         }
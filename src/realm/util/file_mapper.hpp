@@ -28,7 +28,8 @@
 namespace realm {
 namespace util {
 
-void* mmap(FileDesc fd, size_t size, File::AccessMode access, size_t offset, const char* encryption_key);
+void* mmap(FileDesc fd, size_t size, File::AccessMode access, size_t offset, const char* encryption_key,
+           File::EncryptionFormat format = File::encryption_CbcHmac);
 void* mmap_fixed(FileDesc fd, void* address_request, size_t size, File::AccessMode access, size_t offset,
                  const char* enc_key);
 void* mmap_reserve(FileDesc fd, size_t size, size_t offset);
@@ -36,7 +37,36 @@ void munmap(void* addr, size_t size);
 void* mremap(FileDesc fd, size_t file_offset, void* old_addr, size_t old_size, File::AccessMode a, size_t new_size,
              const char* encryption_key);
 void msync(FileDesc fd, void* addr, size_t size);
-void* mmap_anon(size_t size);
+void* mmap_anon(size_t size, File::HugePages huge_pages = File::huge_pages_None);
+
+// Give the kernel a hint about how the mapped range [addr, addr + size) will be
+// accessed. The range is widened to page boundaries. This is only a hint, so
+// failures are ignored.
+void advise_mapping(void* addr, size_t size, File::MappingAdvice advice) noexcept;
+
+// Page faults and data TLB misses of the calling thread since a MappingCounters
+// was created. Major faults are the ones which had to read from the file. TLB
+// misses are read from a hardware performance counter, and are -1 where no such
+// counter is available (anything but Linux, or if perf events are not allowed).
+struct MappingStats {
+    uint64_t major_faults = 0;
+    uint64_t minor_faults = 0;
+    int64_t tlb_misses = -1;
+};
+
+class MappingCounters {
+public:
+    MappingCounters();
+    ~MappingCounters() noexcept;
+    MappingCounters(const MappingCounters&) = delete;
+    MappingCounters& operator=(const MappingCounters&) = delete;
+
+    MappingStats get() const;
+
+private:
+    MappingStats m_start;
+    int m_tlb_fd = -1;
+};
 
 // A function which may be given to encryption_read_barrier. If present, the read barrier is a
 // a barrier for a full array. If absent, the read barrier is a barrier only for the address
@@ -85,15 +115,16 @@ SharedFileInfo* get_file_info_for_file(File& file);
 // This variant allows the caller to obtain direct access to the encrypted file mapping
 // for optimization purposes.
 void* mmap(FileDesc fd, size_t size, File::AccessMode access, size_t offset, const char* encryption_key,
-           EncryptedFileMapping*& mapping);
+           EncryptedFileMapping*& mapping, File::EncryptionFormat format = File::encryption_CbcHmac);
 void* mmap_fixed(FileDesc fd, void* address_request, size_t size, File::AccessMode access, size_t offset,
                  const char* enc_key, EncryptedFileMapping* mapping);
 
 void* mmap_reserve(FileDesc fd, size_t size, File::AccessMode am, size_t offset, const char* enc_key,
-                   EncryptedFileMapping*& mapping);
+                   EncryptedFileMapping*& mapping, File::EncryptionFormat format = File::encryption_CbcHmac);
 
 EncryptedFileMapping* reserve_mapping(void* addr, FileDesc fd, size_t offset, File::AccessMode access,
-                                      const char* encryption_key);
+                                      const char* encryption_key,
+                                      File::EncryptionFormat format = File::encryption_CbcHmac);
 
 void extend_encrypted_mapping(EncryptedFileMapping* mapping, void* addr, size_t offset, size_t old_size,
                               size_t new_size);
@@ -122,7 +153,7 @@ extern util::Mutex& mapping_mutex;
 void inline encryption_flush(EncryptedFileMapping* mapping)
 {
     UniqueLock lock(mapping_mutex);
-    mapping->flush();
+    mapping->flush(); // Throws
 }
 
 inline void do_encryption_read_barrier(const void* addr, size_t size, HeaderToSize header_to_size,
@@ -0,0 +1,176 @@
+/*************************************************************************
+ *
+ * Copyright 2022 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/util/thread_pool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+using namespace realm::util;
+
+struct ThreadPool::Batch {
+    Batch(FunctionRef<void(size_t)> t, size_t n)
+        : task(t)
+        , num_tasks(n)
+    {
+    }
+
+    FunctionRef<void(size_t)> task;
+    const size_t num_tasks;
+    std::atomic<size_t> next_task{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    // Number of workers currently executing tasks from this batch. Protected
+    // by the mutex of the pool.
+    size_t active_helpers = 0;
+    std::condition_variable helpers_done;
+
+    bool exhausted() const noexcept
+    {
+        return next_task.load(std::memory_order_relaxed) >= num_tasks;
+    }
+};
+
+ThreadPool::ThreadPool(size_t num_threads)
+{
+    m_threads.reserve(num_threads);
+    try {
+        for (size_t i = 0; i < num_threads; ++i)
+            m_threads.emplace_back([this] {
+                worker_loop();
+            });
+    }
+    catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_work_available.notify_all();
+        for (auto& thread : m_threads)
+            thread.join();
+        throw;
+    }
+}
+
+ThreadPool::~ThreadPool() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_work_available.notify_all();
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+ThreadPool& ThreadPool::get_default()
+{
+    static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+    return pool;
+}
+
+bool ThreadPool::execute_next(Batch& batch)
+{
+    size_t ndx = batch.next_task.fetch_add(1, std::memory_order_relaxed);
+    if (ndx >= batch.num_tasks)
+        return false;
+    // Once a task has failed the result of the batch is the exception, so
+    // don't waste time on the remaining tasks.
+    if (batch.failed.load(std::memory_order_relaxed))
+        return true;
+    try {
+        batch.task(ndx);
+    }
+    catch (...) {
+        std::lock_guard<std::mutex> lock(batch.error_mutex);
+        if (!batch.error)
+            batch.error = std::current_exception();
+        batch.failed = true;
+    }
+    return true;
+}
+
+void ThreadPool::run(size_t num_tasks, FunctionRef<void(size_t)> task)
+{
+    if (num_tasks <= 1 || m_threads.empty()) {
+        for (size_t i = 0; i < num_tasks; ++i)
+            task(i);
+        return;
+    }
+
+    Batch batch(task, num_tasks);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(&batch);
+    }
+    size_t num_helpers = std::min(num_tasks - 1, m_threads.size());
+    for (size_t i = 0; i < num_helpers; ++i)
+        m_work_available.notify_one();
+
+    while (execute_next(batch))
+        ;
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto it = std::find(m_queue.begin(), m_queue.end(), &batch);
+        if (it != m_queue.end())
+            m_queue.erase(it);
+        batch.helpers_done.wait(lock, [&] {
+            return batch.active_helpers == 0;
+        });
+    }
+
+    if (batch.error)
+        std::rethrow_exception(batch.error);
+}
+
+void ThreadPool::worker_loop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_work_available.wait(lock, [&] {
+            return m_stop || !m_queue.empty();
+        });
+        if (m_stop)
+            return;
+
+        Batch* batch = m_queue.front();
+        if (batch->exhausted()) {
+            // All tasks have been claimed, so there is nothing left to help with
+            m_queue.pop_front();
+            continue;
+        }
+        ++batch->active_helpers;
+        lock.unlock();
+
+        while (execute_next(*batch))
+            ;
+
+        lock.lock();
+        auto it = std::find(m_queue.begin(), m_queue.end(), batch);
+        if (it != m_queue.end())
+            m_queue.erase(it);
+        // The submitting thread may return (and destroy the batch) as soon as
+        // the lock is released after this.
+        if (--batch->active_helpers == 0)
+            batch->helpers_done.notify_all();
+    }
+}
@@ -0,0 +1,123 @@
+/*************************************************************************
+ *
+ * Copyright 2022 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_UTIL_THREAD_POOL_HPP
+#define REALM_UTIL_THREAD_POOL_HPP
+
+#include <realm/util/function_ref.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace realm::util {
+
+/// A fixed set of worker threads which cooperatively execute batches of
+/// independent tasks.
+///
+/// A batch is submitted with run(), which blocks until every task of the
+/// batch has completed. The calling thread takes part in the execution, and
+/// idle workers join a batch by claiming the next unstarted task, so a batch
+/// always makes progress even if all workers are busy elsewhere (including
+/// when run() is called from inside a task).
+///
+/// Tasks must not block waiting for each other.
+class ThreadPool {
+public:
+    /// Create a pool with `num_threads` worker threads. A pool with zero
+    /// threads is valid and runs every batch on the calling thread.
+    explicit ThreadPool(size_t num_threads);
+    ~ThreadPool() noexcept;
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t get_num_threads() const noexcept
+    {
+        return m_threads.size();
+    }
+
+    /// Execute `task(0)`, ..., `task(num_tasks - 1)`, using the calling thread
+    /// and at most `num_tasks - 1` workers of this pool. Returns when all tasks
+    /// have completed. If one or more tasks throw, the first exception is
+    /// rethrown from here after all started tasks have completed; tasks that
+    /// have not yet started are skipped.
+    void run(size_t num_tasks, FunctionRef<void(size_t)> task);
+
+    /// The process-wide pool, with one worker per hardware thread except the
+    /// one the caller is running on. The pool is created on first use.
+    static ThreadPool& get_default();
+
+private:
+    struct Batch;
+
+    std::mutex m_mutex;
+    std::condition_variable m_work_available;
+    std::deque<Batch*> m_queue;
+    std::vector<std::thread> m_threads;
+    bool m_stop = false;
+
+    void worker_loop();
+    static bool execute_next(Batch&);
+};
+
+/// Sort the range [first, last) using the threads of `pool`.
+///
+/// The range is split into `num_chunks` parts (by default one for each thread
+/// of the pool and one for the caller) which are sorted concurrently, and the
+/// sorted parts are then merged pairwise, with the merges of each round running
+/// concurrently. `comp` must be safe to call from several threads at once. As
+/// with std::sort, the order of equivalent elements is not preserved.
+template <class RandomIt, class Compare>
+void parallel_sort(ThreadPool& pool, RandomIt first, RandomIt last, Compare comp, size_t num_chunks = 0)
+{
+    size_t size = size_t(last - first);
+    if (num_chunks == 0)
+        num_chunks = pool.get_num_threads() + 1;
+    num_chunks = std::min(num_chunks, size / 2);
+    if (num_chunks < 2) {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    std::vector<size_t> bounds(num_chunks + 1);
+    for (size_t i = 0; i <= num_chunks; ++i)
+        bounds[i] = size * i / num_chunks;
+
+    pool.run(num_chunks, [&](size_t i) {
+        std::sort(first + bounds[i], first + bounds[i + 1], comp);
+    });
+
+    for (size_t width = 1; width < num_chunks; width *= 2) {
+        size_t num_merges = (num_chunks + 2 * width - 1) / (2 * width);
+        pool.run(num_merges, [&](size_t i) {
+            size_t begin = bounds[2 * i * width];
+            size_t middle = bounds[std::min((2 * i + 1) * width, num_chunks)];
+            size_t end = bounds[std::min((2 * i + 2) * width, num_chunks)];
+            std::inplace_merge(first + begin, first + middle, first + end, comp);
+        });
+    }
+}
+
+} // namespace realm::util
+
+#endif // REALM_UTIL_THREAD_POOL_HPP
@@ -62,6 +62,28 @@ inline unsigned long long _xgetbv(unsigned index)
 
 #endif
 #endif
+
+// Returns EBX of CPUID leaf 7, sub-leaf 0 (the extended feature flags), or 0 if that leaf is not supported
+unsigned int cpuid_extended_features()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return 0;
+    __cpuidex(info, 7, 0);
+    return static_cast<unsigned int>(info[1]);
+#else
+    unsigned int eax = 0, ebx, ecx = 0, edx;
+    __asm__("cpuid" : "+a"(eax), "=b"(ebx), "+c"(ecx), "=d"(edx));
+    if (eax < 7)
+        return 0;
+    eax = 7;
+    ecx = 0;
+    __asm__("cpuid" : "+a"(eax), "=b"(ebx), "+c"(ecx), "=d"(edx));
+    return ebx;
+#endif
+}
 #endif
 
 } // anonymous namespace
@@ -119,15 +141,15 @@ void cpuid_init()
     }
 #endif
 
-    if (avxSupported) {
+    if (avxSupported && (cpuid_extended_features() & (1 << 5))) {
+        avx_support = 1; // AVX2 supported
+    }
+    else if (avxSupported) {
         avx_support = 0; // AVX1 supported
     }
     else {
         avx_support = -1; // No AVX supported
     }
-
-    // 1 is reserved for AVX2
-
 #endif
 }
 } // namespace realm
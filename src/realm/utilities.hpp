@@ -73,6 +73,14 @@ typedef SSIZE_T ssize_t;
 #define REALM_COMPILER_AVX
 #endif
 
+// Functions using AVX2 intrinsics must be marked with REALM_TARGET_AVX2 so that they can be compiled without
+// enabling AVX2 for the whole build. They may only be called after checking sseavx<2>().
+#if defined(REALM_COMPILER_AVX) && (defined(__GNUC__) || defined(__clang__))
+#define REALM_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define REALM_TARGET_AVX2
+#endif
+
 namespace realm {
 
 using StringCompareCallback = util::UniqueFunction<bool(const char* string1, const char* string2)>;
@@ -93,7 +101,7 @@ REALM_FORCEINLINE bool sseavx()
 
     avx_support = -1: No AVX support
     avx_support = 0: AVX1 supported
-    sse_support = 1: AVX2 supported (not yet implemented for detection in our cpuid_init(), todo)
+    avx_support = 1: AVX2 supported
 
     This lets us test very rapidly at runtime because we just need 1 compare instruction (with 0) to test both for
     SSE 3 and 4.2 by caller (compiler optimizes if calls are concecutive), and can decide branch with ja/jl/je because
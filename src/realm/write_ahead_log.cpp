@@ -0,0 +1,245 @@
+/*************************************************************************
+ *
+ * Copyright 2022 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/write_ahead_log.hpp>
+
+#include <realm/disable_sync_to_disk.hpp>
+
+#include <cstddef>
+#include <cstring>
+
+using namespace realm;
+using namespace realm::util;
+
+namespace {
+
+const char s_magic[8] = {'T', '-', 'D', 'B', '-', 'W', 'A', 'L'};
+
+// The blocks of a record are written to the log in pieces of at least this
+// size, unless the record is smaller
+const size_t s_buffer_size = 256 * 1024;
+
+// 64 bit FNV-1a. The checksum only has to detect records which were not
+// completely written before a crash.
+uint64_t checksum(const char* data, size_t size, uint64_t hash = 14695981039346656037ULL) noexcept
+{
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= uint8_t(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+size_t padded_size(size_t size) noexcept
+{
+    return (size + 7) & ~size_t(7);
+}
+
+} // anonymous namespace
+
+struct WriteAheadLog::Header {
+    char magic[8];
+    uint64_t epoch;
+    uint64_t end; // Position following the last record
+};
+
+// A record header is followed by the blocks of the record. Each block is a ref
+// and a size, followed by the contents of the block padded to a multiple of 8
+// bytes.
+struct WriteAheadLog::RecordHeader {
+    uint64_t epoch;
+    uint64_t version;
+    uint64_t top_ref;
+    uint64_t file_size;
+    uint64_t file_format_version;
+    uint64_t body_size;
+    uint64_t checksum; // Of the blocks, followed by the preceding fields
+};
+
+WriteAheadLog::WriteAheadLog(const std::string& path)
+{
+    m_file.open(path, File::access_ReadWrite, File::create_Auto, 0); // Throws
+    Header header;
+    if (m_file.get_size() >= File::SizeType(sizeof(Header))) {
+        read_header(header); // Throws
+    }
+    else {
+        std::memset(&header, 0, sizeof(Header));
+    }
+    if (std::memcmp(header.magic, s_magic, sizeof(s_magic)) != 0) {
+        std::memcpy(header.magic, s_magic, sizeof(s_magic));
+        header.epoch = 0;
+        header.end = sizeof(Header);
+        write_header(header);          // Throws
+        m_file.resize(sizeof(Header)); // Throws
+    }
+    m_size = size_t(header.end);
+}
+
+void WriteAheadLog::read_header(Header& header)
+{
+    m_file.seek(0);                                                           // Throws
+    size_t n = m_file.read(reinterpret_cast<char*>(&header), sizeof(Header)); // Throws
+    REALM_ASSERT_RELEASE(n == sizeof(Header));
+}
+
+void WriteAheadLog::write_header(const Header& header)
+{
+    m_file.seek(0);                                                       // Throws
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(Header)); // Throws
+}
+
+void WriteAheadLog::begin_record()
+{
+    // Another process may have appended to, or emptied, the log since we last
+    // looked at it. A record which was not completed, because the process
+    // appending it crashed, is overwritten.
+    Header header;
+    read_header(header); // Throws
+    m_epoch = header.epoch;
+    m_record_begin = size_t(header.end);
+    m_record_end = m_record_begin + sizeof(RecordHeader);
+    m_body_checksum = checksum(nullptr, 0);
+    m_buffer.clear();
+}
+
+void WriteAheadLog::add_block(ref_type ref, const char* data, size_t size)
+{
+    REALM_ASSERT(m_record_end >= m_record_begin + sizeof(RecordHeader));
+    static const char padding[7] = {};
+    uint64_t block_header[2] = {uint64_t(ref), uint64_t(size)};
+    write_body(reinterpret_cast<const char*>(block_header), sizeof(block_header)); // Throws
+    write_body(data, size);                                                        // Throws
+    write_body(padding, padded_size(size) - size);                                 // Throws
+}
+
+void WriteAheadLog::write_body(const char* data, size_t size)
+{
+    m_body_checksum = checksum(data, size, m_body_checksum);
+    if (m_buffer.size() + size > s_buffer_size) {
+        flush_buffer(); // Throws
+        if (size > s_buffer_size) {
+            m_file.seek(File::SizeType(m_record_end)); // Throws
+            m_file.write(data, size);                  // Throws
+            m_record_end += size;
+            return;
+        }
+    }
+    m_buffer.insert(m_buffer.end(), data, data + size); // Throws
+}
+
+void WriteAheadLog::flush_buffer()
+{
+    if (m_buffer.empty())
+        return;
+    m_file.seek(File::SizeType(m_record_end));      // Throws
+    m_file.write(m_buffer.data(), m_buffer.size()); // Throws
+    m_record_end += m_buffer.size();
+    m_buffer.clear();
+}
+
+void WriteAheadLog::append(uint64_t version, ref_type top_ref, size_t file_size, int file_format_version,
+                           bool sync)
+{
+    REALM_ASSERT(m_record_end >= m_record_begin + sizeof(RecordHeader));
+    flush_buffer(); // Throws
+
+    RecordHeader record_header;
+    record_header.epoch = m_epoch;
+    record_header.version = version;
+    record_header.top_ref = uint64_t(top_ref);
+    record_header.file_size = uint64_t(file_size);
+    record_header.file_format_version = uint64_t(file_format_version);
+    record_header.body_size = m_record_end - m_record_begin - sizeof(RecordHeader);
+    record_header.checksum =
+        checksum(reinterpret_cast<const char*>(&record_header), offsetof(RecordHeader, checksum), m_body_checksum);
+
+    m_file.seek(File::SizeType(m_record_begin));                                        // Throws
+    m_file.write(reinterpret_cast<const char*>(&record_header), sizeof(RecordHeader)); // Throws
+    Header header;
+    std::memcpy(header.magic, s_magic, sizeof(s_magic));
+    header.epoch = m_epoch;
+    header.end = m_record_end;
+    write_header(header); // Throws
+    if (sync && !get_disable_sync_to_disk())
+        m_file.barrier(); // Throws
+
+    m_size = m_record_end;
+    m_record_begin = m_record_end = 0;
+}
+
+void WriteAheadLog::clear()
+{
+    Header header;
+    read_header(header); // Throws
+    ++header.epoch;
+    header.end = sizeof(Header);
+    write_header(header);          // Throws
+    m_file.resize(sizeof(Header)); // Throws
+    // Like append(), so that a checkpoint is durable once it is done, rather
+    // than once the next record is synced
+    if (!get_disable_sync_to_disk())
+        m_file.barrier(); // Throws
+    m_size = sizeof(Header);
+}
+
+WriteAheadLog::Snapshot WriteAheadLog::replay(const std::string& log_path, File& realm_file)
+{
+    Snapshot snapshot{0, 0};
+    if (!File::exists(log_path))
+        return snapshot;
+    File file;
+    file.open(log_path, File::access_ReadOnly, File::create_Never, 0); // Throws
+    size_t log_size = size_t(file.get_size());
+    Header header;
+    if (log_size < sizeof(Header) || file.read(reinterpret_cast<char*>(&header), sizeof(Header)) != sizeof(Header) ||
+        std::memcmp(header.magic, s_magic, sizeof(s_magic)) != 0)
+        return snapshot;
+
+    size_t end = std::min(size_t(header.end), log_size);
+    size_t pos = sizeof(Header);
+    std::vector<char> body;
+    while (pos + sizeof(RecordHeader) <= end) {
+        RecordHeader record_header;
+        file.seek(File::SizeType(pos));                                           // Throws
+        file.read(reinterpret_cast<char*>(&record_header), sizeof(RecordHeader)); // Throws
+        if (record_header.epoch != header.epoch || record_header.body_size > end - pos - sizeof(RecordHeader))
+            break;
+        body.resize(size_t(record_header.body_size)); // Throws
+        file.read(body.data(), body.size());          // Throws
+        uint64_t hash = checksum(body.data(), body.size());
+        if (checksum(reinterpret_cast<const char*>(&record_header), offsetof(RecordHeader, checksum), hash) !=
+            record_header.checksum)
+            break;
+
+        if (realm_file.get_size() < File::SizeType(record_header.file_size))
+            realm_file.prealloc(size_t(record_header.file_size)); // Throws
+        for (size_t i = 0; i < body.size();) {
+            uint64_t block_header[2];
+            std::memcpy(block_header, &body[i], sizeof(block_header));
+            size_t size = size_t(block_header[1]);
+            REALM_ASSERT_RELEASE(i + sizeof(block_header) + size <= body.size());
+            realm_file.seek(File::SizeType(block_header[0]));        // Throws
+            realm_file.write(&body[i + sizeof(block_header)], size); // Throws
+            i += sizeof(block_header) + padded_size(size);
+        }
+        snapshot = {ref_type(record_header.top_ref), int(record_header.file_format_version)};
+        pos += sizeof(RecordHeader) + body.size();
+    }
+    return snapshot;
+}
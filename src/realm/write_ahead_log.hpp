@@ -0,0 +1,112 @@
+/*************************************************************************
+ *
+ * Copyright 2022 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_WRITE_AHEAD_LOG_HPP
+#define REALM_WRITE_AHEAD_LOG_HPP
+
+#include <realm/alloc.hpp>
+#include <realm/util/file.hpp>
+
+#include <string>
+#include <vector>
+
+namespace realm {
+
+/// The log of the commits made to a Realm file opened with Durability::WAL.
+///
+/// A commit writes its arrays to free space in the Realm file as usual, but
+/// instead of syncing the Realm file, selecting the new top ref in the file
+/// header and syncing again, it appends a record holding every block written by
+/// the commit to the log and syncs the log once. The blocks are written to the
+/// log as they are added, through a buffer of bounded size, so a commit is not
+/// held in memory a second time. The Realm file is brought up
+/// to date by a checkpoint, which commits the latest snapshot in the usual way
+/// and then empties the log.
+///
+/// Replaying the records of the log in order restores every block written
+/// since the last checkpoint, so the result is the snapshot of the last
+/// complete record, whichever snapshot the file header selects. Blocks which
+/// are still in use by that snapshot, but were written before the checkpoint,
+/// are never overwritten, as they are not free.
+///
+/// The log starts with a header holding its epoch and the end of the last
+/// record. Every record is stamped with the epoch, which is incremented when
+/// the log is emptied, so that records left over from before a checkpoint are
+/// never mistaken for new ones.
+class WriteAheadLog {
+public:
+    /// Open the log at \a path, creating it if it does not exist.
+    explicit WriteAheadLog(const std::string& path);
+
+    /// Start a new record at the end of the log, discarding any blocks added
+    /// since the last call to append(). The write mutex of the Realm file must
+    /// be held until the record is appended, as the blocks are written to the
+    /// log before the record is complete.
+    void begin_record();
+
+    /// Add a block written to the Realm file to the current record.
+    void add_block(ref_type ref, const char* data, size_t size);
+
+    /// Complete the current record, and sync the log unless \a sync is
+    /// false. \a top_ref and \a file_size describe the snapshot produced by
+    /// the commit.
+    void append(uint64_t version, ref_type top_ref, size_t file_size, int file_format_version, bool sync);
+
+    /// The size of the log after the last call to append() or clear().
+    size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+    /// Empty the log, and sync it. Must only be called when the Realm file
+    /// selects a snapshot at least as new as the one of the last record.
+    void clear();
+
+    struct Snapshot {
+        ref_type top_ref;
+        int file_format_version;
+    };
+
+    /// Write the blocks of every complete record of the log at \a log_path to
+    /// \a realm_file, which must not be encrypted. The file is grown as needed,
+    /// but not synced. Returns the snapshot of the last record, or a null top
+    /// ref if the log is missing or has no complete records.
+    static Snapshot replay(const std::string& log_path, util::File& realm_file);
+
+private:
+    struct Header;
+    struct RecordHeader;
+
+    util::File m_file;
+    // Blocks of the current record which are not written to the log yet
+    std::vector<char> m_buffer;
+    uint64_t m_epoch = 0;
+    size_t m_record_begin = 0;
+    size_t m_record_end = 0; // Position following the blocks written so far
+    uint64_t m_body_checksum = 0;
+    size_t m_size = 0;
+
+    void read_header(Header&);
+    void write_header(const Header&);
+    void write_body(const char* data, size_t size);
+    void flush_buffer();
+};
+
+} // namespace realm
+
+#endif // REALM_WRITE_AHEAD_LOG_HPP
@@ -0,0 +1,104 @@
+/*************************************************************************
+ *
+ * Copyright 2022 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+
+#include <realm/zone_map.hpp>
+#include <realm/cluster.hpp>
+#include <realm/table.hpp>
+
+using namespace realm;
+
+bool ZoneMap::is_read_only(ref_type ref, const Table& table) noexcept
+{
+    return table.get_alloc().is_read_only(ref);
+}
+
+util::Optional<LeafSummary> ZoneMap::find(ref_type ref, const Table& table)
+{
+    if (m_prune_pending.load(std::memory_order_acquire)) {
+        std::unique_lock lock(m_mutex);
+        if (m_prune_pending.load(std::memory_order_relaxed)) {
+            prune(table);
+            m_prune_pending.store(false, std::memory_order_release);
+        }
+    }
+
+    std::shared_lock lock(m_mutex);
+    auto it = m_summaries.find(ref);
+    if (it == m_summaries.end())
+        return util::none;
+    return it->second;
+}
+
+void ZoneMap::insert(ref_type ref, const LeafSummary& summary)
+{
+    std::unique_lock lock(m_mutex);
+    m_summaries.emplace(ref, summary);
+}
+
+// Keeps the summaries of the leaves which are still part of the table, and
+// still in the read-only part of the file. The summaries of leaves that were
+// replaced (and of any other leaf whose space may have been reused) are
+// dropped.
+void ZoneMap::prune(const Table& table)
+{
+    if (m_summaries.empty())
+        return;
+    std::unordered_map<ref_type, LeafSummary> kept;
+    const Allocator& alloc = table.get_alloc();
+    table.traverse_clusters([&](const Cluster* cluster) {
+        size_t n = cluster->size();
+        for (size_t i = 0; i < n; ++i) {
+            RefOrTagged rot = cluster->get_as_ref_or_tagged(i);
+            if (!rot.is_ref())
+                continue;
+            ref_type ref = rot.get_as_ref();
+            if (!ref || !alloc.is_read_only(ref))
+                continue;
+            auto it = m_summaries.find(ref);
+            if (it != m_summaries.end())
+                kept.insert(*it);
+        }
+        return IteratorControl::AdvanceToNext;
+    });
+    m_summaries = std::move(kept);
+}
+
+void ZoneMap::table_changed() noexcept
+{
+    std::unique_lock lock(m_mutex);
+    // A pending prune must see every version the table moves through (see
+    // class comment), so a second change before it has run drops everything.
+    if (m_prune_pending.load(std::memory_order_relaxed))
+        m_summaries.clear();
+    else
+        m_prune_pending.store(true, std::memory_order_release);
+}
+
+void ZoneMap::clear() noexcept
+{
+    std::unique_lock lock(m_mutex);
+    m_summaries.clear();
+    m_prune_pending.store(false, std::memory_order_release);
+}
+
+size_t ZoneMap::size() const
+{
+    std::shared_lock lock(m_mutex);
+    return m_summaries.size();
+}
@@ -0,0 +1,213 @@
+/*************************************************************************
+ *
+ * Copyright 2022 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+
+#ifndef REALM_ZONE_MAP_HPP
+#define REALM_ZONE_MAP_HPP
+
+#include <realm/alloc.hpp>
+#include <realm/mixed.hpp>
+#include <realm/query_conditions.hpp>
+#include <realm/util/optional.hpp>
+
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
+#include <unordered_map>
+
+namespace realm {
+
+class Table;
+
+/// The range of the values in one column leaf of a cluster.
+struct LeafSummary {
+    /// The smallest and largest values which are neither null nor NaN. Both
+    /// are null if the leaf has no such values.
+    Mixed min;
+    Mixed max;
+    size_t null_count = 0;
+    bool has_nan = false;
+
+    /// True for the conditions which a summary can rule out a leaf for.
+    template <class Cond>
+    static constexpr bool can_exclude = std::is_same_v<Cond, Equal> || std::is_same_v<Cond, Greater> ||
+                                        std::is_same_v<Cond, GreaterEqual> || std::is_same_v<Cond, Less> ||
+                                        std::is_same_v<Cond, LessEqual>;
+
+    /// Returns false if it is certain that no value in the leaf satisfies
+    /// `Cond` against `value`.
+    template <class Cond>
+    bool may_match(Mixed value) const noexcept;
+};
+
+/// Summaries of the column leaves of one table (a zone map), which the query
+/// engine uses to skip leaves that cannot contain a match.
+///
+/// A summary is computed the first time a query visits a leaf, and is cached
+/// by the ref of the leaf. Only leaves in the read-only part of the file are
+/// summarized, as a leaf in that part is never modified in place: a change to
+/// it is written to a new ref.
+///
+/// When the table moves to a version where its content may be different, it
+/// calls table_changed(). The summaries of the leaves which are no longer part
+/// of the table are then dropped before the next lookup, while the summaries of
+/// untouched leaves are kept. This must happen for every such version, as the
+/// space of a dropped leaf may be reused by a later version, so if the table
+/// changes again before any lookup was made, all summaries are dropped.
+///
+/// Lookups are thread safe, so a table can be queried by several threads.
+class ZoneMap {
+public:
+    /// Returns the summary of `leaf`, or none if the leaf is being modified by
+    /// the current write transaction.
+    template <class LeafType>
+    util::Optional<LeafSummary> get(const LeafType& leaf, const Table& table);
+
+    void table_changed() noexcept;
+    void clear() noexcept;
+
+    /// The number of cached summaries, for testing.
+    size_t size() const;
+
+private:
+    mutable std::shared_mutex m_mutex;
+    std::unordered_map<ref_type, LeafSummary> m_summaries;
+    std::atomic<bool> m_prune_pending = false;
+
+    util::Optional<LeafSummary> find(ref_type ref, const Table&);
+    void insert(ref_type ref, const LeafSummary& summary);
+    void prune(const Table&);
+    static bool is_read_only(ref_type ref, const Table&) noexcept;
+
+    // The non-null value type of a leaf whose get() returns `T`
+    template <class T>
+    struct Unwrap {
+        using type = T;
+        static const T& get(const T& value) noexcept
+        {
+            return value;
+        }
+    };
+    template <class T>
+    struct Unwrap<util::Optional<T>> {
+        using type = T;
+        static const T& get(const util::Optional<T>& value) noexcept
+        {
+            return *value;
+        }
+    };
+
+    template <class T>
+    static bool is_null(const T& value) noexcept;
+    template <class T>
+    static bool is_nan(const T& value) noexcept;
+};
+
+
+// Implementation:
+
+template <class Cond>
+bool LeafSummary::may_match(Mixed value) const noexcept
+{
+    if (!can_exclude<Cond> || has_nan || value.is_null())
+        return true;
+    if ((value.get_type() == type_Float && std::isnan(value.get_float())) ||
+        (value.get_type() == type_Double && std::isnan(value.get_double())))
+        return true;
+    // None of the conditions below match null
+    if (min.is_null())
+        return false;
+
+    if constexpr (std::is_same_v<Cond, Equal>)
+        return min.compare(value) <= 0 && max.compare(value) >= 0;
+    else if constexpr (std::is_same_v<Cond, Greater>)
+        return max.compare(value) > 0;
+    else if constexpr (std::is_same_v<Cond, GreaterEqual>)
+        return max.compare(value) >= 0;
+    else if constexpr (std::is_same_v<Cond, Less>)
+        return min.compare(value) < 0;
+    else
+        return min.compare(value) <= 0;
+}
+
+template <class T>
+inline bool ZoneMap::is_null(const T& value) noexcept
+{
+    if constexpr (std::is_same_v<T, Timestamp>)
+        return value.is_null();
+    else if constexpr (std::is_arithmetic_v<T>)
+        return false;
+    else
+        return !value;
+}
+
+template <class T>
+inline bool ZoneMap::is_nan(const T& value) noexcept
+{
+    if constexpr (std::is_floating_point_v<T>)
+        return std::isnan(value);
+    else
+        return false;
+}
+
+template <class LeafType>
+util::Optional<LeafSummary> ZoneMap::get(const LeafType& leaf, const Table& table)
+{
+    ref_type ref = leaf.get_ref();
+    if (!is_read_only(ref, table))
+        return util::none;
+    if (auto summary = find(ref, table))
+        return summary;
+
+    // Computed without holding the lock, from the typed values of the leaf.
+    // Two threads may end up computing the same summary, which is harmless.
+    using Value = std::decay_t<decltype(leaf.get(0))>;
+    using T = typename Unwrap<Value>::type;
+    LeafSummary summary;
+    util::Optional<T> min, max;
+    size_t size = leaf.size();
+    for (size_t i = 0; i < size; ++i) {
+        Value value = leaf.get(i);
+        if (is_null(value)) {
+            ++summary.null_count;
+            continue;
+        }
+        const T& v = Unwrap<Value>::get(value);
+        if (is_nan(v)) {
+            summary.has_nan = true;
+        }
+        else {
+            if (!min || v < *min)
+                min = v;
+            if (!max || *max < v)
+                max = v;
+        }
+    }
+    if (min) {
+        summary.min = Mixed(*min);
+        summary.max = Mixed(*max);
+    }
+    insert(ref, summary);
+    return summary;
+}
+
+} // namespace realm
+
+#endif // REALM_ZONE_MAP_HPP
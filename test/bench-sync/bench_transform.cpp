@@ -10,7 +10,6 @@
 #endif // REALM_ENABLE_ENCRYPTION
 
 #include <realm/sync/history.hpp>
-#include <realm/sync/object.hpp>
 
 #include "../peer.hpp"
 
@@ -48,7 +47,7 @@ void transform_transactions(TestContext& test_context, BenchmarkResults& results
             ColKey col_ndx;
             {
                 peer.start_transaction();
-                TableRef t = sync::create_table(*peer.group, "class_t");
+                TableRef t = peer.group->add_table("class_t");
                 col_ndx = t->add_column(type_Int, "i");
                 peer.commit();
             }
@@ -91,7 +90,7 @@ void transform_transactions(TestContext& test_context, BenchmarkResults& results
     }
 
     // results.finish(ident_preface, ident_preface);
-    results.finish(ident, ident);
+    results.finish(ident, ident, "runtime_secs");
 }
 
 // Two peers have 1 transaction each with 1000 instructions (8.3% of
@@ -145,7 +144,7 @@ void transform_instructions(TestContext& test_context, BenchmarkResults& results
     }
 
     // results.finish(ident_preface, ident_preface);
-    results.finish(ident, ident);
+    results.finish(ident, ident, "runtime_secs");
 }
 
 template <size_t num_iterations>
@@ -164,7 +163,7 @@ void connected_objects(TestContext& test_context, BenchmarkResults& results)
 
         auto make_instructions = [](Peer& peer) {
             peer.start_transaction();
-            TableRef t = sync::create_table_with_primary_key(*peer.group, "class_t", type_String, "pk");
+            TableRef t = peer.group->add_table_with_primary_key("class_t", type_String, "pk");
             auto col_key = t->add_column(*t, "l");
 
             // Everything links to this object!
@@ -194,7 +193,78 @@ void connected_objects(TestContext& test_context, BenchmarkResults& results)
         results.submit(ident.c_str(), t.get_elapsed_time());
     }
 
-    results.finish(ident, ident);
+    results.finish(ident, ident, "runtime_secs");
+}
+
+// Two clients have been offline for a long time, and each made a number of
+// transactions editing the same few objects on different fields. One client
+// receives and merges all transactions from the other. Each instruction only
+// conflicts with the instructions on the same field of the same object, but
+// all of the objects are in a single conflict group because they link to each
+// other.
+template <size_t num_transactions>
+void offline_edits(TestContext& test_context, BenchmarkResults& results)
+{
+    std::string ident = test_context.test_details.test_name;
+    const size_t num_objects = 10;
+    const size_t num_fields = 10;
+
+    for (size_t i = 0; i < 3; ++i) {
+        auto changeset_dump_dir_gen = get_changeset_dump_dir_generator(test_context, s_bench_test_dump_dir);
+
+        auto server = Peer::create_server(test_context, changeset_dump_dir_gen.get());
+        auto origin = Peer::create_client(test_context, 2, changeset_dump_dir_gen.get());
+        auto client = Peer::create_client(test_context, 3, changeset_dump_dir_gen.get());
+
+        origin->start_transaction();
+        {
+            TableRef t = origin->group->add_table_with_primary_key("class_t", type_Int, "pk");
+            for (size_t j = 0; j < num_fields; ++j) {
+                t->add_column(type_Int, "i" + std::to_string(j));
+            }
+            auto col_link = t->add_column(*t, "l");
+            ObjKey prev;
+            for (size_t j = 0; j < num_objects; ++j) {
+                Obj obj = t->create_object_with_primary_key(int64_t(j));
+                if (prev)
+                    obj.set(col_link, prev);
+                prev = obj.get_key();
+            }
+        }
+        origin->commit();
+        server->integrate_next_changeset_from(*origin);
+        client->integrate_next_changesets_from(*server, client->count_outstanding_changesets_from(*server));
+
+        // Both sides edit every object, each on their own half of the fields.
+        auto make_transactions = [&](Peer& peer, size_t first_field) {
+            for (size_t j = 0; j < num_transactions; ++j) {
+                peer.start_transaction();
+                TableRef t = peer.table("class_t");
+                for (size_t k = 0; k < num_objects; ++k) {
+                    Obj obj = t->get_object_with_primary_key(int64_t(k));
+                    obj.set(t->get_column_key("i" + std::to_string(first_field + j % (num_fields / 2))),
+                            int64_t(j));
+                }
+                peer.commit();
+            }
+        };
+
+        make_transactions(*origin, 0);
+        make_transactions(*client, num_fields / 2);
+
+        size_t outstanding = server->count_outstanding_changesets_from(*origin);
+        for (size_t j = 0; j < outstanding; ++j) {
+            server->integrate_next_changeset_from(*origin);
+        }
+
+        outstanding = client->count_outstanding_changesets_from(*server);
+        REALM_ASSERT(outstanding != 0);
+        Timer t{Timer::type_RealTime};
+        client->integrate_next_changesets_from(*server, outstanding);
+        results.submit(ident.c_str(), t.get_elapsed_time());
+    }
+
+    results.finish(ident, ident, "runtime_secs");
 }
 
 } // namespace bench
@@ -446,9 +516,27 @@ TEST(BenchMergeManyConnectedObjects)
     bench::connected_objects<8000>(test_context, results);
 }
 
+TEST(BenchMergeOfflineEdits1000x1000)
+{
+    std::string results_file_stem = test_util::get_test_path_prefix() + "offline_edits_1000x1000";
+    BenchmarkResults results(max_lead_text_width, results_file_stem.c_str());
+
+    bench::offline_edits<1000>(test_context, results);
+}
+
+TEST(BenchMergeOfflineEdits4000x4000)
+{
+    std::string results_file_stem = test_util::get_test_path_prefix() + "offline_edits_4000x4000";
+    BenchmarkResults results(max_lead_text_width, results_file_stem.c_str());
+
+    bench::offline_edits<4000>(test_context, results);
+}
+
 #if !REALM_IOS
-int main(int argc, char** argv)
+int main(int argc, const char* argv[])
 {
-    return test_all(argc, argv, nullptr);
+    if (!realm::test_util::initialize_test_path(argc, argv))
+        return 1;
+    return test_all();
 }
 #endif // REALM_IOS
@@ -411,7 +411,8 @@ private:
             _impl::ServerProtocol::ChangesetInfo info{changesets[i].version, entry.remote_version, entry,
                                                       entry.changeset.size()};
 
-            m_protocol.insert_single_changeset_download_message(m_history_entries_buffer, info, *logger); // Throws
+            m_protocol.insert_single_changeset_download_message(sync::get_current_protocol_version(),
+                                                                m_history_entries_buffer, info, *logger); // Throws
 
             encode_buffer.clear();
         }
@@ -432,7 +433,8 @@ private:
             _impl::ServerProtocol::ChangesetInfo info{changesets[i]->version, entry.remote_version, entry,
                                                       entry.changeset.size()};
 
-            m_protocol.insert_single_changeset_download_message(m_history_entries_buffer, info, *logger); // Throws
+            m_protocol.insert_single_changeset_download_message(sync::get_current_protocol_version(),
+                                                                m_history_entries_buffer, info, *logger); // Throws
 
             encode_buffer.clear();
         }
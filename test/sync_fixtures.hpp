@@ -423,6 +423,8 @@ public:
 
         long server_max_open_files = 64;
 
+        int server_num_integration_workers = 1;
+
         bool enable_server_ssl = false;
 
         std::string server_ssl_certificate_path = get_test_resource_path() + "test_sync_ca.pem";
@@ -510,6 +512,7 @@ public:
                 public_key = PKey::load_public(config.server_public_key_path);
             Server::Config config_2;
             config_2.max_open_files = config.server_max_open_files;
+            config_2.num_integration_workers = config.server_num_integration_workers;
             config_2.logger = &*m_server_loggers[i];
             config_2.token_expiration_clock = &m_fake_token_expiration_clock;
             config_2.ssl = m_enable_server_ssl;
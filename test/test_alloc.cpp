@@ -132,6 +132,64 @@ TEST(Alloc_1)
 }
 
 
+TEST(Alloc_Recycling)
+{
+    SlabAlloc alloc;
+    alloc.attach_empty();
+
+    // Blocks are carved off the free space in order
+    MemRef mr1 = alloc.alloc(64);
+    MemRef mr2 = alloc.alloc(64);
+    set_capacity(mr1.get_addr(), 64);
+    set_capacity(mr2.get_addr(), 64);
+    CHECK_LESS(mr1.get_ref(), mr2.get_ref());
+
+    // A freed small block is reused for a block of the same size only
+    alloc.free_(mr1.get_ref(), mr1.get_addr());
+    MemRef mr3 = alloc.alloc(72);
+    set_capacity(mr3.get_addr(), 72);
+    CHECK_NOT_EQUAL(mr1.get_ref(), mr3.get_ref());
+    MemRef mr4 = alloc.alloc(64);
+    set_capacity(mr4.get_addr(), 64);
+    CHECK_EQUAL(mr1.get_ref(), mr4.get_ref());
+
+    // A freed large block at the end is merged back into the free space
+    MemRef mr5 = alloc.alloc(0x4000);
+    set_capacity(mr5.get_addr(), 0x4000);
+    alloc.free_(mr5.get_ref(), mr5.get_addr());
+    MemRef mr6 = alloc.alloc(0x6000);
+    set_capacity(mr6.get_addr(), 0x6000);
+    CHECK_EQUAL(mr5.get_ref(), mr6.get_ref());
+
+    // Recycled blocks of sizes which are not asked for again are merged back
+    // into free space before the slab area grows
+    size_t allocated = alloc.get_allocated_size();
+    for (size_t round = 1; round <= 40; ++round) {
+        size_t size = 8 * round + 64;
+        std::vector<MemRef> blocks;
+        for (int i = 0; i < 128; ++i) {
+            blocks.push_back(alloc.alloc(size));
+            set_capacity(blocks.back().get_addr(), size);
+        }
+        for (auto& mr : blocks)
+            alloc.free_(mr.get_ref(), mr.get_addr());
+    }
+    CHECK_EQUAL(alloc.get_allocated_size(), allocated);
+
+    alloc.free_(mr2.get_ref(), mr2.get_addr());
+    alloc.free_(mr3.get_ref(), mr3.get_addr());
+    alloc.free_(mr4.get_ref(), mr4.get_addr());
+    alloc.free_(mr6.get_ref(), mr6.get_addr());
+
+    // After a reset, allocation starts over from the beginning of the slab
+    alloc.reset_free_space_tracking();
+    CHECK(alloc.is_free_space_clean());
+    MemRef mr7 = alloc.alloc(128);
+    set_capacity(mr7.get_addr(), 128);
+    CHECK_EQUAL(mr1.get_ref(), mr7.get_ref());
+    alloc.free_(mr7.get_ref(), mr7.get_addr());
+}
+
 TEST(Alloc_AttachFile)
 {
     GROUP_TEST_PATH(path);
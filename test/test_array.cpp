@@ -1014,6 +1014,74 @@ TEST(Array_find_sse)
 }
 
 
+namespace {
+
+// Collects the indexes and values of all matches
+class QueryStateCollect : public QueryStateBase {
+public:
+    std::vector<std::pair<size_t, int64_t>> matches;
+
+    QueryStateCollect(size_t limit = -1)
+        : QueryStateBase(limit)
+    {
+    }
+
+    bool match(size_t index, Mixed value) noexcept final
+    {
+        matches.emplace_back(index, value.get_int());
+        ++m_match_count;
+        return m_limit > m_match_count;
+    }
+};
+
+} // unnamed namespace
+
+// Compares the (possibly vectorized) search for each condition and bit width against a naive search, over ranges
+// with unaligned start and end
+TEST(Array_FindConditions)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    const int64_t max_values[] = {1, 3, 15, 127, 32767, 2147483647, 9223372036854775807};
+    for (int64_t max : max_values) {
+        int64_t min = max < 127 ? 0 : -max - 1;
+        // Draw from a few values to get plenty of matches, including the extremes of the width
+        std::vector<int64_t> values = {min, max, 0, 1, max / 2, min / 2};
+        Array a(Allocator::get_default());
+        a.create(Array::type_Normal);
+        for (size_t i = 0; i < 1000; ++i)
+            a.add(values[random.draw_int_mod(values.size())]);
+        a.set(0, max); // Make sure the array has the full width
+
+        for (int64_t value : values) {
+            for (int cond : {cond_Equal, cond_NotEqual, cond_Greater, cond_Less}) {
+                size_t begin = random.draw_int<size_t>(0, 100);
+                size_t end = random.draw_int<size_t>(800, 1000);
+                std::vector<std::pair<size_t, int64_t>> expected;
+                for (size_t i = begin; i < end; ++i) {
+                    int64_t v = a.get(i);
+                    bool match = (cond == cond_Equal && v == value) || (cond == cond_NotEqual && v != value) ||
+                                 (cond == cond_Greater && v > value) || (cond == cond_Less && v < value);
+                    if (match)
+                        expected.emplace_back(i + 7, v);
+                }
+
+                QueryStateCollect state;
+                ArrayWithFind(a).find(cond, value, begin, end, 7, &state);
+                CHECK(state.matches == expected);
+
+                // Also stop at the first match
+                QueryStateCollect first(1);
+                ArrayWithFind(a).find(cond, value, begin, end, 7, &first);
+                CHECK_EQUAL(first.matches.size(), std::min<size_t>(expected.size(), 1));
+                if (!expected.empty() && !first.matches.empty())
+                    CHECK_EQUAL(first.matches[0].first, expected[0].first);
+            }
+        }
+        a.destroy();
+    }
+}
+
+
 TEST(Array_Greater)
 {
     Array a(Allocator::get_default());
@@ -431,4 +431,47 @@ TEST(BPlusTree_LeafCache)
     tree.destroy();
 }
 
+TEST(BPlusTree_PartitionPoint)
+{
+    BPlusTree<Int> tree(Allocator::get_default());
+    tree.create();
+    auto all = [](size_t, Int) {
+        return true;
+    };
+    CHECK_EQUAL(tree.partition_point(all), 0);
+
+    // Even values, with some inserted in the middle so that the inner nodes
+    // are not all compact
+    const int n = 20000;
+    for (int i = 0; i < n; i += 2) {
+        tree.add(2 * i);
+    }
+    for (int i = 1; i < n; i += 2) {
+        tree.insert(size_t(i), 2 * i);
+    }
+    CHECK_EQUAL(tree.size(), n);
+
+    for (int v = -1; v <= 2 * n; v += 7) {
+        size_t expected = v < 0 ? 0 : size_t(v + 1) / 2;
+        size_t pos = tree.partition_point([&](size_t, Int value) {
+            return value < v;
+        });
+        CHECK_EQUAL(pos, expected);
+    }
+
+    // The predicate is given the position of the element
+    size_t pos = tree.partition_point([&](size_t ndx, Int value) {
+        CHECK_EQUAL(value, Int(2 * ndx));
+        return ndx < 12345;
+    });
+    CHECK_EQUAL(pos, 12345);
+
+    // The leaf cache is left consistent
+    tree.set(pos, -1);
+    CHECK_EQUAL(tree.get(pos), -1);
+    CHECK_EQUAL(tree.get(pos + 1), 2 * (pos + 1));
+    CHECK_EQUAL(tree.get(0), 0);
+    tree.destroy();
+}
+
 #endif // TEST_BPLUS_TREE
@@ -3,7 +3,9 @@
 #include <realm/sync/changeset.hpp>
 #include <realm/sync/changeset_encoder.hpp>
 #include <realm/sync/changeset_parser.hpp>
+#include <realm/sync/noinst/columnar_changeset.hpp>
 #include <realm/sync/noinst/integer_codec.hpp>
+#include <realm/sync/noinst/protocol_codec.hpp>
 
 using namespace realm;
 using namespace realm::sync::instr;
@@ -22,6 +24,19 @@ Changeset encode_then_parse(const Changeset& changeset)
     return parsed;
 }
 
+Changeset encode_then_parse_columnar(const Changeset& changeset)
+{
+    using realm::util::SimpleNoCopyInputStream;
+
+    sync::ChangesetEncoder::Buffer buffer;
+    encode_changeset_columnar(changeset, buffer);
+    REALM_ASSERT(sync::is_columnar_changeset(BinaryData{buffer.data(), buffer.size()}));
+    SimpleNoCopyInputStream stream{buffer};
+    Changeset parsed;
+    parse_changeset(stream, parsed);
+    return parsed;
+}
+
 TEST(ChangesetEncoding_AddTable)
 {
     Changeset changeset;
@@ -277,6 +292,394 @@ TEST(ChangesetEncoding_Clear)
     CHECK(**changeset.begin() == instr);
 }
 
+TEST(ChangesetEncoding_Columnar_Empty)
+{
+    Changeset changeset;
+    sync::ChangesetEncoder::Buffer buffer;
+    encode_changeset_columnar(changeset, buffer);
+    CHECK_EQUAL(buffer.size(), 0);
+
+    auto parsed = encode_then_parse(changeset);
+    CHECK_EQUAL(changeset, parsed);
+}
+
+TEST(ChangesetEncoding_Columnar_AllInstructions)
+{
+    Changeset changeset;
+    sync::InternString table = changeset.intern_string("Foo");
+    sync::InternString field = changeset.intern_string("foo");
+    sync::InternString key = changeset.intern_string("key");
+
+    {
+        AddTable instr;
+        instr.table = table;
+        instr.type = AddTable::TopLevelTable{changeset.intern_string("pk"), Payload::Type::String, true, true};
+        changeset.push_back(instr);
+    }
+    {
+        AddTable instr;
+        instr.table = changeset.intern_string("Embedded");
+        instr.type = AddTable::EmbeddedTable{};
+        changeset.push_back(instr);
+    }
+    {
+        AddColumn instr;
+        instr.table = table;
+        instr.field = field;
+        instr.type = Payload::Type::Link;
+        instr.key_type = Payload::Type::String;
+        instr.collection_type = AddColumn::CollectionType::Dictionary;
+        instr.nullable = true;
+        instr.link_target_table = changeset.intern_string("Bar");
+        changeset.push_back(instr);
+    }
+    {
+        EraseColumn instr;
+        instr.table = table;
+        instr.field = field;
+        changeset.push_back(instr);
+    }
+    std::vector<PrimaryKey> keys = {
+        mpark::monostate{}, int64_t(-5), key, GlobalKey{1, 2}, ObjectId::gen(),
+        UUID{"3b241101-e2bb-4255-8caf-4136c566a962"},
+    };
+    for (const PrimaryKey& object : keys) {
+        CreateObject instr;
+        instr.table = table;
+        instr.object = object;
+        changeset.push_back(instr);
+    }
+    {
+        EraseObject instr;
+        instr.table = table;
+        instr.object = PrimaryKey{int64_t(123)};
+        changeset.push_back(instr);
+    }
+
+    // The parser adds each distinct string once, so the original must do so too
+    // for the changesets to compare equal
+    sync::StringBufferRange hello = changeset.append_string("Hello, World!");
+    std::vector<Payload> values = {
+        Payload{},
+        Payload{int64_t(std::numeric_limits<int64_t>::min())},
+        Payload{true},
+        Payload{hello},
+        Payload{changeset.append_string(StringData{"\0\1\2", 3}), true},
+        Payload{Timestamp{-1, -2}},
+        Payload{1.5f},
+        Payload{-2.5},
+        Payload{Decimal128{"123.45"}},
+        Payload{Payload::Link{changeset.intern_string("Bar"), PrimaryKey{int64_t(7)}}},
+        Payload{ObjectId::gen()},
+        Payload{UUID{"3b241101-e2bb-4255-8caf-4136c566a963"}},
+        Payload{Payload::ObjectValue{}},
+        Payload{Payload::Erased{}},
+    };
+    for (const Payload& value : values) {
+        sync::instr::Update instr;
+        instr.table = table;
+        instr.object = PrimaryKey{int64_t(123)};
+        instr.field = field;
+        instr.path.push_back(key);
+        instr.value = value;
+        instr.is_default = true;
+        changeset.push_back(instr);
+    }
+    {
+        sync::instr::Update instr;
+        instr.table = table;
+        instr.object = PrimaryKey{int64_t(124)};
+        instr.field = field;
+        instr.path.push_back(123);
+        instr.value = Payload{int64_t(1)};
+        instr.prior_size = 500;
+        changeset.push_back(instr);
+    }
+    {
+        AddInteger instr;
+        instr.table = table;
+        instr.object = PrimaryKey{int64_t(124)};
+        instr.field = field;
+        instr.value = -500;
+        changeset.push_back(instr);
+    }
+    {
+        ArrayInsert instr;
+        instr.table = table;
+        instr.object = PrimaryKey{key};
+        instr.field = field;
+        instr.path.push_back(key);
+        instr.path.push_back(5);
+        instr.value = Payload{hello};
+        instr.prior_size = 5;
+        changeset.push_back(instr);
+    }
+    {
+        ArrayMove instr;
+        instr.table = table;
+        instr.object = PrimaryKey{key};
+        instr.field = field;
+        instr.path.push_back(5);
+        instr.ndx_2 = 1;
+        instr.prior_size = 6;
+        changeset.push_back(instr);
+    }
+    {
+        ArrayErase instr;
+        instr.table = table;
+        instr.object = PrimaryKey{key};
+        instr.field = field;
+        instr.path.push_back(1);
+        instr.prior_size = 6;
+        changeset.push_back(instr);
+    }
+    {
+        Clear instr;
+        instr.table = table;
+        instr.object = PrimaryKey{key};
+        instr.field = field;
+        changeset.push_back(instr);
+    }
+    {
+        SetInsert instr;
+        instr.table = table;
+        instr.object = PrimaryKey{key};
+        instr.field = field;
+        instr.value = Payload{int64_t(1)};
+        changeset.push_back(instr);
+    }
+    {
+        SetErase instr;
+        instr.table = table;
+        instr.object = PrimaryKey{key};
+        instr.field = field;
+        instr.value = Payload{int64_t(1)};
+        changeset.push_back(instr);
+    }
+    {
+        EraseTable instr;
+        instr.table = table;
+        changeset.push_back(instr);
+    }
+
+    auto parsed = encode_then_parse_columnar(changeset);
+    CHECK_EQUAL(changeset, parsed);
+}
+
+TEST(ChangesetEncoding_Columnar_RepeatedStrings)
+{
+    Changeset changeset;
+    sync::InternString table = changeset.intern_string("Foo");
+    sync::InternString field = changeset.intern_string("bar");
+    const std::string_view value = "a string value which is repeated";
+    for (int64_t i = 0; i < 10; ++i) {
+        sync::instr::Update instr;
+        instr.table = table;
+        instr.object = PrimaryKey{i};
+        instr.field = field;
+        instr.value = Payload{changeset.append_string(value)};
+        changeset.push_back(instr);
+    }
+
+    sync::ChangesetEncoder::Buffer buffer;
+    encode_changeset_columnar(changeset, buffer);
+    std::string_view encoded{buffer.data(), buffer.size()};
+    auto first = encoded.find(value);
+    CHECK_NOT_EQUAL(first, std::string_view::npos);
+    CHECK_EQUAL(encoded.find(value, first + 1), std::string_view::npos);
+
+    // The parsed values share one range, so the changesets are compared by
+    // their contents
+    auto parsed = encode_then_parse_columnar(changeset);
+    std::ostringstream expected, actual;
+    expected << changeset;
+    actual << parsed;
+    CHECK_EQUAL(expected.str(), actual.str());
+    // The parsed changeset holds the value once
+    StringData parsed_strings = parsed.string_data();
+    std::string_view strings{parsed_strings.data(), parsed_strings.size()};
+    first = strings.find(value);
+    CHECK_NOT_EQUAL(first, std::string_view::npos);
+    CHECK_EQUAL(strings.find(value, first + 1), std::string_view::npos);
+}
+
+TEST(ChangesetEncoding_Columnar_Bulk)
+{
+    // A typical bulk insertion; consecutive primary keys and repeated fields
+    // compress particularly well in the columnar format.
+    Changeset changeset;
+    sync::InternString table = changeset.intern_string("Foo");
+    sync::InternString fields[] = {changeset.intern_string("a"), changeset.intern_string("b")};
+    for (int64_t i = 0; i < 1000; ++i) {
+        CreateObject create;
+        create.table = table;
+        create.object = PrimaryKey{1000000 + i};
+        changeset.push_back(create);
+        for (sync::InternString field : fields) {
+            sync::instr::Update instr;
+            instr.table = table;
+            instr.object = PrimaryKey{1000000 + i};
+            instr.field = field;
+            instr.value = Payload{i * 1000};
+            changeset.push_back(instr);
+        }
+    }
+
+    sync::ChangesetEncoder::Buffer legacy, columnar;
+    encode_changeset(changeset, legacy);
+    encode_changeset_columnar(changeset, columnar);
+    CHECK_LESS(columnar.size(), legacy.size());
+
+    // Parse from a stream which delivers the changeset in several blocks
+    util::SimpleInputStream stream{columnar};
+    Changeset parsed;
+    parse_changeset(stream, parsed);
+    CHECK_EQUAL(changeset, parsed);
+}
+
+TEST(ChangesetEncoding_TranscodedChangesetCache)
+{
+    Changeset changeset;
+    sync::InternString table = changeset.intern_string("Foo");
+    for (int64_t i = 0; i < 100; ++i) {
+        CreateObject create;
+        create.table = table;
+        create.object = PrimaryKey{i};
+        changeset.push_back(create);
+    }
+    sync::ChangesetEncoder::Buffer buffer;
+    encode_changeset(changeset, buffer);
+    ChunkedBinaryData stored{BinaryData{buffer.data(), buffer.size()}};
+
+    sync::ChangesetEncoder::Buffer columnar;
+    encode_changeset_columnar(changeset, columnar);
+    // Room for two changesets, shared by two files
+    _impl::ServerProtocol::TranscodedChangesetCache cache{2 * columnar.size()};
+    const int protocol_version = sync::get_current_protocol_version();
+    int file_1 = 0, file_2 = 0;
+    sync::ChangesetEncoder::Buffer transcode_buffer;
+
+    // Transcoded once, and then found in the cache
+    BinaryData first, second;
+    CHECK(cache.get(&file_1, protocol_version, 1, stored, transcode_buffer, first));
+    CHECK_EQUAL(first, BinaryData(columnar.data(), columnar.size()));
+    CHECK(cache.get(&file_1, protocol_version, 1, stored, transcode_buffer, second));
+    CHECK_EQUAL(static_cast<const void*>(first.data()), second.data());
+    CHECK_EQUAL(cache.size(), columnar.size());
+
+    // Changesets which need no transcoding are not cached
+    CHECK_NOT(cache.get(&file_1, 7, 1, stored, transcode_buffer, second));
+    CHECK_EQUAL(cache.size(), columnar.size());
+
+    // The same version of another file is cached separately, within the same
+    // budget
+    CHECK(cache.get(&file_2, protocol_version, 1, stored, transcode_buffer, second));
+    CHECK_NOT_EQUAL(static_cast<const void*>(first.data()), second.data());
+    CHECK_EQUAL(cache.size(), 2 * columnar.size());
+
+    // The least recently used changeset is dropped to make room, so the cache
+    // never holds more than its maximum size
+    CHECK(cache.get(&file_1, protocol_version, 1, stored, transcode_buffer, second));
+    CHECK_EQUAL(static_cast<const void*>(first.data()), second.data());
+    CHECK(cache.get(&file_1, protocol_version, 2, stored, transcode_buffer, second));
+    CHECK_EQUAL(cache.size(), 2 * columnar.size());
+    CHECK(cache.get(&file_1, protocol_version, 1, stored, transcode_buffer, second));
+    CHECK_EQUAL(static_cast<const void*>(first.data()), second.data());
+
+    // Dropping the changesets of a file leaves nothing, since those of the
+    // other file were dropped above
+    cache.erase(&file_1);
+    CHECK_EQUAL(cache.size(), 0);
+    CHECK(cache.get(&file_2, protocol_version, 1, stored, transcode_buffer, second));
+    CHECK_EQUAL(second, BinaryData(columnar.data(), columnar.size()));
+    CHECK_EQUAL(cache.size(), columnar.size());
+
+    // A changeset larger than the whole cache is returned through the buffer
+    // of the caller, and neither cached nor allowed to drop other changesets
+    Changeset large_changeset;
+    table = large_changeset.intern_string("Foo");
+    for (int64_t i = 0; i < 1000; ++i) {
+        CreateObject create;
+        create.table = table;
+        create.object = PrimaryKey{i};
+        large_changeset.push_back(create);
+    }
+    sync::ChangesetEncoder::Buffer large_buffer;
+    encode_changeset(large_changeset, large_buffer);
+    ChunkedBinaryData large_stored{BinaryData{large_buffer.data(), large_buffer.size()}};
+    sync::ChangesetEncoder::Buffer large_columnar;
+    encode_changeset_columnar(large_changeset, large_columnar);
+    CHECK_GREATER(large_columnar.size(), 2 * columnar.size());
+    BinaryData large;
+    CHECK(cache.get(&file_1, protocol_version, 3, large_stored, transcode_buffer, large));
+    CHECK_EQUAL(large, BinaryData(large_columnar.data(), large_columnar.size()));
+    CHECK_EQUAL(static_cast<const void*>(large.data()), static_cast<const void*>(transcode_buffer.data()));
+    CHECK_EQUAL(cache.size(), columnar.size());
+    BinaryData third;
+    CHECK(cache.get(&file_2, protocol_version, 1, stored, transcode_buffer, third));
+    CHECK_EQUAL(static_cast<const void*>(second.data()), third.data());
+}
+
+TEST(ChangesetParser_InstructionHandler)
+{
+    // Instructions are passed to the handler as they are parsed, and string
+    // values need only be kept until the instruction that uses them has been
+    // handled.
+    struct Handler : sync::InstructionHandler {
+        std::vector<std::string> interned;
+        std::string current;
+        std::vector<std::string> values;
+        size_t num_instructions = 0;
+
+        void set_intern_string(uint32_t index, sync::StringBufferRange range) override
+        {
+            REALM_ASSERT(index == interned.size());
+            interned.push_back(current.substr(range.offset, range.size));
+        }
+        sync::StringBufferRange add_string_range(StringData string) override
+        {
+            current.assign(string.data(), string.size());
+            return sync::StringBufferRange{0, uint32_t(string.size())};
+        }
+        void operator()(const sync::Instruction& instr) override
+        {
+            ++num_instructions;
+            if (auto update = instr.get_if<sync::Instruction::Update>()) {
+                REALM_ASSERT(update->value.type == Payload::Type::String);
+                values.push_back(current.substr(update->value.data.str.offset, update->value.data.str.size));
+            }
+        }
+    };
+
+    Changeset changeset;
+    sync::InternString table = changeset.intern_string("Foo");
+    sync::InternString field = changeset.intern_string("bar");
+    for (int64_t i = 0; i < 3; ++i) {
+        sync::instr::Update instr;
+        instr.table = table;
+        instr.object = PrimaryKey{i};
+        instr.field = field;
+        instr.value = Payload{changeset.append_string(std::to_string(i))};
+        changeset.push_back(instr);
+    }
+
+    for (bool columnar : {false, true}) {
+        Handler handler;
+        sync::ChangesetEncoder::Buffer buffer;
+        if (columnar) {
+            encode_changeset_columnar(changeset, buffer);
+        }
+        else {
+            encode_changeset(changeset, buffer);
+        }
+        util::SimpleNoCopyInputStream stream{buffer};
+        parse_changeset(stream, static_cast<sync::InstructionHandler&>(handler));
+        CHECK_EQUAL(handler.num_instructions, 3);
+        CHECK(handler.interned == std::vector<std::string>({"Foo", "bar"}));
+        CHECK(handler.values == std::vector<std::string>({"0", "1", "2"}));
+    }
+}
+
 TEST(ChangesetEncoding_AccentWords)
 {
     sync::ChangesetEncoder encoder;
@@ -438,4 +841,125 @@ TEST(ChangesetParser_BadInternString_InvalidUse)
     CHECK_BADCHANGESET(buffer, "Invalid interned string");
 }
 
+std::string encode_varints(std::initializer_list<uint64_t> values)
+{
+    std::string str;
+    for (uint64_t value : values) {
+        char buf[_impl::columnar::max_varint_size];
+        str.append(buf, _impl::columnar::encode_varint(value, buf));
+    }
+    return str;
+}
+
+void encode_columnar(util::AppendBuffer<char>& buffer, uint64_t version, uint64_t num_intern_strings,
+                     uint64_t num_instructions, std::map<_impl::columnar::Stream, std::string> streams)
+{
+    encode_instruction(buffer, sync::ColumnarChangesetMagic);
+    std::string header = encode_varints({version, num_intern_strings, num_instructions});
+    for (std::size_t i = 0; i < _impl::columnar::num_streams; ++i)
+        header += encode_varints({streams[_impl::columnar::Stream(i)].size()});
+    buffer.append(header.data(), header.size());
+    for (std::size_t i = 0; i < _impl::columnar::num_streams; ++i) {
+        const std::string& stream = streams[_impl::columnar::Stream(i)];
+        buffer.append(stream.data(), stream.size());
+    }
+}
+
+using Stream = _impl::columnar::Stream;
+
+TEST(ChangesetParser_Columnar_Good)
+{
+    util::AppendBuffer<char> buffer;
+    encode_columnar(buffer, 1, 2, 1,
+                    {{Stream::sizes, encode_varints({1, 1})},
+                     {Stream::bytes, "ab"},
+                     {Stream::opcodes, encode_varints({uint64_t(sync::Instruction::Type::EraseTable), 1})},
+                     {Stream::tables, encode_varints({2})}});
+
+    util::SimpleNoCopyInputStream stream{buffer};
+    Changeset parsed;
+    CHECK_NOTHROW(parse_changeset(stream, parsed));
+    CHECK_EQUAL(parsed.size(), 1);
+    CHECK_EQUAL(parsed.get_string((*parsed.begin())->get_as<sync::instr::EraseTable>().table), "b");
+}
+
+TEST(ChangesetParser_Columnar_BadVersion)
+{
+    util::AppendBuffer<char> buffer;
+    encode_columnar(buffer, 2, 0, 0, {});
+    CHECK_BADCHANGESET(buffer, "Bad columnar changeset header");
+}
+
+TEST(ChangesetParser_Columnar_Truncated)
+{
+    util::AppendBuffer<char> buffer;
+    encode_columnar(buffer, 1, 1, 0, {{Stream::sizes, encode_varints({1})}, {Stream::bytes, "a"}});
+    buffer.resize(buffer.size() - 1);
+    CHECK_BADCHANGESET(buffer, "Unexpected size of columnar changeset");
+}
+
+TEST(ChangesetParser_Columnar_TrailingData)
+{
+    util::AppendBuffer<char> buffer;
+    encode_columnar(buffer, 1, 1, 0, {{Stream::sizes, encode_varints({1})}, {Stream::bytes, "a"}});
+    encode_instruction(buffer, 0);
+    CHECK_BADCHANGESET(buffer, "Unexpected data after columnar changeset");
+}
+
+TEST(ChangesetParser_Columnar_UnconsumedStream)
+{
+    util::AppendBuffer<char> buffer;
+    encode_columnar(buffer, 1, 0, 0, {{Stream::ints, encode_varints({1})}});
+    CHECK_BADCHANGESET(buffer, "Unexpected data at end of stream");
+}
+
+TEST(ChangesetParser_Columnar_BadInstruction)
+{
+    util::AppendBuffer<char> buffer;
+    encode_columnar(buffer, 1, 0, 1, {{Stream::opcodes, encode_varints({0x3e, 1})}});
+    CHECK_BADCHANGESET(buffer, "unknown instruction");
+}
+
+TEST(ChangesetParser_Columnar_BadRunLength)
+{
+    util::AppendBuffer<char> buffer;
+    encode_columnar(buffer, 1, 0, 1,
+                    {{Stream::opcodes, encode_varints({uint64_t(sync::Instruction::Type::EraseTable), 2})}});
+    CHECK_BADCHANGESET(buffer, "Bad instruction run length");
+}
+
+TEST(ChangesetParser_Columnar_BadInternString)
+{
+    util::AppendBuffer<char> buffer;
+    encode_columnar(buffer, 1, 1, 1,
+                    {{Stream::sizes, encode_varints({1})},
+                     {Stream::bytes, "a"},
+                     {Stream::opcodes, encode_varints({uint64_t(sync::Instruction::Type::EraseTable), 1})},
+                     {Stream::tables, encode_varints({2})}});
+    CHECK_BADCHANGESET(buffer, "Invalid interned string");
+}
+
+TEST(ChangesetParser_Columnar_RepeatedInternString)
+{
+    util::AppendBuffer<char> buffer;
+    encode_columnar(buffer, 1, 2, 0, {{Stream::sizes, encode_varints({1, 1})}, {Stream::bytes, "aa"}});
+    CHECK_BADCHANGESET(buffer, "Unexpected intern string");
+}
+
+TEST(ChangesetParser_Columnar_BadStringValueReference)
+{
+    util::AppendBuffer<char> buffer;
+    encode_columnar(buffer, 1, 2, 1,
+                    {{Stream::sizes, encode_varints({1, 1})},
+                     {Stream::bytes, "ab"},
+                     {Stream::opcodes, encode_varints({uint64_t(sync::Instruction::Type::Update), 1})},
+                     {Stream::tables, encode_varints({0})},
+                     {Stream::key_types, encode_varints({0})},
+                     {Stream::fields, encode_varints({2})},
+                     {Stream::paths, encode_varints({0})},
+                     {Stream::value_types, encode_varints({_impl::columnar::zigzag_encode(3)})},
+                     {Stream::strings, encode_varints({1})}});
+    CHECK_BADCHANGESET(buffer, "Invalid string value reference");
+}
+
 } // namespace
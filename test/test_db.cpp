@@ -29,10 +29,12 @@ TEST(DB_getCoreFiles_adding_path)
     auto extension_management = ".management";
     auto extension_note = ".note";
     auto extension_log = ".log";
+    auto extension_wal = ".wal";
 
     CHECK_EQUAL(DB::get_core_file(path, DB::CoreFileType::Lock), path + extension_lock);
     CHECK_EQUAL(DB::get_core_file(path, DB::CoreFileType::Storage), path + extension_storage);
     CHECK_EQUAL(DB::get_core_file(path, DB::CoreFileType::Management), path + extension_management);
     CHECK_EQUAL(DB::get_core_file(path, DB::CoreFileType::Note), path + extension_note);
     CHECK_EQUAL(DB::get_core_file(path, DB::CoreFileType::Log), path + extension_log);
+    CHECK_EQUAL(DB::get_core_file(path, DB::CoreFileType::WAL), path + extension_wal);
 }
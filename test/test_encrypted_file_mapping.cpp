@@ -30,6 +30,8 @@
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <algorithm>
+#include <vector>
 
 // Test independence and thread-safety
 // -----------------------------------
@@ -184,5 +186,144 @@ TEST(EncryptedFile_LargePages)
     close(fd);
 }
 
+TEST(EncryptedFile_CryptorBatches)
+{
+    TEST_PATH(path);
+
+    // Spans several metadata blocks, which hold the IVs of 64 blocks each
+    const size_t num_blocks = 150;
+    std::vector<char> data(4096 * num_blocks);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = static_cast<char>(i * 7 + i / 4096);
+    std::vector<char> buffer(data.size());
+
+    int fd = open(path.c_str(), O_CREAT | O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    {
+        AESCryptor cryptor(test_key);
+        cryptor.set_file_size(off_t(data.size() + 4096 * 64));
+        cryptor.write(fd, 4096 * 3, data.data(), data.size());
+        CHECK(cryptor.read(fd, 4096 * 3, buffer.data(), buffer.size()));
+        CHECK(buffer == data);
+        // Rewrite a range in the middle
+        cryptor.write(fd, 4096 * 60, data.data(), 4096 * 10);
+    }
+
+    AESCryptor cryptor(test_key);
+    cryptor.set_file_size(off_t(data.size() + 4096 * 64));
+    CHECK(cryptor.read(fd, 4096 * 60, buffer.data(), 4096 * 10));
+    CHECK(memcmp(buffer.data(), data.data(), 4096 * 10) == 0);
+    for (size_t i = 0; i < num_blocks; ++i) {
+        if (i >= 57 && i < 67)
+            continue;
+        char block[4096];
+        CHECK(cryptor.read(fd, off_t(4096 * (i + 3)), block, sizeof(block)));
+        CHECK(memcmp(block, data.data() + 4096 * i, sizeof(block)) == 0);
+    }
+
+    // Blocks which have never been written are left untouched, but the
+    // blocks which follow them are still read
+    std::fill(buffer.begin(), buffer.end(), 'x');
+    CHECK_NOT(cryptor.read(fd, 0, buffer.data(), 4096 * 20));
+    CHECK(std::all_of(buffer.begin(), buffer.begin() + 4096 * 3, [](char c) {
+        return c == 'x';
+    }));
+    CHECK(memcmp(buffer.data() + 4096 * 3, data.data(), 4096 * 17) == 0);
+    close(fd);
+}
+
+TEST(EncryptedFile_GcmFormat)
+{
+    TEST_PATH(path);
+
+    char data[4096 * 3];
+    for (size_t i = 0; i < sizeof(data); ++i)
+        data[i] = static_cast<char>(i * 3);
+    char buffer[sizeof(data)];
+    // Entries written with AES-GCM end with this marker
+    auto is_gcm_entry = [&](int fd, size_t block) {
+        char entry[64];
+        ssize_t actual_pread = pread(fd, entry, sizeof(entry), off_t(block * 64));
+        return actual_pread == 64 && memcmp(entry + 24, "AES-GCM\1", 8) == 0;
+    };
+
+    int fd = open(path.c_str(), O_CREAT | O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    {
+        AESCryptor cryptor(test_key, File::encryption_Gcm);
+        cryptor.set_file_size(sizeof(data));
+        cryptor.write(fd, 0, data, sizeof(data));
+        CHECK(cryptor.read(fd, 0, buffer, sizeof(buffer)));
+        CHECK(memcmp(buffer, data, sizeof(data)) == 0);
+    }
+    CHECK(is_gcm_entry(fd, 0));
+    CHECK(is_gcm_entry(fd, 2));
+
+    {
+        // A cryptor which would write AES-CBC reads the file, and keeps
+        // writing it with AES-GCM
+        AESCryptor cryptor(test_key);
+        cryptor.set_file_size(sizeof(data));
+        CHECK(cryptor.read(fd, 0, buffer, sizeof(buffer)));
+        CHECK(memcmp(buffer, data, sizeof(data)) == 0);
+        cryptor.write(fd, 4096, data, 4096);
+    }
+    CHECK(is_gcm_entry(fd, 1));
+
+    // Fake an interrupted write which updates the IV table but not the data
+    char entry[64];
+    ssize_t actual_pread = pread(fd, entry, sizeof(entry), 64);
+    CHECK_EQUAL(actual_pread, 64);
+    memcpy(entry + 32, entry, 32);
+    entry[0]++;
+    entry[5]++; // first byte of the tag
+    ssize_t actual_pwrite = pwrite(fd, entry, sizeof(entry), 64);
+    CHECK_EQUAL(actual_pwrite, 64);
+    {
+        AESCryptor cryptor(test_key);
+        cryptor.set_file_size(sizeof(data));
+        CHECK(cryptor.read(fd, 4096, buffer, 4096));
+        CHECK(memcmp(buffer, data, 4096) == 0);
+        // The next write does not reuse the nonce of the interrupted one, and
+        // keeps the entry of the data on disk as the previous one
+        cryptor.write(fd, 4096, data + 4096, 4096);
+        CHECK(cryptor.read(fd, 4096, buffer, 4096));
+        CHECK(memcmp(buffer, data + 4096, 4096) == 0);
+    }
+    char new_entry[64];
+    actual_pread = pread(fd, new_entry, sizeof(new_entry), 64);
+    CHECK_EQUAL(actual_pread, 64);
+    bool same_nonce = memcmp(new_entry, entry, 4) == 0 && memcmp(new_entry + 20, entry + 20, 4) == 0;
+    CHECK_NOT(same_nonce);
+    CHECK(memcmp(new_entry + 32, entry + 32, 32) == 0);
+    {
+        AESCryptor cryptor(test_key);
+        cryptor.set_file_size(sizeof(data));
+        CHECK(cryptor.read(fd, 4096, buffer, 4096));
+        CHECK(memcmp(buffer, data + 4096, 4096) == 0);
+    }
+
+    // A block written once has a placeholder as its previous entry, so that
+    // readers which do not know AES-GCM cannot take it for a block whose
+    // first write was interrupted
+    actual_pread = pread(fd, new_entry, sizeof(new_entry), 0);
+    CHECK_EQUAL(actual_pread, 64);
+    CHECK_NOT_EQUAL(new_entry[32], 0);
+    CHECK(memcmp(new_entry + 56, "AES-GCM\3", 8) == 0);
+
+    // Data which does not match its tag is rejected
+    char byte;
+    actual_pread = pread(fd, &byte, 1, 4096 * 2 + 10);
+    CHECK_EQUAL(actual_pread, 1);
+    byte ^= 1;
+    actual_pwrite = pwrite(fd, &byte, 1, 4096 * 2 + 10);
+    CHECK_EQUAL(actual_pwrite, 1);
+    {
+        AESCryptor cryptor(test_key);
+        cryptor.set_file_size(sizeof(data));
+        CHECK_THROW(cryptor.read(fd, 4096, buffer, 4096), DecryptionFailed);
+        CHECK(cryptor.read(fd, 0, buffer, 4096));
+    }
+    close(fd);
+}
+
 #endif // REALM_ENABLE_ENCRYPTION
 #endif // TEST_ENCRYPTED_FILE_MAPPING
@@ -0,0 +1,309 @@
+/*************************************************************************
+ *
+ * Copyright 2022 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_INDEX_FULLTEXT
+
+#include <realm.hpp>
+#include <realm/index_fulltext.hpp>
+
+#include "test.hpp"
+#include "util/random.hpp"
+
+using namespace realm;
+using namespace realm::test_util;
+
+// Test independence and thread-safety
+// -----------------------------------
+//
+// All tests must be thread safe and independent of each other. This
+// is required because it allows for both shuffling of the execution
+// order and for parallelized testing.
+//
+// In particular, avoid using std::rand() since it is not guaranteed
+// to be thread safe. Instead use the API offered in
+// `test/util/random.hpp`.
+//
+// All files created in tests must use the TEST_PATH macro (or one of
+// its friends) to obtain a suitable file system path. See
+// `test/util/test_path.hpp`.
+//
+//
+// Debugging and the ONLY() macro
+// ------------------------------
+//
+// A simple way of disabling all tests except one called `Foo`, is to
+// replace TEST(Foo) with ONLY(Foo) and then recompile and rerun the
+// test suite. Note that you can also use filtering by setting the
+// environment varible `UNITTEST_FILTER`. See `README.md` for more on
+// this.
+
+namespace {
+
+const char* words[] = {"apple", "Apricot", "banana", "band", "bandana", "cherry", "ÆBLE", "æble",
+                       "x2",    "x20",     "dog",    "do",   "d",       "zebra",  "Zoo",  "zoom"};
+
+std::string random_text(Random& random)
+{
+    std::string text;
+    size_t num_words = random.draw_int<size_t>(0, 6);
+    for (size_t i = 0; i < num_words; ++i) {
+        if (i > 0)
+            text += random.draw_bool() ? " " : ", ";
+        text += words[random.draw_int<size_t>(0, std::size(words) - 1)];
+    }
+    return text;
+}
+
+std::vector<ObjKey> get_keys(const TableView& tv)
+{
+    std::vector<ObjKey> keys;
+    for (size_t i = 0; i < tv.size(); ++i)
+        keys.push_back(tv.get_key(i));
+    return keys;
+}
+
+// The keys of the objects whose value matches `text`, in table order
+std::vector<ObjKey> find_all(const Table& table, ColKey col, StringData text)
+{
+    auto terms = FullTextIndex::get_terms(text);
+    std::vector<ObjKey> keys;
+    for (auto& obj : table) {
+        if (FullTextIndex::matches(terms, obj.get<String>(col)))
+            keys.push_back(obj.get_key());
+    }
+    return keys;
+}
+
+} // anonymous namespace
+
+TEST(FullTextIndex_Tokenizer)
+{
+    auto words = Tokenizer::get_all_words("The quick, brown fox -- jumps over the QUICK dog x2y Æble");
+    std::vector<std::string> expected = {"brown", "dog", "fox", "jumps", "over", "quick", "the", "x2y", "Æble"};
+    CHECK(words == expected);
+    CHECK(Tokenizer::get_all_words("").empty());
+    CHECK(Tokenizer::get_all_words(StringData()).empty());
+    CHECK(Tokenizer::get_all_words(" ,.-!").empty());
+
+    auto terms = FullTextIndex::get_terms("Foo ba* foo *x ba*");
+    CHECK_EQUAL(terms.size(), 3);
+    CHECK_EQUAL(terms[0].word, "foo");
+    CHECK_NOT(terms[0].is_prefix);
+    CHECK_EQUAL(terms[1].word, "ba");
+    CHECK(terms[1].is_prefix);
+    CHECK_EQUAL(terms[2].word, "x");
+    CHECK_NOT(terms[2].is_prefix);
+
+    CHECK(FullTextIndex::matches(terms, "Foo, bar and X"));
+    CHECK(FullTextIndex::matches(terms, "x foo ba"));
+    CHECK_NOT(FullTextIndex::matches(terms, "foo bar"));
+    CHECK_NOT(FullTextIndex::matches(terms, "foo x b"));
+    CHECK(FullTextIndex::matches({}, "anything"));
+}
+
+TEST(FullTextIndex_Maintenance)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Table table;
+    auto col = table.add_column(type_String, "text", true);
+    auto col_2 = table.add_column(type_String, "text_2");
+    auto col_int = table.add_column(type_Int, "int");
+
+    for (int i = 0; i < 300; ++i) {
+        auto obj = table.create_object();
+        if (i % 7)
+            obj.set(col, random_text(random));
+        obj.set(col_2, random_text(random));
+    }
+
+    CHECK_NOT(table.has_fulltext_index(col));
+    table.add_fulltext_index(col);
+    table.add_fulltext_index(col_2);
+    CHECK(table.has_fulltext_index(col));
+    CHECK(table.has_fulltext_index(col_2));
+    CHECK_THROW_ANY(table.add_fulltext_index(col_int));
+    table.get_fulltext_index(col)->verify();
+    table.get_fulltext_index(col_2)->verify();
+
+    for (int round = 0; round < 10; ++round) {
+        for (int i = 0; i < 30; ++i) {
+            ObjKey key = table.get_object(random.draw_int<size_t>(0, table.size() - 1)).get_key();
+            auto obj = table.get_object(key);
+            switch (random.draw_int<int>(0, 4)) {
+                case 0:
+                    obj.set(col, random_text(random));
+                    break;
+                case 1:
+                    obj.set_null(col);
+                    break;
+                case 2:
+                    obj.set(col_2, random_text(random));
+                    break;
+                case 3:
+                    obj.set_any(col, Mixed(random_text(random)));
+                    break;
+                case 4:
+                    obj.remove();
+                    break;
+            }
+        }
+        for (int i = 0; i < 10; ++i)
+            table.create_object().set(col, random_text(random));
+        table.get_fulltext_index(col)->verify();
+        table.get_fulltext_index(col_2)->verify();
+    }
+
+    // Objects created in bulk are indexed too
+    std::vector<Mixed> values{Mixed("apple dog"), Mixed(), Mixed("Zoo")};
+    table.create_objects(3, {{col, util::Span<const Mixed>(values)}});
+    table.get_fulltext_index(col)->verify();
+    table.get_fulltext_index(col_2)->verify();
+
+    // The index follows the column when its nullability is changed
+    auto col_2_nullable = table.set_nullability(col_2, true, false);
+    CHECK(table.has_fulltext_index(col_2_nullable));
+    table.get_fulltext_index(col_2_nullable)->verify();
+
+    table.remove_fulltext_index(col);
+    CHECK_NOT(table.has_fulltext_index(col));
+    CHECK(table.has_fulltext_index(col_2_nullable));
+    table.get_fulltext_index(col_2_nullable)->verify();
+    table.remove_column(col_2_nullable);
+    CHECK(table.get_fulltext_index(col) == nullptr);
+
+    table.add_fulltext_index(col);
+    table.clear();
+    CHECK_EQUAL(table.get_fulltext_index(col)->size(), 0);
+}
+
+TEST(FullTextIndex_Queries)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Table table;
+    auto col = table.add_column(type_String, "text", true);
+    auto col_other = table.add_column(type_Int, "other");
+
+    for (int i = 0; i < 2000; ++i) {
+        auto obj = table.create_object();
+        if (i % 11)
+            obj.set(col, random_text(random));
+        obj.set(col_other, i % 3);
+    }
+    // A rare word and a common one, so that both ways of intersecting are used
+    for (int i = 0; i < 2000; i += 97)
+        table.get_object(i).set(col, "needle apple apple");
+    table.add_fulltext_index(col);
+
+    const char* searches[] = {"apple",      "APPLE banana",  "needle",   "needle apple", "apple needle x2",
+                              "ban*",       "band*",         "band",     "do*",          "d* z*",
+                              "æble",       "Æble banana",   "x2",       "x2*",          "nothing",
+                              "apple app*", "needle zebra*", "zoo zoom", "z*",           ""};
+    for (auto text : searches) {
+        auto expected = find_all(table, col, text);
+        CHECK(get_keys(table.where().fulltext(col, text).find_all()) == expected);
+        CHECK_EQUAL(table.where().fulltext(col, text).count(), expected.size());
+
+        // The same results without the index
+        table.remove_fulltext_index(col);
+        CHECK(get_keys(table.where().fulltext(col, text).find_all()) == expected);
+        table.add_fulltext_index(col);
+
+        // Combined with other conditions
+        auto q = table.where().fulltext(col, text).equal(col_other, 1);
+        CHECK_EQUAL(q.count(), std::count_if(expected.begin(), expected.end(), [&](ObjKey key) {
+                        return table.get_object(key).get<int64_t>(col_other) == 1;
+                    }));
+        q = table.where().Not().fulltext(col, text);
+        CHECK_EQUAL(q.count(), table.size() - expected.size());
+        q = table.where().equal(col_other, 2).Or().fulltext(col, text);
+        CHECK_EQUAL(q.count(), std::count_if(table.begin(), table.end(), [&](const Obj& obj) {
+                        return obj.get<int64_t>(col_other) == 2 ||
+                               std::find(expected.begin(), expected.end(), obj.get_key()) != expected.end();
+                    }));
+        ObjKey first = table.where().fulltext(col, text).find();
+        CHECK_EQUAL(first, expected.empty() ? ObjKey() : expected.front());
+    }
+
+    CHECK_THROW_ANY(table.where().fulltext(col_other, "apple"));
+}
+
+TEST(FullTextIndex_Transactions)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBRef db = DB::create(make_in_realm_history(), path);
+    ColKey col;
+    ColKey col_2;
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("table");
+        col = table->add_column(type_String, "text");
+        col_2 = table->add_column(type_String, "text_2");
+        for (int i = 0; i < 100; ++i)
+            table->create_object().set(col, i % 10 ? "apple banana" : "cherry").set(col_2, "dog");
+        table->add_fulltext_index(col);
+        wt->commit();
+    }
+
+    auto rt = db->start_read();
+    auto table = rt->get_table("table");
+    CHECK(table->has_fulltext_index(col));
+    CHECK_EQUAL(table->where().fulltext(col, "cherry").count(), 10);
+
+    {
+        auto wt = db->start_write();
+        auto t = wt->get_table("table");
+        t->create_object().set(col, "Cherry pie");
+        t->add_fulltext_index(col_2);
+        t->get_fulltext_index(col)->verify();
+        wt->commit();
+    }
+    rt->advance_read();
+    CHECK(table->has_fulltext_index(col_2));
+    table->get_fulltext_index(col)->verify();
+    table->get_fulltext_index(col_2)->verify();
+    CHECK_EQUAL(table->where().fulltext(col, "cherry").count(), 11);
+
+    // The accessors of the remaining indexes are shifted
+    {
+        auto wt = db->start_write();
+        auto t = wt->get_table("table");
+        t->remove_fulltext_index(col);
+        wt->commit();
+    }
+    rt->advance_read();
+    CHECK_NOT(table->has_fulltext_index(col));
+    CHECK(table->has_fulltext_index(col_2));
+    table->get_fulltext_index(col_2)->verify();
+
+    // Changes are rolled back with the transaction
+    {
+        auto wt = db->start_write();
+        auto t = wt->get_table("table");
+        t->add_fulltext_index(col);
+        t->get_object(0).set(col_2, "cat");
+        wt->rollback();
+    }
+    rt->advance_read();
+    CHECK_NOT(table->has_fulltext_index(col));
+    table->get_fulltext_index(col_2)->verify();
+    CHECK_EQUAL(table->where().fulltext(col_2, "cat").count(), 0);
+    CHECK_EQUAL(table->where().fulltext(col, "cherry").count(), 11);
+}
+
+#endif // TEST_INDEX_FULLTEXT
@@ -0,0 +1,371 @@
+/*************************************************************************
+ *
+ * Copyright 2022 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_INDEX_ORDERED
+
+#include <realm.hpp>
+#include <realm/index_ordered.hpp>
+#include <realm/sort_descriptor.hpp>
+
+#include "test.hpp"
+#include "util/random.hpp"
+
+using namespace realm;
+using namespace realm::test_util;
+
+// Test independence and thread-safety
+// -----------------------------------
+//
+// All tests must be thread safe and independent of each other. This
+// is required because it allows for both shuffling of the execution
+// order and for parallelized testing.
+//
+// In particular, avoid using std::rand() since it is not guaranteed
+// to be thread safe. Instead use the API offered in
+// `test/util/random.hpp`.
+//
+// All files created in tests must use the TEST_PATH macro (or one of
+// its friends) to obtain a suitable file system path. See
+// `test/util/test_path.hpp`.
+//
+//
+// Debugging and the ONLY() macro
+// ------------------------------
+//
+// A simple way of disabling all tests except one called `Foo`, is to
+// replace TEST(Foo) with ONLY(Foo) and then recompile and rerun the
+// test suite. Note that you can also use filtering by setting the
+// environment varible `UNITTEST_FILTER`. See `README.md` for more on
+// this.
+
+namespace {
+
+std::vector<ObjKey> get_keys(const TableView& tv)
+{
+    std::vector<ObjKey> keys;
+    for (size_t i = 0; i < tv.size(); ++i)
+        keys.push_back(tv.get_key(i));
+    return keys;
+}
+
+// The keys of the objects matching `pred`, in table order
+template <class Pred>
+std::vector<ObjKey> find_all(const Table& table, Pred pred)
+{
+    std::vector<ObjKey> keys;
+    for (auto& obj : table) {
+        if (pred(obj))
+            keys.push_back(obj.get_key());
+    }
+    return keys;
+}
+
+} // anonymous namespace
+
+TEST(OrderedIndex_Maintenance)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Table table;
+    auto col = table.add_column(type_Int, "int", true);
+    auto col_ts = table.add_column(type_Timestamp, "ts");
+    auto col_str = table.add_column(type_String, "str");
+
+    for (int i = 0; i < 500; ++i) {
+        auto obj = table.create_object();
+        if (i % 7)
+            obj.set(col, random.draw_int<int64_t>(-50, 50));
+        obj.set(col_ts, Timestamp(random.draw_int<int64_t>(0, 100), 0));
+    }
+
+    CHECK_NOT(table.has_ordered_index(col));
+    table.add_ordered_index(col);
+    table.add_ordered_index(col_ts);
+    CHECK(table.has_ordered_index(col));
+    CHECK(table.has_ordered_index(col_ts));
+    CHECK_THROW_ANY(table.add_ordered_index(col_str));
+    table.get_ordered_index(col)->verify();
+    table.get_ordered_index(col_ts)->verify();
+
+    // Nulls are ordered first
+    auto index = table.get_ordered_index(col);
+    CHECK_EQUAL(index->size(), 500);
+    CHECK(index->get_value(0).is_null());
+    CHECK_EQUAL(index->upper_bound(Mixed()), 500 / 7 + 1);
+
+    for (int round = 0; round < 10; ++round) {
+        for (int i = 0; i < 50; ++i) {
+            ObjKey key = table.get_object(random.draw_int<size_t>(0, table.size() - 1)).get_key();
+            auto obj = table.get_object(key);
+            switch (random.draw_int<int>(0, 4)) {
+                case 0:
+                    obj.set(col, random.draw_int<int64_t>(-50, 50));
+                    break;
+                case 1:
+                    obj.set_null(col);
+                    break;
+                case 2:
+                    if (!obj.is_null(col))
+                        obj.add_int(col, random.draw_int<int64_t>(-5, 5));
+                    break;
+                case 3:
+                    obj.set(col_ts, Timestamp(random.draw_int<int64_t>(0, 100), random.draw_int<int32_t>(0, 9)));
+                    break;
+                case 4:
+                    obj.remove();
+                    break;
+            }
+        }
+        for (int i = 0; i < 20; ++i)
+            table.create_object().set(col, random.draw_int<int64_t>(-50, 50));
+        table.get_ordered_index(col)->verify();
+        table.get_ordered_index(col_ts)->verify();
+    }
+
+    // Objects created in bulk are indexed too
+    std::vector<Mixed> values{Mixed(3), Mixed(), Mixed(-3)};
+    table.create_objects(3, {{col, util::Span<const Mixed>(values)}});
+    table.get_ordered_index(col)->verify();
+    table.get_ordered_index(col_ts)->verify();
+
+    // The index follows the column when its nullability is changed
+    auto col_ts_nullable = table.set_nullability(col_ts, true, false);
+    CHECK(table.has_ordered_index(col_ts_nullable));
+    table.get_ordered_index(col_ts_nullable)->verify();
+
+    table.remove_ordered_index(col);
+    CHECK_NOT(table.has_ordered_index(col));
+    CHECK(table.has_ordered_index(col_ts_nullable));
+    table.get_ordered_index(col_ts_nullable)->verify();
+    table.remove_column(col_ts_nullable);
+    CHECK(table.get_ordered_index(col) == nullptr);
+
+    table.add_ordered_index(col);
+    table.clear();
+    CHECK_EQUAL(table.get_ordered_index(col)->size(), 0);
+}
+
+TEST(OrderedIndex_RangeQueries)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Table table;
+    auto col = table.add_column(type_Int, "int");
+    auto col_null = table.add_column(type_Int, "int_null", true);
+    auto col_ts = table.add_column(type_Timestamp, "ts", true);
+    auto col_other = table.add_column(type_Int, "other");
+
+    for (int i = 0; i < 2000; ++i) {
+        auto obj = table.create_object();
+        obj.set(col, random.draw_int<int64_t>(0, 999));
+        if (i % 5)
+            obj.set(col_null, random.draw_int<int64_t>(0, 999));
+        if (i % 3)
+            obj.set(col_ts, Timestamp(random.draw_int<int64_t>(0, 999), 0));
+        obj.set(col_other, i % 2);
+    }
+    table.add_ordered_index(col);
+    table.add_ordered_index(col_null);
+    table.add_ordered_index(col_ts);
+
+    for (int64_t v : {-1, 0, 10, 500, 990, 999, 1000}) {
+        auto int_value = [&](const Obj& obj, ColKey c) {
+            return obj.get<util::Optional<int64_t>>(c);
+        };
+        CHECK(get_keys(table.where().greater(col, v).find_all()) == find_all(table, [&](const Obj& obj) {
+                        return obj.get<int64_t>(col) > v;
+                    }));
+        CHECK(get_keys(table.where().greater_equal(col, v).find_all()) == find_all(table, [&](const Obj& obj) {
+                        return obj.get<int64_t>(col) >= v;
+                    }));
+        CHECK(get_keys(table.where().less(col_null, v).find_all()) == find_all(table, [&](const Obj& obj) {
+                        auto val = int_value(obj, col_null);
+                        return val && *val < v;
+                    }));
+        CHECK(get_keys(table.where().less_equal(col_null, v).find_all()) == find_all(table, [&](const Obj& obj) {
+                        auto val = int_value(obj, col_null);
+                        return val && *val <= v;
+                    }));
+        CHECK_EQUAL(table.where().greater(col_null, v).count(), find_all(table, [&](const Obj& obj) {
+                                                                    auto val = int_value(obj, col_null);
+                                                                    return val && *val > v;
+                                                                }).size());
+
+        Timestamp ts(v, 0);
+        CHECK(get_keys(table.where().greater(col_ts, ts).find_all()) == find_all(table, [&](const Obj& obj) {
+                        auto val = obj.get<Timestamp>(col_ts);
+                        return !val.is_null() && val > ts;
+                    }));
+        CHECK(get_keys(table.where().less(col_ts, ts).find_all()) == find_all(table, [&](const Obj& obj) {
+                        auto val = obj.get<Timestamp>(col_ts);
+                        return !val.is_null() && val < ts;
+                    }));
+
+        // Combined with other conditions
+        CHECK(get_keys(table.where().between(col, v, v + 20).equal(col_other, 1).find_all()) ==
+                    find_all(table, [&](const Obj& obj) {
+                        auto val = obj.get<int64_t>(col);
+                        return val >= v && val <= v + 20 && obj.get<int64_t>(col_other) == 1;
+                    }));
+        auto q = table.where().greater(col, v).less(col_null, v);
+        CHECK_EQUAL(q.count(), find_all(table, [&](const Obj& obj) {
+                                   auto val = int_value(obj, col_null);
+                                   return obj.get<int64_t>(col) > v && val && *val < v;
+                               }).size());
+        auto expected = find_all(table, [&](const Obj& obj) {
+            return obj.get<int64_t>(col) > v;
+        });
+        ObjKey first = table.where().greater(col, v).find();
+        CHECK_EQUAL(first, expected.empty() ? ObjKey() : expected.front());
+    }
+}
+
+TEST(OrderedIndex_Sort)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Table table;
+    auto col = table.add_column(type_Int, "int", true);
+    auto col_ts = table.add_column(type_Timestamp, "ts");
+    auto col_other = table.add_column(type_Int, "other");
+
+    for (int i = 0; i < 3000; ++i) {
+        auto obj = table.create_object();
+        if (i % 10)
+            obj.set(col, random.draw_int<int64_t>(0, 50));
+        obj.set(col_ts, Timestamp(random.draw_int<int64_t>(0, 100000), 0));
+        obj.set(col_other, random.draw_int<int64_t>(0, 3));
+    }
+
+    auto check_sorted = [&](TableView tv, ColKey c, bool ascending, size_t limit = npos) {
+        // The unindexed sort is the reference
+        std::vector<ObjKey> expected;
+        {
+            table.remove_ordered_index(c);
+            TableView ref = tv;
+            DescriptorOrdering ordering;
+            ordering.append_sort(SortDescriptor({{c}}, {ascending}));
+            if (limit != npos)
+                ordering.append_limit(limit);
+            ref.apply_descriptor_ordering(ordering);
+            expected = get_keys(ref);
+            table.add_ordered_index(c);
+        }
+        DescriptorOrdering ordering;
+        ordering.append_sort(SortDescriptor({{c}}, {ascending}));
+        if (limit != npos)
+            ordering.append_limit(limit);
+        tv.apply_descriptor_ordering(ordering);
+        CHECK(get_keys(tv) == expected);
+    };
+
+    table.add_ordered_index(col);
+    table.add_ordered_index(col_ts);
+    for (bool ascending : {true, false}) {
+        check_sorted(table.where().find_all(), col, ascending);
+        check_sorted(table.where().find_all(), col_ts, ascending);
+        check_sorted(table.where().find_all(), col, ascending, 10);
+        check_sorted(table.where().find_all(), col_ts, ascending, 10);
+        check_sorted(table.where().equal(col_other, 1).find_all(), col, ascending);
+        check_sorted(table.where().equal(col_other, 1).find_all(), col_ts, ascending, 25);
+
+        // A view which is not in table order
+        TableView tv = table.where().find_all();
+        tv.sort(col_other);
+        check_sorted(tv, col, ascending);
+    }
+
+    // Top N by date
+    TableView tv = table.where().find_all();
+    DescriptorOrdering ordering;
+    ordering.append_sort(SortDescriptor({{col_ts}}, {false}));
+    ordering.append_limit(5);
+    tv.apply_descriptor_ordering(ordering);
+    CHECK_EQUAL(tv.size(), 5);
+    CHECK_EQUAL(tv.get_num_results_excluded_by_limit(), 2995);
+    for (size_t i = 1; i < tv.size(); ++i)
+        CHECK_GREATER_EQUAL(tv.get_object(i - 1).get<Timestamp>(col_ts), tv.get_object(i).get<Timestamp>(col_ts));
+    CHECK_EQUAL(tv.get_object(0).get<Timestamp>(col_ts), table.max(col_ts)->get_timestamp());
+
+    // Distinct uses the index as well
+    tv = table.where().find_all();
+    tv.distinct(col);
+    CHECK_EQUAL(tv.size(), 52);
+}
+
+TEST(OrderedIndex_Transactions)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBRef db = DB::create(make_in_realm_history(), path);
+    ColKey col;
+    ColKey col_2;
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("table");
+        col = table->add_column(type_Int, "int");
+        col_2 = table->add_column(type_Int, "int_2");
+        for (int i = 0; i < 100; ++i)
+            table->create_object().set(col, 100 - i).set(col_2, i);
+        table->add_ordered_index(col);
+        wt->commit();
+    }
+
+    auto rt = db->start_read();
+    auto table = rt->get_table("table");
+    CHECK(table->has_ordered_index(col));
+    CHECK_EQUAL(table->where().less(col, 6).count(), 5);
+
+    {
+        auto wt = db->start_write();
+        auto t = wt->get_table("table");
+        t->create_object().set(col, 1);
+        t->add_ordered_index(col_2);
+        t->get_ordered_index(col)->verify();
+        wt->commit();
+    }
+    rt->advance_read();
+    CHECK(table->has_ordered_index(col_2));
+    table->get_ordered_index(col)->verify();
+    table->get_ordered_index(col_2)->verify();
+    CHECK_EQUAL(table->where().less(col, 6).count(), 6);
+
+    // The accessors of the remaining indexes are shifted
+    {
+        auto wt = db->start_write();
+        auto t = wt->get_table("table");
+        t->remove_ordered_index(col);
+        wt->commit();
+    }
+    rt->advance_read();
+    CHECK_NOT(table->has_ordered_index(col));
+    CHECK(table->has_ordered_index(col_2));
+    table->get_ordered_index(col_2)->verify();
+
+    // Changes are rolled back with the transaction
+    {
+        auto wt = db->start_write();
+        auto t = wt->get_table("table");
+        t->add_ordered_index(col);
+        t->get_object(0).set(col_2, 1000);
+        wt->rollback();
+    }
+    rt->advance_read();
+    CHECK_NOT(table->has_ordered_index(col));
+    table->get_ordered_index(col_2)->verify();
+    CHECK_EQUAL(table->where().greater(col_2, 98).count(), 1);
+}
+
+#endif // TEST_INDEX_ORDERED
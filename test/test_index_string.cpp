@@ -1826,6 +1826,91 @@ TEST(StringIndex_MixedEqualBitPattern)
     CHECK_EQUAL(tv.get_object(1).get_any(col), val1);
 }
 
+TEST(StringIndex_Populate)
+{
+    // Adding an index to a column with data builds it in bulk. Compare the
+    // result with an index which was built one object at a time.
+    Group g;
+    auto bulk = g.add_table("bulk");
+    auto incremental = g.add_table("incremental");
+    for (auto table : {bulk, incremental}) {
+        table->add_column(type_String, "string", true);
+        table->add_column(type_Int, "int", true);
+        table->add_column(type_Mixed, "mixed");
+    }
+    for (auto col : incremental->get_column_keys())
+        incremental->add_search_index(col);
+
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    const std::string long_prefix(300, 'a');
+    std::vector<Mixed> values;
+    for (int i = 0; i < 200; ++i) {
+        values.emplace_back(util::to_string(i));
+        values.emplace_back(long_prefix + util::to_string(i));
+        values.emplace_back(int64_t(i) << 40);
+    }
+    values.emplace_back(StringData(""));
+    values.emplace_back(int64_t(0));
+    values.emplace_back(Mixed("abcdefgh"));
+    values.emplace_back(int64_t(0x6867666564636261)); // Same index data as "abcdefgh"
+    values.emplace_back();
+
+    const size_t num_objects = 5000;
+    for (size_t i = 0; i < num_objects; ++i) {
+        // Skewed, so that there are both unique values and long lists
+        Mixed value = values[random.draw_int_mod(random.draw_int_mod(values.size()) + 1)];
+        std::string str = value.is_type(type_String) ? std::string(value.get_string()) : std::string();
+        Mixed string_value = value.is_null() ? Mixed() : Mixed(StringData(str));
+        Mixed int_value = value.is_type(type_Int) ? value : Mixed();
+        for (auto table : {bulk, incremental}) {
+            auto cols = table->get_column_keys();
+            table->create_object(ObjKey(int64_t(i * 3)))
+                .set_any(cols[0], value.is_type(type_String) ? string_value : Mixed())
+                .set_any(cols[1], int_value)
+                .set_any(cols[2], value.is_type(type_String) ? string_value : value);
+        }
+    }
+    for (auto col : bulk->get_column_keys())
+        bulk->add_search_index(col);
+
+    auto check_same = [&] {
+        bulk->verify();
+        auto bulk_cols = bulk->get_column_keys();
+        auto incremental_cols = incremental->get_column_keys();
+        for (size_t c = 0; c < bulk_cols.size(); ++c) {
+            const StringIndex* bulk_index = bulk->get_search_index(bulk_cols[c]);
+            const StringIndex* incremental_index = incremental->get_search_index(incremental_cols[c]);
+            for (auto& value : values) {
+                if ((c == 0 && value.is_type(type_Int)) || (c == 1 && value.is_type(type_String)))
+                    continue;
+                std::vector<ObjKey> expected, actual;
+                incremental_index->find_all(expected, value);
+                bulk_index->find_all(actual, value);
+                CHECK(expected == actual);
+                CHECK_EQUAL(bulk_index->count(value), expected.size());
+                CHECK_EQUAL(bulk_index->find_first(value), expected.empty() ? ObjKey() : expected.front());
+            }
+        }
+    };
+    check_same();
+
+    // The bulk built index can be updated like any other
+    for (size_t i = 0; i < num_objects; i += 7) {
+        bulk->remove_object(ObjKey(int64_t(i * 3)));
+        incremental->remove_object(ObjKey(int64_t(i * 3)));
+    }
+    for (size_t i = 0; i < 500; ++i) {
+        Mixed value = values[random.draw_int_mod(values.size())];
+        if (!value.is_type(type_String))
+            continue;
+        for (auto table : {bulk, incremental}) {
+            auto cols = table->get_column_keys();
+            table->create_object(ObjKey(int64_t(i * 3 + 1))).set_any(cols[0], value).set_any(cols[2], value);
+        }
+    }
+    check_same();
+}
+
 TEST(Unicode_Casemap)
 {
     std::string inp = "A very old house 🏠 is on 🔥, we have to save the 🦄";
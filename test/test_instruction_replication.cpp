@@ -181,6 +181,61 @@ TEST(InstructionReplication_CreateObject)
     }
 }
 
+TEST(InstructionReplication_CreateObjectsColumnar)
+{
+    Fixture fixture{test_context};
+    const size_t num_objects = 3 * REALM_MAX_BPNODE_SIZE + 5;
+    std::vector<Mixed> pks, names, ages, links;
+    {
+        WriteTransaction wt{fixture.sg_1};
+        TableRef target = wt.add_table("class_target");
+        target->create_objects(3, {});
+        ObjKey target_key = target->begin()->get_key();
+        for (size_t i = 0; i < num_objects; ++i) {
+            pks.emplace_back(int64_t(i * 3));
+            if (i % 5)
+                names.emplace_back(StringData(i % 2 ? "odd" : "even"));
+            else
+                names.emplace_back();
+            ages.emplace_back(int64_t(i));
+            if (i % 3)
+                links.emplace_back(target_key);
+            else
+                links.emplace_back();
+        }
+
+        TableRef foo = wt.get_group().add_table_with_primary_key("class_foo", type_Int, "id");
+        ColKey col_pk = foo->get_primary_key_column();
+        ColKey col_name = foo->add_column(type_String, "name", true);
+        ColKey col_age = foo->add_column(type_Int, "age");
+        ColKey col_link = foo->add_column(*target, "link");
+        foo->create_objects(num_objects, {{col_pk, util::Span<const Mixed>(pks)},
+                                          {col_name, util::Span<const Mixed>(names)},
+                                          {col_age, util::Span<const Mixed>(ages)},
+                                          {col_link, util::Span<const Mixed>(links)}});
+
+        TableRef bar = wt.add_table("class_bar");
+        ColKey col_bar_age = bar->add_column(type_Int, "age");
+        bar->create_objects(num_objects, {{col_bar_age, util::Span<const Mixed>(ages)}});
+        wt.commit();
+    }
+    fixture.replay_transactions();
+    fixture.check_equal();
+    {
+        ReadTransaction rt{fixture.sg_2};
+        ConstTableRef foo = rt.get_table("class_foo");
+        CHECK_EQUAL(foo->size(), num_objects);
+        ColKey col_name = foo->get_column_key("name");
+        ColKey col_link = foo->get_column_key("link");
+        Obj obj = foo->get_object_with_primary_key(int64_t(3 * 7));
+        CHECK_EQUAL(obj.get_any(col_name), names[7]);
+        Obj target = *rt.get_table("class_target")->begin();
+        CHECK_EQUAL(obj.get<ObjKey>(col_link), target.get_key());
+        CHECK_EQUAL(target.get_backlink_count(), num_objects - (num_objects + 2) / 3);
+        CHECK_EQUAL(rt.get_table("class_bar")->size(), num_objects);
+    }
+}
+
 TEST(InstructionReplication_CreateObjectNullStringPK)
 {
     Fixture fixture{test_context};
@@ -239,6 +239,118 @@ TEST(Transactions_ConcurrentFrozenQueryAndObj)
         threads[j].join();
 }
 
+TEST(Transactions_SharedFrozen)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist_w(make_in_realm_history());
+    DBOptions options;
+    options.share_frozen_transactions = true;
+    DBRef db = DB::create(*hist_w, path, options);
+    ColKey col;
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("MyTable");
+        col = table->add_column(type_Int, "MyCol");
+        for (int i = 0; i < 1000; ++i)
+            table->create_object().set_all(i);
+        wt->commit();
+    }
+
+    // All requests for a version get the same transaction
+    auto rt = db->start_read();
+    auto frozen = rt->freeze();
+    CHECK_EQUAL(db->start_frozen(), frozen);
+    CHECK_EQUAL(db->start_frozen(rt->get_version_of_current_transaction()), frozen);
+    CHECK_EQUAL(rt->freeze(), frozen);
+    auto duplicate = frozen->duplicate();
+    CHECK_NOT_EQUAL(duplicate, frozen);
+    CHECK_EQUAL(duplicate->get_version(), frozen->get_version());
+
+    // A newer version gets a transaction of its own
+    {
+        auto wt = db->start_write();
+        wt->get_table("MyTable")->create_object().set_all(1000);
+        wt->commit();
+    }
+    auto newer = db->start_frozen();
+    CHECK_NOT_EQUAL(newer, frozen);
+    CHECK_EQUAL(newer->get_table("MyTable")->size(), 1001);
+    CHECK_EQUAL(frozen->get_table("MyTable")->size(), 1000);
+
+    // Threads freezing the same version share its table accessors
+    const int num_threads = 16;
+    std::vector<TransactionRef> seen(num_threads);
+    std::vector<const Table*> tables(num_threads);
+    std::vector<std::thread> threads;
+    for (int j = 0; j < num_threads; ++j) {
+        threads.emplace_back([&, j] {
+            seen[j] = db->start_frozen();
+            auto table = seen[j]->get_table("MyTable");
+            tables[j] = table.unchecked_ptr();
+            TableView tv = table->where().greater_equal(col, 500).find_all();
+            CHECK_EQUAL(tv.size(), 501);
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+    for (int j = 0; j < num_threads; ++j) {
+        CHECK_EQUAL(seen[j], newer);
+        CHECK_EQUAL(tables[j], tables[0]);
+    }
+
+    // Closing a shared transaction does not end it for the other holders
+    auto other = db->start_frozen(frozen->get_version_of_current_transaction());
+    CHECK_EQUAL(other, frozen);
+    other->close();
+    CHECK(frozen->is_attached());
+    CHECK_EQUAL(frozen->get_table("MyTable")->size(), 1000);
+    CHECK_EQUAL(frozen->get_table("MyTable")->where().greater_equal(col, 500).count(), 500);
+    duplicate->close();
+    CHECK_NOT(duplicate->is_attached());
+    CHECK(frozen->is_attached());
+
+    // Closing it again, or closing it while others hold it, has no effect
+    auto last = newer;
+    for (auto& tr : seen) {
+        tr->close();
+        tr->close();
+    }
+    CHECK(newer->is_attached());
+    CHECK_EQUAL(newer->get_table("MyTable")->size(), 1001);
+
+    // It ends when the last holder closes it, and is not handed out again
+    seen.clear();
+    newer->close();
+    CHECK_NOT(last->is_attached());
+    auto replacement = db->start_frozen(last->get_version_of_current_transaction());
+    CHECK_NOT_EQUAL(replacement, last);
+    CHECK_EQUAL(replacement->get_table("MyTable")->size(), 1001);
+
+    // A holder which closes the transaction twice only releases it once
+    auto holder = db->start_frozen(replacement->get_version_of_current_transaction());
+    CHECK_EQUAL(holder, replacement);
+    holder->close();
+    holder->close();
+    CHECK(replacement->is_attached());
+    CHECK_EQUAL(replacement->get_table("MyTable")->size(), 1001);
+
+    // Once released, a version is no longer retained
+    auto version = frozen->get_version_of_current_transaction();
+    frozen.reset();
+    other.reset();
+    duplicate.reset();
+    rt.reset();
+    {
+        auto wt = db->start_write();
+        wt->commit();
+    }
+    {
+        auto wt = db->start_write();
+        wt->commit();
+    }
+    CHECK_THROW(db->start_frozen(version), DB::BadVersion);
+}
+
 // this tests resilience against some violations of the Core API.
 // It creates a lot of races between accessor use and transaction close.
 // This is undefined behaviour
@@ -6044,4 +6156,77 @@ TEST(LangBindHelper_SchemaChangeNotification)
     CHECK(handler_called);
 }
 
+TEST(LangBindHelper_SchemaChangeNotificationWithObserver)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    auto hist = make_in_realm_history();
+    DBRef db = DB::create(*hist, path);
+
+    struct Observer : _impl::NullInstructionObserver {
+        size_t num_created = 0;
+        int num_columns = 0;
+        bool create_object(ObjKey)
+        {
+            ++num_created;
+            return true;
+        }
+        bool insert_column(ColKey)
+        {
+            ++num_columns;
+            return true;
+        }
+        bool erase_column(ColKey)
+        {
+            --num_columns;
+            return true;
+        }
+    };
+
+    auto rt = db->start_read();
+    bool handler_called;
+    rt->set_schema_change_notification_handler([&handler_called]() {
+        handler_called = true;
+    });
+
+    // The observer sees the instructions, and the schema change is still
+    // reported, although the log is only parsed once
+    {
+        auto tr = db->start_write();
+        auto table = tr->add_table("my_table");
+        table->add_column(type_Int, "integer");
+        table->create_object();
+        table->create_object();
+        tr->commit();
+    }
+    Observer observer;
+    handler_called = false;
+    rt->advance_read(&observer);
+    CHECK(handler_called);
+    CHECK_EQUAL(observer.num_created, 2);
+    CHECK_EQUAL(observer.num_columns, 1);
+    CHECK_EQUAL(rt->get_table("my_table")->size(), 2);
+
+    {
+        auto tr = db->start_write();
+        tr->get_table("my_table")->create_object();
+        tr->commit();
+    }
+    observer = Observer();
+    handler_called = false;
+    rt->advance_read(&observer);
+    CHECK_NOT(handler_called);
+    CHECK_EQUAL(observer.num_created, 1);
+    CHECK_EQUAL(rt->get_table("my_table")->size(), 3);
+
+    // Same when rolling back, where the observer sees the reversed log
+    rt->promote_to_write();
+    rt->get_table("my_table")->add_column(type_String, "string");
+    observer = Observer();
+    handler_called = false;
+    rt->rollback_and_continue_as_read(&observer);
+    CHECK(handler_called);
+    CHECK_EQUAL(observer.num_columns, -1);
+    CHECK_EQUAL(rt->get_table("my_table")->get_column_count(), 1);
+}
+
 #endif
@@ -159,6 +159,9 @@ static std::vector<std::string> valid_queries = {
     "contains contains 'contains'",
     "beginswith beginswith 'beginswith'",
     "endswith endswith 'endswith'",
+    "a TEXT 'b c'",
+    "a text $0",
+    "text Text 'text'",
     // "NOT NOT != 'NOT'",
     // "AND == 'AND' AND OR == 'OR'",
     // FIXME - bug
@@ -901,6 +904,43 @@ TEST(Parser_StringOperations)
     verify_query(test_context, t, "NULL LIKE[c] name", 1);
 }
 
+TEST(Parser_TextSearch)
+{
+    Group g;
+    TableRef t = g.add_table("note");
+    ColKey body_col = t->add_column(type_String, "body", true);
+    ColKey text_col = t->add_column(type_String, "text");
+    t->add_column(*t, "parent");
+    t->add_column(type_Int, "int");
+    std::vector<std::string> bodies = {"The quick brown fox", "A quick brown dog", "Lazy dogs sleep",
+                                       "FOX AND DOG",         "foxes, everywhere", "no match here"};
+    for (auto& body : bodies)
+        t->create_object().set(body_col, StringData(body)).set(text_col, "text");
+    t->create_object(); // null
+
+    for (bool indexed : {false, true}) {
+        if (indexed)
+            t->add_fulltext_index(body_col);
+        verify_query(test_context, t, "body TEXT 'quick'", 2);
+        verify_query(test_context, t, "body TEXT 'QUICK brown'", 2);
+        verify_query(test_context, t, "body text 'fox'", 2);
+        verify_query(test_context, t, "body TEXT 'fox dog'", 1);
+        verify_query(test_context, t, "body TEXT 'fox*'", 3);
+        verify_query(test_context, t, "body TEXT 'dog* fox*'", 1);
+        verify_query(test_context, t, "body TEXT 'cat'", 0);
+        verify_query(test_context, t, "body TEXT 'dog' AND body TEXT 'quick'", 1);
+        verify_query(test_context, t, "body TEXT 'dog' OR body TEXT 'quick'", 3);
+        verify_query(test_context, t, "NOT body TEXT 'quick'", t->size() - 2);
+        verify_query(test_context, t, "body TEXT 'quick' AND int == 0", 2);
+        verify_query(test_context, t, "text TEXT 'text'", t->size() - 1);
+    }
+
+    CHECK_THROW_ANY(verify_query(test_context, t, "parent.body TEXT 'fox'", 0));
+    CHECK_THROW_ANY(verify_query(test_context, t, "'fox' TEXT body", 0));
+    CHECK_THROW_ANY(verify_query(test_context, t, "int TEXT 'fox'", 0));
+    CHECK_THROW_ANY(verify_query(test_context, t, "body TEXT body", 0));
+}
+
 
 TEST(Parser_Timestamps)
 {
@@ -5600,4 +5600,186 @@ TEST(Query_AsymmetricObjects)
                       LogicError::wrong_kind_of_table);
 }
 
+// Queries skip leaves that cannot contain a match using the zone map of the
+// table. The results must be the same as those of a full scan.
+TEST(Query_ZoneMap)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history());
+    auto db = DB::create(*hist, path, DBOptions(crypt_key()));
+    constexpr int64_t num_objects = 20 * REALM_MAX_BPNODE_SIZE;
+    ColKey col_int, col_int_null, col_float, col_double, col_date;
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("table");
+        col_int = table->add_column(type_Int, "int");
+        col_int_null = table->add_column(type_Int, "int_null", true);
+        col_float = table->add_column(type_Float, "float");
+        col_double = table->add_column(type_Double, "double", true);
+        col_date = table->add_column(type_Timestamp, "date", true);
+        for (int64_t i = 0; i < num_objects; ++i) {
+            // Nearly sorted, like a time series
+            int64_t v = i + i % 5 - 2;
+            auto obj = table->create_object();
+            obj.set(col_int, v);
+            if (i % 11)
+                obj.set(col_int_null, v);
+            obj.set(col_float, i == num_objects / 3 ? std::numeric_limits<float>::quiet_NaN() : float(v));
+            if (i % 13)
+                obj.set(col_double, double(v));
+            if (i % 17)
+                obj.set(col_date, Timestamp(v, 0));
+        }
+        wt->commit();
+    }
+
+    auto verify = [&](ConstTableRef table, Query q, auto&& predicate) {
+        size_t expected_count = 0;
+        ObjKey expected_first;
+        for (auto& obj : *table) {
+            if (predicate(obj)) {
+                if (expected_count++ == 0)
+                    expected_first = obj.get_key();
+            }
+        }
+        CHECK_EQUAL(q.count(), expected_count);
+        CHECK_EQUAL(q.find(), expected_first);
+    };
+
+    auto check = [&](ConstTableRef t) {
+        for (int64_t v : {int64_t(-10), int64_t(0), num_objects / 2, num_objects - 1, num_objects + 10}) {
+            verify(t, t->where().greater(col_int, v), [&](const Obj& o) {
+                return o.get<int64_t>(col_int) > v;
+            });
+            verify(t, t->where().less(col_int, v), [&](const Obj& o) {
+                return o.get<int64_t>(col_int) < v;
+            });
+            verify(t, t->where().equal(col_int, v), [&](const Obj& o) {
+                return o.get<int64_t>(col_int) == v;
+            });
+            verify(t, t->where().greater_equal(col_int_null, v), [&](const Obj& o) {
+                auto val = o.get<util::Optional<int64_t>>(col_int_null);
+                return val && *val >= v;
+            });
+            verify(t, t->where().less_equal(col_int_null, v), [&](const Obj& o) {
+                auto val = o.get<util::Optional<int64_t>>(col_int_null);
+                return val && *val <= v;
+            });
+            verify(t, t->where().greater(col_float, float(v)), [&](const Obj& o) {
+                return o.get<float>(col_float) > float(v);
+            });
+            verify(t, t->where().less(col_double, double(v)), [&](const Obj& o) {
+                auto val = o.get<util::Optional<double>>(col_double);
+                return val && *val < double(v);
+            });
+            verify(t, t->where().greater_equal(col_date, Timestamp(v, 0)), [&](const Obj& o) {
+                auto val = o.get<Timestamp>(col_date);
+                return !val.is_null() && val >= Timestamp(v, 0);
+            });
+            verify(t, t->where().equal(col_date, Timestamp(v, 0)), [&](const Obj& o) {
+                return o.get<Timestamp>(col_date) == Timestamp(v, 0);
+            });
+        }
+        verify(t, t->where().equal(col_date, null()), [&](const Obj& o) {
+            return o.get<Timestamp>(col_date).is_null();
+        });
+    };
+
+    auto rt = db->start_read();
+    ConstTableRef rt_table = rt->get_table("table");
+    check(rt_table);
+    // Second run uses the cached summaries
+    size_t num_summaries = rt_table->get_zone_map().size();
+    CHECK_GREATER(num_summaries, 0);
+    check(rt_table);
+    CHECK_EQUAL(rt_table->get_zone_map().size(), num_summaries);
+    check(db->start_frozen()->get_table("table"));
+
+    // Changing a value must make the leaf visible to queries in the write
+    // transaction, and after advancing
+    {
+        auto wt = db->start_write();
+        auto table = wt->get_table("table");
+        check(table);
+        table->begin()->set(col_int, num_objects * 2);
+        CHECK_EQUAL(table->where().greater(col_int, num_objects + 10).count(), 1);
+        check(table);
+        wt->commit_and_continue_as_read();
+        CHECK_EQUAL(table->where().greater(col_int, num_objects + 10).count(), 1);
+        check(table);
+    }
+    rt->advance_read();
+    CHECK_EQUAL(rt_table->where().greater(col_int, num_objects + 10).count(), 1);
+    // Only the summaries of the leaves in the modified cluster are dropped
+    CHECK_GREATER_EQUAL(rt_table->get_zone_map().size(), num_summaries - rt_table->get_column_count());
+    check(rt_table);
+
+    // Online compaction moves the leaves without changing the table. The
+    // summaries of the leaves must not be used for the leaves which are later
+    // written to the space they were moved from.
+    SHARED_GROUP_TEST_PATH(compact_path);
+    DBOptions options(crypt_key());
+    options.compaction_budget = 1024 * 1024;
+    std::unique_ptr<Replication> compact_hist(make_in_realm_history());
+    auto compact_db = DB::create(*compact_hist, compact_path, options);
+    {
+        // The table comes last in the file, so that it is moved when the
+        // filler is removed
+        auto wt = compact_db->start_write();
+        auto filler = wt->add_table("filler");
+        auto col_filler = filler->add_column(type_String, "str");
+        std::string long_string(200, 'x');
+        for (int64_t i = 0; i < 4 * num_objects; ++i)
+            filler->create_object().set(col_filler, long_string);
+        wt->commit();
+        wt = compact_db->start_write();
+        auto table = wt->add_table("table");
+        col_int = table->add_column(type_Int, "int");
+        for (int64_t i = 0; i < num_objects; ++i)
+            table->create_object().set(col_int, i);
+        wt->commit();
+        wt = compact_db->start_write();
+        wt->remove_table("filler");
+        wt->commit();
+    }
+    auto compact_rt = compact_db->start_read();
+    ConstTableRef compact_table = compact_rt->get_table("table");
+    auto check_int = [&] {
+        verify(compact_table, compact_table->where().greater(col_int, num_objects + 10), [&](const Obj& o) {
+            return o.get<int64_t>(col_int) > num_objects + 10;
+        });
+        verify(compact_table, compact_table->where().less(col_int, 10), [&](const Obj& o) {
+            return o.get<int64_t>(col_int) < 10;
+        });
+    };
+    check_int();
+    size_t num_leaves = compact_table->get_zone_map().size();
+    CHECK_GREATER(num_leaves, 0);
+    size_t file_size = size_t(File(compact_path).get_size());
+    for (int i = 0; i < 20; ++i) {
+        auto wt = compact_db->start_write();
+        wt->add_table("other" + util::to_string(i));
+        wt->commit();
+        compact_rt->advance_read();
+        check_int();
+        // The summaries of the leaves which were moved are dropped
+        CHECK_LESS_EQUAL(compact_table->get_zone_map().size(), num_leaves);
+    }
+    if (!crypt_key()) {
+        CHECK_LESS(size_t(File(compact_path).get_size()), file_size);
+    }
+
+    // Rewrite every leaf, so that the space freed by the compaction is reused
+    // for leaves with other values
+    for (int i = 0; i < 3; ++i) {
+        auto wt = compact_db->start_write();
+        auto table = wt->get_table("table");
+        for (auto& obj : *table)
+            obj.set(col_int, obj.get<int64_t>(col_int) + num_objects);
+        wt->commit();
+        compact_rt->advance_read();
+        check_int();
+    }
+}
+
 #endif // TEST_QUERY
@@ -5851,4 +5851,72 @@ TEST(Query_links_to_with_bpnode_split)
     }
 }
 
+TEST(Query_Parallel)
+{
+    Group g;
+    auto table = g.add_table("table");
+    auto col_int = table->add_column(type_Int, "int", true);
+    auto col_double = table->add_column(type_Double, "double");
+    auto col_str = table->add_column(type_String, "str");
+    constexpr size_t num_objects = 10 * REALM_MAX_BPNODE_SIZE + 17;
+    std::vector<ObjKey> keys;
+    for (size_t i = 0; i < num_objects; ++i) {
+        auto obj = table->create_object();
+        if (i % 7)
+            obj.set(col_int, int64_t(i % 100));
+        obj.set(col_double, i * 0.5);
+        obj.set(col_str, i % 3 ? "foo" : "bar");
+        keys.push_back(obj.get_key());
+    }
+    // Leave some holes in the key sequence
+    for (size_t i = 0; i < num_objects; i += 13)
+        table->remove_object(keys[i]);
+
+    for (size_t threads : {0, 2, 3, 16}) {
+        Query seq = table->where().greater(col_int, 20).equal(col_str, "foo");
+        Query par = Query(seq).set_threads(threads);
+        CHECK_EQUAL(par.count(), seq.count());
+
+        auto tv_seq = seq.find_all();
+        auto tv_par = par.find_all();
+        CHECK_EQUAL(tv_par.size(), tv_seq.size());
+        bool same_order = true;
+        for (size_t i = 0; i < tv_seq.size() && i < tv_par.size(); ++i)
+            same_order = same_order && tv_par.get_key(i) == tv_seq.get_key(i);
+        CHECK(same_order);
+
+        // The view is synced again with the same settings
+        table->create_object().set(col_int, 50).set(col_str, "foo");
+        tv_par.sync_if_needed();
+        CHECK_EQUAL(tv_par.size(), tv_seq.size() + 1);
+        table->remove_object(tv_par.get_key(tv_par.size() - 1));
+
+        CHECK_EQUAL(*par.sum(col_int), *seq.sum(col_int));
+        CHECK_EQUAL(*par.sum(col_double), *seq.sum(col_double));
+        size_t count_seq, count_par;
+        CHECK_EQUAL(*par.avg(col_int, &count_par), *seq.avg(col_int, &count_seq));
+        CHECK_EQUAL(count_par, count_seq);
+
+        // Many objects share the smallest and largest values, and the first of them must be found
+        ObjKey key_seq, key_par;
+        CHECK_EQUAL(*par.min(col_int, &key_par), *seq.min(col_int, &key_seq));
+        CHECK_EQUAL(key_par, key_seq);
+        CHECK_EQUAL(*par.max(col_int, &key_par), *seq.max(col_int, &key_seq));
+        CHECK_EQUAL(key_par, key_seq);
+
+        // No matches
+        Query none = table->where().greater(col_int, 1000).set_threads(threads);
+        CHECK_EQUAL(none.count(), 0);
+        CHECK(none.max(col_int)->is_null());
+        CHECK_EQUAL(none.find_all().size(), 0);
+
+        // Limits and OR conditions
+        CHECK_EQUAL(par.find_all(5).size(), 5);
+        Query or_seq = table->where().less(col_int, 5).Or().equal(col_str, "bar");
+        Query or_par = Query(or_seq).set_threads(threads);
+        CHECK_EQUAL(or_par.count(), or_seq.count());
+        CHECK_EQUAL(or_par.find_all().size(), or_seq.find_all().size());
+    }
+}
+
 #endif // TEST_QUERY
@@ -50,6 +50,7 @@
 #include <realm/util/to_string.hpp>
 #include <realm/impl/simulated_failure.hpp>
 #include <realm/impl/copy_replication.hpp>
+#include <realm/hot_ranges.hpp>
 
 #include "fuzz_group.hpp"
 
@@ -2839,8 +2840,548 @@ TEST_IF(Shared_CompactEncrypt, REALM_ENABLE_ENCRYPTION)
         }
     }
 }
+
+TEST_IF(Shared_CompactEncryptGcm, REALM_ENABLE_ENCRYPTION)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    SHARED_GROUP_TEST_PATH(copy_path);
+    const char* key = "KdrL2ieWyspILXIPetpkLD6rQYKhYnS6lvGsgk4qsJAMr1adQnKsYo3oTEYJDIfa";
+
+    // The IV table entry of the first block comes first in the file, and
+    // blocks written with AES-GCM end their entry with this marker
+    auto is_gcm_file = [](const std::string& file_path) {
+        File file(file_path, File::mode_Read);
+        char entry[32];
+        file.read(entry, sizeof(entry));
+        return memcmp(entry + 24, "AES-GCM\1", 8) == 0;
+    };
+    auto check_contents = [&](DBRef db) {
+        auto rt = db->start_read();
+        auto t = rt->get_table("table");
+        CHECK_EQUAL(t->size(), 1000);
+        auto col = t->get_column_key("Strings");
+        CHECK_EQUAL(t->get_object(999).get<String>(col), "Shared_CompactEncryptGcm999");
+    };
+
+    {
+        auto db = DB::create(path, false, DBOptions(key));
+        auto tr = db->start_write();
+        TableRef t = tr->add_table("table");
+        auto col = t->add_column(type_String, "Strings");
+        for (size_t i = 0; i < 1000; i++) {
+            std::string str = "Shared_CompactEncryptGcm" + util::to_string(i);
+            t->create_object(ObjKey(i)).set(col, StringData(str));
+        }
+        tr->commit();
+    }
+    CHECK_NOT(is_gcm_file(path));
+
+    DBOptions options(key);
+    options.encryption_format = util::File::encryption_Gcm;
+    {
+        // The existing file keeps its format until it is compacted
+        auto db = DB::create(path, true, options);
+        auto tr = db->start_write();
+        tr->get_table("table")->create_object(ObjKey(1000));
+        tr->commit();
+        CHECK_NOT(is_gcm_file(path));
+        tr = db->start_write();
+        tr->get_table("table")->remove_object(ObjKey(1000));
+        tr->commit();
+
+        CHECK(db->compact());
+        CHECK(is_gcm_file(path));
+        check_contents(db);
+        db->write_copy(std::string(copy_path), key);
+    }
+    CHECK(is_gcm_file(copy_path));
+
+    {
+        // Files written with AES-GCM can be opened without asking for it, and
+        // keep their format
+        auto db = DB::create(path, true, DBOptions(key));
+        check_contents(db);
+        auto tr = db->start_write();
+        tr->get_table("table")->create_object(ObjKey(1000));
+        tr->commit();
+        check_contents(DB::create(copy_path, true, DBOptions(key)));
+    }
+    CHECK(is_gcm_file(path));
+
+    {
+        // ...and converted back by compacting
+        auto db = DB::create(path, true, DBOptions(key));
+        auto tr = db->start_write();
+        tr->get_table("table")->remove_object(ObjKey(1000));
+        tr->commit();
+        CHECK(db->compact());
+        check_contents(db);
+    }
+    CHECK_NOT(is_gcm_file(path));
+}
+
+TEST_IF(Shared_CompactEncryptGcmNonces, REALM_ENABLE_ENCRYPTION)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    SHARED_GROUP_TEST_PATH(copy_path_1);
+    SHARED_GROUP_TEST_PATH(copy_path_2);
+    const char* key = "KdrL2ieWyspILXIPetpkLD6rQYKhYnS6lvGsgk4qsJAMr1adQnKsYo3oTEYJDIfa";
+
+    DBOptions options(key);
+    options.encryption_format = util::File::encryption_Gcm;
+    {
+        auto db = DB::create(path, false, options);
+        auto tr = db->start_write();
+        TableRef t = tr->add_table("table");
+        auto col = t->add_column(type_String, "Strings");
+        for (size_t i = 0; i < 1000; i++) {
+            std::string str = "Shared_CompactEncryptGcmNonces" + util::to_string(i);
+            t->create_object(ObjKey(i)).set(col, StringData(str));
+        }
+        tr->commit();
+        // Both copies have the same contents and are written with the same
+        // key, so they only differ by their IVs
+        db->write_copy(std::string(copy_path_1), key);
+        db->write_copy(std::string(copy_path_2), key);
+    }
+
+    // The nonce of a block is made of the IV at the start of its IV table
+    // entry, the 32 bits which follow the tag, and the index of the block
+    auto read_iv_table = [](const std::string& file_path) {
+        File file(file_path, File::mode_Read);
+        std::vector<char> entries(4096);
+        file.read(entries.data(), entries.size());
+        return entries;
+    };
+    std::vector<char> entries_1 = read_iv_table(copy_path_1);
+    std::vector<char> entries_2 = read_iv_table(copy_path_2);
+    size_t num_blocks = 0;
+    for (size_t i = 0; i < 4096; i += 64) {
+        uint32_t iv_1, iv_2;
+        memcpy(&iv_1, &entries_1[i], 4);
+        memcpy(&iv_2, &entries_2[i], 4);
+        if (iv_1 == 0 || iv_2 == 0)
+            continue;
+        CHECK(memcmp(&entries_1[i + 24], "AES-GCM\1", 8) == 0);
+        bool same_nonce = iv_1 == iv_2 && memcmp(&entries_1[i + 20], &entries_2[i + 20], 4) == 0;
+        CHECK_NOT(same_nonce);
+        ++num_blocks;
+    }
+    CHECK_GREATER(num_blocks, 0);
+
+    for (const std::string& file_path : {std::string(copy_path_1), std::string(copy_path_2)}) {
+        auto db = DB::create(file_path, true, DBOptions(key));
+        auto rt = db->start_read();
+        CHECK_EQUAL(rt->get_table("table")->size(), 1000);
+    }
+}
+
+TEST_IF(Shared_EncryptGcmRestoredBackupNonces, REALM_ENABLE_ENCRYPTION)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    SHARED_GROUP_TEST_PATH(backup_path);
+    const char* key = "KdrL2ieWyspILXIPetpkLD6rQYKhYnS6lvGsgk4qsJAMr1adQnKsYo3oTEYJDIfa";
+
+    DBOptions options(key);
+    options.encryption_format = util::File::encryption_Gcm;
+    {
+        auto db = DB::create(path, false, options);
+        auto tr = db->start_write();
+        tr->add_table("table")->add_column(type_Int, "ints");
+        tr->commit();
+    }
+    File::copy(path, backup_path);
+
+    // Make the same commit to the file and to the restored backup, so that
+    // the same blocks are written again
+    auto rewrite = [&] {
+        auto db = DB::create(path, true, options);
+        auto tr = db->start_write();
+        tr->get_table("table")->create_object();
+        tr->commit();
+    };
+    auto read_iv_table = [](const std::string& file_path) {
+        File file(file_path, File::mode_Read);
+        std::vector<char> entries(4096);
+        file.read(entries.data(), entries.size());
+        return entries;
+    };
+    std::vector<char> backup_entries = read_iv_table(backup_path);
+    rewrite();
+    std::vector<char> entries_1 = read_iv_table(path);
+    File::copy(backup_path, path);
+    rewrite();
+    std::vector<char> entries_2 = read_iv_table(path);
+
+    // The nonce of a block is made of the IV at the start of its IV table
+    // entry, the 32 bits which follow the tag, and the index of the block
+    size_t num_blocks = 0;
+    for (size_t i = 0; i < 4096; i += 64) {
+        bool rewritten_1 = memcmp(&entries_1[i], &backup_entries[i], 32) != 0;
+        bool rewritten_2 = memcmp(&entries_2[i], &backup_entries[i], 32) != 0;
+        if (!rewritten_1 || !rewritten_2)
+            continue;
+        bool same_nonce =
+            memcmp(&entries_1[i], &entries_2[i], 4) == 0 && memcmp(&entries_1[i + 20], &entries_2[i + 20], 4) == 0;
+        CHECK_NOT(same_nonce);
+        ++num_blocks;
+    }
+    CHECK_GREATER(num_blocks, 0);
+
+    auto db = DB::create(path, true, DBOptions(key));
+    auto rt = db->start_read();
+    CHECK_EQUAL(rt->get_table("table")->size(), 1);
+}
+#endif
+
+TEST(Shared_OnlineCompaction)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBOptions options(crypt_key());
+    options.compaction_budget = 64 * 1024;
+    auto db = DB::create(path, false, options);
+    std::string long_string(200, 'x');
+    auto check_contents = [&](DBRef db_to_check) {
+        auto rt = db_to_check->start_read();
+        auto t = rt->get_table("table");
+        CHECK_EQUAL(t->size(), 500);
+        auto col_str = t->get_column_key("str");
+        auto col_int = t->get_column_key("int");
+        for (int64_t i = 0; i < 10000; i += 20) {
+            auto obj = t->get_object(ObjKey(i));
+            CHECK_EQUAL(obj.get<String>(col_str), long_string + util::to_string(i));
+            CHECK_EQUAL(obj.get<Int>(col_int), i);
+        }
+    };
+
+    {
+        auto tr = db->start_write();
+        auto t = tr->add_table("table");
+        auto col_str = t->add_column(type_String, "str");
+        auto col_int = t->add_column(type_Int, "int");
+        for (int64_t i = 0; i < 10000; ++i) {
+            t->create_object(ObjKey(i)).set(col_str, long_string + util::to_string(i)).set(col_int, i);
+        }
+        tr->commit();
+    }
+    size_t full_size = size_t(File(path).get_size());
+
+    // A frozen snapshot taken before the deletion keeps the space it uses
+    auto frozen = db->start_frozen();
+    {
+        auto tr = db->start_write();
+        auto t = tr->get_table("table");
+        for (int64_t i = 0; i < 10000; ++i) {
+            if (i % 20)
+                t->remove_object(ObjKey(i));
+        }
+        tr->commit();
+    }
+    auto touch = [&](int n) {
+        for (int i = 0; i < n; ++i) {
+            auto tr = db->start_write();
+            tr->get_table("table")->get_object(ObjKey(0)).set("int", 0);
+            tr->commit();
+        }
+    };
+    touch(50);
+    CHECK_GREATER_EQUAL(size_t(File(path).get_size()), full_size);
+    CHECK_EQUAL(frozen->get_table("table")->size(), 10000);
+    CHECK_EQUAL(frozen->get_table("table")->get_object(ObjKey(9999)).get<String>("str"),
+                long_string + util::to_string(9999));
+    frozen = nullptr;
+
+    // Once released, the space is reclaimed by moving the remaining objects
+    touch(200);
+    check_contents(db);
+    if (!crypt_key()) {
+        CHECK_LESS(size_t(File(path).get_size()), full_size / 2);
+    }
+    db = nullptr;
+
+    // Encrypted files are truncated when opened again
+    db = DB::create(path, false, options);
+    CHECK_LESS(size_t(File(path).get_size()), full_size / 2);
+    check_contents(db);
+    {
+        auto tr = db->start_write();
+        tr->verify();
+    }
+}
+
+#ifdef REALM_DEBUG
+// The number of commits which reused the free-lists is only counted in debug
+// mode
+TEST(Shared_FreeSpaceIndex)
+{
+    // Each DB keeps the free-lists of its last commit in memory. Commits by
+    // another DB, rollbacks and compaction must make it read them again.
+    SHARED_GROUP_TEST_PATH(path);
+    auto db_1 = DB::create(path, false, DBOptions(crypt_key()));
+    auto db_2 = DB::create(path, false, DBOptions(crypt_key()));
+    {
+        auto tr = db_1->start_write();
+        tr->add_table("table")->add_column(type_String, "str");
+        tr->commit();
+    }
+    auto num_reused = [](const DB& db) {
+        return _impl::DBFriend::get_num_reused_free_space_indexes(db);
+    };
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    auto modify = [&](DBRef db, bool commit) {
+        auto tr = db->start_write();
+        auto t = tr->get_table("table");
+        auto col = t->get_column_key("str");
+        for (int i = 0; i < 100; ++i) {
+            ObjKey key(random.draw_int_mod(1000));
+            if (auto obj = t->try_get_object(key)) {
+                obj.remove();
+            }
+            else {
+                t->create_object(key).set(col, std::string(random.draw_int_mod(300), 'x'));
+            }
+        }
+        // Keep the snapshot alive across a commit, so that some chunks are
+        // locked when the next commit reads the free-lists
+        auto frozen = db->start_frozen();
+        if (commit) {
+            tr->commit();
+        }
+        else {
+            tr->rollback();
+        }
+        tr = db->start_write();
+        tr->verify();
+    };
+    for (int i = 0; i < 20; ++i) {
+        // Only a commit which follows a commit of the same DB reuses the index
+        uint64_t reused = num_reused(*db_1);
+        modify(db_1, true);
+        CHECK_EQUAL(num_reused(*db_1), i == 0 ? reused + 1 : reused);
+        modify(db_1, true);
+        CHECK_EQUAL(num_reused(*db_1), (i == 0 ? reused + 1 : reused) + 1);
+        modify(db_1, false);
+        modify(db_2, true);
+    }
+    CHECK_EQUAL(num_reused(*db_2), 0);
+    db_2 = nullptr;
+    modify(db_1, true);
+    CHECK(db_1->compact());
+    uint64_t reused = num_reused(*db_1);
+    modify(db_1, true);
+    CHECK_EQUAL(num_reused(*db_1), reused);
+    modify(db_1, true);
+    CHECK_EQUAL(num_reused(*db_1), reused + 1);
+
+    // Another DB which only reads does not invalidate the index
+    auto db_3 = DB::create(path, false, DBOptions(crypt_key()));
+    {
+        auto tr = db_3->start_write();
+        tr->verify();
+    }
+    modify(db_1, true);
+    CHECK_EQUAL(num_reused(*db_1), reused + 2);
+}
 #endif
 
+TEST(Shared_MappingPolicies)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBOptions options(crypt_key());
+    options.mapping_advice = util::File::advice_Random;
+    options.prefetch_top_levels = true;
+    options.slab_huge_pages = util::File::huge_pages_Explicit;
+    util::MappingCounters counters;
+    {
+        auto db = DB::create(path, false, options);
+        auto tr = db->start_write();
+        auto t = tr->add_table("table");
+        auto col = t->add_column(type_Int, "int");
+        for (int64_t i = 0; i < 100000; ++i)
+            t->create_object().set(col, i);
+        tr->commit();
+    }
+
+    options.mapping_advice = util::File::advice_Sequential;
+    auto db = DB::create(path, false, options);
+    auto rt = db->start_read();
+    auto t = rt->get_table("table");
+    CHECK_EQUAL(t->size(), 100000);
+    CHECK_EQUAL(t->sum(t->get_column_key("int"))->get_int(), int64_t(100000) * 99999 / 2);
+
+    // Faults of this thread since the counters were created
+    util::MappingStats stats = counters.get();
+    CHECK_GREATER(stats.minor_faults + stats.major_faults, 0);
+    CHECK_GREATER_EQUAL(stats.tlb_misses, -1);
+}
+
+TEST(Shared_WarmStart)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::string hot_path = DB::get_core_file(path, DB::CoreFileType::HotRanges);
+    DBOptions options(crypt_key());
+    options.warm_start_interval = std::chrono::seconds(3600);
+    {
+        auto db = DB::create(path, false, options);
+        auto tr = db->start_write();
+        auto t = tr->add_table("table");
+        auto col = t->add_column(type_Int, "int");
+        for (int64_t i = 0; i < 100000; ++i)
+            t->create_object().set(col, i);
+        tr->commit();
+    }
+    if (crypt_key()) {
+        CHECK_NOT(File::exists(hot_path));
+        return;
+    }
+
+    // The ranges are recorded when the DB is closed
+    auto ranges = HotRanges::read(hot_path);
+    CHECK(!ranges.empty());
+    size_t file_size = size_t(File(path).get_size());
+    size_t end = 0;
+    for (const auto& range : ranges) {
+        CHECK_GREATER_EQUAL(range.first, end);
+        CHECK_GREATER(range.second, 0);
+        end = range.first + range.second;
+    }
+    CHECK_LESS_EQUAL(end, file_size);
+
+    // A new session reads them ahead, and records them again
+    {
+        auto db = DB::create(path, false, options);
+        auto rt = db->start_read();
+        CHECK_EQUAL(rt->get_table("table")->size(), 100000);
+    }
+    CHECK(!HotRanges::read(hot_path).empty());
+
+    // A file which does not match its checksum is ignored
+    {
+        File file(hot_path, File::mode_Append);
+        file.write("x", 1);
+    }
+    CHECK(HotRanges::read(hot_path).empty());
+    {
+        auto db = DB::create(path, false, options);
+        CHECK_EQUAL(db->start_read()->get_table("table")->size(), 100000);
+    }
+
+    DB::delete_files(path);
+    CHECK_NOT(File::exists(hot_path));
+}
+
+TEST(Shared_ReadLockCache)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBOptions options(crypt_key());
+    options.cache_read_locks = true;
+    auto db = DB::create(path, false, options);
+    ColKey col;
+    {
+        auto tr = db->start_write();
+        auto t = tr->add_table("table");
+        col = t->add_column(type_Int, "int");
+        t->create_object().set(col, 0);
+        tr->commit();
+    }
+
+    // Transactions on the same snapshot share a read lock
+    auto rt_1 = db->start_read();
+    auto rt_2 = db->start_frozen();
+    CHECK_EQUAL(rt_1->get_version(), rt_2->get_version());
+    rt_1->close();
+    CHECK_EQUAL(rt_2->get_table("table")->begin()->get<Int>(col), 0);
+
+    // A transaction ending after a newer snapshot has been pinned still
+    // releases its read lock
+    {
+        auto tr = db->start_write();
+        tr->get_table("table")->begin()->set(col, 1);
+        tr->commit();
+    }
+    auto rt_3 = db->start_read();
+    CHECK_GREATER(rt_3->get_version(), rt_2->get_version());
+    CHECK_EQUAL(rt_3->get_table("table")->begin()->get<Int>(col), 1);
+    CHECK_EQUAL(rt_2->get_table("table")->begin()->get<Int>(col), 0);
+    rt_2->close();
+    rt_3->close();
+
+    // Snapshots retained only by the cache do not accumulate
+    for (int i = 0; i < 10; ++i) {
+        db->start_read()->get_table("table")->begin()->get<Int>(col);
+        auto tr = db->start_write();
+        tr->get_table("table")->begin()->set(col, i);
+        tr->commit();
+    }
+    CHECK_LESS_EQUAL(db->get_number_of_versions(), 3);
+
+    // Readers on several threads while a writer commits
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&] {
+            int64_t last = -1;
+            while (!stop) {
+                auto rt = db->start_read();
+                int64_t value = rt->get_table("table")->begin()->get<Int>(col);
+                // The value only grows with each snapshot
+                CHECK_GREATER_EQUAL(value, last);
+                last = value;
+            }
+        });
+    }
+    for (int64_t i = 100; i < 200; ++i) {
+        auto tr = db->start_write();
+        tr->get_table("table")->begin()->set(col, i);
+        tr->commit();
+    }
+    stop = true;
+    for (auto& t : readers)
+        t.join();
+
+    // Idle read locks held by the cache do not count as open transactions
+    CHECK_EQUAL(db->start_read()->get_table("table")->begin()->get<Int>(col), 199);
+    auto rt = db->start_read();
+    CHECK_THROW(db->close(), LogicError);
+    rt->close();
+    CHECK(db->compact());
+    CHECK_EQUAL(db->start_read()->get_table("table")->begin()->get<Int>(col), 199);
+    db->close();
+
+    // A DB which only reads releases the snapshots held for threads which have
+    // stopped reading, so that the space freed by another DB is reused
+    auto reader_db = DB::create(path, false, options);
+    auto writer_db = DB::create(path, false, DBOptions(crypt_key()));
+    std::string long_string(1000, 'x');
+    ColKey col_str;
+    {
+        auto tr = writer_db->start_write();
+        auto t = tr->get_table("table");
+        col_str = t->add_column(type_String, "str");
+        for (int i = 0; i < 200; ++i)
+            t->create_object().set(col_str, long_string);
+        tr->commit();
+    }
+    for (int i = 0; i < 8; ++i) {
+        std::thread([&] {
+            reader_db->start_read()->get_table("table")->size();
+        }).join();
+    }
+    size_t file_size = 0;
+    for (int i = 0; i < 50; ++i) {
+        {
+            auto tr = writer_db->start_write();
+            for (auto& obj : *tr->get_table("table"))
+                obj.set(col_str, long_string + util::to_string(i));
+            tr->commit();
+        }
+        CHECK_EQUAL(reader_db->start_read()->get_table("table")->size(), 201);
+        if (i == 10)
+            file_size = size_t(File(path).get_size());
+    }
+    CHECK_LESS_EQUAL(size_t(File(path).get_size()), file_size * 2);
+}
+
 // Repro case for: Assertion failed: top_size == 3 || top_size == 5 || top_size == 7 [0, 3, 0, 5, 0, 7]
 NONCONCURRENT_TEST(Shared_BigAllocationsMinimized)
 {
@@ -3904,6 +4445,286 @@ TEST(Shared_MultipleDBInstances)
     CHECK_EQUAL(table->get_object(0).get<int64_t>("value"), 0);
 }
 
+TEST(Shared_GroupCommit)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBOptions options;
+    options.enable_group_commit = true;
+    ColKey col;
+    {
+        auto hist = make_in_realm_history();
+        DBRef db = DB::create(*hist, path, options);
+        {
+            auto wt = db->start_write();
+            col = wt->add_table("table")->add_column(type_Int, "value");
+            wt->commit();
+        }
+
+        const int num_threads = 4;
+        const int num_commits = 50;
+        std::vector<std::vector<util::Future<DB::version_type>>> futures(num_threads);
+        std::vector<std::vector<DB::version_type>> versions(num_threads);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < num_threads; ++i) {
+            threads.emplace_back([&, i] {
+                for (int j = 0; j < num_commits; ++j) {
+                    auto wt = db->start_write();
+                    wt->get_table("table")->create_object().set(col, i);
+                    versions[i].push_back(wt->get_version() + 1);
+                    // Every other thread waits for its commits to become durable
+                    if (i % 2)
+                        CHECK_EQUAL(wt->commit(), versions[i].back());
+                    else
+                        futures[i].push_back(wt->commit_grouped());
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        for (int i = 0; i < num_threads; i += 2) {
+            for (int j = 0; j < num_commits; ++j)
+                CHECK_EQUAL(std::move(futures[i][j]).get(), versions[i][j]);
+        }
+
+        // Commits from a DB without group commit are interleaved correctly
+        auto hist2 = make_in_realm_history();
+        DBRef db2 = DB::create(*hist2, path);
+        std::vector<util::Future<DB::version_type>> pending;
+        for (int j = 0; j < 10; ++j) {
+            auto wt = db->start_write();
+            wt->get_table("table")->create_object().set(col, 100);
+            pending.push_back(wt->commit_grouped());
+            wt = db2->start_write();
+            wt->get_table("table")->create_object().set(col, 200);
+            wt->commit();
+        }
+        db2->close();
+
+        // Pending commits are made durable when the DB is closed
+        auto wt = db->start_write();
+        wt->get_table("table")->create_object().set(col, 300);
+        pending.push_back(wt->commit_grouped());
+        wt = nullptr;
+        db->close();
+        for (auto& future : pending)
+            CHECK(future.get_no_throw().is_ok());
+    }
+
+    auto hist = make_in_realm_history();
+    DBRef db = DB::create(*hist, path);
+    auto rt = db->start_read();
+    auto table = rt->get_table("table");
+    CHECK_EQUAL(table->size(), 4 * 50 + 10 + 10 + 1);
+    CHECK_EQUAL(table->where().equal(col, 300).count(), 1);
+    rt->verify();
+}
+
+// A flush only reports the commits as durable if it selects the snapshot it
+// synced. Here another writer overwrites the slot of the file header between
+// the two steps of the flush, and never selects it. Commits in MemOnly mode
+// leave the header alone, so only the flushes select snapshots.
+TEST(Shared_GroupCommitInterleaved)
+{
+    using _impl::DBFriend;
+    SHARED_GROUP_TEST_PATH(path);
+    DBOptions options(DBOptions::Durability::MemOnly);
+    auto hist_1 = make_in_realm_history();
+    auto hist_2 = make_in_realm_history();
+    DBRef db_1 = DB::create(*hist_1, path, options);
+    DBRef db_2 = DB::create(*hist_2, path, options);
+    auto num_objects_on_disk = [&] {
+        Group g(path);
+        return g.get_table("table")->size();
+    };
+    auto create_object = [](DBRef db) {
+        auto wt = db->start_write();
+        wt->get_or_add_table("table")->create_object();
+        wt->commit();
+    };
+    auto flush = [](DBRef db) {
+        DBFriend::GroupCommitFlush flush;
+        DBFriend::begin_flush_group_commit(*db, flush);
+        bool selected = DBFriend::end_flush_group_commit(*db, flush);
+        DBFriend::release_read_lock(*db, flush);
+        return selected;
+    };
+    create_object(db_1);
+    CHECK(flush(db_1));
+    CHECK_EQUAL(num_objects_on_disk(), 1);
+    // Keeps the space of the selected snapshot from being reused
+    auto rt = db_1->start_read();
+
+    DBFriend::GroupCommitFlush flush_1, flush_2;
+    create_object(db_1);
+    DBFriend::begin_flush_group_commit(*db_1, flush_1);
+    create_object(db_2);
+    DBFriend::begin_flush_group_commit(*db_2, flush_2);
+    CHECK_NOT(DBFriend::end_flush_group_commit(*db_1, flush_1));
+    CHECK_EQUAL(num_objects_on_disk(), 1);
+
+    // A retry selects the latest snapshot, which the other writer then can no
+    // longer select
+    CHECK(flush(db_1));
+    CHECK_EQUAL(num_objects_on_disk(), 3);
+    CHECK_NOT(DBFriend::end_flush_group_commit(*db_2, flush_2));
+    CHECK_EQUAL(num_objects_on_disk(), 3);
+
+    DBFriend::release_read_lock(*db_1, flush_1);
+    DBFriend::release_read_lock(*db_2, flush_2);
+}
+
+TEST(Shared_WriteAheadLog)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    SHARED_GROUP_TEST_PATH(path_2);
+    SHARED_GROUP_TEST_PATH(path_3);
+    SHARED_GROUP_TEST_PATH(path_4);
+    std::string log_path = DB::get_core_file(path, DB::CoreFileType::WAL);
+    DBOptions options(DBOptions::Durability::WAL);
+    ColKey col;
+    {
+        auto hist = make_in_realm_history();
+        DBRef db = DB::create(*hist, path, options);
+        for (int i = 0; i < 10; ++i) {
+            auto wt = db->start_write();
+            auto table = wt->get_or_add_table("table");
+            if (i == 0)
+                col = table->add_column(type_Int, "value");
+            table->create_object().set(col, i);
+            wt->commit();
+        }
+        CHECK(File::exists(log_path));
+
+        // Simulate a crash by copying the files of the open DB. The file
+        // header still selects the empty snapshot which the file was created
+        // with, but the log brings the copy up to date.
+        File::copy(path, path_2);
+        File::copy(log_path, DB::get_core_file(path_2, DB::CoreFileType::WAL));
+        File::copy(path, path_3);
+        File::copy(log_path, DB::get_core_file(path_3, DB::CoreFileType::WAL));
+        File::copy(path, path_4);
+        {
+            // A record which was not completely written is ignored
+            File log(DB::get_core_file(path_3, DB::CoreFileType::WAL), File::mode_Update);
+            log.resize(log.get_size() - 8);
+        }
+        db->close();
+        // The log is checkpointed and removed by the last session participant
+        CHECK_NOT(File::exists(log_path));
+    }
+
+    auto check = [&](const std::string& p, size_t expected_size) {
+        auto hist = make_in_realm_history();
+        DBRef db = DB::create(*hist, p);
+        CHECK_NOT(File::exists(DB::get_core_file(p, DB::CoreFileType::WAL)));
+        auto rt = db->start_read();
+        auto table = rt->get_table("table");
+        CHECK(table);
+        if (table) {
+            CHECK_EQUAL(table->size(), expected_size);
+            CHECK_EQUAL(table->where().greater_equal(col, 0).count(), expected_size);
+        }
+        rt->verify();
+    };
+    check(path, 10);
+    check(path_2, 10);
+    check(path_3, 9);
+
+
+    // Without the log, the copy holds the snapshot selected by the file header
+    auto hist = make_in_realm_history();
+    DBRef db = DB::create(*hist, path_4);
+    CHECK_NOT(db->start_read()->has_table("table"));
+}
+
+TEST(Shared_WriteAheadLogLargeCommit)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    SHARED_GROUP_TEST_PATH(path_2);
+    std::string log_path = DB::get_core_file(path, DB::CoreFileType::WAL);
+    DBOptions options(DBOptions::Durability::WAL);
+    // The blocks of a commit are written to the log in several pieces, and a
+    // block larger than those pieces is written on its own
+    std::string large(1024 * 1024, 'x');
+    ColKey col_int, col_str;
+    {
+        auto hist = make_in_realm_history();
+        DBRef db = DB::create(*hist, path, options);
+        auto wt = db->start_write();
+        auto table = wt->add_table("table");
+        col_int = table->add_column(type_Int, "value");
+        col_str = table->add_column(type_String, "str");
+        for (int i = 0; i < 100000; ++i)
+            table->create_object().set(col_int, i);
+        table->create_object().set(col_str, StringData(large));
+        wt->commit();
+        CHECK_GREATER(File(log_path).get_size(), large.size());
+
+        File::copy(path, path_2);
+        File::copy(log_path, DB::get_core_file(path_2, DB::CoreFileType::WAL));
+    }
+
+    auto hist = make_in_realm_history();
+    DBRef db = DB::create(*hist, path_2);
+    auto rt = db->start_read();
+    auto table = rt->get_table("table");
+    CHECK(table);
+    if (table) {
+        CHECK_EQUAL(table->size(), 100001);
+        CHECK_EQUAL(table->where().greater_equal(col_int, 0).count(), 100001);
+        CHECK_EQUAL(table->where().equal(col_str, StringData(large)).count(), 1);
+    }
+    rt->verify();
+}
+
+TEST(Shared_WriteAheadLogCheckpoint)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::string log_path = DB::get_core_file(path, DB::CoreFileType::WAL);
+    DBOptions options(DBOptions::Durability::WAL);
+    options.wal_checkpoint_size = 4096;
+    ColKey col;
+    {
+        auto hist = make_in_realm_history();
+        DBRef db = DB::create(*hist, path, options);
+        {
+            auto wt = db->start_write();
+            col = wt->add_table("table")->add_column(type_String, "value");
+            wt->commit();
+        }
+
+        const int num_threads = 4;
+        const int num_commits = 100;
+        std::vector<std::thread> threads;
+        for (int i = 0; i < num_threads; ++i) {
+            threads.emplace_back([&] {
+                for (int j = 0; j < num_commits; ++j) {
+                    auto wt = db->start_write();
+                    wt->get_table("table")->create_object().set(col, std::string(200, 'x'));
+                    wt->commit();
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        // The log is emptied before the file is compacted
+        CHECK(db->compact());
+        CHECK_LESS(File(log_path).get_size(), 64);
+        auto wt = db->start_write();
+        wt->get_table("table")->create_object();
+        wt->commit();
+    }
+    CHECK_NOT(File::exists(log_path));
+
+    auto hist = make_in_realm_history();
+    DBRef db = DB::create(*hist, path, options);
+    auto rt = db->start_read();
+    auto table = rt->get_table("table");
+    CHECK_EQUAL(table->size(), 4 * 100 + 1);
+    rt->verify();
+}
+
 TEST(Shared_WriteCopy)
 {
     SHARED_GROUP_TEST_PATH(path1);
@@ -717,6 +717,61 @@ TEST(Sync_Replication)
 }
 
 
+TEST(Sync_ReplicationWithSeveralIntegrationWorkers)
+{
+    // Replicate changes to several files, which are integrated by different
+    // workers on the server.
+
+    constexpr int num_files = 4;
+    TEST_DIR(client_dir);
+    TEST_DIR(dir);
+    ClientServerFixture::Config config;
+    config.server_num_integration_workers = 3;
+    ClientServerFixture fixture{dir, test_context, std::move(config)};
+    fixture.start();
+
+    std::vector<DBRef> dbs_1, dbs_2;
+    std::vector<Session> sessions_1, sessions_2;
+    for (int i = 0; i < num_files; ++i) {
+        std::string server_path = "/test_" + util::to_string(i);
+        std::string path_1 = util::File::resolve("client_1_" + util::to_string(i) + ".realm", client_dir);
+        std::string path_2 = util::File::resolve("client_2_" + util::to_string(i) + ".realm", client_dir);
+        dbs_1.push_back(DB::create(make_client_replication(), path_1));
+        dbs_2.push_back(DB::create(make_client_replication(), path_2));
+        sessions_1.push_back(fixture.make_bound_session(dbs_1.back(), server_path));
+        sessions_2.push_back(fixture.make_bound_session(dbs_2.back(), server_path));
+    }
+
+    for (int i = 0; i < num_files; ++i) {
+        write_transaction_notifying_session(dbs_1[i], sessions_1[i], [](WriteTransaction& wt) {
+            TableRef table = wt.add_table("class_foo");
+            table->add_column(type_Int, "i");
+        });
+    }
+    for (int j = 0; j < 20; ++j) {
+        for (int i = 0; i < num_files; ++i) {
+            write_transaction_notifying_session(dbs_1[i], sessions_1[i], [&](WriteTransaction& wt) {
+                wt.get_table("class_foo")->create_object().set<int64_t>("i", i * 100 + j);
+            });
+        }
+    }
+
+    for (int i = 0; i < num_files; ++i) {
+        sessions_1[i].wait_for_upload_complete_or_client_stopped();
+        sessions_2[i].wait_for_download_complete_or_client_stopped();
+    }
+
+    for (int i = 0; i < num_files; ++i) {
+        ReadTransaction rt_1(dbs_1[i]);
+        ReadTransaction rt_2(dbs_2[i]);
+        CHECK(compare_groups(rt_1, rt_2));
+        ConstTableRef table = rt_2.get_table("class_foo");
+        CHECK_EQUAL(20, table->size());
+        CHECK_EQUAL(i * 100 + 19, table->max(table->get_column_key("i"))->get_int());
+    }
+}
+
+
 TEST(Sync_Merge)
 {
 
@@ -6642,4 +6697,198 @@ TEST(Sync_InvalidChangesetFromServer)
                    StringData(e.what()).contains("Failed to parse received changeset: Invalid interned string"));
 }
 
+TEST(Sync_ChangesetFromServerFailsToApply)
+{
+    TEST_CLIENT_DB(db);
+
+    auto& history = get_history(db);
+    history.set_client_file_ident(SaltedFileIdent{2, 0x1234567812345678}, false);
+
+    Changeset changeset;
+    instr::CreateObject instr;
+    instr.table = changeset.intern_string("Foo"); // No such table
+    instr.object = int64_t(1);
+    changeset.push_back(instr);
+
+    ChangesetEncoder::Buffer encoded;
+    encode_changeset(changeset, encoded);
+    Transformer::RemoteChangeset server_changeset;
+    server_changeset.origin_file_ident = 1;
+    server_changeset.remote_version = 1;
+    server_changeset.data = BinaryData(encoded.data(), encoded.size());
+
+    VersionInfo version_info;
+    util::StderrLogger logger;
+    CHECK_THROW_EX(history.integrate_server_changesets({}, nullptr, util::Span(&server_changeset, 1), version_info,
+                                                       DownloadBatchState::LastInBatch, logger),
+                   sync::IntegrationException,
+                   StringData(e.what()).contains("Failed to apply received changeset"));
+}
+
+TEST(Sync_IntegrateServerChangesetsWithoutLocalChanges)
+{
+    // Changesets received when there are no local changes to merge them with
+    // are applied as they are parsed, in either encoding.
+    TEST_CLIENT_DB(db);
+
+    auto& history = get_history(db);
+    history.set_client_file_ident(SaltedFileIdent{2, 0x1234567812345678}, false);
+    version_type schema_version;
+    {
+        WriteTransaction wt(db);
+        wt.get_group().add_table_with_primary_key("class_Foo", type_Int, "_id")->add_column(type_String, "str");
+        schema_version = wt.commit();
+    }
+
+    std::vector<ChangesetEncoder::Buffer> encoded(3);
+    std::vector<Transformer::RemoteChangeset> server_changesets(3);
+    for (int i = 0; i < 3; ++i) {
+        Changeset changeset;
+        instr::CreateObject create;
+        create.table = changeset.intern_string("Foo");
+        create.object = int64_t(i);
+        changeset.push_back(create);
+        instr::Update update;
+        update.table = create.table;
+        update.object = create.object;
+        update.field = changeset.intern_string("str");
+        update.value = instr::Payload{changeset.append_string("value")};
+        changeset.push_back(update);
+
+        if (i == 1) {
+            encode_changeset_columnar(changeset, encoded[i]);
+        }
+        else {
+            encode_changeset(changeset, encoded[i]);
+        }
+        server_changesets[i].origin_file_ident = 1;
+        server_changesets[i].remote_version = i + 1;
+        // Produced by the server after it integrated the schema
+        server_changesets[i].last_integrated_local_version = schema_version;
+        server_changesets[i].data = BinaryData(encoded[i].data(), encoded[i].size());
+    }
+
+    std::ostringstream log;
+    util::StreamLogger logger{log};
+    logger.set_level_threshold(util::Logger::Level::debug);
+    auto integrate = [&](std::size_t begin, std::size_t end) {
+        log.str("");
+        SyncProgress progress;
+        progress.download.server_version = end;
+        progress.download.last_integrated_client_version = schema_version;
+        progress.latest_server_version.version = end;
+        VersionInfo version_info;
+        util::Span<const Transformer::RemoteChangeset> changesets{server_changesets.data() + begin, end - begin};
+        history.integrate_server_changesets(progress, nullptr, changesets, version_info,
+                                            DownloadBatchState::LastInBatch, logger);
+        return log.str().find("as they are parsed") != std::string::npos;
+    };
+
+    CHECK(integrate(0, 2));
+    {
+        ReadTransaction rt(db);
+        auto table = rt.get_table("class_Foo");
+        CHECK_EQUAL(table->size(), 2);
+        for (int64_t i = 0; i < 2; ++i) {
+            auto obj = table->get_object_with_primary_key(i);
+            CHECK_EQUAL(obj.get<String>("str"), "value");
+        }
+    }
+
+    // A local change which the server has not seen must be merged with
+    {
+        WriteTransaction wt(db);
+        wt.get_table("class_Foo")->create_object_with_primary_key(10);
+        wt.commit();
+    }
+    CHECK_NOT(integrate(2, 3));
+    ReadTransaction rt(db);
+    auto table = rt.get_table("class_Foo");
+    CHECK_EQUAL(table->size(), 4);
+    CHECK_EQUAL(table->get_object_with_primary_key(2).get<String>("str"), "value");
+}
+
+
+TEST(Sync_ChunkedDownloadBody)
+{
+    // A DOWNLOAD body of 100 entries, compressed in chunks of at most 4KiB
+    // and decompressed on several threads.
+    std::string body;
+    std::vector<std::size_t> entry_ends;
+    for (int i = 0; i < 100; ++i) {
+        body += util::format("%1 %2 ", i, std::string(std::size_t(500 + 10 * i), char('a' + i % 26)));
+        entry_ends.push_back(body.size());
+    }
+
+    util::compression::CompressMemoryArena arena;
+    std::vector<char> compressed;
+    std::error_code ec = _impl::compress_chunked_download_body(
+        arena, {body.data(), body.size()}, util::Span<const std::size_t>{entry_ends}, 4096, compressed);
+    CHECK_NOT(ec);
+    CHECK_LESS(compressed.size(), body.size());
+
+    // Chunks are cut at entry boundaries.
+    _impl::HeaderLineParser parser({compressed.data(), compressed.size()});
+    std::size_t num_chunks = 0;
+    std::size_t offset = 0;
+    while (!parser.at_end()) {
+        offset += parser.read_next<std::size_t>();
+        parser.advance(parser.read_next<std::size_t>('\n'));
+        CHECK(std::find(entry_ends.begin(), entry_ends.end(), offset) != entry_ends.end());
+        ++num_chunks;
+    }
+    CHECK_EQUAL(offset, body.size());
+    CHECK_GREATER(num_chunks, 10);
+
+    util::ThreadPool thread_pool{3};
+    std::string decompressed(body.size(), '\0');
+    ec = _impl::decompress_chunked_download_body({compressed.data(), compressed.size()},
+                                                 {decompressed.data(), decompressed.size()}, thread_pool);
+    CHECK_NOT(ec);
+    CHECK(decompressed == body);
+
+    // An entry larger than the chunk size gets a chunk of its own.
+    ec = _impl::compress_chunked_download_body(arena, {body.data(), body.size()},
+                                               util::Span<const std::size_t>{entry_ends}, 1, compressed);
+    CHECK_NOT(ec);
+    decompressed.assign(body.size(), '\0');
+    ec = _impl::decompress_chunked_download_body({compressed.data(), compressed.size()},
+                                                 {decompressed.data(), decompressed.size()}, thread_pool);
+    CHECK_NOT(ec);
+    CHECK(decompressed == body);
+}
+
+
+TEST(Sync_ChunkedDownloadBody_Corrupt)
+{
+    using util::compression::error;
+    std::string body(10000, 'x');
+    std::vector<std::size_t> entry_ends = {2500, 5000, 7500, 10000};
+    util::compression::CompressMemoryArena arena;
+    std::vector<char> compressed;
+    CHECK_NOT(_impl::compress_chunked_download_body(arena, {body.data(), body.size()},
+                                                    util::Span<const std::size_t>{entry_ends}, 2500, compressed));
+
+    util::ThreadPool thread_pool{2};
+    auto decompress = [&](std::string_view input, std::size_t size) {
+        std::string out(size, '\0');
+        return _impl::decompress_chunked_download_body({input.data(), input.size()}, {out.data(), out.size()},
+                                                       thread_pool);
+    };
+    std::string_view input{compressed.data(), compressed.size()};
+    CHECK_NOT(decompress(input, body.size()));
+
+    // Truncated chunk
+    CHECK(decompress(input.substr(0, input.size() - 1), body.size()) == error::corrupt_input);
+    // Chunks smaller than the body
+    CHECK(decompress(input, body.size() + 1) == error::incorrect_decompressed_size);
+    // Chunks larger than the body
+    CHECK(decompress(input, body.size() - 1) == error::incorrect_decompressed_size);
+    // Bad chunk head
+    CHECK(decompress("2500 x\n", 2500) == error::corrupt_input);
+    // Bad chunk data
+    std::string bad_data = "2500 4\nabcd";
+    CHECK(decompress(bad_data, 2500));
+}
+
 } // unnamed namespace
@@ -3989,6 +3989,93 @@ TEST(Table_CreateObjectWithPrimaryKeyDidCreate)
     CHECK_NOT(did_create);
 }
 
+TEST(Table_CreateObjectsColumnar)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history());
+    DBRef db = DB::create(*hist, path);
+
+    const size_t num_objects = 2500;
+    std::vector<Mixed> pks, names, ages;
+    for (size_t i = 0; i < num_objects; ++i) {
+        // Primary keys in descending order, names with many duplicates
+        pks.emplace_back(int64_t(2 * (num_objects - i)));
+        if (i % 7 == 0)
+            names.emplace_back();
+        else
+            names.emplace_back(StringData(i % 2 ? "odd" : "even"));
+        ages.emplace_back(int64_t(i));
+    }
+
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table_with_primary_key("class_Person", type_Int, "id");
+        auto col_pk = table->get_primary_key_column();
+        auto col_name = table->add_column(type_String, "name", true);
+        auto col_age = table->add_column(type_Int, "age");
+        auto col_score = table->add_column(type_Double, "score");
+        table->add_search_index(col_name);
+        table->add_search_index(col_age);
+
+        table->create_object_with_primary_key(int64_t(1)).set(col_age, 100);
+        auto keys = table->create_objects(num_objects, {{col_age, util::Span<const Mixed>(ages)},
+                                                        {col_pk, util::Span<const Mixed>(pks)},
+                                                        {col_name, util::Span<const Mixed>(names)}});
+        CHECK_EQUAL(keys.size(), num_objects);
+        CHECK_EQUAL(table->size(), num_objects + 1);
+        for (size_t i = 0; i < num_objects; ++i) {
+            Obj obj = table->get_object(keys[i]);
+            CHECK_EQUAL(obj.get_primary_key(), pks[i]);
+            CHECK_EQUAL(obj.get_any(col_name), names[i]);
+            CHECK_EQUAL(obj.get<Int>(col_age), ages[i].get_int());
+            CHECK_EQUAL(obj.get<Double>(col_score), 0.);
+        }
+        CHECK_EQUAL(table->find_primary_key(pks[17]), keys[17]);
+        CHECK_EQUAL(table->find_first_int(col_age, 17), keys[17]);
+        CHECK_EQUAL(table->where().equal(col_name, StringData("odd")).count(), 1071);
+        CHECK_EQUAL(table->where().equal(col_name, StringData()).count(), 359);
+        CHECK_EQUAL(table->where().equal(col_age, 100).count(), 2);
+
+        // Duplicates within the batch or with existing objects are rejected
+        // before anything is created
+        std::vector<Mixed> dup_pks = {int64_t(-1), int64_t(-2), int64_t(-1)};
+        CHECK_THROW(table->create_objects(3, {{col_pk, util::Span<const Mixed>(dup_pks)}}), std::logic_error);
+        dup_pks[2] = int64_t(1);
+        CHECK_THROW(table->create_objects(3, {{col_pk, util::Span<const Mixed>(dup_pks)}}), std::logic_error);
+        CHECK_THROW(table->create_objects(3, {{col_age, util::Span<const Mixed>(dup_pks)}}), LogicError);
+        std::vector<Mixed> bad_type = {int64_t(-1), StringData("a"), int64_t(-3)};
+        CHECK_THROW(table->create_objects(3, {{col_pk, util::Span<const Mixed>(bad_type)}}), LogicError);
+        // Nulls are rejected for required columns
+        std::vector<Mixed> new_pks = {int64_t(-1), int64_t(-2), int64_t(-3)};
+        std::vector<Mixed> null_age = {int64_t(1), int64_t(2), Mixed()};
+        CHECK_THROW(table->create_objects(3, {{col_pk, util::Span<const Mixed>(new_pks)},
+                                              {col_age, util::Span<const Mixed>(null_age)}}),
+                    LogicError);
+        CHECK_EQUAL(table->size(), num_objects + 1);
+        table->verify();
+        wt->commit();
+    }
+
+    auto rt = db->start_read();
+    auto table = rt->get_table("class_Person");
+    CHECK_EQUAL(table->size(), num_objects + 1);
+    CHECK(table->find_primary_key(Mixed(int64_t(2))));
+    table->verify();
+
+    // Table without primary key
+    auto wt = db->start_write();
+    auto plain = wt->add_table("plain");
+    auto col_name = plain->add_column(type_String, "name", true);
+    plain->add_search_index(col_name);
+    plain->create_object();
+    auto keys = plain->create_objects(num_objects, {{col_name, util::Span<const Mixed>(names)}});
+    CHECK_EQUAL(plain->size(), num_objects + 1);
+    CHECK_EQUAL(plain->get_object(keys.back()).get_any(col_name), names.back());
+    CHECK_EQUAL(plain->where().equal(col_name, StringData()).count(), 359);
+    plain->verify();
+    wt->commit();
+}
+
 TEST(Table_PrimaryKeyIndexBug)
 {
     Group g;
@@ -28,6 +28,7 @@
 #include <realm.hpp>
 
 #include "util/misc.hpp"
+#include "util/random.hpp"
 
 #include "test.hpp"
 #include "test_table_helper.hpp"
@@ -2690,6 +2691,93 @@ TEST(TableView_SortNull)
     CHECK_EQUAL(tv.get_object(0).get_key(), keys[9]);
 }
 
+// Large views are sorted with all values fetched up front, using a radix sort
+// for integer, boolean and timestamp columns and a parallel sort otherwise.
+TEST(TableView_SortLarge)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Group g;
+    auto target = g.add_table("target");
+    auto col_target_int = target->add_column(type_Int, "int", true);
+    auto table = g.add_table("table");
+    auto col_int = table->add_column(type_Int, "int", true);
+    auto col_bool = table->add_column(type_Bool, "bool");
+    auto col_date = table->add_column(type_Timestamp, "date", true);
+    auto col_str = table->add_column(type_String, "string", true);
+    auto col_link = table->add_column(*target, "link");
+
+    std::vector<ObjKey> target_keys;
+    for (int i = 0; i < 100; ++i)
+        target_keys.push_back(target->create_object().set(col_target_int, random.draw_int(-10, 10)).get_key());
+
+    for (int i = 0; i < 5000; ++i) {
+        Obj obj = table->create_object();
+        if (random.draw_int_mod(10) != 0)
+            obj.set(col_int, random.draw_int<int64_t>(-50, 50) << random.draw_int(0, 50));
+        obj.set(col_bool, random.draw_bool());
+        if (random.draw_int_mod(10) != 0) {
+            // The nanoseconds must have the same sign as the seconds
+            int64_t seconds = random.draw_int(-3, 3);
+            int32_t nanoseconds = random.draw_int(0, 2);
+            obj.set(col_date, Timestamp(seconds, seconds < 0 ? -nanoseconds : nanoseconds));
+        }
+        if (random.draw_int_mod(10) != 0)
+            obj.set(col_str, util::to_string(random.draw_int(0, 30)));
+        if (random.draw_int_mod(10) != 0)
+            obj.set(col_link, target_keys[random.draw_int_mod(target_keys.size())]);
+    }
+
+    auto check = [&](std::vector<std::vector<ColKey>> columns, std::vector<bool> ascending) {
+        TableView tv = table->where().find_all();
+        std::vector<ObjKey> expected(tv.size());
+        for (size_t i = 0; i < tv.size(); ++i)
+            expected[i] = tv.get_key(i);
+        // Null links are ordered after all values when ascending
+        auto get_value = [&](ObjKey key, const std::vector<ColKey>& path) -> util::Optional<Mixed> {
+            Obj obj = table->get_object(key);
+            for (size_t i = 0; i + 1 < path.size(); ++i) {
+                ObjKey link = obj.get<ObjKey>(path[i]);
+                if (!link)
+                    return util::none;
+                obj = obj.get_target_table(path[i])->get_object(link);
+            }
+            return obj.get_any(path.back());
+        };
+        std::stable_sort(expected.begin(), expected.end(), [&](ObjKey a, ObjKey b) {
+            for (size_t i = 0; i < columns.size(); ++i) {
+                auto value_a = get_value(a, columns[i]);
+                auto value_b = get_value(b, columns[i]);
+                if (!value_a || !value_b) {
+                    if (bool(value_a) == bool(value_b))
+                        continue;
+                    return ascending[i] == bool(value_a);
+                }
+                int c = value_a->compare(*value_b);
+                if (c != 0)
+                    return ascending[i] ? c < 0 : c > 0;
+            }
+            return false;
+        });
+
+        tv.sort(SortDescriptor{columns, ascending});
+        CHECK_EQUAL(tv.size(), expected.size());
+        for (size_t i = 0; i < tv.size(); ++i)
+            CHECK_EQUAL(tv.get_key(i), expected[i]);
+    };
+
+    check({{col_int}}, {true});
+    check({{col_int}}, {false});
+    check({{col_date}}, {true});
+    check({{col_date}}, {false});
+    check({{col_bool}, {col_int}}, {true, false});
+    check({{col_bool}, {col_date}, {col_int}}, {false, true, true});
+    check({{col_str}}, {true});
+    check({{col_str}, {col_int}}, {false, true});
+    check({{col_bool}, {col_str}, {col_date}}, {true, false, true});
+    check({{col_link, col_target_int}, {col_int}}, {true, true});
+    check({{col_int}, {col_link, col_target_int}}, {false, false});
+}
+
 // Verify that copy-constructed and copy-assigned TableViews work normally.
 TEST(TableView_Copy)
 {
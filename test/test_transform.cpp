@@ -1607,6 +1607,77 @@ TEST(Transform_CreateEraseCreateSequencePreservesObject)
     });
 }
 
+TEST(Transform_ManyEditsOfSameObjects)
+{
+    // Two clients make many edits to different fields of the same, linked
+    // objects while offline. The merge only visits instructions on the same
+    // field or on the object itself, and must produce the same result as
+    // merging against the entire conflict group.
+
+    auto changeset_dump_dir_gen = get_changeset_dump_dir_generator(test_context);
+    Associativity assoc{test_context, 2, changeset_dump_dir_gen.get()};
+    assoc.for_each_permutation([&](auto& it) {
+        auto server = &*it.server;
+        auto client_1 = &*it.clients[0];
+        auto client_2 = &*it.clients[1];
+
+        client_1->transaction([&](Peer& c) {
+            auto table = c.group->add_table_with_primary_key("class_table", type_Int, "pk");
+            table->add_column(type_Int, "a");
+            table->add_column(type_Int, "b");
+            table->add_column_list(type_Int, "l");
+            table->add_column(*table, "link");
+            auto obj_1 = table->create_object_with_primary_key(1);
+            auto obj_2 = table->create_object_with_primary_key(2);
+            obj_1.set("link", obj_2.get_key());
+            auto list = obj_1.get_list<int64_t>("l");
+            list.add(0);
+            list.add(1);
+            list.add(2);
+        });
+
+        it.sync_all();
+
+        for (int64_t i = 0; i < 100; ++i) {
+            client_1->transaction([&](Peer& c) {
+                TableRef table = c.group->get_table("class_table");
+                auto obj_1 = table->get_object_with_primary_key(1);
+                obj_1.set("a", i);
+                obj_1.get_list<int64_t>("l").add(100 + i);
+            });
+        }
+
+        client_2->history.advance_time(1);
+        for (int64_t i = 0; i < 100; ++i) {
+            client_2->transaction([&](Peer& c) {
+                TableRef table = c.group->get_table("class_table");
+                table->get_object_with_primary_key(1).set("b", i);
+                table->get_object_with_primary_key(2).set("a", i);
+            });
+        }
+        client_2->transaction([&](Peer& c) {
+            TableRef table = c.group->get_table("class_table");
+            table->get_object_with_primary_key(1).get_list<int64_t>("l").remove(0);
+        });
+
+        it.sync_all();
+
+        ReadTransaction rt_0(server->shared_group);
+        auto table = rt_0.get_table("class_table");
+        CHECK_EQUAL(table->size(), 2);
+        auto obj_1 = table->get_object_with_primary_key(1);
+        auto obj_2 = table->get_object_with_primary_key(2);
+        CHECK_EQUAL(obj_1.get<int64_t>("a"), 99);
+        CHECK_EQUAL(obj_1.get<int64_t>("b"), 99);
+        CHECK_EQUAL(obj_2.get<int64_t>("a"), 99);
+        auto list = obj_1.get_list<int64_t>("l");
+        CHECK_EQUAL(list.size(), 102);
+        CHECK_EQUAL(list.get(0), 1);
+        CHECK_EQUAL(list.get(2), 100);
+        CHECK_EQUAL(list.get(101), 199);
+    });
+}
+
 TEST(Transform_AddIntegerSurvivesSetNull)
 {
     // An AddInteger instruction merged with a Set(null) instruction with a
@@ -0,0 +1,128 @@
+/*************************************************************************
+ *
+ * Copyright 2022 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+
+#include <realm/util/thread_pool.hpp>
+
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#include "test.hpp"
+#include "util/random.hpp"
+
+using namespace realm;
+using namespace realm::test_util;
+
+// Test independence and thread-safety
+// -----------------------------------
+//
+// All tests must be thread safe and independent of each other. This
+// is required because it allows for both shuffling of the execution
+// order and for parallelized testing.
+//
+// In particular, avoid using std::rand() since it is not guaranteed
+// to be thread safe. Instead use the API offered in
+// `test/util/random.hpp`.
+//
+// All files created in tests must use the TEST_PATH macro (or one of
+// its friends) to obtain a suitable file system path. See
+// `test/util/test_path.hpp`.
+//
+//
+// Debugging and the ONLY() macro
+// ------------------------------
+//
+// A simple way of disabling all tests except one called `Foo`, is to
+// replace TEST(Foo) with ONLY(Foo) and then recompile and rerun the
+// test suite. Note that you can also use filtering by setting the
+// environment varible `UNITTEST_FILTER`. See `README.md` for more on
+// this.
+//
+// Another way to debug a particular test, is to copy that test into
+// `experiments/testcase.cpp` and then run `sh build.sh
+// check-testcase` (or one of its friends) from the command line.
+
+namespace {
+
+TEST(Util_ThreadPool_Run)
+{
+    for (size_t num_threads : {0, 1, 3}) {
+        util::ThreadPool pool(num_threads);
+        CHECK_EQUAL(pool.get_num_threads(), num_threads);
+
+        std::vector<std::atomic<int>> executed(100);
+        pool.run(executed.size(), [&](size_t i) {
+            ++executed[i];
+        });
+        for (auto& count : executed)
+            CHECK_EQUAL(count.load(), 1);
+
+        // Batches submitted from inside a task must make progress as well
+        std::atomic<size_t> total{0};
+        pool.run(4, [&](size_t) {
+            pool.run(8, [&](size_t i) {
+                total += i;
+            });
+        });
+        CHECK_EQUAL(total.load(), 4 * 28);
+
+        pool.run(0, [&](size_t) {
+            CHECK(false);
+        });
+    }
+}
+
+TEST(Util_ThreadPool_Exception)
+{
+    util::ThreadPool pool(2);
+    CHECK_THROW(pool.run(10,
+                         [](size_t i) {
+                             if (i == 5)
+                                 throw std::runtime_error("task failed");
+                         }),
+                std::runtime_error);
+
+    // The pool is still usable afterwards
+    std::atomic<size_t> count{0};
+    pool.run(10, [&](size_t) {
+        ++count;
+    });
+    CHECK_EQUAL(count.load(), 10);
+}
+
+TEST(Util_ThreadPool_ParallelSort)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    util::ThreadPool pool(3);
+    for (size_t size : {0, 1, 2, 10, 1000, 10007}) {
+        for (size_t num_chunks : {0, 1, 2, 3, 7, 64}) {
+            std::vector<int> values(size);
+            for (auto& v : values)
+                v = random.draw_int(-100, 100);
+            std::vector<int> expected = values;
+            std::sort(expected.begin(), expected.end(), std::greater<>());
+            util::parallel_sort(pool, values.begin(), values.end(), std::greater<>(), num_chunks);
+            CHECK(values == expected);
+        }
+    }
+}
+
+} // unnamed namespace